@@ -8484,11 +8484,417 @@ static void addJump(EcCompiler *cp, EcNode *np, int kind)
 }
 
 
+/*
+ *  Decoded instruction used by the peephole optimizer
+ */
+typedef struct EcInstruction {
+    int         offset;                 /* Code offset of the instruction */
+    int         opcode;                 /* Instruction opcode */
+    int         length;                 /* Length of the instruction including operands */
+    int         slot;                   /* Slot operand for the Get/Put local and object slot instructions */
+    int         jumpKind;               /* EJS_OPT_JMP or EJS_OPT_JMP8 if the instruction branches */
+    int         jumpPos;                /* Offset of the jump operand relative to the instruction */
+    int         target;                 /* Code offset of the branch target */
+} EcInstruction;
+
+
+static uchar *decodeOperandNum(uchar *pc, uchar *end, int *value)
+{
+    uint    t, c;
+    int     shift;
+
+    t = 0;
+    shift = 0;
+    do {
+        if (pc >= end || shift > 28) {
+            return 0;
+        }
+        c = *pc++;
+        t |= (c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+    *value = (int) t;
+    return pc;
+}
+
+
+/*
+ *  Decode the function code into an instruction list. Return the number of instructions or -1 if the code uses
+ *  constructs that the peephole optimizer does not relocate (default argument jump tables).
+ */
+static int decodeInstructions(EcCompiler *cp, uchar *code, int len, EcInstruction *instructions)
+{
+    EjsOptable      *optable, *opt;
+    EcInstruction   *ip;
+    uchar           *pc, *end;
+    int             *argp, numOpcodes, count, value, word;
+
+    optable = ejsGetOptable();
+    for (numOpcodes = 0; optable[numOpcodes].name; numOpcodes++) ;
+
+    pc = code;
+    end = &code[len];
+
+    for (count = 0; pc < end; count++) {
+        ip = &instructions[count];
+        memset(ip, 0, sizeof(EcInstruction));
+        ip->offset = (int) (pc - code);
+        ip->opcode = *pc++;
+        ip->slot = -1;
+        if (ip->opcode >= numOpcodes) {
+            return -1;
+        }
+        opt = &optable[ip->opcode];
+        for (argp = opt->args; *argp && pc; argp++) {
+            switch (*argp) {
+            case EJS_OPT_BYTE:
+                pc = (pc + 1 <= end) ? pc + 1 : 0;
+                break;
+
+            case EJS_OPT_SHORT:
+                pc = (pc + 2 <= end) ? pc + 2 : 0;
+                break;
+
+            case EJS_OPT_WORD:
+                pc = (pc + 4 <= end) ? pc + 4 : 0;
+                break;
+
+            case EJS_OPT_LONG:
+            case EJS_OPT_DOUBLE:
+                pc = (pc + 8 <= end) ? pc + 8 : 0;
+                break;
+
+            case EJS_OPT_SLOT:
+                pc = decodeOperandNum(pc, end, &value);
+                if (ip->slot < 0) {
+                    ip->slot = value;
+                }
+                break;
+
+            case EJS_OPT_NUM:
+            case EJS_OPT_STRING:
+            case EJS_OPT_ARGC:
+            case EJS_OPT_ARGC2:
+                pc = decodeOperandNum(pc, end, &value);
+                break;
+
+            case EJS_OPT_GLOBAL:
+                pc = decodeOperandNum(pc, end, &value);
+                if (pc && (value & EJS_ENCODE_GLOBAL_MASK) == EJS_ENCODE_GLOBAL_NAME) {
+                    pc = decodeOperandNum(pc, end, &value);
+                }
+                break;
+
+            case EJS_OPT_JMP:
+                if (pc + 4 > end) {
+                    return -1;
+                }
+                memcpy(&word, pc, sizeof(int));
+                ip->jumpKind = EJS_OPT_JMP;
+                ip->jumpPos = (int) (pc - code) - ip->offset;
+                pc += 4;
+                ip->target = (int) (pc - code) + word;
+                break;
+
+            case EJS_OPT_JMP8:
+                if (pc + 1 > end) {
+                    return -1;
+                }
+                ip->jumpKind = EJS_OPT_JMP8;
+                ip->jumpPos = (int) (pc - code) - ip->offset;
+                pc++;
+                ip->target = (int) (pc - code) + (char) pc[-1];
+                break;
+
+            default:
+                return -1;
+            }
+        }
+        if (pc == 0) {
+            return -1;
+        }
+        ip->length = (int) (pc - code) - ip->offset;
+        if (ip->opcode >= EJS_OP_GET_LOCAL_SLOT_0 && ip->opcode <= EJS_OP_GET_LOCAL_SLOT_9) {
+            ip->slot = ip->opcode - EJS_OP_GET_LOCAL_SLOT_0;
+        } else if (ip->opcode >= EJS_OP_PUT_LOCAL_SLOT_0 && ip->opcode <= EJS_OP_PUT_LOCAL_SLOT_9) {
+            ip->slot = ip->opcode - EJS_OP_PUT_LOCAL_SLOT_0;
+        } else if (ip->opcode >= EJS_OP_GET_OBJ_SLOT_0 && ip->opcode <= EJS_OP_GET_OBJ_SLOT_9) {
+            ip->slot = ip->opcode - EJS_OP_GET_OBJ_SLOT_0;
+        }
+    }
+    return count;
+}
+
+
+static int isGetLocalSlot(EcInstruction *ip)
+{
+    return ip->opcode == EJS_OP_GET_LOCAL_SLOT || (EJS_OP_GET_LOCAL_SLOT_0 <= ip->opcode && 
+        ip->opcode <= EJS_OP_GET_LOCAL_SLOT_9);
+}
+
+
+static int isPutLocalSlot(EcInstruction *ip)
+{
+    return ip->opcode == EJS_OP_PUT_LOCAL_SLOT || (EJS_OP_PUT_LOCAL_SLOT_0 <= ip->opcode && 
+        ip->opcode <= EJS_OP_PUT_LOCAL_SLOT_9);
+}
+
+
+static int isGetObjSlot(EcInstruction *ip)
+{
+    return ip->opcode == EJS_OP_GET_OBJ_SLOT || (EJS_OP_GET_OBJ_SLOT_0 <= ip->opcode && 
+        ip->opcode <= EJS_OP_GET_OBJ_SLOT_9);
+}
+
+
+static int isCompare(EcInstruction *ip)
+{
+    switch (ip->opcode) {
+    case EJS_OP_COMPARE_EQ:
+    case EJS_OP_COMPARE_NE:
+    case EJS_OP_COMPARE_LT:
+    case EJS_OP_COMPARE_LE:
+    case EJS_OP_COMPARE_GT:
+    case EJS_OP_COMPARE_GE:
+    case EJS_OP_COMPARE_STRICTLY_EQ:
+    case EJS_OP_COMPARE_STRICTLY_NE:
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ *  Return the superinstruction that can replace the sequence starting at "ip" and set *span to the number of 
+ *  instructions it replaces. Interior instructions must not be branch targets. Returns zero if there is no match.
+ */
+static int matchSuperInstruction(EcInstruction *ip, EcInstruction *last, char *isTarget, int *span)
+{
+    EcInstruction   *next;
+    int             i;
+
+    next = &ip[1];
+    if (next > last || isTarget[next->offset]) {
+        return 0;
+    }
+    if (isGetLocalSlot(ip) && isGetObjSlot(next)) {
+        *span = 2;
+        return EJS_OP_GET_LOCAL_PROPERTY_SLOT;
+    }
+    if (isCompare(ip)) {
+        switch (next->opcode) {
+        case EJS_OP_BRANCH_FALSE:
+            *span = 2;
+            return EJS_OP_COMPARE_BRANCH_FALSE;
+        case EJS_OP_BRANCH_TRUE:
+            *span = 2;
+            return EJS_OP_COMPARE_BRANCH_TRUE;
+        case EJS_OP_BRANCH_FALSE_8:
+            *span = 2;
+            return EJS_OP_COMPARE_BRANCH_FALSE_8;
+        case EJS_OP_BRANCH_TRUE_8:
+            *span = 2;
+            return EJS_OP_COMPARE_BRANCH_TRUE_8;
+        }
+        return 0;
+    }
+    /*
+     *  Postfix and prefix increment of a local where the result is discarded:
+     *      GetLocalSlot, Dup, Inc, PutLocalSlot, Pop
+     *      GetLocalSlot, Inc, Dup, PutLocalSlot, Pop
+     */
+    if (isGetLocalSlot(ip) && &ip[4] <= last) {
+        for (i = 1; i <= 4; i++) {
+            if (isTarget[ip[i].offset]) {
+                return 0;
+            }
+        }
+        if (((ip[1].opcode == EJS_OP_DUP && ip[2].opcode == EJS_OP_INC) || 
+                (ip[1].opcode == EJS_OP_INC && ip[2].opcode == EJS_OP_DUP)) &&
+                isPutLocalSlot(&ip[3]) && ip[3].slot == ip->slot && ip[4].opcode == EJS_OP_POP) {
+            *span = 5;
+            return EJS_OP_INC_LOCAL_SLOT;
+        }
+    }
+    return 0;
+}
+
+
+static uchar *encodeOperandNum(uchar *pc, uint number)
+{
+    do {
+        *pc = number & 0x7f;
+        if ((number >>= 7) != 0) {
+            *pc |= 0x80;
+        }
+        pc++;
+    } while (number);
+    return pc;
+}
+
+
+/*
+ *  Peephole optimizer. Fuse common instruction sequences in the final function code into superinstructions. 
+ *  Branch offsets and exception handler ranges are relocated. The code is left unmodified if it cannot be safely 
+ *  rewritten.
+ */
+static void optimizeFunctionCode(EcCompiler *cp, EcCodeGen *code)
+{
+    EcInstruction   *instructions, *ip, *last;
+    EjsEx           *ex;
+    uchar           *buf, *newCode, *pc, *start;
+    char            *isTarget;
+    int             *offsetMap, *jumps;
+    int             len, count, i, next, opcode, span, numJumps, offset, target, changed;
+
+    buf = (uchar*) mprGetBufStart(code->buf);
+    len = mprGetBufLength(code->buf);
+    if (len <= 0 || cp->buildEndian != cp->hostEndian) {
+        return;
+    }
+
+    /*
+     *  Superinstructions can be up to 50% larger than the sequences they replace (GetLocalSlot_0, GetObjSlot_0).
+     */
+    instructions = (EcInstruction*) mprAlloc(cp, len * sizeof(EcInstruction));
+    isTarget = (char*) mprAllocZeroed(cp, len + 1);
+    offsetMap = (int*) mprAlloc(cp, (len + 1) * sizeof(int));
+    jumps = (int*) mprAlloc(cp, len * sizeof(int));
+    newCode = (uchar*) mprAlloc(cp, len * 2);
+    if (instructions == 0 || isTarget == 0 || offsetMap == 0 || jumps == 0 || newCode == 0) {
+        goto done;
+    }
+    if ((count = decodeInstructions(cp, buf, len, instructions)) <= 0) {
+        goto done;
+    }
+
+    /*
+     *  Branch targets and exception boundaries must be preserved. They must also be instruction boundaries, otherwise 
+     *  the code is not understood and is left as-is.
+     */
+    for (i = 0; i <= len; i++) {
+        offsetMap[i] = -1;
+    }
+    for (i = 0; i < count; i++) {
+        offsetMap[instructions[i].offset] = 0;
+    }
+    offsetMap[len] = 0;
+    for (i = 0; i < count; i++) {
+        ip = &instructions[i];
+        if (ip->jumpKind) {
+            if (ip->target < 0 || ip->target > len || offsetMap[ip->target] < 0) {
+                goto done;
+            }
+            isTarget[ip->target] = 1;
+        }
+    }
+    next = 0;
+    while ((ex = (EjsEx*) mprGetNextItem(code->exceptions, &next)) != 0) {
+        if (ex->tryStart > (uint) len || ex->tryEnd > (uint) len || ex->handlerStart > (uint) len || 
+                ex->handlerEnd > (uint) len || offsetMap[ex->tryStart] < 0 || offsetMap[ex->tryEnd] < 0 || 
+                offsetMap[ex->handlerStart] < 0 || offsetMap[ex->handlerEnd] < 0) {
+            goto done;
+        }
+        isTarget[ex->tryStart] = isTarget[ex->tryEnd] = isTarget[ex->handlerStart] = isTarget[ex->handlerEnd] = 1;
+    }
+
+    /*
+     *  Emit the new code. Record the new offset of every original instruction and the location of each jump operand.
+     */
+    last = &instructions[count - 1];
+    pc = newCode;
+    numJumps = 0;
+    changed = 0;
+
+    for (i = 0; i < count; i += span) {
+        ip = &instructions[i];
+        start = pc;
+        offsetMap[ip->offset] = (int) (pc - newCode);
+        if ((opcode = matchSuperInstruction(ip, last, isTarget, &span)) == 0) {
+            span = 1;
+            memcpy(pc, &buf[ip->offset], ip->length);
+            pc += ip->length;
+            if (ip->jumpKind) {
+                jumps[numJumps++] = i;
+                ip->jumpPos = (int) (start - newCode) + ip->jumpPos;
+            }
+            continue;
+        }
+        changed++;
+        *pc++ = opcode;
+
+        switch (opcode) {
+        case EJS_OP_GET_LOCAL_PROPERTY_SLOT:
+            pc = encodeOperandNum(pc, ip[0].slot);
+            pc = encodeOperandNum(pc, ip[1].slot);
+            break;
+
+        case EJS_OP_COMPARE_BRANCH_FALSE:
+        case EJS_OP_COMPARE_BRANCH_TRUE:
+        case EJS_OP_COMPARE_BRANCH_FALSE_8:
+        case EJS_OP_COMPARE_BRANCH_TRUE_8:
+            *pc++ = ip[0].opcode;
+            ip[1].jumpPos = (int) (pc - newCode);
+            jumps[numJumps++] = i + 1;
+            pc += (ip[1].jumpKind == EJS_OPT_JMP) ? 4 : 1;
+            break;
+
+        case EJS_OP_INC_LOCAL_SLOT:
+            pc = encodeOperandNum(pc, ip[0].slot);
+            *pc++ = (ip[1].opcode == EJS_OP_INC) ? buf[ip[1].offset + 1] : buf[ip[2].offset + 1];
+            break;
+        }
+    }
+    if (changed == 0) {
+        goto done;
+    }
+    offsetMap[len] = (int) (pc - newCode);
+
+    /*
+     *  Relocate branches. Fused sequences never contain targets, so every target maps to an emitted instruction.
+     */
+    for (i = 0; i < numJumps; i++) {
+        ip = &instructions[jumps[i]];
+        target = offsetMap[ip->target];
+        if (ip->jumpKind == EJS_OPT_JMP) {
+            offset = target - (ip->jumpPos + 4);
+            memcpy(&newCode[ip->jumpPos], &offset, sizeof(int));
+        } else {
+            offset = target - (ip->jumpPos + 1);
+            if (offset < -128 || offset > 127) {
+                goto done;
+            }
+            newCode[ip->jumpPos] = (uchar) offset;
+        }
+    }
+    next = 0;
+    while ((ex = (EjsEx*) mprGetNextItem(code->exceptions, &next)) != 0) {
+        ex->tryStart = offsetMap[ex->tryStart];
+        ex->tryEnd = offsetMap[ex->tryEnd];
+        ex->handlerStart = offsetMap[ex->handlerStart];
+        ex->handlerEnd = offsetMap[ex->handlerEnd];
+    }
+    mprFlushBuf(code->buf);
+    mprPutBlockToBuf(code->buf, (char*) newCode, (int) (pc - newCode));
+
+done:
+    mprFree(instructions);
+    mprFree(isTarget);
+    mprFree(offsetMap);
+    mprFree(jumps);
+    mprFree(newCode);
+}
+
+
 static void setFunctionCode(EcCompiler *cp, EjsFunction *fun, EcCodeGen *code)
 {
     EjsEx       *ex;
     int         next, len;
 
+    if (cp->optimizeLevel > 0) {
+        optimizeFunctionCode(cp, code);
+    }
+
     /*
      *  Define any try/catch blocks encountered
      */
@@ -41,29 +41,31 @@
 #define ES_ejs_db_Database_close                                       10
 #define ES_ejs_db_Database_sql                                         11
 #define ES_ejs_db_Database_query                                       12
-#define ES_ejs_db_Database_connection                                  13
-#define ES_ejs_db_Database_name                                        14
-#define ES_ejs_db_Database_getTables                                   15
-#define ES_ejs_db_Database_getColumns                                  16
-#define ES_ejs_db_Database_defaultDatabase                             17
-#define ES_ejs_db_Database_set_defaultDatabase                         18
-#define ES_ejs_db_Database_DatatypeToSqlite                            19
-#define ES_ejs_db_Database_SqliteToDatatype                            20
-#define ES_ejs_db_Database_SqliteToEjs                                 21
-#define ES_ejs_db_Database_createDatabase                              22
-#define ES_ejs_db_Database_destroyDatabase                             23
-#define ES_ejs_db_Database_createTable                                 24
-#define ES_ejs_db_Database_renameTable                                 25
-#define ES_ejs_db_Database_destroyTable                                26
-#define ES_ejs_db_Database_addIndex                                    27
-#define ES_ejs_db_Database_removeIndex                                 28
-#define ES_ejs_db_Database_addColumn                                   29
-#define ES_ejs_db_Database_changeColumn                                30
-#define ES_ejs_db_Database_renameColumn                                31
-#define ES_ejs_db_Database_removeColumns                               32
-#define ES_ejs_db_Database_log                                         33
-#define ES_ejs_db_Database_trace                                       34
-#define ES_ejs_db_Database_NUM_CLASS_PROP                              35
+#define ES_ejs_db_Database_statementCache                              13
+#define ES_ejs_db_Database_cursor                                      14
+#define ES_ejs_db_Database_connection                                  15
+#define ES_ejs_db_Database_name                                        16
+#define ES_ejs_db_Database_getTables                                   17
+#define ES_ejs_db_Database_getColumns                                  18
+#define ES_ejs_db_Database_defaultDatabase                             19
+#define ES_ejs_db_Database_set_defaultDatabase                         20
+#define ES_ejs_db_Database_DatatypeToSqlite                            21
+#define ES_ejs_db_Database_SqliteToDatatype                            22
+#define ES_ejs_db_Database_SqliteToEjs                                 23
+#define ES_ejs_db_Database_createDatabase                              24
+#define ES_ejs_db_Database_destroyDatabase                             25
+#define ES_ejs_db_Database_createTable                                 26
+#define ES_ejs_db_Database_renameTable                                 27
+#define ES_ejs_db_Database_destroyTable                                28
+#define ES_ejs_db_Database_addIndex                                    29
+#define ES_ejs_db_Database_removeIndex                                 30
+#define ES_ejs_db_Database_addColumn                                   31
+#define ES_ejs_db_Database_changeColumn                                32
+#define ES_ejs_db_Database_renameColumn                                33
+#define ES_ejs_db_Database_removeColumns                               34
+#define ES_ejs_db_Database_log                                         35
+#define ES_ejs_db_Database_trace                                       36
+#define ES_ejs_db_Database_NUM_CLASS_PROP                              37
 
 /**
  * Instance slots for "Database" type 
@@ -79,7 +81,11 @@
 #define ES_ejs_db_Database_Database_connectionString                   0
 #define ES_ejs_db_Database_connect_connectionString                    0
 #define ES_ejs_db_Database_sql_cmd                                     0
+#define ES_ejs_db_Database_sql_params                                  1
 #define ES_ejs_db_Database_query_cmd                                   0
+#define ES_ejs_db_Database_query_params                                1
+#define ES_ejs_db_Database_cursor_cmd                                  0
+#define ES_ejs_db_Database_cursor_params                               1
 #define ES_ejs_db_Database_getTables_cmd                               0
 #define ES_ejs_db_Database_getTables_grid                              1
 #define ES_ejs_db_Database_getTables_result                            2
@@ -129,6 +135,20 @@
 #define ES_ejs_db_Database_trace_on                                    0
 
 
+/**
+ *   Class property slots for the "Cursor" class 
+ */
+#define ES_ejs_db_Cursor__origin                                       5
+#define ES_ejs_db_Cursor_next                                          5
+#define ES_ejs_db_Cursor_close                                         6
+#define ES_ejs_db_Cursor_NUM_CLASS_PROP                                7
+
+/**
+ * Instance slots for "Cursor" type 
+ */
+#define ES_ejs_db_Cursor_NUM_INSTANCE_PROP                             0
+
+
 /**
  *   Class property slots for the "Record" class 
  */
@@ -338,6 +358,6 @@
 #define ES_ejs_db_Record_coerceTypes__hoisted_0_field                  0
 #define ES_ejs_db_Record_coerceTypes__hoisted_1_value                  1
 
-#define _ES_CHECKSUM_ejs_db 1141514
+#define _ES_CHECKSUM_ejs_db 1179833
 
 #endif
@@ -5159,26 +5159,46 @@ module ejs.db {
 
 		/**
 		 *	Execute a SQL command on the database. This is a low level SQL command interface that bypasses logging.
-         *	    Use @query instead.
-		 *	@param sql SQL command string
+         *	    Use @query instead. Prepared statements for single SQL commands are cached and reused when the same 
+         *	    command text is executed again.
+		 *	@param sql SQL command string. Use "?" for parameter values.
+		 *	@param params Optional array of values to bind in order to the "?" parameters of the command
 		 *	@returns An array of row results where each row is represented by an Object hash containing the column names and
 		 *		values
 		 */
-		native function sql(cmd: String): Array
+		native function sql(cmd: String, params: Array = null): Array
 
 
 		/**
 		 *	Execute a SQL command on the database.
-		 *	@param sql SQL command string
+		 *	@param sql SQL command string. Use "?" for parameter values rather than concatenating values into the command.
+		 *	@param params Values to bind in order to the "?" parameters of the command
 		 *	@returns An array of row results where each row is represented by an Object hash containing the column names and
 		 *		values
          */
-        function query(cmd: String): Array {
+        function query(cmd: String, ...params): Array {
             log(cmd)
-            return sql(cmd)
+            return sql(cmd, params)
         }
 
 
+        /**
+         *  Get the prepared statement cache statistics.
+         *  @returns An object with "hits" and "misses" counts, the "count" of cached statements and the cache "limit"
+         */
+        native function get statementCache(): Object
+
+
+        /**
+         *  Create a cursor to step through the result rows of a SQL command one row at a time. Rows are created as they
+         *  are read rather than creating an array of all the rows.
+         *  @param sql SQL command string. Use "?" for parameter values. Cursors support a single SQL command.
+         *  @param params Values to bind in order to the "?" parameters of the command
+         *  @returns A Cursor for use with "for each ..." or Cursor.next
+         */
+        native function cursor(cmd: String, ...params): Cursor
+
+
 		/**
 		 *	Get the database connection string
 		 */
@@ -5477,6 +5497,36 @@ module ejs.db {
 		function commit(): Void {}
 */
 	}
+
+
+    /**
+     *  Database result cursor. Cursors step through the result rows of a SQL command one row at a time. Each row is 
+     *  an Object hash of the column names and values. INTEGER and REAL column values are Numbers, NULL values are null 
+     *  and other values are Strings. Cursors are created via Database.cursor.
+     */
+    class Cursor {
+
+        use default namespace public
+
+        /**
+         *  Return an iterator over the remaining result rows. For use with "for each ..."
+         *  @return An iterator object
+         */
+        override iterator native function getValues(deep: Boolean = false): Iterator
+
+
+        /**
+         *  Get the next result row. The cursor is closed after the last row has been read.
+         *  @returns The next row object or null if there are no more rows
+         */
+        native function next(): Object
+
+
+        /**
+         *  Close the cursor and release the SQL statement. Cursors should be closed if not all rows are read.
+         */
+        native function close(): Void
+    }
 }
 
 
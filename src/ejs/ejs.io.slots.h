@@ -72,8 +72,8 @@
  *    Local slots for methods in type BinaryStream 
  */
 #define ES_ejs_io_BinaryStream_BinaryStream_stream                     0
-#define ES_ejs_io_BinaryStream_BinaryStream___fun_9733__               1
-#define ES_ejs_io_BinaryStream_BinaryStream___fun_9754__               2
+#define ES_ejs_io_BinaryStream_BinaryStream___fun_9788__               1
+#define ES_ejs_io_BinaryStream_BinaryStream___fun_9809__               2
 #define ES_ejs_io_BinaryStream_close_graceful                          0
 #define ES_ejs_io_BinaryStream_set_endian_value                        0
 #define ES_ejs_io_BinaryStream_read_buffer                             0
@@ -492,6 +492,6 @@
 #define ES_ejs_io_XMLHttp_callback_hp                                  1
 #define ES_ejs_io_XMLHttp_callback_count                               2
 
-#define _ES_CHECKSUM_ejs_io 1375817
+#define _ES_CHECKSUM_ejs_io 1375828
 
 #endif
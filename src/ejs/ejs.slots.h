@@ -93,61 +93,62 @@
 #define ES_Type                                                        72
 #define ES_Void                                                        73
 #define ES_ejs_db_Database                                             74
-#define ES_ejs_db_Record                                               75
-#define ES_ejs_db_pluralize                                            76
-#define ES_ejs_events_Dispatcher                                       77
-#define ES_Endpoint                                                    78
-#define ES_ejs_events_Event                                            79
-#define ES_ejs_events_Timer                                            80
-#define ES_ejs_events_TimerEvent                                       81
-#define ES_ejs_io_BinaryStream                                         82
-#define ES_ejs_io_File                                                 83
-#define ES_ejs_io_Http                                                 84
-#define ES_ejs_io_HttpDataEvent                                        85
-#define ES_ejs_io_HttpErrorEvent                                       86
-#define ES_ejs_io_TextStream                                           87
-#define ES_ejs_io_XMLHttp                                              88
-#define ES_ejs_sys_App                                                 89
-#define ES_Config                                                      90
-#define ES_ejs_sys_GC                                                  91
-#define ES_ejs_sys_Memory                                              92
-#define ES_ejs_sys_System                                              93
-#define ES_basename                                                    94
-#define ES_close                                                       95
-#define ES_cp                                                          96
-#define ES_dirname                                                     97
-#define ES_exists                                                      98
-#define ES_extension                                                   99
-#define ES_freeSpace                                                   100
-#define ES_isDir                                                       101
-#define ES_ls                                                          102
-#define ES_mkdir                                                       103
-#define ES_mv                                                          104
-#define ES_open                                                        105
-#define ES_pwd                                                         106
-#define ES_read                                                        107
-#define ES_rm                                                          108
-#define ES_rmdir                                                       109
-#define ES_tempname                                                    110
-#define ES_write                                                       111
-#define ES_ejs_web_GoogleConnector                                     112
-#define ES_ejs_web_HtmlConnector                                       113
-#define ES_ejs_web_action                                              114
-#define ES_ejs_web_view                                                115
-#define ES_ejs_web_Controller                                          116
-#define ES_ejs_web__SoloController                                     117
-#define ES_ejs_web_Cookie                                              118
-#define ES_ejs_web_Host                                                119
-#define ES_ejs_web_Request                                             120
-#define ES_ejs_web_Response                                            121
-#define ES_ejs_web_sessions                                            122
-#define ES_ejs_web_Session                                             123
-#define ES_ejs_web_UploadFile                                          124
-#define ES_ejs_web_View                                                125
-#define ES_Model                                                       126
-#define ES_XML                                                         127
-#define ES_XMLList                                                     128
-#define ES_global_NUM_CLASS_PROP                                       129
+#define ES_ejs_db_Cursor                                               75
+#define ES_ejs_db_Record                                               76
+#define ES_ejs_db_pluralize                                            77
+#define ES_ejs_events_Dispatcher                                       78
+#define ES_Endpoint                                                    79
+#define ES_ejs_events_Event                                            80
+#define ES_ejs_events_Timer                                            81
+#define ES_ejs_events_TimerEvent                                       82
+#define ES_ejs_io_BinaryStream                                         83
+#define ES_ejs_io_File                                                 84
+#define ES_ejs_io_Http                                                 85
+#define ES_ejs_io_HttpDataEvent                                        86
+#define ES_ejs_io_HttpErrorEvent                                       87
+#define ES_ejs_io_TextStream                                           88
+#define ES_ejs_io_XMLHttp                                              89
+#define ES_ejs_sys_App                                                 90
+#define ES_Config                                                      91
+#define ES_ejs_sys_GC                                                  92
+#define ES_ejs_sys_Memory                                              93
+#define ES_ejs_sys_System                                              94
+#define ES_basename                                                    95
+#define ES_close                                                       96
+#define ES_cp                                                          97
+#define ES_dirname                                                     98
+#define ES_exists                                                      99
+#define ES_extension                                                   100
+#define ES_freeSpace                                                   101
+#define ES_isDir                                                       102
+#define ES_ls                                                          103
+#define ES_mkdir                                                       104
+#define ES_mv                                                          105
+#define ES_open                                                        106
+#define ES_pwd                                                         107
+#define ES_read                                                        108
+#define ES_rm                                                          109
+#define ES_rmdir                                                       110
+#define ES_tempname                                                    111
+#define ES_write                                                       112
+#define ES_ejs_web_GoogleConnector                                     113
+#define ES_ejs_web_HtmlConnector                                       114
+#define ES_ejs_web_action                                              115
+#define ES_ejs_web_view                                                116
+#define ES_ejs_web_Controller                                          117
+#define ES_ejs_web__SoloController                                     118
+#define ES_ejs_web_Cookie                                              119
+#define ES_ejs_web_Host                                                120
+#define ES_ejs_web_Request                                             121
+#define ES_ejs_web_Response                                            122
+#define ES_ejs_web_sessions                                            123
+#define ES_ejs_web_Session                                             124
+#define ES_ejs_web_UploadFile                                          125
+#define ES_ejs_web_View                                                126
+#define ES_Model                                                       127
+#define ES_XML                                                         128
+#define ES_XMLList                                                     129
+#define ES_global_NUM_CLASS_PROP                                       130
 
 /**
  * Instance slots for "global" type 
@@ -1298,6 +1299,6 @@
 #define ES_XMLList_setSettings_settings                                0
 #define ES_XMLList_text_name                                           0
 
-#define _ES_CHECKSUM_ejs 2089289
+#define _ES_CHECKSUM_ejs 2091700
 
 #endif
@@ -722,11 +722,11 @@
 #define ES_ejs_web_View_ejs_web_getValue_typeName                      4
 #define ES_ejs_web_View_ejs_web_getValue_fmt                           5
 #define ES_ejs_web_View_ejs_web_date_fmt                               0
-#define ES_ejs_web_View_ejs_web_date___fun_21788__                     1
+#define ES_ejs_web_View_ejs_web_date___fun_21843__                     1
 #define ES_ejs_web_View_ejs_web_currency_fmt                           0
-#define ES_ejs_web_View_ejs_web_currency___fun_21822__                 1
+#define ES_ejs_web_View_ejs_web_currency___fun_21877__                 1
 #define ES_ejs_web_View_ejs_web_number_fmt                             0
-#define ES_ejs_web_View_ejs_web_number___fun_21852__                   1
+#define ES_ejs_web_View_ejs_web_number___fun_21907__                   1
 #define ES_ejs_web_View_ejs_web_getOptions_options                     0
 #define ES_ejs_web_View_ejs_web_getOptions_result                      1
 #define ES_ejs_web_View_ejs_web_getOptions__hoisted_2_option           2
@@ -951,6 +951,6 @@
 #define ES_Model_coerceTypes__hoisted_1_value                          1
 #define ES_Model_Model_fields                                          0
 
-#define _ES_CHECKSUM_ejs_web 3386549
+#define _ES_CHECKSUM_ejs_web 3386552
 
 #endif
@@ -379,7 +379,7 @@ static EjsVar *getRequestVar(void *handle, int field)
 
     case ES_ejs_web_Request_sessionID:
         web = ejs->handle;
-        return createString(ejs, web->session ? web->session->id : "");
+        return createString(ejs, (web->session && web->session->state) ? web->session->state->id : "");
 
     case ES_ejs_web_Request_url:
         return createString(ejs, req->url);
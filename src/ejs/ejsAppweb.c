@@ -6,6 +6,7 @@
 /********************************** Includes **********************************/
 
 #include    "ejs.h"
+#include    "ec.h"
 
 #if BLD_APPWEB_PRODUCT || BLD_FEATURE_APPWEB
 
@@ -20,6 +21,7 @@ static void ejsWebUnlock(void *lockData);
 
 /***************************** Forward Declarations *****************************/
 
+static int  compileModule(MprCtx ctx, cchar *module, int argc, char **files);
 static void error(void *handle, int code, cchar *fmt, ...);
 static int  parseUrl(MaConn *conn);
 static void redirect(void *handle, int code, cchar *url);
@@ -150,6 +152,9 @@ static int parseUrl(MaConn *conn)
     if (location->flags & MA_LOC_AUTO_SESSION) {
         flags |= EJS_WEB_FLAG_SESSION;
     }
+    if (location->flags & MA_LOC_MODULE_CACHE) {
+        flags |= EJS_WEB_FLAG_CACHE;
+    }
 
     control = conn->http->ejsHandler->stageData;
     web = ejsCreateWebRequest(req, control, conn, baseUrl, url, baseDir, flags);
@@ -376,7 +381,7 @@ static EjsVar *getRequestVar(void *handle, int field)
 
     case ES_ejs_web_Request_sessionID:
         web = ejs->handle;
-        return createString(ejs, web->session ? web->session->id : "");
+        return createString(ejs, (web->session && web->session->state) ? web->session->state->id : "");
 
     case ES_ejs_web_Request_url:
         return createString(ejs, req->url);
@@ -538,12 +543,57 @@ static int writeBlock(void *handle, cchar *buf, int size)
 }
 
 
+/*
+ *  Compile web components in-process. This is equivalent to "ejsc --debug --web --out module files". Called by the 
+ *  web framework on its compile thread.
+ */
+static int compileModule(MprCtx ctx, cchar *module, int argc, char **files)
+{
+    Ejs             *ejs;
+    EcCompiler      *cp;
+    MprList         *useModules;
+    cchar           *name;
+    int             next, rc;
+
+    if ((ejs = ejsCreate(ctx, NULL, EJS_FLAG_COMPILER | EJS_FLAG_NO_EXE)) == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+    if ((cp = ecCreateCompiler(ejs, EC_FLAGS_DEBUG, BLD_FEATURE_EJS_LANG)) == 0) {
+        mprFree(ejs);
+        return MPR_ERR_NO_MEMORY;
+    }
+    ecSetOutputFile(cp, module);
+
+    useModules = mprCreateList(cp);
+#if BLD_FEATURE_EJS_DB
+    mprAddItem(useModules, "ejs.db");
+#endif
+    mprAddItem(useModules, "ejs.web");
+    for (next = 0; (name = (cchar*) mprGetNextItem(useModules, &next)) != 0; ) {
+        if (ejsLoadModule(ejs, name, NULL, NULL, EJS_MODULE_DONT_INIT) == 0) {
+            mprError(ctx, "Can't load module %s\n%s", name, ejsGetErrorMsg(ejs, 0));
+            mprFree(ejs);
+            return MPR_ERR_CANT_READ;
+        }
+    }
+    cp->useModules = useModules;
+
+    rc = ecCompile(cp, argc, files, 0);
+    if (rc == 0 && cp->errorCount > 0) {
+        rc = MPR_ERR_BAD_SYNTAX;
+    }
+    mprFree(ejs);
+    return rc;
+}
+
+
 #if BLD_FEATURE_CONFIG_PARSE
 static int parseEjs(MaHttp *http, cchar *key, char *value, MaConfigState *state)
 {
     MaLocation      *location;
     MaServer        *server;
     MaHost          *host;
+    EjsWebControl   *control;
     char            *prefix, *path;
     int             flags;
     
@@ -551,7 +601,7 @@ static int parseEjs(MaHttp *http, cchar *key, char *value, MaConfigState *state)
     server = state->server;
     location = state->location;
     
-    flags = location->flags & (MA_LOC_BROWSER | MA_LOC_AUTO_SESSION);
+    flags = location->flags & (MA_LOC_BROWSER | MA_LOC_AUTO_SESSION | MA_LOC_MODULE_CACHE);
 
 #if UNUSED
     MaStage         *ejsHandler;
@@ -616,6 +666,22 @@ static int parseEjs(MaHttp *http, cchar *key, char *value, MaConfigState *state)
         }
         return 1;
 
+    } else if (mprStrcmpAnyCase(key, "EjsModuleCache") == 0) {
+        if (value == 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        value = mprStrTrim(value, "\"");
+        if (mprStrcmpAnyCase(value, "off") == 0) {
+            location->flags &= ~MA_LOC_MODULE_CACHE;
+        } else {
+            location->flags |= MA_LOC_MODULE_CACHE;
+            if (mprStrcmpAnyCase(value, "on") != 0) {
+                control = (EjsWebControl*) http->ejsHandler->stageData;
+                control->moduleCheck = atoi(value) * MPR_TICKS_PER_SEC;
+            }
+        }
+        return 1;
+
     } else if (mprStrcmpAnyCase(key, "EjsSessionTimeout") == 0) {
         if (value == 0) {
             return MPR_ERR_BAD_SYNTAX;
@@ -701,6 +767,7 @@ MprModule *maEjsHandlerInit(MaHttp *http, cchar *path)
     control->setHttpCode = setHttpCode;
     control->setMimeType = setMimeType;
     control->write = writeBlock;
+    control->compile = compileModule;
     control->modulePath = mprStrdup(control, path);
 
 #if BLD_FEATURE_MULTITHREAD && FUTURE
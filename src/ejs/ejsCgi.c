@@ -714,7 +714,7 @@ static EjsVar *getRequestVar(void *handle, int field)
         return createString(ejs, getHeader(handle, "REMOTE_ADDR"));
 
     case ES_ejs_web_Request_sessionID:
-        return createString(ejs, web->session ? web->session->id : "");
+        return createString(ejs, (web->session && web->session->state) ? web->session->state->id : "");
 
     case ES_ejs_web_Request_url:
         return createString(ejs, uri);
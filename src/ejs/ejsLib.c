@@ -7746,13 +7746,16 @@ bool ejsIsInfinite(MprNumber f)
 EjsNumber *ejsCreateNumber(Ejs *ejs, MprNumber value)
 {
     EjsNumber   *vp;
+    int         i;
 
-    if (value == 0) {
-        return ejs->zeroValue;
-    } else if (value == 1) {
-        return ejs->oneValue;
-    } else if (value == -1) {
-        return ejs->minusOneValue;
+    /*
+     *  Small integers are shared and never allocated. This covers most loop counters, indices and arithmetic results.
+     */
+    if (EJS_MIN_SMALL_INT <= value && value <= EJS_MAX_SMALL_INT) {
+        i = (int) value;
+        if (i == value) {
+            return ejs->smallInts[i - EJS_MIN_SMALL_INT];
+        }
     }
 
     vp = (EjsNumber*) ejsCreateVar(ejs, ejs->numberType, 0);
@@ -7769,7 +7772,9 @@ EjsNumber *ejsCreateNumber(Ejs *ejs, MprNumber value)
 void ejsCreateNumberType(Ejs *ejs)
 {
     EjsType     *type;
+    EjsNumber   *np;
     EjsName     qname;
+    int         i;
 #if BLD_FEATURE_FLOATING_POINT
     static int  zero = 0;
 #endif
@@ -7821,6 +7826,30 @@ void ejsCreateNumberType(Ejs *ejs)
     ejsSetDebugName(ejs->zeroValue, "0");
     ejsSetDebugName(ejs->maxValue, "MaxValue");
     ejsSetDebugName(ejs->minValue, "MinValue");
+
+    /*
+     *  Pre-create the shared small integers. These are created in the eternal generation and are never collected.
+     *  They are created last so the other values exist if the table can't be allocated. ejsCreateNumber requires the
+     *  table, so failing to create it fails the interpreter.
+     */
+    ejs->smallInts = (EjsNumber**) mprAlloc(ejs, (EJS_MAX_SMALL_INT - EJS_MIN_SMALL_INT + 1) * sizeof(EjsNumber*));
+    if (ejs->smallInts == 0) {
+        ejs->hasError = 1;
+        return;
+    }
+    for (i = EJS_MIN_SMALL_INT; i <= EJS_MAX_SMALL_INT; i++) {
+        if (i == 0) {
+            np = ejs->zeroValue;
+        } else if (i == 1) {
+            np = ejs->oneValue;
+        } else if (i == -1) {
+            np = ejs->minusOneValue;
+        } else if ((np = (EjsNumber*) ejsCreateVar(ejs, ejs->numberType, 0)) != 0) {
+            np->value = i;
+            ejsSetDebugName(np, "small integer");
+        }
+        ejs->smallInts[i - EJS_MIN_SMALL_INT] = np;
+    }
 }
 
 
@@ -8049,7 +8078,8 @@ EjsObject *ejsCreateObjectEx(Ejs *ejs, EjsType *type, int numExtraSlots, bool se
 EjsObject *ejsCopyObject(Ejs *ejs, EjsObject *src, bool deep)
 {
     EjsObject   *dest;
-    bool        separateSlots;
+    cchar       *name;
+    bool        separateSlots, ownNames;
     int         numProp, i;
 
     numProp = src->numProp;
@@ -8075,7 +8105,6 @@ EjsObject *ejsCopyObject(Ejs *ejs, EjsObject *src, bool deep)
     dest->var.isType = src->var.isType;
     dest->var.isFrame = src->var.isFrame;
     dest->var.hidden = src->var.hidden;
-    dest->var.marked = src->var.marked;
     dest->var.native = src->var.native;
     dest->var.nativeProc = src->var.nativeProc;
     dest->var.permanent = src->var.permanent;
@@ -8098,13 +8127,24 @@ EjsObject *ejsCopyObject(Ejs *ejs, EjsObject *src, bool deep)
         ejsSetReference(ejs, (EjsVar*) dest, dest->slots[i]);
     }
 
-    if (separateSlots) {
-        if (dest->names == NULL && growNames(dest, numProp) < 0) {
+    /*
+     *  A names block owned by the source object is freed with its property names when the source is collected. So the 
+     *  copy must have its own names block and its own copies of the names. Names owned by a type can be shared. Type
+     *  names may be part of the loaded module and are not tested.
+     */
+    ownNames = (!ejsIsType(src) && src->names && mprGetParent(src->names) == src);
+    if (separateSlots || ownNames) {
+        if ((dest->names == NULL || mprGetParent(dest->names) != dest) && growNames(dest, numProp) < 0) {
             return 0;
         }
-
         for (i = 0; i < numProp; i++) {
             dest->names->entries[i] = src->names->entries[i];
+            name = src->names->entries[i].qname.name;
+            if (ownNames && name && *name) {
+                if ((dest->names->entries[i].qname.name = mprStrdup(dest, name)) == 0) {
+                    return 0;
+                }
+            }
         }
         if (makeHash(dest) < 0) {
             return 0;
@@ -20620,6 +20660,7 @@ EjsVar *ejsGetException(Ejs *ejs)
 
 
 static void addRoot(Ejs *ejs, int generation, EjsVar *obj);
+static void addSharedRoot(Ejs *ejs, EjsVar *obj);
 static inline void addVar(struct Ejs *ejs, struct EjsVar *vp, int generation);
 static inline void linkVar(EjsGen *gen, EjsVar *vp);
 static void mark(Ejs *ejs, int generation);
@@ -20739,7 +20780,7 @@ void ejsCollectGarbage(Ejs *ejs, int mode)
             totalCreated = 0;
             for (i = EJS_GEN_NEW; i < EJS_GEN_ETERNAL; i++) {
                 count = gc->generations[i].newlyCreated;
-                if (count > prevMax || count > EJS_GC_WORK_QUOTA) {
+                if (count > prevMax || count > gc->workQuota) {
                     prevMax = count;
                     generation = i;
                 }
@@ -20749,7 +20790,7 @@ void ejsCollectGarbage(Ejs *ejs, int mode)
             /*
              *  Collect from this generation and all younger generations.
              */
-            if (totalCreated < EJS_GC_WORK_QUOTA) {
+            if (totalCreated < gc->workQuota) {
                 break;
             }
             mark(ejs, generation);
@@ -20767,6 +20808,49 @@ void ejsCollectGarbage(Ejs *ejs, int mode)
 }
 
 
+/*
+ *  Discard all objects created after the given eternal object without marking. This returns a cloned interpreter to
+ *  its state after cloning so it can be reused. The caller must first remove all references to the discarded objects
+ *  from the objects that remain. The cross-generational roots are cleared.
+ */
+void ejsDiscardObjects(Ejs *ejs, EjsVar *lastEternal)
+{
+    EjsGC       *gc;
+    EjsGen      *gen;
+    EjsVar      *vp;
+    int         i;
+
+    gc = &ejs->gc;
+    mprAssert(!gc->collecting);
+
+    ejsFlushPropertyCache(ejs);
+
+    for (i = 0; i < EJS_MAX_GEN; i++) {
+        gen = &gc->generations[i];
+        while ((vp = gen->next) != 0 && !(i == EJS_GEN_ETERNAL && vp == lastEternal)) {
+            checkAddr(vp);
+            unlinkVar(gen, 0, vp);
+            if (vp->type->hasFinalizer) {
+                ejsFinalizeVar(ejs, vp);
+            }
+            ejsDestroyVar(ejs, vp);
+            gc->allocatedObjects--;
+            gc->totalReclaimed++;
+        }
+        gen->nextRoot = gen->roots;
+        gen->rootCount = 0;
+        *gen->nextRoot = 0;
+        gen->newlyCreated = 0;
+    }
+    if (gc->sharedRoots) {
+        mprClearList(gc->sharedRoots);
+    }
+    gc->overflow = 0;
+    gc->workDone = 0;
+    gc->required = 0;
+}
+
+
 /*
  *  Mark phase. Mark objects that are still in use and should not be collected.
  */
@@ -20830,6 +20914,16 @@ static void mark(Ejs *ejs, int generation)
             ejsMarkVar(ejs, NULL, *src);
         }
     }
+
+    /*
+     *  Master objects are not marked by clones, but their properties may refer to objects owned by this interpreter.
+     *  Traverse them without setting the mark so the master's own collector is not disturbed.
+     */
+    if (gc->sharedRoots) {
+        for (next = 0; (vp = mprGetNextItem(gc->sharedRoots, &next)) != 0; ) {
+            (vp->type->helpers->markVar)(ejs, NULL, vp);
+        }
+    }
 }
 
 
@@ -20849,6 +20943,11 @@ static int sweep(Ejs *ejs, int maxGeneration)
     count = 0;
     aliveCount = 0;
 
+    /*
+     *  Cached property lookups may refer to objects being freed
+     */
+    ejsFlushPropertyCache(ejs);
+
     /*
      *  Must go from oldest to youngest generation incase moving objects to elder generations and we clear the mark. Must
      *  not re-examine.
@@ -21063,6 +21162,17 @@ void ejsMarkVar(Ejs *ejs, EjsVar *container, EjsVar *vp)
     if (vp->marked) {
         return;
     }
+
+    /*
+     *  Objects owned by the master are shared by all clones and are only marked by the master. The master does not
+     *  mark objects owned by clones as the clones may be collecting them concurrently.
+     */
+    if (vp->master && !(ejs->flags & EJS_FLAG_MASTER)) {
+        return;
+    }
+    if (!vp->master && (ejs->flags & EJS_FLAG_MASTER)) {
+        return;
+    }
     
     /*
      *  Don't traverse generations older than the one being marked. 
@@ -21070,7 +21180,7 @@ void ejsMarkVar(Ejs *ejs, EjsVar *container, EjsVar *vp)
     if (vp->generation <= ejs->gc.collectGeneration) {
         checkAddr(vp);
         vp->marked = 1;
-        if (container) {
+        if (container && !container->master) {
             if (vp->generation < EJS_GEN_ETERNAL) {
                 container->refLinks |= (1 << vp->generation);
             }
@@ -21283,6 +21393,12 @@ void ejsFreeVar(Ejs *ejs, EjsVar *vp)
      */
     gc = &ejs->gc;
     if (type->id >= 0 && type->id < gc->numPools) {
+        /*
+         *  Release memory allocated in the context of the object (array elements, property names). Otherwise it is
+         *  held until the pooled object is finally freed.
+         */
+        mprFreeChildren(vp);
+
         pool = &gc->pools[type->id];
         vp->next = pool->next;
         pool->next = (EjsVar*) vp;
@@ -21354,6 +21470,7 @@ static inline void addVar(Ejs *ejs, EjsVar *vp, int generation)
     vp->generation = generation;
     vp->rootLinks = 0;
     vp->refLinks = 0;
+    vp->master = (ejs->flags & EJS_FLAG_MASTER) ? 1 : 0;
 
     gen = &gc->generations[generation];
     linkVar(gen, vp);
@@ -21466,16 +21583,38 @@ void ejsSetReference(Ejs *ejs, EjsVar *obj, EjsVar *value)
 
         mprAssert(value->generation < EJS_GEN_ETERNAL);
 
-        //  TODO - this won't work with master interpreters.
-        //  mprAssert(!obj->master);
-        
-        if ((obj->rootLinks & (1 << value->generation)) == 0) {
+        if (obj->master && !(ejs->flags & EJS_FLAG_MASTER)) {
+            /*
+             *  A clone is storing into a shared master object. The master object's GC bits are not modified. Instead, 
+             *  it is remembered as a root if it now refers to an object owned by this interpreter.
+             */
+            if (!value->master) {
+                addSharedRoot(ejs, obj);
+            }
+
+        } else if ((obj->rootLinks & (1 << value->generation)) == 0) {
             addRoot(ejs, value->generation, obj);
         }
     }
 }
 
 
+static void addSharedRoot(Ejs *ejs, EjsVar *obj)
+{
+    EjsGC   *gc;
+
+    gc = &ejs->gc;
+    if (gc->sharedRoots == 0) {
+        if ((gc->sharedRoots = mprCreateList(ejs)) == 0) {
+            return;
+        }
+    }
+    if (mprLookupItem(gc->sharedRoots, obj) < 0) {
+        mprAddItem(gc->sharedRoots, obj);
+    }
+}
+
+
 static void addRoot(Ejs *ejs, int generation, EjsVar *obj)
 {
     EjsGen  *gen;
@@ -21589,6 +21728,14 @@ void ejsPrintAllocReport(Ejs *ejs)
     }
 
     mprLog(ejs, 0, "  Object GC work quota   %,14d", gc->workQuota);
+
+    mprLog(ejs, 0, "\nProperty Cache Statistics");
+    mprLog(ejs, 0, "  Cache hits             %,14d", ejs->propCacheHits);
+    mprLog(ejs, 0, "  Cache misses           %,14d", ejs->propCacheMisses);
+    if ((ejs->propCacheHits + ejs->propCacheMisses) > 0) {
+        mprLog(ejs, 0, "  Hit rate               %14d %%", 
+            (int) ((int64) ejs->propCacheHits * 100 / (ejs->propCacheHits + ejs->propCacheMisses)));
+    }
 }
 
 
@@ -21803,6 +21950,7 @@ static void callExceptionHandler(Ejs *ejs, EjsFunction *fun, int index, int flag
 static void debug(EjsFrame *frame);
 static EjsVar *evalBinaryExpr(Ejs *ejs, EjsVar *lhs, EjsOpCode opcode, EjsVar *rhs);
 static EjsVar *evalUnaryExpr(Ejs *ejs, EjsVar *lhs, EjsOpCode opcode);
+static EjsVar *getCachedVar(Ejs *ejs, uchar *pc, EjsVar *vp, EjsName *qname, EjsLookup *lookup);
 static EjsName getNameArg(EjsFrame *frame);
 static EjsVar *getNthBase(Ejs *ejs, EjsVar *obj, int nthBase);
 static EjsVar *getNthBaseFromBottom(Ejs *ejs, EjsVar *obj, int nthBase);
@@ -21812,6 +21960,7 @@ static char *getStringArg(EjsFrame *frame);
 static EjsVar *getGlobalArg(EjsFrame *frame);
 static bool handleException(Ejs *ejs);
 static void handleExceptionAtThisLevel(Ejs *ejs, EjsFrame *frame);
+static int lookupCachedVar(Ejs *ejs, uchar *pc, EjsVar *vp, EjsName *qname, EjsLookup *lookup);
 static void makeClosure(EjsFrame *frame);
 static EjsFrame *getFunction(Ejs *ejs, EjsVar *thisObj, EjsVar *owner, int slotNum, EjsFunction *fun, EjsObject **local);
 static void needClosure(EjsFrame *frame, EjsBlock *block);
@@ -21819,7 +21968,7 @@ static EjsFrame *payAttention(Ejs *ejs);
 static EjsFrame *popExceptionFrame(Ejs *ejs);
 static bool popFrameAndReturn(Ejs *ejs);
 static void putFunction(Ejs *ejs, EjsVar *thisObj, EjsFunction *fun, EjsVar *value);
-static void storeProperty(Ejs *ejs, EjsVar *obj, EjsName *name);
+static void storeProperty(Ejs *ejs, EjsVar *obj, EjsName *name, uchar *pc);
 static void storePropertyToScope(Ejs *ejs, EjsName *qname);
 static void swap2(Ejs *ejs);
 static void throwNull(Ejs *ejs);
@@ -22059,6 +22208,12 @@ static void vmLoop(Ejs *ejs)
         &&EJS_OP_TYPE_OF,
         &&EJS_OP_USHR,
         &&EJS_OP_XOR,
+        &&EJS_OP_GET_LOCAL_PROPERTY_SLOT,
+        &&EJS_OP_COMPARE_BRANCH_FALSE,
+        &&EJS_OP_COMPARE_BRANCH_TRUE,
+        &&EJS_OP_COMPARE_BRANCH_FALSE_8,
+        &&EJS_OP_COMPARE_BRANCH_TRUE_8,
+        &&EJS_OP_INC_LOCAL_SLOT,
     };
 #endif
 
@@ -22502,6 +22657,20 @@ static void vmLoop(Ejs *ejs)
             GET_PROPERTY(ejs, NULL, vp, slotNum);
             CHECK; BREAK;
 
+        /*
+         *  Push a property of a local variable by slot numbers. Fused GetLocalSlot, GetObjSlot.
+         *      GetLocalPropertySlot    <localSlot> <slot>
+         *      Stack before (top)  []
+         *      Stack after         [value]
+         */
+        CASE (EJS_OP_GET_LOCAL_PROPERTY_SLOT):
+            slotNum = getNum(frame);
+            GET_PROPERTY(ejs, NULL, local, slotNum);
+            vp = pop(ejs);
+            slotNum = getNum(frame);
+            GET_PROPERTY(ejs, NULL, vp, slotNum);
+            CHECK; BREAK;
+
 
         /*
          *  Push a variable from a type by slot number
@@ -22559,9 +22728,10 @@ static void vmLoop(Ejs *ejs)
          *      Stack after         [result]
          */
         CASE (EJS_OP_GET_OBJ_NAME):
+            pc = frame->pc;
             qname = getNameArg(frame);
             vp = pop(ejs);
-            result = ejsGetVarByName(ejs, vp, &qname, 1, &lookup);
+            result = getCachedVar(ejs, pc, vp, &qname, &lookup);
             if (result) {
                 if (ejsIsFunction(result)) {
                     GET_PROPERTY(ejs, vp, lookup.obj, lookup.slotNum);
@@ -22791,8 +22961,9 @@ static void vmLoop(Ejs *ejs)
          *      Stack after         []
          */
         CASE (EJS_OP_PUT_OBJ_NAME):
+            pc = frame->pc;
             qname = getNameArg(frame);
-            storeProperty(ejs, pop(ejs), &qname);
+            storeProperty(ejs, pop(ejs), &qname, pc);
             CHECK; BREAK;
 
         /*
@@ -22814,7 +22985,7 @@ static void vmLoop(Ejs *ejs)
                     //  TODO BUG - not freeing old property name if it was alloced.
                     qname.name = mprStrdup(vp, nameVar->value);
                     qname.space = EJS_PUBLIC_NAMESPACE;
-                    storeProperty(ejs, vp, &qname);
+                    storeProperty(ejs, vp, &qname, 0);
                 }
             }
             CHECK; BREAK;
@@ -23018,6 +23189,7 @@ static void vmLoop(Ejs *ejs)
          *      Stack after         []
          */
         CASE (EJS_OP_CALL_OBJ_NAME):
+            pc = frame->pc;
             qname = getNameArg(frame);
             argc = getNum(frame);
             vp = ejs->stack.top[-argc];
@@ -23026,7 +23198,7 @@ static void vmLoop(Ejs *ejs)
                 throwNull(ejs);
                 CHECK; BREAK;
             }
-            slotNum = ejsLookupVar(ejs, (EjsVar*) vp, &qname, 1, &lookup);
+            slotNum = lookupCachedVar(ejs, pc, (EjsVar*) vp, &qname, &lookup);
             if (slotNum < 0) {
                 ejsThrowReferenceError(ejs, "Can't find function \"%s\"", qname.name);
             } else {
@@ -23596,6 +23768,62 @@ static void vmLoop(Ejs *ejs)
             }
             BREAK;
 
+        /*
+         *  Compare two values and branch to offset if the result is false. Fused Compare, BranchFalse.
+         *      CompareBranchFalse  <compareOpcode> <offset>
+         *      Stack before (top)  [value1]
+         *                          [value2]
+         *      Stack after         []
+         */
+        CASE (EJS_OP_COMPARE_BRANCH_FALSE):
+
+        /*
+         *  Compare two values and branch to offset if the result is true. Fused Compare, BranchTrue.
+         *      CompareBranchTrue   <compareOpcode> <offset>
+         *      Stack before (top)  [value1]
+         *                          [value2]
+         *      Stack after         []
+         */
+        CASE (EJS_OP_COMPARE_BRANCH_TRUE):
+            count = getByte(frame);
+            offset = getWord(frame);
+            goto commonCompareBranchCode;
+
+        /*
+         *  Compare two values and branch to offset if the result is false (8 bit)
+         *      CompareBranchFalse.8 <compareOpcode> <offset.8>
+         *      Stack before (top)  [value1]
+         *                          [value2]
+         *      Stack after         []
+         */
+        CASE (EJS_OP_COMPARE_BRANCH_FALSE_8):
+
+        /*
+         *  Compare two values and branch to offset if the result is true (8 bit)
+         *      CompareBranchTrue.8 <compareOpcode> <offset.8>
+         *      Stack before (top)  [value1]
+         *                          [value2]
+         *      Stack after         []
+         */
+        CASE (EJS_OP_COMPARE_BRANCH_TRUE_8):
+            opcode = (EjsOpCode) (opcode - EJS_OP_COMPARE_BRANCH_FALSE_8 + EJS_OP_COMPARE_BRANCH_FALSE);
+            count = getByte(frame);
+            offset = (char) getByte(frame);
+
+        /*
+         *  Evaluate the comparison as the Compare instruction would, then branch as BranchTrue/BranchFalse would.
+         */
+        commonCompareBranchCode:
+            v2 = pop(ejs);
+            v1 = pop(ejs);
+            ejs->result = evalBinaryExpr(ejs, v1, count, v2);
+            push(ejs, ejs->result);
+            if (ejs->exception) {
+                CHECK; BREAK;
+            }
+            opcode = (opcode == EJS_OP_COMPARE_BRANCH_TRUE) ? EJS_OP_BRANCH_TRUE : EJS_OP_BRANCH_FALSE;
+            goto commonBoolBranchCode;
+
         /*
          *  Compare if [value1] == true
          *      CompareTrue
@@ -23806,6 +24034,22 @@ static void vmLoop(Ejs *ejs)
             push(ejs, result);
             CHECK; BREAK;
 
+        /*
+         *  Increment a local variable in-place. Fused GetLocalSlot, Dup, Inc, PutLocalSlot, Pop.
+         *      IncLocalSlot        <slot> <increment>
+         *      Stack before (top)  []
+         *      Stack after         []
+         */
+        CASE (EJS_OP_INC_LOCAL_SLOT):
+            slotNum = getNum(frame);
+            count = (char) getByte(frame);
+            GET_PROPERTY(ejs, NULL, local, slotNum);
+            v1 = pop(ejs);
+            result = evalBinaryExpr(ejs, v1, EJS_OP_ADD, (EjsVar*) ejsCreateNumber(ejs, count));
+            push(ejs, result);
+            PUT_PROPERTY(ejs, NULL, local, slotNum);
+            CHECK; BREAK;
+
         /*
          *  Object creation
          */
@@ -25485,9 +25729,173 @@ static void storePropertyToScope(Ejs *ejs, EjsName *qname)
 
 
 /*
- *  Store a property by name in the given object. Will create if the property does not already exist.
+ *  Test if a property of the given name is stored at a slot. Objects are examined directly. Other types use their helpers.
+ */
+static inline bool isPropertyAt(Ejs *ejs, EjsVar *vp, int slotNum, EjsName *qname)
+{
+    EjsObject   *obj;
+    EjsName     name;
+
+    if (vp->type->helpers->lookupProperty == ejs->objectHelpers->lookupProperty) {
+        obj = (EjsObject*) vp;
+        if (slotNum >= obj->numProp || obj->names == 0) {
+            return 0;
+        }
+        name = obj->names->entries[slotNum].qname;
+
+    } else {
+        if (slotNum >= ejsGetPropertyCount(ejs, vp)) {
+            return 0;
+        }
+        name = ejsGetPropertyName(ejs, vp, slotNum);
+        if (name.name == 0 || name.space == 0) {
+            return 0;
+        }
+    }
+    if (name.name == qname->name && name.space == qname->space) {
+        return 1;
+    }
+    return strcmp(name.name, qname->name) == 0 && strcmp(name.space, qname->space) == 0;
+}
+
+
+/*
+ *  Test if a cached lookup is valid for a receiver. Properties owned by the receiver are validated by checking the name at
+ *  the cached slot. Inherited properties are only cached for objects still sharing the property names of their type 
+ *  (i.e. that have not added properties), so the receiver can't hide the inherited property.
+ */
+static inline bool isCacheValid(Ejs *ejs, EjsPropCacheEntry *ep, EjsVar *vp, EjsName *qname)
+{
+    EjsNames    *names;
+
+    if (ep->type != vp->type || ep->qname.name == 0) {
+        return 0;
+    }
+    if (ep->qname.name != qname->name && strcmp(ep->qname.name, qname->name) != 0) {
+        return 0;
+    }
+    if (ep->owner == 0) {
+        return isPropertyAt(ejs, vp, ep->slotNum, &ep->qname);
+    }
+    names = ((EjsObject*) vp)->names;
+    if (names != ep->names || (names && mprGetParent(names) == vp)) {
+        return 0;
+    }
+    return isPropertyAt(ejs, ep->owner, ep->slotNum, &ep->qname);
+}
+
+
+/*
+ *  Lookup a property by name using the inline cache for the instruction at pc. The cache is indexed by instruction 
+ *  address and holds results for up to EJS_PROP_CACHE_WAYS receiver types. Misses do a full search via ejsLookupVar.
+ */
+static int lookupCachedVar(Ejs *ejs, uchar *pc, EjsVar *vp, EjsName *qname, EjsLookup *lookup)
+{
+    EjsPropCache        *cache;
+    EjsPropCacheEntry   *ep;
+    EjsNames            *names;
+    int                 i, slotNum;
+
+    if (ejs->propCache == 0) {
+        ejs->propCache = (EjsPropCache*) mprAllocZeroed(ejs, sizeof(EjsPropCache) * EJS_PROP_CACHE_SIZE);
+        if (ejs->propCache == 0) {
+            return ejsLookupVar(ejs, vp, qname, 1, lookup);
+        }
+    }
+    cache = &ejs->propCache[((size_t) pc) & (EJS_PROP_CACHE_SIZE - 1)];
+
+    if (cache->pc == pc) {
+        for (i = 0; i < EJS_PROP_CACHE_WAYS; i++) {
+            ep = &cache->entries[i];
+            if (isCacheValid(ejs, ep, vp, qname)) {
+                ejs->propCacheHits++;
+                lookup->obj = (ep->owner) ? ep->owner : vp;
+                lookup->slotNum = ep->slotNum;
+                lookup->name = ep->qname;
+                lookup->nthBase = ep->nthBase;
+                lookup->nthBlock = 0;
+                lookup->useThis = 0;
+                lookup->instanceProperty = 0;
+                lookup->ownerIsType = 0;
+                return ep->slotNum;
+            }
+        }
+    } else {
+        memset(cache, 0, sizeof(EjsPropCache));
+        cache->pc = pc;
+    }
+    ejs->propCacheMisses++;
+
+    slotNum = ejsLookupVar(ejs, vp, qname, 1, lookup);
+    if (slotNum < 0) {
+        return slotNum;
+    }
+    if (lookup->obj == vp) {
+        ep = &cache->entries[cache->next];
+        ep->owner = 0;
+        ep->names = 0;
+
+    } else if (vp->type->helpers->lookupProperty == ejs->objectHelpers->lookupProperty && 
+            lookup->obj->type->helpers->lookupProperty == ejs->objectHelpers->lookupProperty) {
+        names = ((EjsObject*) vp)->names;
+        if (names && mprGetParent(names) == vp) {
+            /* The object has its own properties */
+            return slotNum;
+        }
+        ep = &cache->entries[cache->next];
+        ep->owner = lookup->obj;
+        ep->names = names;
+
+    } else {
+        return slotNum;
+    }
+    ep->type = vp->type;
+    ep->qname = lookup->name;
+    ep->slotNum = slotNum;
+    ep->nthBase = lookup->nthBase;
+    cache->next = (cache->next + 1) % EJS_PROP_CACHE_WAYS;
+    return slotNum;
+}
+
+
+/*
+ *  Get a property by name using the inline cache. This is ejsGetVarByName for an explicit object.
+ */
+static EjsVar *getCachedVar(Ejs *ejs, uchar *pc, EjsVar *vp, EjsName *qname, EjsLookup *lookup)
+{
+    EjsVar  *result;
+    int     slotNum;
+
+    if (vp->type->helpers->getPropertyByName) {
+        result = (*vp->type->helpers->getPropertyByName)(ejs, vp, qname);
+        if (result) {
+            return result;
+        }
+    }
+    slotNum = lookupCachedVar(ejs, pc, vp, qname, lookup);
+    if (slotNum < 0) {
+        return ejs->undefinedValue;
+    }
+    return ejsGetProperty(ejs, lookup->obj, slotNum);
+}
+
+
+/*
+ *  Discard all cached property lookups. Called when objects may be freed and when modules are loaded.
+ */
+void ejsFlushPropertyCache(Ejs *ejs)
+{
+    if (ejs->propCache) {
+        memset(ejs->propCache, 0, sizeof(EjsPropCache) * EJS_PROP_CACHE_SIZE);
+    }
+}
+
+
+/*
+ *  Store a property by name in the given object. Will create if the property does not already exist. If pc is supplied,
+ *  the lookup uses the inline cache for the instruction.
  */
-static void storeProperty(Ejs *ejs, EjsVar *obj, EjsName *qname)
+static void storeProperty(Ejs *ejs, EjsVar *obj, EjsName *qname, uchar *pc)
 {
     EjsFrame        *frame;
     EjsFunction     *fun;
@@ -25516,7 +25924,11 @@ static void storeProperty(Ejs *ejs, EjsVar *obj, EjsName *qname)
         }
     }
 
-    slotNum = ejsLookupVar(ejs, obj, qname, 1, &lookup);
+    if (pc) {
+        slotNum = lookupCachedVar(ejs, pc, obj, qname, &lookup);
+    } else {
+        slotNum = ejsLookupVar(ejs, obj, qname, 1, &lookup);
+    }
 
     if (slotNum >= 0) {
         obj = lookup.obj;
@@ -25729,220 +26141,237 @@ void ejsShowStack(Ejs *ejs)
 }
 
 
-#if BLD_DEBUG || 1
-static char *opcodes[] = {
-    "Add",
-    "AddNamespace",
-    "AddNamespaceRef",
-    "And",
-    "BranchEQ",
-    "BranchStrictlyEQ",
-    "BranchFalse",
-    "BranchGE",
-    "BranchGT",
-    "BranchLE",
-    "BranchLT",
-    "BranchNE",
-    "BranchStrictlyNE",
-    "BranchNull",
-    "BranchNotZero",
-    "BranchTrue",
-    "BranchUndefined",
-    "BranchZero",
-    "BranchFalse.8",
-    "BranchTrue.8",
-    "Breakpoint",
-    "Call",
-    "CallGlobalSlot",
-    "CallObjSlot",
-    "CallThisSlot",
-    "CallBlockSlot",
-    "CallObjInstanceSlot",
-    "CallObjStaticSlot",
-    "CallThisStaticSlot",
-    "CallName",
-    "CallScopedName",
-    "CallConstructor",
-    "CallNextConstructor",
-    "Cast",
-    "CastBoolean",
-    "CloseBlock",
-    "CloseWith",
-    "CompareEQ",
-    "CompareStrictlyEQ",
-    "CompareFalse",
-    "CompareGE",
-    "CompareGT",
-    "CompareLE",
-    "CompareLT",
-    "CompareNE",
-    "CompareStrictlyNE",
-    "CompareNull",
-    "CompareNotZero",
-    "CompareTrue",
-    "CompareUndefined",
-    "CompareZero",
-    "Debug",
-    "DefineClass",
-    "DefineFunction",
-    "DefineGlobalFunction",
-    "DeleteNameExp",
-    "Delete",
-    "DeleteName",
-    "Div",
-    "Dup",
-    "Dup2",
-    "EndCode",
-    "EndException",
-    "Goto",
-    "Goto.8",
-    "Inc",
-    "InitDefaultArgs",
-    "InitDefaultArgs.8",
-    "InstOf",
-    "IsA",
-    "Load0",
-    "Load1",
-    "Load2",
-    "Load3",
-    "Load4",
-    "Load5",
-    "Load6",
-    "Load7",
-    "Load8",
-    "Load9",
-    "LoadDouble",
-    "LoadFalse",
-    "LoadGlobal",
-    "LoadInt.16",
-    "LoadInt.32",
-    "LoadInt.64",
-    "LoadInt.8",
-    "LoadM1",
-    "LoadName",
-    "LoadNamespace",
-    "LoadNull",
-    "LoadRegexp",
-    "LoadString",
-    "LoadThis",
-    "LoadTrue",
-    "LoadUndefined",
-    "LoadXML",
-    "GetLocalSlot_0",
-    "GetLocalSlot_1",
-    "GetLocalSlot_2",
-    "GetLocalSlot_3",
-    "GetLocalSlot_4",
-    "GetLocalSlot_5",
-    "GetLocalSlot_6",
-    "GetLocalSlot_7",
-    "GetLocalSlot_8",
-    "GetLocalSlot_9",
-    "GetObjSlot_0",
-    "GetObjSlot_1",
-    "GetObjSlot_2",
-    "GetObjSlot_3",
-    "GetObjSlot_4",
-    "GetObjSlot_5",
-    "GetObjSlot_6",
-    "GetObjSlot_7",
-    "GetObjSlot_8",
-    "GetObjSlot_9",
-    "GetThisSlot_0",
-    "GetThisSlot_1",
-    "GetThisSlot_2",
-    "GetThisSlot_3",
-    "GetThisSlot_4",
-    "GetThisSlot_5",
-    "GetThisSlot_6",
-    "GetThisSlot_7",
-    "GetThisSlot_8",
-    "GetThisSlot_9",
-    "GetName",
-    "GetObjName",
-    "GetObjNameExpr",
-    "GetBlockSlot",
-    "GetGlobalSlot",
-    "GetLocalSlot",
-    "GetObjSlot",
-    "GetThisSlot",
-    "GetTypeSlot",
-    "GetThisTypeSlot",
-    "In",
-    "Like",
-    "LogicalNot",
-    "Mul",
-    "Neg",
-    "New",
-    "NewArray",
-    "NewObject",
-    "Nop",
-    "Not",
-    "OpenBlock",
-    "OpenWith",
-    "Or",
-    "Pop",
-    "PopItems",
-    "PushCatchArg",
-    "PushResult",
-    "PutLocalSlot_0",
-    "PutLocalSlot_1",
-    "PutLocalSlot_2",
-    "PutLocalSlot_3",
-    "PutLocalSlot_4",
-    "PutLocalSlot_5",
-    "PutLocalSlot_6",
-    "PutLocalSlot_7",
-    "PutLocalSlot_8",
-    "PutLocalSlot_9",
-    "PutObjSlot_0",
-    "PutObjSlot_1",
-    "PutObjSlot_2",
-    "PutObjSlot_3",
-    "PutObjSlot_4",
-    "PutObjSlot_5",
-    "PutObjSlot_6",
-    "PutObjSlot_7",
-    "PutObjSlot_8",
-    "PutObjSlot_9",
-    "PutThisSlot_0",
-    "PutThisSlot_1",
-    "PutThisSlot_2",
-    "PutThisSlot_3",
-    "PutThisSlot_4",
-    "PutThisSlot_5",
-    "PutThisSlot_6",
-    "PutThisSlot_7",
-    "PutThisSlot_8",
-    "PutThisSlot_9",
-    "PutObjNameExpr",
-    "PutScopedNameExpr",
-    "PutObjName",
-    "PutScopedName",
-    "PutBlockSlot",
-    "PutGlobalSlot",
-    "PutLocalSlot",
-    "PutObjSlot",
-    "PutThisSlot",
-    "PutTypeSlot",
-    "PutThisTypeSlot",
-    "Rem",
-    "Return",
-    "ReturnValue",
-    "SaveResult",
-    "Shl",
-    "Shr",
-    "Sub",
-    "Super",
-    "Swap",
-    "Throw",
-    "Ushr",
-    "Xor",
-    "Ext",
-    0
+/*
+ *  Opcode table. Order must match the EjsOpCode enumeration.
+ */
+/*  Opcode string                               Stack Effect    Operands, ...                                   */
+static EjsOptable optable[] = {
+    {   "Add",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "AddNamespace",                            0,          { EJS_OPT_STRING,                                 },},
+    {   "AddNamespaceRef",                         -1,         { EJS_OPT_NONE,                                   },},
+    {   "And",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "BranchEQ",                                -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchStrictlyEQ",                        -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchFalse",                             -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchGE",                                -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchGT",                                -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchLE",                                -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchLT",                                -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchNE",                                -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchStrictlyNE",                        -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchNull",                              -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchNotZero",                           -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchTrue",                              -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchUndefined",                         -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchZero",                              -1,         { EJS_OPT_JMP,                                    },},
+    {   "BranchFalse.8",                           -1,         { EJS_OPT_JMP8,                                   },},
+    {   "BranchTrue.8",                            -1,         { EJS_OPT_JMP8,                                   },},
+    {   "Breakpoint",                              0,          { EJS_OPT_NUM, EJS_OPT_STRING,                    },},
+    {   "Call",                                    -2,         { EJS_OPT_ARGC,                                   },},
+    {   "CallGlobalSlot",                          0,          { EJS_OPT_SLOT, EJS_OPT_ARGC,                     },},
+    {   "CallObjSlot",                             -1,         { EJS_OPT_SLOT, EJS_OPT_ARGC,                     },},
+    {   "CallThisSlot",                            0,          { EJS_OPT_SLOT, EJS_OPT_ARGC,                     },},
+    {   "CallBlockSlot",                           0,          { EJS_OPT_SLOT, EJS_OPT_NUM, EJS_OPT_ARGC,        },},
+    {   "CallObjInstanceSlot",                     -1,         { EJS_OPT_SLOT, EJS_OPT_ARGC,                     },},
+    {   "CallObjStaticSlot",                       -1,         { EJS_OPT_SLOT, EJS_OPT_NUM, EJS_OPT_ARGC,        },},
+    {   "CallThisStaticSlot",                      0,          { EJS_OPT_SLOT, EJS_OPT_NUM, EJS_OPT_ARGC,        },},
+    {   "CallObjName",                             -1,         { EJS_OPT_STRING, EJS_OPT_STRING, EJS_OPT_ARGC,   },},
+    {   "CallScopedName",                          0,          { EJS_OPT_STRING, EJS_OPT_STRING, EJS_OPT_ARGC,   },},
+    {   "CallConstructor",                         0,          { EJS_OPT_ARGC,                                   },},
+    {   "CallNextConstructor",                     0,          { EJS_OPT_ARGC,                                   },},
+    {   "Cast",                                    -1,         { EJS_OPT_NONE,                                   },},
+    {   "CastBoolean",                             0,          { EJS_OPT_NONE,                                   },},
+    {   "CloseBlock",                              0,          { EJS_OPT_NONE,                                   },},
+    {   "CloseWith",                               0,          { EJS_OPT_NONE,                                   },},
+    {   "CompareEQ",                               -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareStrictlyEQ",                       -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareFalse",                            -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareGE",                               -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareGT",                               -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareLE",                               -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareLT",                               -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareNE",                               -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareStrictlyNE",                       -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareNull",                             -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareNotZero",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareTrue",                             -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareUndefined",                        -1,         { EJS_OPT_NONE,                                   },},
+    {   "CompareZero",                             -1,         { EJS_OPT_NONE,                                   },},
+    {   "Debug",                                   0,          { EJS_OPT_STRING, EJS_OPT_NUM, EJS_OPT_STRING,    },},
+    {   "DefineClass",                             0,          { EJS_OPT_GLOBAL,                                 },},
+    {   "DefineFunction",                          0,          { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "DefineGlobalFunction",                    0,          { EJS_OPT_GLOBAL,                                 },},
+    {   "DeleteNameExpr",                          -2,         { EJS_OPT_NONE,                                   },},
+    {   "Delete",                                  -1,         { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "DeleteName",                              0,          { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "Div",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Dup",                                     1,          { EJS_OPT_NONE,                                   },},
+    {   "Dup2",                                    2,          { EJS_OPT_NONE,                                   },},
+    {   "EndCode",                                 0,          { EJS_OPT_NONE,                                   },},
+    {   "EndException",                            0,          { EJS_OPT_NONE,                                   },},
+    {   "Goto",                                    0,          { EJS_OPT_JMP,                                    },},
+    {   "Goto.8",                                  0,          { EJS_OPT_JMP8,                                   },},
+    {   "Inc",                                     0,          { EJS_OPT_BYTE,                                   },},
+    {   "InitDefaultArgs",                         0,          { EJS_OPT_INIT_DEFAULT,                           },},
+    {   "InitDefaultArgs.8",                       0,          { EJS_OPT_INIT_DEFAULT8,                          },},
+    {   "InstOf",                                  -1,         { EJS_OPT_NONE,                                   },},
+    {   "IsA",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Load0",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load1",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load2",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load3",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load4",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load5",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load6",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load7",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load8",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "Load9",                                   1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadDouble",                              1,          { EJS_OPT_DOUBLE,                                 },},
+    {   "LoadFalse",                               1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadGlobal",                              1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadInt.16",                              1,          { EJS_OPT_SHORT,                                  },},
+    {   "LoadInt.32",                              1,          { EJS_OPT_WORD,                                   },},
+    {   "LoadInt.64",                              1,          { EJS_OPT_LONG,                                   },},
+    {   "LoadInt.8",                               1,          { EJS_OPT_BYTE,                                   },},
+    {   "LoadM1",                                  1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadName",                                1,          { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "LoadNamespace",                           1,          { EJS_OPT_STRING,                                 },},
+    {   "LoadNull",                                1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadRegexp",                              1,          { EJS_OPT_STRING,                                 },},
+    {   "LoadString",                              1,          { EJS_OPT_STRING,                                 },},
+    {   "LoadThis",                                1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadTrue",                                1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadUndefined",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "LoadXML",                                 1,          { EJS_OPT_STRING,                                 },},
+    {   "GetLocalSlot_0",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_1",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_2",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_3",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_4",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_5",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_6",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_7",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_8",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetLocalSlot_9",                          1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_0",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_1",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_2",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_3",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_4",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_5",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_6",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_7",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_8",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetObjSlot_9",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_0",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_1",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_2",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_3",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_4",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_5",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_6",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_7",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_8",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetThisSlot_9",                           1,          { EJS_OPT_NONE,                                   },},
+    {   "GetScopedName",                           1,          { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "GetObjName",                              0,          { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "GetObjNameExpr",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "GetBlockSlot",                            1,          { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "GetGlobalSlot",                           1,          { EJS_OPT_BYTE,                                   },},
+    {   "GetLocalSlot",                            1,          { EJS_OPT_SLOT,                                   },},
+    {   "GetObjSlot",                              0,          { EJS_OPT_SLOT,                                   },},
+    {   "GetThisSlot",                             1,          { EJS_OPT_SLOT,                                   },},
+    {   "GetTypeSlot",                             0,          { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "GetThisTypeSlot",                         1,          { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "In",                                      -1,         { EJS_OPT_NONE,                                   },},
+    {   "Like",                                    -1,         { EJS_OPT_NONE,                                   },},
+    {   "LogicalNot",                              0,          { EJS_OPT_NONE,                                   },},
+    {   "Mul",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Neg",                                     0,          { EJS_OPT_NONE,                                   },},
+    {   "New",                                     0,          { EJS_OPT_NONE,                                   },},
+    {   "NewArray",                                1,          { EJS_OPT_GLOBAL, EJS_OPT_ARGC2,                  },},
+    {   "NewObject",                               1,          { EJS_OPT_GLOBAL, EJS_OPT_ARGC2,                  },},
+    {   "Nop",                                     0,          { EJS_OPT_NONE,                                   },},
+    {   "Not",                                     0,          { EJS_OPT_NONE,                                   },},
+    {   "OpenBlock",                               0,          { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "OpenWith",                                1,          { EJS_OPT_NONE,                                   },},
+    {   "Or",                                      -1,         { EJS_OPT_NONE,                                   },},
+    {   "Pop",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "PopItems",                                EJS_STACK_POP1, { EJS_OPT_BYTE,                                   },},
+    {   "PushCatchArg",                            1,          { EJS_OPT_NONE,                                   },},
+    {   "PushResult",                              1,          { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_0",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_1",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_2",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_3",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_4",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_5",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_6",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_7",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_8",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutLocalSlot_9",                          -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_0",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_1",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_2",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_3",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_4",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_5",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_6",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_7",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_8",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjSlot_9",                            -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_0",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_1",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_2",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_3",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_4",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_5",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_6",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_7",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_8",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutThisSlot_9",                           -1,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjNameExpr",                          -3,         { EJS_OPT_NONE,                                   },},
+    {   "PutScopedNameExpr",                       -2,         { EJS_OPT_NONE,                                   },},
+    {   "PutObjName",                              -2,         { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "PutScopedName",                           -1,         { EJS_OPT_STRING, EJS_OPT_STRING,                 },},
+    {   "PutBlockSlot",                            -1,         { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "PutGlobalSlot",                           -1,         { EJS_OPT_BYTE,                                   },},
+    {   "PutLocalSlot",                            -1,         { EJS_OPT_SLOT,                                   },},
+    {   "PutObjSlot",                              -2,         { EJS_OPT_SLOT,                                   },},
+    {   "PutThisSlot",                             -1,         { EJS_OPT_SLOT,                                   },},
+    {   "PutTypeSlot",                             -2,         { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "PutThisTypeSlot",                         -1,         { EJS_OPT_SLOT, EJS_OPT_NUM,                      },},
+    {   "Rem",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Return",                                  0,          { EJS_OPT_NONE,                                   },},
+    {   "ReturnValue",                             -1,         { EJS_OPT_NONE,                                   },},
+    {   "SaveResult",                              -1,         { EJS_OPT_NONE,                                   },},
+    {   "Shl",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Shr",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Sub",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "Super",                                   0,          { EJS_OPT_NONE,                                   },},
+    {   "Swap",                                    0,          { EJS_OPT_NONE,                                   },},
+    {   "Throw",                                   0,          { EJS_OPT_NONE,                                   },},
+    {   "TypeOf",                                  0,          { EJS_OPT_NONE,                                   },},
+    {   "Ushr",                                    -1,         { EJS_OPT_NONE,                                   },},
+    {   "Xor",                                     -1,         { EJS_OPT_NONE,                                   },},
+    {   "GetLocalPropertySlot",                    1,          { EJS_OPT_SLOT, EJS_OPT_SLOT,                     },},
+    {   "CompareBranchFalse",                      -2,         { EJS_OPT_BYTE, EJS_OPT_JMP,                      },},
+    {   "CompareBranchTrue",                       -2,         { EJS_OPT_BYTE, EJS_OPT_JMP,                      },},
+    {   "CompareBranchFalse.8",                    -2,         { EJS_OPT_BYTE, EJS_OPT_JMP8,                     },},
+    {   "CompareBranchTrue.8",                     -2,         { EJS_OPT_BYTE, EJS_OPT_JMP8,                     },},
+    {   "IncLocalSlot",                            0,          { EJS_OPT_SLOT, EJS_OPT_BYTE,                     },},
+    {   0,                                         0,          { EJS_OPT_NONE,                                   },},
 };
 
 
+EjsOptable *ejsGetOptable()
+{
+    return optable;
+}
+
+
+#if BLD_DEBUG || 1
+
 static EjsOpCode traceCode(Ejs *ejs, EjsOpCode opcode)
 {
     EjsFrame    *frame;
@@ -25952,6 +26381,11 @@ static EjsOpCode traceCode(Ejs *ejs, EjsOpCode opcode)
 
     frame = ejs->frame;
 
+    if (ejs->opProfile && opcode != EJS_OP_DEBUG) {
+        ejs->opProfile->counts[ejs->opProfile->lastOpcode][opcode]++;
+        ejs->opProfile->lastOpcode = opcode;
+    }
+
     if (ejs->initialized && opcode != EJS_OP_DEBUG) {
         //  TODO - should strip '\n' in the compiler
         if (frame->currentLine) {
@@ -25963,7 +26397,7 @@ static EjsOpCode traceCode(Ejs *ejs, EjsOpCode opcode)
         //  TODO - compiler should strip '\n' from currentLine and we should explicitly add it here
         mprLog(ejs, 6, "%04d: [%d] %02x: %-35s # %s:%d %s",
             (uint) (frame->pc - frame->code->byteCode) - 1, (int) (ejs->stack.top - frame->stackBase + 1),
-            (uchar) opcode, opcodes[opcode], frame->fileName, frame->lineNumber, frame->currentLine);
+            (uchar) opcode, optable[opcode].name, frame->fileName, frame->lineNumber, frame->currentLine);
         if (stop && once++ == 0) {
              mprSleep(ejs, 0);
         }
@@ -25973,19 +26407,99 @@ static EjsOpCode traceCode(Ejs *ejs, EjsOpCode opcode)
 #endif
 
 
-/*
- *  @copy   default
- *
- *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
- *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
- *
- *  This software is distributed under commercial and open source licenses.
- *  You may use the GPL open source license described below or you may acquire
- *  a commercial license from Embedthis Software. You agree to be fully bound
- *  by the terms of either license. Consult the LICENSE.TXT distributed with
- *  this software for full details.
- *
- *  This software is open source; you can redistribute it and/or modify it
+int ejsEnableOpcodeProfile(Ejs *ejs, bool on)
+{
+    if (on) {
+        if (ejs->opProfile == 0) {
+            ejs->opProfile = mprAllocObjZeroed(ejs, EjsOpProfile);
+            if (ejs->opProfile == 0) {
+                return MPR_ERR_NO_MEMORY;
+            }
+            ejs->opProfile->lastOpcode = EJS_OP_NOP;
+        }
+    } else {
+        mprFree(ejs->opProfile);
+        ejs->opProfile = 0;
+    }
+    return 0;
+}
+
+
+typedef struct OpPair {
+    uint    count;
+    uchar   first;
+    uchar   second;
+} OpPair;
+
+
+static int comparePairs(cvoid *p1, cvoid *p2)
+{
+    uint    c1, c2;
+
+    c1 = ((OpPair*) p1)->count;
+    c2 = ((OpPair*) p2)->count;
+    return (c1 < c2) ? 1 : ((c1 > c2) ? -1 : 0);
+}
+
+
+/*
+ *  Report the most frequently executed opcode pairs
+ */
+void ejsPrintOpcodeProfile(Ejs *ejs, int count)
+{
+    EjsOpProfile    *profile;
+    OpPair          *pairs;
+    int64           total;
+    int             i, j, numPairs, numOpcodes, permille;
+
+    if ((profile = ejs->opProfile) == 0) {
+        return;
+    }
+    for (numOpcodes = 0; optable[numOpcodes].name; numOpcodes++) ;
+
+    pairs = (OpPair*) mprAlloc(ejs, sizeof(OpPair) * numOpcodes * numOpcodes);
+    if (pairs == 0) {
+        return;
+    }
+    total = 0;
+    numPairs = 0;
+    for (i = 0; i < numOpcodes; i++) {
+        for (j = 0; j < numOpcodes; j++) {
+            if (profile->counts[i][j]) {
+                pairs[numPairs].count = profile->counts[i][j];
+                pairs[numPairs].first = i;
+                pairs[numPairs].second = j;
+                total += pairs[numPairs].count;
+                numPairs++;
+            }
+        }
+    }
+    qsort(pairs, numPairs, sizeof(OpPair), comparePairs);
+
+    mprLog(ejs, 0, "\nOpcode Pair Profile (%Ld pairs executed)", total);
+    mprLog(ejs, 0, "           Count  Percent  Opcodes");
+    for (i = 0; i < numPairs && i < count; i++) {
+        permille = (int) ((int64) pairs[i].count * 1000 / total);
+        mprLog(ejs, 0, "  %,14d  %4d.%d%%  %s, %s", pairs[i].count, permille / 10, permille % 10, 
+            optable[pairs[i].first].name, optable[pairs[i].second].name);
+    }
+    mprFree(pairs);
+}
+
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
  *  under the terms of the GNU General Public License as published by the
  *  Free Software Foundation; either version 2 of the License, or (at your
  *  option) any later version. See the GNU General Public License for more
@@ -26627,6 +27141,11 @@ MprList *ejsLoadModule(Ejs *ejs, cchar *nameArg, cchar *url, EjsLoaderCallback c
     mp = 0;
     ejs->loaderCallback = callback;
 
+    /*
+     *  Loading may add properties to existing types and change the resolution of cached lookups
+     */
+    ejsFlushPropertyCache(ejs);
+
     /* TODO - Refactor need api for ejs->flags */
     alreadyLoading = ejs->flags & EJS_FLAG_LOADING;
     ejs->flags |= EJS_FLAG_LOADING;
@@ -28862,7 +29381,7 @@ Ejs *ejsCreate(MprCtx ctx, Ejs *master, int flags)
     mprSetAllocNotifier(ejs, (MprAllocNotifier) allocNotifier);
 
     ejs->service = _globalEjsService;
-    ejs->flags |= (flags & (EJS_FLAG_EMPTY | EJS_FLAG_COMPILER | EJS_FLAG_NO_EXE | EJS_FLAG_DOC));
+    ejs->flags |= (flags & (EJS_FLAG_EMPTY | EJS_FLAG_COMPILER | EJS_FLAG_NO_EXE | EJS_FLAG_DOC | EJS_FLAG_MASTER));
 
     if (ejsInitStack(ejs) < 0) {
         mprFree(ejs);
@@ -29251,6 +29770,7 @@ static int cloneMaster(Ejs *ejs, Ejs *master)
     ejs->negativeInfinityValue = master->negativeInfinityValue;
     ejs->nullValue = master->nullValue;
     ejs->oneValue = master->oneValue;
+    ejs->smallInts = master->smallInts;
     ejs->trueValue = master->trueValue;
     ejs->undefinedValue = master->undefinedValue;
     ejs->zeroValue = master->zeroValue;
@@ -31072,17 +31592,62 @@ static MprNumber parseNumber(Ejs *ejs, cchar *str, bool isHex)
 #if BLD_FEATURE_EJS_DB
 
 
+/*
+ *  Cached prepared statement. Cached statements are kept in least recently used order.
+ */
+typedef struct EjsDbStatement
+{
+    char            *sql;               /* SQL command text. Key for the statement hash */
+    sqlite3_stmt    *stmt;              /* Prepared statement */
+    struct EjsDbStatement *next;        /* Next least recently used */
+    struct EjsDbStatement *prev;        /* Previous more recently used */
+} EjsDbStatement;
+
+
 typedef struct EjsDb
 {
     EjsObject       obj;
     sqlite3         *sdb;               /* Sqlite handle */
     MprHeap         *arena;             /* Memory context arena */
     MprThreadLocal  *tls;               /* Thread local data for setting Sqlite memory context */
+    MprHashTable    *statements;        /* Prepared statement cache indexed by SQL command text */
+    EjsDbStatement  *first;             /* Most recently used statement */
+    EjsDbStatement  *last;              /* Least recently used statement */
+    int             numStatements;      /* Count of cached statements */
+    int             hits;               /* Statement cache hits */
+    int             misses;             /* Statement cache misses */
+    MprList         *cursors;           /* Statements held by open cursors (EjsDbStatement) */
+    struct EjsDb    **handle;           /* Destructor handle. Cleared when the database is finalized */
 } EjsDb;
 
 
+/*
+ *  Column name table for a statement. Rows take a single copy of the name block and index names by offset.
+ */
+typedef struct EjsDbColumns
+{
+    char            *block;             /* Column names, each null terminated */
+    int             size;               /* Size of the name block */
+    int             *offsets;           /* Offset of each column name in the block */
+    int             *slots;             /* Row property slot for each column. -1 for duplicate column names */
+    int             ncol;               /* Count of columns */
+    int             numProp;            /* Count of row properties */
+} EjsDbColumns;
+
+
+typedef struct EjsDbCursor
+{
+    EjsObject       obj;
+    EjsDb           *db;                /* Database owning the statement */
+    EjsDbStatement  *statement;         /* Statement being stepped. Zero when the cursor is closed */
+    EjsDbColumns    *columns;           /* Column name table */
+} EjsDbCursor;
+
+
 
 static int dbDestructor(EjsDb **db);
+static void closeCursors(EjsDb *db);
+static void flushStatements(EjsDb *db);
 
 /*
  *  DB Constructor and also used for constructor for sub classes.
@@ -31115,6 +31680,7 @@ static EjsVar *dbConstructor(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
         return 0;
     }
     *dbp = db;
+    db->handle = dbp;
     
     db->tls = mprCreateThreadLocal(db->arena);
     if (db->tls == 0) {
@@ -31129,6 +31695,13 @@ static EjsVar *dbConstructor(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     }
     db->sdb = sdb;
 
+    db->statements = mprCreateHash(db->arena, EJS_DB_STATEMENTS * 2 + 1);
+    db->cursors = mprCreateList(db->arena);
+    if (db->statements == 0 || db->cursors == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+
     sqlite3_busy_timeout(sdb, 15000);
 
     /*
@@ -31150,10 +31723,13 @@ static int dbDestructor(EjsDb **dbp)
 {
     EjsDb       *db;
 
-    db = *dbp;
-
+    if ((db = *dbp) == 0) {
+        return 0;
+    }
     if (db->sdb) {
         ejsSetDbMemoryContext(db->tls, db->arena);
+        closeCursors(db);
+        flushStatements(db);
         sqlite3_close(db->sdb);
         db->sdb = 0;
     }
@@ -31171,6 +31747,8 @@ static int closeDb(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 
     if (db->sdb) {
         ejsSetDbMemoryContext(db->tls, db->arena);
+        closeCursors(db);
+        flushStatements(db);
         sqlite3_close(db->sdb);
         db->sdb = 0;
     }
@@ -31199,30 +31777,372 @@ static int rollbackDb(Ejs *ejs, EjsVar *db, int argc, EjsVar **argv)
 
 
 /*
- *  function sql(cmd: String): Array
+ *  Unlink a statement from the least recently used list
+ */
+static void unlinkStatement(EjsDb *db, EjsDbStatement *sp)
+{
+    if (sp->prev) {
+        sp->prev->next = sp->next;
+    } else {
+        db->first = sp->next;
+    }
+    if (sp->next) {
+        sp->next->prev = sp->prev;
+    } else {
+        db->last = sp->prev;
+    }
+    sp->next = sp->prev = 0;
+}
+
+
+/*
+ *  Add a statement as the most recently used
+ */
+static void linkStatement(EjsDb *db, EjsDbStatement *sp)
+{
+    sp->prev = 0;
+    sp->next = db->first;
+    if (db->first) {
+        db->first->prev = sp;
+    }
+    db->first = sp;
+    if (db->last == 0) {
+        db->last = sp;
+    }
+}
+
+
+static void removeStatement(EjsDb *db, EjsDbStatement *sp)
+{
+    unlinkStatement(db, sp);
+    mprRemoveHash(db->statements, sp->sql);
+    sqlite3_finalize(sp->stmt);
+    mprFree(sp);
+    db->numStatements--;
+}
+
+
+/*
+ *  Finalize all cached statements. Must be done before closing the database.
+ */
+static void flushStatements(EjsDb *db)
+{
+    while (db->first) {
+        removeStatement(db, db->first);
+    }
+}
+
+
+/*
+ *  Get a prepared statement for the first SQL command in cmd. Commands consisting of a single statement are cached 
+ *  by their text and reused. Set *tail to the remaining commands and *cached if the statement is owned by the cache.
+ */
+static int prepareStatement(EjsDb *db, cchar *cmd, sqlite3_stmt **stmtp, cchar **tail, bool *cached)
+{
+    EjsDbStatement  *sp;
+    cchar           *cp;
+    int             rc;
+
+    *cached = 0;
+    if ((sp = (EjsDbStatement*) mprLookupHash(db->statements, cmd)) != 0) {
+        db->hits++;
+        if (sp != db->first) {
+            unlinkStatement(db, sp);
+            linkStatement(db, sp);
+        }
+        *stmtp = sp->stmt;
+        *tail = &cmd[strlen(cmd)];
+        *cached = 1;
+        return SQLITE_OK;
+    }
+    db->misses++;
+
+    rc = sqlite3_prepare_v2(db->sdb, cmd, -1, stmtp, tail);
+    if (rc != SQLITE_OK || *stmtp == 0) {
+        return rc;
+    }
+    for (cp = *tail; isspace((int) *cp); cp++) {
+        ;
+    }
+    if (*cp) {
+        /* Multiple commands are not cached */
+        return rc;
+    }
+    if (db->numStatements >= EJS_DB_STATEMENTS) {
+        removeStatement(db, db->last);
+    }
+    if ((sp = mprAllocObjZeroed(db->statements, EjsDbStatement)) == 0) {
+        return rc;
+    }
+    sp->sql = mprStrdup(sp, cmd);
+    sp->stmt = *stmtp;
+    mprAddHash(db->statements, sp->sql, sp);
+    linkStatement(db, sp);
+    db->numStatements++;
+    *cached = 1;
+    return rc;
+}
+
+
+/*
+ *  Release a statement after use. Cached statements are reset for reuse, others are finalized. Returns the error code
+ *  of the last step.
+ */
+static int releaseStatement(sqlite3_stmt *stmt, bool cached)
+{
+    int     rc;
+
+    if (cached) {
+        rc = sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return rc;
+    }
+    return sqlite3_finalize(stmt);
+}
+
+
+/*
+ *  Bind parameter values in order to the "?" parameters of a statement
+ */
+static int bindParams(Ejs *ejs, sqlite3_stmt *stmt, EjsArray *params)
+{
+    EjsVar      *vp;
+    EjsString   *str;
+    MprNumber   n;
+    int         i, count, rc;
+
+    count = min(sqlite3_bind_parameter_count(stmt), params->length);
+
+    for (i = 0, rc = SQLITE_OK; i < count && rc == SQLITE_OK; i++) {
+        vp = ejsGetProperty(ejs, (EjsVar*) params, i);
+        if (vp == 0 || ejsIsNull(vp) || ejsIsUndefined(vp)) {
+            rc = sqlite3_bind_null(stmt, i + 1);
+
+        } else if (ejsIsNumber(vp)) {
+            n = ejsGetNumber(vp);
+#if BLD_FEATURE_FLOATING_POINT
+            if (n != (int64) n) {
+                rc = sqlite3_bind_double(stmt, i + 1, n);
+                continue;
+            }
+#endif
+            rc = sqlite3_bind_int64(stmt, i + 1, (int64) n);
+
+        } else if (ejsIsBoolean(vp)) {
+            rc = sqlite3_bind_int(stmt, i + 1, ejsGetBoolean(vp));
+
+        } else {
+            if ((str = ejsToString(ejs, vp)) == 0) {
+                return SQLITE_NOMEM;
+            }
+            rc = sqlite3_bind_text(stmt, i + 1, str->value, str->length, SQLITE_TRANSIENT);
+        }
+    }
+    return rc;
+}
+
+
+/*
+ *  Take a statement for exclusive use by a cursor. A cached statement is removed from the cache until the cursor is 
+ *  closed, otherwise a new statement is prepared. Commands must consist of a single statement.
+ */
+static EjsDbStatement *takeStatement(Ejs *ejs, EjsDb *db, cchar *cmd)
+{
+    EjsDbStatement  *sp;
+    sqlite3_stmt    *stmt;
+    cchar           *tail;
+    int             rc;
+
+    if ((sp = (EjsDbStatement*) mprLookupHash(db->statements, cmd)) != 0) {
+        db->hits++;
+        unlinkStatement(db, sp);
+        mprRemoveHash(db->statements, sp->sql);
+        db->numStatements--;
+        return sp;
+    }
+    db->misses++;
+
+    stmt = 0;
+    rc = sqlite3_prepare_v2(db->sdb, cmd, -1, &stmt, &tail);
+    if (rc != SQLITE_OK) {
+        ejsThrowIOError(ejs, "SQL error: %s", sqlite3_errmsg(db->sdb));
+        return 0;
+    }
+    if (stmt == 0) {
+        ejsThrowArgError(ejs, "Empty SQL command");
+        return 0;
+    }
+    for (; isspace((int) *tail); tail++) {
+        ;
+    }
+    if (*tail) {
+        sqlite3_finalize(stmt);
+        ejsThrowArgError(ejs, "Cursors support a single SQL command");
+        return 0;
+    }
+    if ((sp = mprAllocObjZeroed(db->statements, EjsDbStatement)) == 0) {
+        sqlite3_finalize(stmt);
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    sp->sql = mprStrdup(sp, cmd);
+    sp->stmt = stmt;
+    return sp;
+}
+
+
+/*
+ *  Return a statement taken by a cursor to the cache. Returns the error code of the last step.
+ */
+static int returnStatement(EjsDb *db, EjsDbStatement *sp)
+{
+    int     rc;
+
+    rc = releaseStatement(sp->stmt, 1);
+    if (mprLookupHash(db->statements, sp->sql)) {
+        /* The command was cached again while the cursor was open */
+        sqlite3_finalize(sp->stmt);
+        mprFree(sp);
+        return rc;
+    }
+    if (db->numStatements >= EJS_DB_STATEMENTS) {
+        removeStatement(db, db->last);
+    }
+    mprAddHash(db->statements, sp->sql, sp);
+    linkStatement(db, sp);
+    db->numStatements++;
+    return rc;
+}
+
+
+/*
+ *  Create the column name table for a statement. Duplicate column names use the first column.
+ */
+static EjsDbColumns *createColumns(MprCtx ctx, sqlite3_stmt *stmt)
+{
+    EjsDbColumns    *cols;
+    cchar           *name;
+    int             i, j, len;
+
+    if ((cols = mprAllocObjZeroed(ctx, EjsDbColumns)) == 0) {
+        return 0;
+    }
+    cols->ncol = sqlite3_column_count(stmt);
+    cols->offsets = (int*) mprAlloc(cols, (cols->ncol + 1) * sizeof(int));
+    cols->slots = (int*) mprAlloc(cols, (cols->ncol + 1) * sizeof(int));
+    if (cols->offsets == 0 || cols->slots == 0) {
+        mprFree(cols);
+        return 0;
+    }
+    for (i = 0; i < cols->ncol; i++) {
+        cols->offsets[i] = cols->size;
+        cols->size += (int) strlen(sqlite3_column_name(stmt, i)) + 1;
+    }
+    if ((cols->block = (char*) mprAlloc(cols, cols->size + 1)) == 0) {
+        mprFree(cols);
+        return 0;
+    }
+    for (i = 0; i < cols->ncol; i++) {
+        name = sqlite3_column_name(stmt, i);
+        len = (int) strlen(name);
+        memcpy(&cols->block[cols->offsets[i]], name, len + 1);
+        cols->slots[i] = cols->numProp;
+        for (j = 0; j < i; j++) {
+            if (cols->slots[j] >= 0 && strcmp(&cols->block[cols->offsets[j]], name) == 0) {
+                cols->slots[i] = -1;
+                break;
+            }
+        }
+        if (cols->slots[i] >= 0) {
+            cols->numProp++;
+        }
+    }
+    return cols;
+}
+
+
+/*
+ *  Create a row object for the current statement row. Each row takes one copy of the column name block. Rows may 
+ *  outlive the statement, the column table and the database, so the names are not shared with the column table. If 
+ *  typed, INTEGER and REAL values are returned as Numbers and NULL as null. Otherwise all values are Strings.
+ */
+static EjsVar *createRow(Ejs *ejs, EjsDbColumns *cols, sqlite3_stmt *stmt, bool typed)
+{
+    EjsVar      *row, *value;
+    EjsName     qname;
+    cchar       *text;
+    char        *names;
+    int         i, slotNum;
+
+    row = (EjsVar*) ejsCreateSimpleObject(ejs);
+    if (row == 0 || ejsGrowObject(ejs, (EjsObject*) row, cols->numProp) < 0) {
+        return 0;
+    }
+    if ((names = mprMemdup(row, cols->block, cols->size + 1)) == 0) {
+        return 0;
+    }
+    for (i = 0; i < cols->ncol; i++) {
+        if ((slotNum = cols->slots[i]) < 0) {
+            continue;
+        }
+        if (typed) {
+            switch (sqlite3_column_type(stmt, i)) {
+            case SQLITE_INTEGER:
+                value = (EjsVar*) ejsCreateNumber(ejs, (MprNumber) sqlite3_column_int64(stmt, i));
+                break;
+            case SQLITE_FLOAT:
+                value = (EjsVar*) ejsCreateNumber(ejs, (MprNumber) sqlite3_column_double(stmt, i));
+                break;
+            case SQLITE_NULL:
+                value = ejs->nullValue;
+                break;
+            default:
+                value = (EjsVar*) ejsCreateString(ejs, (cchar*) sqlite3_column_text(stmt, i));
+                break;
+            }
+        } else {
+            text = (cchar*) sqlite3_column_text(stmt, i);
+            value = (EjsVar*) ejsCreateString(ejs, text ? text : "");
+        }
+        if (value == 0) {
+            return 0;
+        }
+        ejsSetProperty(ejs, row, slotNum, value);
+        ejsSetPropertyName(ejs, row, slotNum, ejsName(&qname, EJS_EMPTY_NAMESPACE, &names[cols->offsets[i]]));
+    }
+    return row;
+}
+
+
+/*
+ *  function sql(cmd: String, params: Array = null): Array
  *
- *  Will support multiple sql cmds but will only return one result table.
+ *  Will support multiple sql cmds but will only return one result table. Parameters are bound to each command.
  */
 static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 {
     sqlite3         *sdb;
     sqlite3_stmt    *stmt;
-    EjsArray        *result;
-    EjsVar          *row, *svalue;
-    EjsName         qname;
-    cchar           *tail, *colName, *cmd, *value;
-    int             i, ncol, rc, retries, rowNum;
+    EjsArray        *result, *params;
+    EjsDbColumns    *cols;
+    EjsVar          *row;
+    cchar           *tail, *cmd;
+    bool            cached;
+    int             rc, retries, rowNum;
 
     mprAssert(ejs);
     mprAssert(db);
 
     cmd = ejsGetString(argv[0]);
+    params = (argc >= 2 && ejsIsArray(argv[1])) ? (EjsArray*) argv[1] : 0;
     
     ejsSetDbMemoryContext(db->tls, db->arena);
 
     rc = SQLITE_OK;
     retries = 0;
     sdb = db->sdb;
+    stmt = 0;
+    cached = 0;
 
     if (sdb == 0) {
         ejsThrowIOError(ejs, "Database is closed");
@@ -31238,7 +32158,7 @@ static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     while (cmd && *cmd && (rc == SQLITE_OK || (rc == SQLITE_SCHEMA && ++retries < 2))) {
 
         stmt = 0;
-        rc = sqlite3_prepare_v2(sdb, cmd, -1, &stmt, &tail);
+        rc = prepareStatement(db, cmd, &stmt, &tail, &cached);
         if (rc != SQLITE_OK) {
             continue;
         }
@@ -31247,8 +32167,15 @@ static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
             cmd = tail;
             continue;
         }
+        if (params && params->length > 0 && (rc = bindParams(ejs, stmt, params)) != SQLITE_OK) {
+            break;
+        }
 
-        ncol = sqlite3_column_count(stmt);
+        if ((cols = createColumns(result, stmt)) == 0) {
+            releaseStatement(stmt, cached);
+            ejsThrowMemoryError(ejs);
+            return 0;
+        }
 
         for (rowNum = 0; ; rowNum++) {
 
@@ -31256,27 +32183,18 @@ static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 
             if (rc == SQLITE_ROW) {
 
-                row = (EjsVar*) ejsCreateSimpleObject(ejs);
+                row = createRow(ejs, cols, stmt, 0);
                 if (row == 0) {
-                    sqlite3_finalize(stmt);
+                    mprFree(cols);
+                    releaseStatement(stmt, cached);
                     return 0;
                 }
                 if (ejsSetProperty(ejs, (EjsVar*) result, rowNum, row) < 0) {
                     /* TODO rc */
                 }
-                for (i = 0; i < ncol; i++) {
-                    colName = sqlite3_column_name(stmt, i);
-                    value = (cchar*) sqlite3_column_text(stmt, i);
-                    ejsName(&qname, EJS_EMPTY_NAMESPACE, mprStrdup(row, colName));
-                    if (ejsLookupProperty(ejs, row, &qname) < 0) {
-                        svalue = (EjsVar*) ejsCreateString(ejs, mprStrdup(row, value));
-                        if (ejsSetPropertyByName(ejs, row, &qname, svalue) < 0) {
-                            /* TODO */
-                        }
-                    }
-                }
             } else {
-                rc = sqlite3_finalize(stmt);
+                mprFree(cols);
+                rc = releaseStatement(stmt, cached);
                 stmt = 0;
 
                 if (rc != SQLITE_SCHEMA) {
@@ -31296,7 +32214,7 @@ static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     }
 
     if (stmt) {
-        rc = sqlite3_finalize(stmt);
+        releaseStatement(stmt, cached);
     }
 
     if (rc != SQLITE_OK) {
@@ -31312,21 +32230,242 @@ static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 }
 
 
-#if UNUSED
+#if ES_ejs_db_Database_statementCache
 /*
- *  Save database changes
+ *  Return prepared statement cache statistics.
  *
- *  function save(): Void
+ *  function get statementCache(): Object
  */
-static EjsVar *save(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
+static EjsVar *statementCache(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 {
-    EjsArray    *ap;
-    char        **data, *error;
-    int         rc, rowCount, i;
+    EjsVar      *stats;
+    EjsName     qname;
 
-    ejsSetDbMemoryContext(db->tls, db->arena);
+    stats = (EjsVar*) ejsCreateSimpleObject(ejs);
+    if (stats == 0) {
+        return 0;
+    }
+    ejsName(&qname, EJS_EMPTY_NAMESPACE, "hits");
+    ejsSetPropertyByName(ejs, stats, &qname, (EjsVar*) ejsCreateNumber(ejs, db->hits));
+    ejsName(&qname, EJS_EMPTY_NAMESPACE, "misses");
+    ejsSetPropertyByName(ejs, stats, &qname, (EjsVar*) ejsCreateNumber(ejs, db->misses));
+    ejsName(&qname, EJS_EMPTY_NAMESPACE, "count");
+    ejsSetPropertyByName(ejs, stats, &qname, (EjsVar*) ejsCreateNumber(ejs, db->numStatements));
+    ejsName(&qname, EJS_EMPTY_NAMESPACE, "limit");
+    ejsSetPropertyByName(ejs, stats, &qname, (EjsVar*) ejsCreateNumber(ejs, EJS_DB_STATEMENTS));
+    return stats;
+}
+#endif
 
-    ap = ejsCreateArray(ejs, 0);
+
+/*
+ *  Close a cursor and return its statement to the statement cache. Returns the error code of the last step.
+ *  If the database has been closed, the statement is already finalized and is left for the database arena.
+ */
+static int closeCursorStatement(EjsDbCursor *cp)
+{
+    EjsDbStatement  *sp;
+    EjsDb           *db;
+
+    if ((sp = cp->statement) == 0) {
+        return SQLITE_OK;
+    }
+    cp->statement = 0;
+    mprFree(cp->columns);
+    cp->columns = 0;
+    if (sp->stmt == 0) {
+        return SQLITE_OK;
+    }
+    db = cp->db;
+    ejsSetDbMemoryContext(db->tls, db->arena);
+    mprRemoveItem(db->cursors, sp);
+    return returnStatement(db, sp);
+}
+
+
+/*
+ *  Finalize the statements held by open cursors. Must be done before closing the database. The cursor objects are
+ *  not touched as they may already have been collected. They see a finalized statement and report no more rows.
+ */
+static void closeCursors(EjsDb *db)
+{
+    EjsDbStatement  *sp;
+
+    if (db->cursors == 0) {
+        return;
+    }
+    while ((sp = (EjsDbStatement*) mprGetFirstItem(db->cursors)) != 0) {
+        mprRemoveItem(db->cursors, sp);
+        sqlite3_finalize(sp->stmt);
+        sp->stmt = 0;
+    }
+}
+
+
+/*
+ *  Create a cursor for a SQL command.
+ *
+ *  function cursor(cmd: String, ...params): Cursor
+ */
+static EjsVar *cursor(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
+{
+    EjsDbCursor     *cp;
+    EjsDbStatement  *sp;
+    EjsArray        *params;
+    EjsType         *type;
+    EjsName         qname;
+
+    mprAssert(argc >= 1);
+
+    if (db->sdb == 0) {
+        ejsThrowIOError(ejs, "Database is closed");
+        return 0;
+    }
+    type = (EjsType*) ejsGetPropertyByName(ejs, ejs->global, ejsName(&qname, "ejs.db", "Cursor"));
+    if (type == 0 || !ejsIsType(type)) {
+        ejsThrowReferenceError(ejs, "Can't find Cursor type");
+        return 0;
+    }
+    ejsSetDbMemoryContext(db->tls, db->arena);
+
+    if ((sp = takeStatement(ejs, db, ejsGetString(argv[0]))) == 0) {
+        return 0;
+    }
+    params = (argc >= 2 && ejsIsArray(argv[1])) ? (EjsArray*) argv[1] : 0;
+    if (params && params->length > 0 && bindParams(ejs, sp->stmt, params) != SQLITE_OK) {
+        ejsThrowIOError(ejs, "SQL error: %s", sqlite3_errmsg(db->sdb));
+        returnStatement(db, sp);
+        return 0;
+    }
+    if ((cp = (EjsDbCursor*) ejsCreateVar(ejs, type, 0)) == 0) {
+        returnStatement(db, sp);
+        return 0;
+    }
+    cp->db = db;
+    cp->statement = sp;
+    cp->columns = 0;
+    if (mprAddItem(db->cursors, sp) < 0 || (cp->columns = createColumns(cp, sp->stmt)) == 0) {
+        closeCursorStatement(cp);
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    return (EjsVar*) cp;
+}
+
+
+/*
+ *  Step the cursor to the next row. Returns zero when there are no more rows or on errors.
+ */
+static EjsVar *stepCursor(Ejs *ejs, EjsDbCursor *cp)
+{
+    EjsDb       *db;
+    EjsVar      *row;
+    int         rc;
+
+    if (cp->statement == 0 || cp->statement->stmt == 0) {
+        closeCursorStatement(cp);
+        return 0;
+    }
+    db = cp->db;
+    ejsSetDbMemoryContext(db->tls, db->arena);
+
+    rc = sqlite3_step(cp->statement->stmt);
+    if (rc == SQLITE_ROW) {
+        if ((row = createRow(ejs, cp->columns, cp->statement->stmt, 1)) == 0) {
+            ejsThrowMemoryError(ejs);
+        }
+        return row;
+    }
+    if (closeCursorStatement(cp) != SQLITE_OK) {
+        ejsThrowIOError(ejs, "SQL error: %s", sqlite3_errmsg(db->sdb));
+    }
+    return 0;
+}
+
+
+/*
+ *  function next(): Object
+ */
+static EjsVar *nextCursor(Ejs *ejs, EjsDbCursor *cp, int argc, EjsVar **argv)
+{
+    EjsVar      *row;
+
+    if ((row = stepCursor(ejs, cp)) == 0 && ejs->exception == 0) {
+        return ejs->nullValue;
+    }
+    return row;
+}
+
+
+static EjsVar *nextCursorValue(Ejs *ejs, EjsIterator *ip, int argc, EjsVar **argv)
+{
+    EjsVar      *row;
+
+    if ((row = stepCursor(ejs, (EjsDbCursor*) ip->target)) == 0 && ejs->exception == 0) {
+        ejsThrowStopIteration(ejs);
+    }
+    return row;
+}
+
+
+/*
+ *  Return an iterator to enumerate the remaining rows. For use with "for each ..."
+ *
+ *  iterator native function getValues(): Iterator
+ */
+static EjsVar *getCursorValues(Ejs *ejs, EjsDbCursor *cp, int argc, EjsVar **argv)
+{
+    return (EjsVar*) ejsCreateIterator(ejs, (EjsVar*) cp, (EjsNativeFunction) nextCursorValue, 0, NULL);
+}
+
+
+/*
+ *  function close(): Void
+ */
+static EjsVar *closeCursor(Ejs *ejs, EjsDbCursor *cp, int argc, EjsVar **argv)
+{
+    closeCursorStatement(cp);
+    return 0;
+}
+
+
+/*
+ *  Mark the cursor's database so it is not collected while the cursor is in use
+ */
+static void markCursor(Ejs *ejs, EjsVar *parent, EjsDbCursor *cp)
+{
+    ejsMarkObject(ejs, parent, (EjsObject*) cp);
+    if (cp->db) {
+        ejsMarkVar(ejs, (EjsVar*) cp, (EjsVar*) cp->db);
+    }
+}
+
+
+/*
+ *  Called by the garbage colllector
+ */
+static EjsVar *finalizeCursor(Ejs *ejs, EjsDbCursor *cp)
+{
+    closeCursorStatement(cp);
+    return 0;
+}
+
+
+#if UNUSED
+/*
+ *  Save database changes
+ *
+ *  function save(): Void
+ */
+static EjsVar *save(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
+{
+    EjsArray    *ap;
+    char        **data, *error;
+    int         rc, rowCount, i;
+
+    ejsSetDbMemoryContext(db->tls, db->arena);
+
+    ap = ejsCreateArray(ejs, 0);
 
     rc = sqlite3_exec(db->sdb,
       "SELECT name FROM sqlite_master "
@@ -31401,6 +32540,10 @@ static EjsVar *finalizeDb(Ejs *ejs, EjsDb *db)
         closeDb(ejs, db, 0, 0);
         db->sdb = 0;
     }
+    if (db->handle) {
+        *db->handle = 0;
+        db->handle = 0;
+    }
     return 0;
 }
 
@@ -31418,11 +32561,18 @@ void ejsConfigureDbTypes(Ejs *ejs)
     }
 
     type->instanceSize = sizeof(EjsDb);
+    type->hasFinalizer = 1;
     type->helpers->finalizeVar = (EjsFinalizeVarHelper) finalizeDb;
 
     ejsBindMethod(ejs, type, ES_ejs_db_Database_Database, (EjsNativeFunction) dbConstructor);
     ejsBindMethod(ejs, type, ES_ejs_db_Database_close, (EjsNativeFunction) closeDb);
     ejsBindMethod(ejs, type, ES_ejs_db_Database_sql, (EjsNativeFunction) sql);
+#if ES_ejs_db_Database_statementCache
+    ejsBindMethod(ejs, type, ES_ejs_db_Database_statementCache, (EjsNativeFunction) statementCache);
+#endif
+#if ES_ejs_db_Database_cursor
+    ejsBindMethod(ejs, type, ES_ejs_db_Database_cursor, (EjsNativeFunction) cursor);
+#endif
 
 #if UNUSED
     ejsSetAccessors(ejs, type, ES_ejs_db_Database_tables, (EjsNativeFunction) tables, -1, 0);
@@ -31430,6 +32580,23 @@ void ejsConfigureDbTypes(Ejs *ejs)
     ejsBindMethod(ejs, type, ES_ejs_db_Database_commit, commitDb);
     ejsBindMethod(ejs, type, ES_ejs_db_Database_rollback, rollbackDb);
 #endif
+
+#if ES_ejs_db_Cursor_next
+    ejsName(&qname, "ejs.db", "Cursor");
+    type = (EjsType*) ejsGetPropertyByName(ejs, ejs->global, &qname);
+    if (type == 0 || !ejsIsType(type)) {
+        ejs->hasError = 1;
+        return;
+    }
+    type->instanceSize = sizeof(EjsDbCursor);
+    type->hasFinalizer = 1;
+    type->helpers->finalizeVar = (EjsFinalizeVarHelper) finalizeCursor;
+    type->helpers->markVar = (EjsMarkVarHelper) markCursor;
+
+    ejsBindMethod(ejs, type, ES_Object_getValues, (EjsNativeFunction) getCursorValues);
+    ejsBindMethod(ejs, type, ES_ejs_db_Cursor_next, (EjsNativeFunction) nextCursor);
+    ejsBindMethod(ejs, type, ES_ejs_db_Cursor_close, (EjsNativeFunction) closeCursor);
+#endif
 }
 
 
@@ -31917,13 +33084,47 @@ static EjsWebControl *webControl;
 
 
 static int  compile(EjsWeb *web, cchar *kind, cchar *name);
+static void collectShared(EjsWebControl *control, EjsWebCache *cache);
+static int  compileComponent(EjsWebControl *control, EjsWebCompile *job);
 static void createCookie(Ejs *ejs, EjsVar *cookies, cchar *name, cchar *value, cchar *domain, cchar *path);
+static int  destroyWebRequest(EjsWeb *web);
+static void flushPropertyCaches(EjsWebCache *cache);
+static EjsWebCache *getCache(EjsWebControl *control, MprHashTable *caches, cchar *appDir);
+static EjsWebInterp *getInterp(EjsWebCache *cache);
+static bool isCacheStale(EjsWebControl *control, EjsWebCache *cache);
+static bool isModuleCurrent(EjsWeb *web, cchar *module);
 static int  initInterp(Ejs *ejs, EjsWebControl *control);
 static int  loadApplication(EjsWeb *web);
+static int  loadCachedComponent(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *ext);
 static int  loadController(EjsWeb *web);
 static int  loadComponent(EjsWeb *web, cchar *kind, cchar *name, cchar *ext);
+static int  loadModule(EjsWeb *web, Ejs *ejs, cchar *base);
 static int  build(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *ext);
 static int  parseControllerAction(EjsWeb *web);
+static char *parsePage(EjsWebCompile *job, cchar *path, cchar *layout);
+static int  resetInterp(EjsWebInterp *interp);
+static void restoreStatics(EjsWebCache *cache);
+static void retireCache(EjsWebControl *control, EjsWebCache *cache);
+static void runCompile(EjsWebControl *control, EjsWebCompile *job);
+static int  saveStatics(EjsWebCache *cache, int first);
+static EjsWebCompile *startCompile(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *source);
+static int  waitForCompile(EjsWeb *web, EjsWebCompile *job);
+
+#if BLD_FEATURE_MULTITHREAD
+static void compileThread(EjsWebControl *control, MprThread *tp);
+#endif
+
+#if BLD_FEATURE_MULTITHREAD
+static inline void lock(EjsWebControl *control) {
+    mprLock(control->mutex);
+}
+static inline void unlock(EjsWebControl *control) {
+    mprUnlock(control->mutex);
+}
+#else
+static inline void lock(EjsWebControl *control) {}
+static inline void unlock(EjsWebControl *control) {}
+#endif
 
 /*
  *  Create and configure web framework types
@@ -31988,6 +33189,21 @@ int ejsOpenWebFramework(EjsWebControl *control, bool useMaster)
             return MPR_ERR_CANT_INITIALIZE;
         }
     }
+    //  TODO - should session timeouts per different per app?
+    control->sessionTimeout = EJS_SESSION_TIMEOUT;
+    control->sessions = ejsCreateSessionStore(control);
+    if (control->sessions == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+    control->caches = mprCreateHash(control, 0);
+    control->pools = mprCreateHash(control, 0);
+    control->compiling = mprCreateHash(control, 0);
+    control->moduleCheck = EJS_MODULE_CHECK;
+#if BLD_FEATURE_MULTITHREAD
+    control->mutex = mprCreateLock(control);
+    control->compileQueue = mprCreateList(control);
+    control->compileCond = mprCreateCond(control);
+#endif
     webControl = control;
     return 0;
 }
@@ -31995,8 +33211,6 @@ int ejsOpenWebFramework(EjsWebControl *control, bool useMaster)
 
 static int initInterp(Ejs *ejs, EjsWebControl *control)
 {
-    EjsVar      *sessions;
-
 #if !BLD_FEATURE_STATIC
     if (ejsLoadModule(ejs, "ejs.web", NULL, NULL, 0) == 0) {
         mprError(control, "Can't load ejs.web.mod: %s", ejsGetErrorMsg(ejs, 1));
@@ -32008,19 +33222,6 @@ static int initInterp(Ejs *ejs, EjsWebControl *control)
     control->applications = ejsCreateSimpleObject(ejs);
 #endif
 
-    //  TODO - should session timeouts per different per app?
-    control->sessionTimeout = EJS_SESSION_TIMEOUT;
-#if ES_ejs_web_sessions
-    sessions = ejsGetProperty(ejs, ejs->global, ES_ejs_web_sessions);
-#else
-{
-    EjsName qname;
-    sessions = ejsGetPropertyByName(ejs, ejs->global, ejsName(&qname, "ejs.web", "sessions"));
-}
-#endif
-    ejsMakePermanent(ejs, sessions);
-    control->sessions = (EjsObject*) sessions;
-
     return 0;
 }
 
@@ -32047,9 +33248,10 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
 {
     Ejs             *ejs;
     EjsWeb          *web;
+    MprHashTable    *caches;
     cchar           *appUrl;
 
-    web = (EjsWeb*) mprAllocObjZeroed(ctx, EjsWeb);
+    web = (EjsWeb*) mprAllocObjWithDestructorZeroed(ctx, EjsWeb, (MprDestructor) destroyWebRequest);
     if (web == 0) {
         return 0;
     }
@@ -32072,8 +33274,29 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
     web->control = control;
 
     if (control->master) {
-        ejs = web->ejs = ejsCreate(ctx, control->master, 0);
-        ejs->master = control->master;
+        /*
+         *  Take a pooled interpreter for the application. If the location caches modules, the interpreter is cloned from
+         *  the module cache so the request binds to previously loaded modules. Otherwise the request loads its modules
+         *  privately.
+         */
+        lock(control);
+        caches = (flags & EJS_WEB_FLAG_CACHE) ? control->caches : control->pools;
+        if ((web->cache = getCache(control, caches, web->appDir)) != 0) {
+            web->cache->refs++;
+            if ((web->interp = getInterp(web->cache)) != 0) {
+                web->cacheGeneration = web->interp->generation;
+                ejs = web->ejs = web->interp->ejs;
+            } else {
+                ejs = 0;
+            }
+        } else {
+            ejs = web->ejs = ejsCreate(ctx, control->master, 0);
+        }
+        control->active++;
+        unlock(control);
+        if (ejs) {
+            ejs->master = control->master;
+        }
     } else {
         ejs = web->ejs = ejsCreate(ctx, 0, 0);
         if (ejs) {
@@ -32090,12 +33313,6 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
 
     ejsSetHandle(ejs, web);
 
-    //  TODO - temp
-    if (control->master) {
-        control->master->gc.enabled = 0;
-    }
-    ejs->gc.enabled = 0;
-
     mprLog(ctx, 3, "EJS: new request: AppDir %s, AppUrl %s, URL %s", web->appDir, web->appUrl, web->url);
 
     return web;
@@ -32103,94 +33320,401 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
 
 
 /*
- *  Parse the request URI and create the controller and action names. URI is in the form: "controller/action"
+ *  Release the request's interpreter and cache. The interpreter is reset and returned to the pool if possible.
  */
-static int parseControllerAction(EjsWeb *web)
+static int destroyWebRequest(EjsWeb *web)
 {
-    cchar   *url;
-    char    *cp, *controllerName;
+    EjsWebControl   *control;
+    EjsWebCache     *cache;
+    EjsWebInterp    *interp;
+    int             reuse;
 
-    if (web->flags & EJS_WEB_FLAG_SOLO || strstr(web->url, EJS_WEB_EXT)) {
-        if (web->flags & EJS_WEB_FLAG_SOLO) {
-            ejsName(&web->controllerName, "ejs.web", "_SoloController");
-        } else {
-            ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, "BaseController");
-        }
-        ejsName(&web->doActionName, "ejs.web", "renderView");
+    ejsReleaseSession(web);
 
-        /*
-         *  View name strips extension and converts "/" to "_"
-         */
-        web->viewName = mprStrdup(web, &web->url[1]);
-        if ((cp = strchr(web->viewName, '.')) != 0) {
-            *cp = '\0';
-        }
-        for (cp = web->viewName; *cp; cp++) {
-            if (*cp == '/') {
-                *cp = '_';
-            }
-        }
+    control = web->control;
+    if (control->master == 0) {
         return 0;
     }
-
-    /*
-     *  Request as part of an Ejscript application (not stand-alone)
-     */
-    for (url = web->url; *url == '/'; url++) {
-        ;
+    if ((cache = web->cache) == 0) {
+        lock(control);
+        control->active--;
+        collectShared(control, 0);
+        unlock(control);
+        return 0;
     }
-    controllerName = mprStrdup(web, url);
-    controllerName[0] = toupper((int) controllerName[0]);
-    mprStrTrim(controllerName, "/");
-
-    web->viewName = "";
-    if ((cp = strchr(controllerName, '/')) != 0) {
-        *cp++ = '\0';
-        web->viewName = cp;
-        if ((cp = strchr(cp, '/')) != 0) {
-            *cp++ = '\0';
+    interp = web->interp;
+    if (mprGetListCount(cache->statics) > 0) {
+        /*
+         *  Restore class statics before the objects the request assigned to them are discarded
+         */
+        lock(control);
+        restoreStatics(cache);
+        unlock(control);
+    }
+    reuse = interp && interp->uses < EJS_MAX_WEB_REUSE && resetInterp(interp) == 0;
+
+    lock(control);
+    if (interp) {
+        if (reuse && !cache->retired && cache->numIdle < EJS_MAX_WEB_POOL && interp->generation == cache->generation) {
+            interp->next = cache->idle;
+            cache->idle = interp;
+            cache->numIdle++;
+        } else {
+            mprFree(interp);
         }
     }
-    if (*controllerName == '\0') {
-        controllerName = "Base";
-    }
-    if (*web->viewName == '\0') {
-        web->viewName = "index";
+    if (--cache->refs == 0 && cache->retired) {
+        mprFree(cache);
+        cache = 0;
     }
-
-    mprAllocSprintf(web, &cp, -1, "%sController", controllerName);
-    ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, cp);
-    web->controllerFile = controllerName;
-
-    ejsName(&web->doActionName, "ejs.web", "doAction");
-
+    control->active--;
+    collectShared(control, cache);
+    unlock(control);
     return 0;
 }
 
 
-static int loadApplication(EjsWeb *web)
+/*
+ *  Collect the master and cache interpreters. They do not run request code, so they are collected here once their
+ *  allocations exceed the work quota. Requests run unlocked on clones that read master and cache objects, so these are
+ *  only collected when no request is running. Must be called locked.
+ */
+static void collectShared(EjsWebControl *control, EjsWebCache *cache)
 {
-    return loadComponent(web, "app", "App", ".es");
+    Ejs         *ejs;
+    MprHash     *hp;
+
+    if (control->active > 0) {
+        return;
+    }
+    if (control->master->gc.required) {
+        ejsCollectGarbage(control->master, EJS_GC_SMART);
+        for (hp = mprGetFirstHash(control->caches); hp; hp = mprGetNextHash(control->caches, hp)) {
+            flushPropertyCaches((EjsWebCache*) hp->data);
+        }
+        for (hp = mprGetFirstHash(control->pools); hp; hp = mprGetNextHash(control->pools, hp)) {
+            flushPropertyCaches((EjsWebCache*) hp->data);
+        }
+    }
+    if (cache && cache->interp->gc.required) {
+        ejs = cache->interp;
+        ejs->gc.enabled = 1;
+        ejsCollectGarbage(ejs, EJS_GC_SMART);
+        ejs->gc.enabled = 0;
+        flushPropertyCaches(cache);
+    }
 }
 
 
 /*
- *  Load the controller module
+ *  Flush the property lookup caches of the cache interpreter and its idle clones. These may refer to collected objects
+ *  of the interpreters they were cloned from. Must be called locked.
  */
-static int loadController(EjsWeb *web)
+static void flushPropertyCaches(EjsWebCache *cache)
 {
-    return loadComponent(web, "controller", web->controllerFile, ".es");
+    EjsWebInterp    *interp;
+
+    ejsFlushPropertyCache(cache->interp);
+    for (interp = cache->idle; interp; interp = interp->next) {
+        ejsFlushPropertyCache(interp->ejs);
+    }
 }
 
 
-static int createController(EjsWeb *web)
+/*
+ *  Get an interpreter from the cache pool or clone a new interpreter from the cache interpreter. The global state 
+ *  after cloning is saved for resetInterp. Must be called locked.
+ */
+static EjsWebInterp *getInterp(EjsWebCache *cache)
 {
-    Ejs         *ejs;
-    EjsVar      *host, *request, *response, *argv[16];
-    EjsType     *type;
-    int         oldGen, slotNum;
+    EjsWebInterp    *interp;
+    EjsObject       *global;
+    Ejs             *ejs;
 
-    ejs = web->ejs;
+    while ((interp = cache->idle) != 0) {
+        cache->idle = interp->next;
+        cache->numIdle--;
+        if (interp->generation == cache->generation) {
+            interp->uses++;
+            return interp;
+        }
+        /* Cloned before more modules were cached */
+        mprFree(interp);
+    }
+    if ((interp = mprAllocObjZeroed(cache, EjsWebInterp)) == 0) {
+        return 0;
+    }
+    if ((ejs = ejsCreate(interp, cache->interp, 0)) == 0) {
+        mprFree(interp);
+        return 0;
+    }
+    mprAssert(ejs->gc.generations[EJS_GEN_NEW].next == 0);
+
+    global = (EjsObject*) ejs->global;
+    interp->ejs = ejs;
+    interp->numProp = global->numProp;
+    interp->slots = (EjsVar**) mprMemdup(interp, global->slots, global->numProp * sizeof(EjsVar*));
+    interp->numSpaces = ejs->globalBlock->namespaces.length;
+    interp->numModules = mprGetListCount(ejs->modules);
+    interp->flags = ejs->flags;
+    interp->lastEternal = ejs->gc.generations[EJS_GEN_ETERNAL].next;
+    interp->generation = cache->generation;
+    interp->uses = 1;
+    if (interp->slots == 0) {
+        mprFree(interp);
+        return 0;
+    }
+    return interp;
+}
+
+
+/*
+ *  Reset an interpreter to its state after cloning. Global properties are restored and all objects created by the
+ *  request are discarded. Modules loaded privately by the request are removed.
+ */
+static int resetInterp(EjsWebInterp *interp)
+{
+    Ejs             *ejs;
+    EjsBlock        *block;
+    EjsObject       *global;
+    EjsModule       *mp;
+    EjsHashEntry    *entry;
+    int             i;
+
+    ejs = interp->ejs;
+    block = ejs->globalBlock;
+    global = (EjsObject*) block;
+
+    if (ejs->frame || mprGetListCount(ejs->modules) < interp->numModules || global->numProp < interp->numProp) {
+        return MPR_ERR_BAD_STATE;
+    }
+    if (global->numProp > interp->numProp) {
+        for (i = interp->numProp; i < global->numProp; i++) {
+            global->slots[i] = 0;
+            entry = &global->names->entries[i];
+            entry->qname.name = "";
+            entry->qname.space = "";
+            entry->nextSlot = -1;
+        }
+        if (block->numTraits > interp->numProp) {
+            memset(&block->traits[interp->numProp], 0, (block->numTraits - interp->numProp) * sizeof(EjsTrait));
+            block->numTraits = interp->numProp;
+        }
+        global->numProp = interp->numProp;
+        if (ejsRebuildHash(ejs, global) < 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+    }
+    memcpy(global->slots, interp->slots, interp->numProp * sizeof(EjsVar*));
+    block->namespaces.length = min(block->namespaces.length, interp->numSpaces);
+
+    ejs->exception = 0;
+    ejs->result = 0;
+    ejs->handle = 0;
+    ejs->attention = 0;
+    ejs->flags = interp->flags;
+    ejs->stack.top = &ejs->stack.bottom[-1];
+
+    ejsDiscardObjects(ejs, interp->lastEternal);
+    ejsSetGeneration(ejs, EJS_GEN_NEW);
+
+    /*
+     *  The loader also lists modules that were already loaded. Only free modules created by this interpreter.
+     */
+    for (i = mprGetListCount(ejs->modules) - 1; i >= interp->numModules; i--) {
+        mp = (EjsModule*) mprGetItem(ejs->modules, i);
+        mprRemoveItemAtPos(ejs->modules, i);
+        if (mprGetParent(mp) == ejs && mprLookupItem(ejs->modules, mp) < 0) {
+            mprFree(mp);
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Get the module cache or interpreter pool for an application from the given table. The cached modules are checked 
+ *  for changes at most once per moduleCheck period. If any have changed, the cache is retired and a new cache 
+ *  interpreter is cloned from the master. Must be called locked.
+ */
+static EjsWebCache *getCache(EjsWebControl *control, MprHashTable *caches, cchar *appDir)
+{
+    EjsWebCache     *cache;
+    MprTime         now;
+
+    now = mprGetTime(control);
+    cache = (EjsWebCache*) mprLookupHash(caches, appDir);
+    if (cache && (now - cache->checked) >= control->moduleCheck) {
+        cache->checked = now;
+        if (isCacheStale(control, cache)) {
+            retireCache(control, cache);
+            cache = 0;
+        }
+    }
+    if (cache) {
+        return cache;
+    }
+    if ((cache = mprAllocObjZeroed(control, EjsWebCache)) == 0) {
+        return 0;
+    }
+    cache->appDir = mprStrdup(cache, appDir);
+    cache->modules = mprCreateHash(cache, 0);
+    cache->statics = mprCreateList(cache);
+    cache->interp = ejsCreate(cache, control->master, EJS_FLAG_MASTER);
+    if (cache->interp == 0 || cache->modules == 0 || cache->statics == 0) {
+        mprFree(cache);
+        return 0;
+    }
+    cache->interp->master = control->master;
+    cache->interp->gc.enabled = 0;
+    cache->checked = now;
+    mprAddHash(caches, appDir, cache);
+    return cache;
+}
+
+
+/*
+ *  Test if any cached module has been rebuilt or if its source is newer than the module (see build). Modules being 
+ *  recompiled are not stale until the compilation replaces the module. Must be called locked.
+ */
+static bool isCacheStale(EjsWebControl *control, EjsWebCache *cache)
+{
+    EjsWebModule    *mp;
+    MprHash         *hp;
+    MprFileInfo     moduleInfo, sourceInfo;
+    char            path[MPR_MAX_FNAME];
+
+    for (hp = mprGetFirstHash(cache->modules); hp; hp = mprGetNextHash(cache->modules, hp)) {
+        mp = (EjsWebModule*) hp->data;
+        mprSprintf(path, sizeof(path), "%s%s", hp->key, EJS_MODULE_EXT);
+        if (mprGetFileInfo(cache, path, &moduleInfo) < 0 || moduleInfo.mtime != mp->mtime) {
+            mprLog(cache, 3, "EJS: Module %s has changed", path);
+            return 1;
+        }
+        if (mp->source && mprGetFileInfo(cache, mp->source, &sourceInfo) == 0 && sourceInfo.mtime >= moduleInfo.mtime &&
+                mprLookupHash(control->compiling, hp->key) == 0) {
+            mprLog(cache, 3, "EJS: Source %s has changed", mp->source);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Remove the cache from service. Requests already cloned from the cache continue to use it. Must be called locked.
+ */
+static void retireCache(EjsWebControl *control, EjsWebCache *cache)
+{
+    mprLog(control, 3, "EJS: Retiring the module cache");
+    cache->retired = 1;
+    if (mprLookupHash(control->caches, cache->appDir) == cache) {
+        mprRemoveHash(control->caches, cache->appDir);
+    }
+    if (cache->refs == 0) {
+        mprFree(cache);
+    }
+}
+
+
+/*
+ *  Parse the request URI and create the controller and action names. URI is in the form: "controller/action"
+ */
+static int parseControllerAction(EjsWeb *web)
+{
+    cchar   *url;
+    char    *cp, *controllerName;
+
+    if (web->flags & EJS_WEB_FLAG_SOLO || strstr(web->url, EJS_WEB_EXT)) {
+        if (web->flags & EJS_WEB_FLAG_SOLO) {
+            ejsName(&web->controllerName, "ejs.web", "_SoloController");
+        } else {
+            ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, "BaseController");
+        }
+        ejsName(&web->doActionName, "ejs.web", "renderView");
+
+        /*
+         *  View name strips extension and converts "/" to "_"
+         */
+        web->viewName = mprStrdup(web, &web->url[1]);
+        if ((cp = strchr(web->viewName, '.')) != 0) {
+            *cp = '\0';
+        }
+        for (cp = web->viewName; *cp; cp++) {
+            if (*cp == '/') {
+                *cp = '_';
+            }
+        }
+        return 0;
+    }
+
+    /*
+     *  Request as part of an Ejscript application (not stand-alone)
+     */
+    for (url = web->url; *url == '/'; url++) {
+        ;
+    }
+    controllerName = mprStrdup(web, url);
+    controllerName[0] = toupper((int) controllerName[0]);
+    mprStrTrim(controllerName, "/");
+
+    web->viewName = "";
+    if ((cp = strchr(controllerName, '/')) != 0) {
+        *cp++ = '\0';
+        web->viewName = cp;
+        if ((cp = strchr(cp, '/')) != 0) {
+            *cp++ = '\0';
+        }
+    }
+    if (*controllerName == '\0') {
+        controllerName = "Base";
+    }
+    if (*web->viewName == '\0') {
+        web->viewName = "index";
+    }
+
+    mprAllocSprintf(web, &cp, -1, "%sController", controllerName);
+    ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, cp);
+    web->controllerFile = controllerName;
+
+    ejsName(&web->doActionName, "ejs.web", "doAction");
+
+    return 0;
+}
+
+
+/*
+ *  Load the application module. Applications without shared code may omit it.
+ */
+static int loadApplication(EjsWeb *web)
+{
+    char    path[MPR_MAX_FNAME];
+
+    mprSprintf(path, sizeof(path), "%s/App%s", web->appDir, EJS_MODULE_EXT);
+    if (!mprAccess(web, path, R_OK)) {
+        return 0;
+    }
+    return loadComponent(web, "app", "App", ".es");
+}
+
+
+/*
+ *  Load the controller module
+ */
+static int loadController(EjsWeb *web)
+{
+    return loadComponent(web, "controller", web->controllerFile, ".es");
+}
+
+
+static int createController(EjsWeb *web)
+{
+    Ejs         *ejs;
+    EjsVar      *host, *request, *response, *argv[16];
+    EjsType     *type;
+    int         oldGen, slotNum;
+
+    ejs = web->ejs;
 
     if (web->flags & EJS_WEB_FLAG_APP) {
         if (loadApplication(web) < 0) {
@@ -32339,12 +33863,9 @@ int ejsLoadView(Ejs *ejs)
  */
 static int loadComponent(EjsWeb *web, cchar *kind, cchar *name, cchar *ext)
 {
-    Ejs         *ejs;
     char        base[MPR_MAX_FNAME], nameBuf[MPR_MAX_FNAME], *delim;
     int         rc;
 
-    ejs = web->ejs;
-
     delim = (web->appDir[strlen(web->appDir) - 1] == '/') ? "" : "/";
 
     if (strcmp(kind, "app") == 0) {
@@ -32354,9 +33875,6 @@ static int loadComponent(EjsWeb *web, cchar *kind, cchar *name, cchar *ext)
     } else if (*kind) {
         /* Note we pluralize the kind (e.g. view to views) */
         mprSprintf(base, sizeof(base), "%s%s%ss/%s", web->appDir, delim, kind, name);
-        if ((rc = build(web, kind, name, base, ext)) < 0) {
-            return rc;
-        }
 
     } else {
         /*
@@ -32365,12 +33883,141 @@ static int loadComponent(EjsWeb *web, cchar *kind, cchar *name, cchar *ext)
         mprSprintf(base, sizeof(base), "%s%s%s", web->appDir, delim, name);
         mprSprintf(nameBuf, sizeof(nameBuf), "%s%s", name, ext);
         name = nameBuf;
-        if ((rc = build(web, kind, name, base, ext)) < 0) {
+    }
+
+    if (web->cache && (web->flags & EJS_WEB_FLAG_CACHE)) {
+        return loadCachedComponent(web, kind, name, base, ext);
+    }
+    if (strcmp(kind, "app") != 0 && (rc = build(web, kind, name, base, ext)) < 0) {
+        return rc;
+    }
+    return loadModule(web, web->ejs, base);
+}
+
+
+/*
+ *  Load a component via the module cache. The module is loaded into the cache interpreter on first use and subsequent 
+ *  requests are cloned with the cached definitions. Changed modules are detected by getCache when requests are created.
+ */
+static int loadCachedComponent(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *ext)
+{
+    EjsWebControl   *control;
+    EjsWebCache     *cache;
+    EjsWebModule    *mp;
+    MprFileInfo     info;
+    char            path[MPR_MAX_FNAME];
+    int             rc, oldGen, numProp;
+
+    control = web->control;
+    cache = web->cache;
+
+    lock(control);
+    if ((mp = (EjsWebModule*) mprLookupHash(cache->modules, base)) != 0) {
+        unlock(control);
+        if (mp->generation > web->cacheGeneration) {
+            /* Cached after this request was created */
+            return loadModule(web, web->ejs, base);
+        }
+        return 0;
+    }
+    unlock(control);
+
+    /*
+     *  Build unlocked as the build may wait for a compilation
+     */
+    if (strcmp(kind, "app") != 0 && (rc = build(web, kind, name, base, ext)) < 0) {
+        return rc;
+    }
+    lock(control);
+    if (!cache->retired && mprLookupHash(cache->modules, base) == 0) {
+        mprSprintf(path, sizeof(path), "%s%s", base, EJS_MODULE_EXT);
+        mprGetFileInfo(web, path, &info);
+
+        numProp = ((EjsObject*) cache->interp->global)->numProp;
+        oldGen = ejsSetGeneration(cache->interp, EJS_GEN_ETERNAL);
+        rc = loadModule(web, cache->interp, base);
+        ejsSetGeneration(cache->interp, oldGen);
+
+        if (rc == 0) {
+            rc = saveStatics(cache, numProp);
+        }
+        if (rc < 0) {
+            /*
+             *  The cache interpreter may hold partial definitions
+             */
+            retireCache(control, cache);
+            unlock(control);
             return rc;
         }
+        if ((mp = mprAllocObjZeroed(cache->modules, EjsWebModule)) != 0) {
+            if (strcmp(kind, "app") != 0) {
+                mprAllocSprintf(mp, &mp->source, -1, "%s%s", base, ext);
+            }
+            mp->mtime = info.mtime;
+            mp->generation = ++cache->generation;
+            mprAddHash(cache->modules, base, mp);
+        }
+    }
+    unlock(control);
+
+    /*
+     *  This request was created before the module was cached
+     */
+    return loadModule(web, web->ejs, base);
+}
+
+
+/*
+ *  Save the static properties of the classes defined by a newly cached module. Classes are global properties from 
+ *  slot "first". The statics are restored when each request completes, so they are per request. Must be called locked.
+ */
+static int saveStatics(EjsWebCache *cache, int first)
+{
+    EjsWebStatics   *sp;
+    EjsObject       *global, *obj;
+    EjsVar          *vp;
+    int             i;
+
+    global = (EjsObject*) cache->interp->global;
+    for (i = first; i < global->numProp; i++) {
+        vp = global->slots[i];
+        if (vp == 0 || !ejsIsType(vp) || ((EjsObject*) vp)->numProp == 0) {
+            continue;
+        }
+        obj = (EjsObject*) vp;
+        if ((sp = mprAllocObjZeroed(cache->statics, EjsWebStatics)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        sp->type = (EjsType*) vp;
+        sp->numProp = obj->numProp;
+        if ((sp->slots = (EjsVar**) mprMemdup(sp, obj->slots, obj->numProp * sizeof(EjsVar*))) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        mprAddItem(cache->statics, sp);
     }
+    return 0;
+}
+
+
+/*
+ *  Restore the static properties of cached classes to their values after loading. Must be called locked.
+ */
+static void restoreStatics(EjsWebCache *cache)
+{
+    EjsWebStatics   *sp;
+    EjsObject       *obj;
+    int             next;
+
+    for (next = 0; (sp = (EjsWebStatics*) mprGetNextItem(cache->statics, &next)) != 0; ) {
+        obj = (EjsObject*) sp->type;
+        memcpy(obj->slots, sp->slots, min(obj->numProp, sp->numProp) * sizeof(EjsVar*));
+    }
+}
 
-    if (ejsLoadModule(web->ejs, base, NULL, NULL, 0) == 0) {
+
+static int loadModule(EjsWeb *web, Ejs *ejs, cchar *base)
+{
+    if (ejsLoadModule(ejs, base, NULL, NULL, 0) == 0) {
         mprAllocSprintf(web, &web->error, -1, "Can't load module : \"%s.mod\"\n%s", base, ejsGetErrorMsg(ejs, 1));
         return MPR_ERR_CANT_READ;
     }
@@ -32440,33 +34087,568 @@ static int compile(EjsWeb *web, cchar *kind, cchar *name)
 }
 
 
-/*
- *  Buidl a resource
- */
-static int build(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *ext)
-{
-    MprFileInfo     moduleInfo, sourceInfo;
-    char            module[MPR_MAX_FNAME], source[MPR_MAX_FNAME];
+/*
+ *  Build a resource. If the web server provides an in-process compiler, out of date components are compiled on the 
+ *  compile thread. If a module exists, it continues to be used until the compilation replaces it. Otherwise the 
+ *  request waits for the compilation.
+ */
+static int build(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *ext)
+{
+    EjsWebControl   *control;
+    EjsWebCompile   *job;
+    MprFileInfo     moduleInfo, sourceInfo;
+    char            module[MPR_MAX_FNAME], source[MPR_MAX_FNAME];
+
+    control = web->control;
+
+    mprSprintf(module, sizeof(module), "%s.mod", base);
+    mprSprintf(source, sizeof(source), "%s%s", base, ext);
+    mprGetFileInfo(web, module, &moduleInfo);
+    mprGetFileInfo(web, source, &sourceInfo);
+
+    if (!sourceInfo.valid) {
+        mprLog(web, 3, "Can't find resource %s", source);
+        mprAllocSprintf(web, &web->error, -1, "Can't find resource: \"%s\"", source);
+        return MPR_ERR_NOT_FOUND;
+    }
+    if (moduleInfo.valid && !isModuleCurrent(web, module)) {
+        /* Compiled for a different module file format. Must recompile before it can be used. */
+        mprLog(web, 3, "Module %s has an incompatible format, recompiling", module);
+        moduleInfo.valid = 0;
+    }
+    if (moduleInfo.valid && sourceInfo.valid && sourceInfo.mtime < moduleInfo.mtime) {
+        /* Up to date already */
+        mprLog(web, 5, "Resource %s is up to date", source);
+        return 0;
+    }
+    if (control->compile == 0) {
+        if (compile(web, kind, name) != 0) {
+            return MPR_ERR_BAD_STATE;
+        }
+        return 0;
+    }
+
+    lock(control);
+    if ((job = startCompile(web, kind, name, base, source)) == 0) {
+        unlock(control);
+        return MPR_ERR_NO_MEMORY;
+    }
+#if BLD_FEATURE_MULTITHREAD
+    if (moduleInfo.valid) {
+        unlock(control);
+        mprLog(web, 4, "Using module %s while recompiling", module);
+        return 0;
+    }
+#endif
+    job->waiters++;
+    unlock(control);
+
+    return waitForCompile(web, job);
+}
+
+
+/*
+ *  Test if a compiled module uses the module file format supported by this interpreter
+ */
+static bool isModuleCurrent(EjsWeb *web, cchar *module)
+{
+    MprFile         *file;
+    EjsModuleHdr    hdr;
+    int             rc;
+
+    if ((file = mprOpen(web, module, O_RDONLY | O_BINARY, 0)) == 0) {
+        return 0;
+    }
+    rc = mprRead(file, &hdr, sizeof(hdr));
+    mprFree(file);
+
+    return rc == sizeof(hdr) && (int) hdr.magic == EJS_MODULE_MAGIC && (int) hdr.major == EJS_MAJOR && 
+        (int) hdr.minor == EJS_MINOR;
+}
+
+
+/*
+ *  Start compiling a component. If the component is already being compiled, return the existing compilation. 
+ *  Must be called locked.
+ */
+static EjsWebCompile *startCompile(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *source)
+{
+    EjsWebControl   *control;
+    EjsWebCompile   *job;
+    char            *cp;
+#if BLD_FEATURE_MULTITHREAD
+    MprThread       *tp;
+#endif
+
+    control = web->control;
+
+    if ((job = (EjsWebCompile*) mprLookupHash(control->compiling, base)) != 0) {
+        return job;
+    }
+    if ((job = mprAllocObjZeroed(control, EjsWebCompile)) == 0) {
+        return 0;
+    }
+    job->kind = mprStrdup(job, kind);
+    job->name = mprStrdup(job, name);
+    job->appDir = mprStrdup(job, web->appDir);
+    job->base = mprStrdup(job, base);
+    job->source = mprStrdup(job, source);
+
+    /*
+     *  View class names are prefixed by the controller name (see Controller.renderView)
+     */
+    if (strcmp(kind, "view") == 0) {
+        mprAllocSprintf(job, &job->prefix, -1, "%s_", name);
+        if ((cp = strchr(job->prefix, '/')) != 0) {
+            strcpy(cp, "_");
+        }
+        job->prefix[0] = toupper((int) job->prefix[0]);
+
+    } else if (*kind == '\0') {
+        job->prefix = mprStrdup(job, (web->flags & EJS_WEB_FLAG_SOLO) ? "_Solo_" : "Base_");
+    }
+    mprAddHash(control->compiling, base, job);
+
+#if BLD_FEATURE_MULTITHREAD
+    job->cond = mprCreateCond(job);
+    mprAddItem(control->compileQueue, job);
+    if (control->compileThread == 0) {
+        tp = mprCreateThread(control, "ejsCompile", (MprThreadProc) compileThread, control, MPR_NORMAL_PRIORITY, 0);
+        if (tp == 0 || mprStartThread(tp) < 0) {
+            mprError(web, "Can't start the compile thread");
+            mprRemoveItem(control->compileQueue, job);
+            mprRemoveHash(control->compiling, base);
+            mprFree(job);
+            return 0;
+        }
+        control->compileThread = tp;
+    }
+    mprSignalCond(control->compileCond);
+#endif
+    return job;
+}
+
+
+/*
+ *  Wait for a compilation to complete and return its status. The caller must have incremented job->waiters.
+ */
+static int waitForCompile(EjsWeb *web, EjsWebCompile *job)
+{
+    EjsWebControl   *control;
+    int             status;
+
+    control = web->control;
+
+#if BLD_FEATURE_MULTITHREAD
+    lock(control);
+    while (!job->done) {
+        unlock(control);
+        /* The condition wakes one waiter. Poll in case there are several. */
+        mprWaitForCond(job->cond, 100);
+        lock(control);
+    }
+    mprSignalCond(job->cond);
+#else
+    if (!job->done) {
+        runCompile(control, job);
+    }
+    lock(control);
+#endif
+    status = job->status;
+    if (status < 0 && job->error) {
+        web->error = mprStrdup(web, job->error);
+    }
+    if (--job->waiters == 0) {
+        mprFree(job);
+    }
+    unlock(control);
+    return status;
+}
+
+
+#if BLD_FEATURE_MULTITHREAD
+/*
+ *  Compile thread. Compilations are serialized so only one compiler interpreter exists at a time.
+ */
+static void compileThread(EjsWebControl *control, MprThread *tp)
+{
+    EjsWebCompile   *job;
+
+    lock(control);
+    while (1) {
+        if ((job = (EjsWebCompile*) mprGetFirstItem(control->compileQueue)) == 0) {
+            unlock(control);
+            mprWaitForCond(control->compileCond, -1);
+            lock(control);
+            continue;
+        }
+        mprRemoveItemAtPos(control->compileQueue, 0);
+        unlock(control);
+        runCompile(control, job);
+        lock(control);
+    }
+}
+#endif
+
+
+/*
+ *  Run a compilation and notify waiting requests. The job is freed by the last waiter.
+ */
+static void runCompile(EjsWebControl *control, EjsWebCompile *job)
+{
+    int     status;
+
+    status = compileComponent(control, job);
+
+    lock(control);
+    job->status = status;
+    job->done = 1;
+    if (mprLookupHash(control->compiling, job->base) == job) {
+        mprRemoveHash(control->compiling, job->base);
+    }
+#if BLD_FEATURE_MULTITHREAD
+    mprSignalCond(job->cond);
+#endif
+    if (job->waiters == 0) {
+        mprFree(job);
+    }
+    unlock(control);
+}
+
+
+/*
+ *  Compile a component using the web server's in-process compiler. Web pages and views are first parsed into 
+ *  Ejscript (see ejsweb). The module is written to a temporary and renamed so requests never load a partial module.
+ */
+static int compileComponent(EjsWebControl *control, EjsWebCompile *job)
+{
+    MprFile     *file;
+    MprFileInfo info;
+    MprBuf      *buf;
+    cchar       *delim;
+    char        module[MPR_MAX_FNAME], temp[MPR_MAX_FNAME], script[MPR_MAX_FNAME], app[MPR_MAX_FNAME];
+    char        controller[MPR_MAX_FNAME], layout[MPR_MAX_FNAME], viewName[MPR_MAX_FNAME];
+    char        *files[4], *body, *cp;
+    int         argc, rc, len;
+
+    delim = (job->appDir[strlen(job->appDir) - 1] == '/') ? "" : "/";
+    mprSprintf(module, sizeof(module), "%s%s", job->base, EJS_MODULE_EXT);
+    mprSprintf(temp, sizeof(temp), "%s.tmp%s", job->base, EJS_MODULE_EXT);
+    mprSprintf(app, sizeof(app), "%s%sApp%s", job->appDir, delim, EJS_MODULE_EXT);
+    script[0] = '\0';
+
+    argc = 0;
+    if (mprGetFileInfo(job, app, &info) == 0) {
+        files[argc++] = app;
+    }
+    if (strcmp(job->kind, "controller") == 0) {
+        files[argc++] = job->source;
+
+    } else {
+        if (strcmp(job->kind, "view") == 0) {
+            mprStrcpy(viewName, sizeof(viewName), mprGetBaseName(job->name));
+            mprSprintf(controller, sizeof(controller), "%s%scontrollers/%.*s%s", job->appDir, delim, 
+                (int) strlen(job->prefix) - 1, job->prefix, EJS_MODULE_EXT);
+            if (mprGetFileInfo(job, controller, &info) == 0) {
+                files[argc++] = controller;
+            }
+            mprSprintf(layout, sizeof(layout), "%s%sviews/layouts/default%s", job->appDir, delim, EJS_WEB_EXT);
+            if (mprGetFileInfo(job, layout, &info) < 0) {
+                layout[0] = '\0';
+            }
+
+        } else {
+            /*
+             *  View name strips the extension and converts "/" to "_"
+             */
+            mprStrcpy(viewName, sizeof(viewName), job->name);
+            if ((cp = strrchr(viewName, '.')) != 0 && strcmp(cp, EJS_WEB_EXT) == 0) {
+                *cp = '\0';
+            }
+            for (cp = viewName; *cp; cp++) {
+                if (*cp == '/' || *cp == '\\') {
+                    *cp = '_';
+                }
+            }
+            layout[0] = '\0';
+        }
+        if ((body = parsePage(job, job->source, (*layout) ? layout : 0)) == 0) {
+            mprLog(control, 3, "Can't parse %s\n%s", job->source, job->error);
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        buf = mprCreateBuf(job, MPR_BUFSIZE, -1);
+        mprAllocSprintf(buf, &cp, -1, 
+            "\n\npublic dynamic class %s%sView extends View {\n"
+            "    function %s%sView(c: Controller) {\n"
+            "        super(c)\n"
+            "    }\n\n"
+            "    override public function render() {\n", job->prefix, viewName, job->prefix, viewName);
+        mprPutStringToBuf(buf, cp);
+        mprPutStringToBuf(buf, body);
+        mprPutStringToBuf(buf, "\n    }\n}\n");
+        mprFree(body);
+
+        mprSprintf(script, sizeof(script), "%s.es", job->base);
+        if ((file = mprOpen(job, script, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0664)) == 0) {
+            mprAllocSprintf(job, &job->error, -1, "Can't create \"%s\"", script);
+            mprFree(buf);
+            return MPR_ERR_CANT_CREATE;
+        }
+        len = mprGetBufLength(buf);
+        rc = mprWrite(file, mprGetBufStart(buf), len);
+        mprFree(file);
+        mprFree(buf);
+        if (rc != len) {
+            mprAllocSprintf(job, &job->error, -1, "Can't write \"%s\"", script);
+            mprDelete(job, script);
+            return MPR_ERR_CANT_WRITE;
+        }
+        files[argc++] = script;
+    }
+
+    mprLog(control, 3, "Compiling %s", job->source);
+    mprDelete(job, temp);
+    rc = control->compile(job, temp, argc, files);
+    if (*script) {
+        mprDelete(job, script);
+    }
+    if (rc < 0 || mprGetFileInfo(job, temp, &info) < 0 || rename(temp, module) < 0) {
+        mprLog(control, 3, "Compilation failure for %s", job->source);
+        mprAllocSprintf(job, &job->error, -1, "Compilation failed for \"%s\"", job->source);
+        mprDelete(job, temp);
+        return MPR_ERR_BAD_STATE;
+    }
+    return 0;
+}
+
+
+/*
+ *  Web page parser tokens
+ */
+#define PAGE_TOK_EOF        0           /* End of file */
+#define PAGE_TOK_EJS        1           /* <% code %> */
+#define PAGE_TOK_VAR        2           /* @@var */
+#define PAGE_TOK_LITERAL    3           /* Literal HTML */
+#define PAGE_TOK_EQUALS     4           /* <%= expression %> */
+#define PAGE_TOK_CONTROL    5           /* <%@ control %> */
+
+#define PAGE_CONTENT_MARKER "__ejs:CONTENT:ejs__"
+
+/*
+ *  Get the next web page token from script[*pos]. Literal text is escaped for use in a string.
+ */
+static int getPageToken(cchar *script, int *pos, MprBuf *token)
+{
+    int     c, p, tid;
+
+    mprFlushBuf(token);
+    tid = PAGE_TOK_LITERAL;
+
+    for (p = *pos; script[p]; ) {
+        c = script[p++];
+        if (c == '<' && script[p] == '%' && (p < 2 || script[p - 2] != '\\')) {
+            if (mprGetBufLength(token) > 0) {
+                p--;
+                break;
+            }
+            for (p++; isspace((int) (uchar) script[p]); p++) ;
+            if (script[p] == '=') {
+                tid = PAGE_TOK_EQUALS;
+            } else if (script[p] == '@') {
+                tid = PAGE_TOK_CONTROL;
+            } else {
+                tid = PAGE_TOK_EJS;
+            }
+            if (tid != PAGE_TOK_EJS) {
+                for (p++; isspace((int) (uchar) script[p]); p++) ;
+            }
+            while (script[p] && (script[p] != '%' || script[p + 1] != '>' || 
+                    (tid != PAGE_TOK_CONTROL && script[p - 1] == '\\'))) {
+                mprPutCharToBuf(token, script[p++]);
+            }
+            if (script[p]) {
+                p += 2;
+            }
+            break;
+
+        } else if (c == '@' && script[p] == '@') {
+            if (mprGetBufLength(token) > 0) {
+                p--;
+                break;
+            }
+            for (p++; (c = script[p]) != '\0' && (isalnum((int) (uchar) c) || strchr("[]._$'", c)); p++) {
+                mprPutCharToBuf(token, c);
+            }
+            tid = PAGE_TOK_VAR;
+            break;
+
+        } else if (c == '\"' || c == '\\') {
+            mprPutCharToBuf(token, '\\');
+        }
+        mprPutCharToBuf(token, c);
+    }
+    *pos = p;
+    mprAddNullToBuf(token);
+    if (tid == PAGE_TOK_LITERAL && mprGetBufLength(token) == 0) {
+        return PAGE_TOK_EOF;
+    }
+    return tid;
+}
+
+
+static char *readPage(MprCtx ctx, cchar *path)
+{
+    MprFile     *file;
+    MprFileInfo info;
+    char        *buf;
+    int         len;
+
+    if (mprGetFileInfo(ctx, path, &info) < 0 || (file = mprOpen(ctx, path, O_RDONLY | O_BINARY, 0)) == 0) {
+        return 0;
+    }
+    if ((buf = mprAlloc(ctx, (int) info.size + 1)) == 0) {
+        mprFree(file);
+        return 0;
+    }
+    len = mprRead(file, buf, (int) info.size);
+    mprFree(file);
+    if (len < 0) {
+        mprFree(buf);
+        return 0;
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+
+/*
+ *  Parse a web page and return the equivalent Ejscript. This is the same transformation as performed by ejsweb. 
+ *  It supports:
+ *
+ *    <% code %>            Ejscript statements
+ *    <%= expression %>     Expression to evaluate and substitute
+ *    <%@ include "file" %> Include an ejs file
+ *    <%@ layout "file" %>  Specify a layout page to use. Use layout "" to disable layout management.
+ *    <%@ content %>        Where to put the page content in a layout page
+ *    @@var                 Expand the value of "var"
+ */
+static char *parsePage(EjsWebCompile *job, cchar *path, cchar *layout)
+{
+    MprBuf      *out, *token;
+    cchar       *delim;
+    char        dir[MPR_MAX_FNAME], incPath[MPR_MAX_FNAME], layoutPath[MPR_MAX_FNAME];
+    char        *script, *text, *cmd, *arg, *tok, *inc, *layoutText, *result, *marker, *cp;
+    int         tid, pos;
+
+    if ((script = readPage(job, path)) == 0) {
+        mprAllocSprintf(job, &job->error, -1, "Can't read web page \"%s\"", path);
+        return 0;
+    }
+    delim = (job->appDir[strlen(job->appDir) - 1] == '/') ? "" : "/";
+    out = mprCreateBuf(job, MPR_BUFSIZE, -1);
+    token = mprCreateBuf(out, MPR_BUFSIZE, -1);
+    result = 0;
+
+    for (pos = 0; (tid = getPageToken(script, &pos, token)) != PAGE_TOK_EOF; ) {
+        text = mprGetBufStart(token);
+
+        switch (tid) {
+        case PAGE_TOK_LITERAL:
+            mprPutStringToBuf(out, "\nwrite(\"");
+            mprPutStringToBuf(out, text);
+            mprPutStringToBuf(out, "\");\n");
+            break;
+
+        case PAGE_TOK_VAR:
+            /*
+             *  Catenate with "" so undefined variables evaluate to ""
+             */
+            mprPutStringToBuf(out, "\nwrite(\"\" + ");
+            mprPutStringToBuf(out, text);
+            mprPutStringToBuf(out, ");\n");
+            break;
+
+        case PAGE_TOK_EQUALS:
+            mprPutStringToBuf(out, "\nwrite(\"\" + (");
+            mprPutStringToBuf(out, text);
+            mprPutStringToBuf(out, "));\n");
+            break;
+
+        case PAGE_TOK_EJS:
+            mprPutStringToBuf(out, text);
+            break;
 
-    mprSprintf(module, sizeof(module), "%s.mod", base);
-    mprSprintf(source, sizeof(source), "%s%s", base, ext);
-    mprGetFileInfo(web, module, &moduleInfo);
-    mprGetFileInfo(web, source, &sourceInfo);
+        case PAGE_TOK_CONTROL:
+            cmd = mprStrTok(text, " \t\r\n", &tok);
+            if ((arg = mprStrTok(0, " \t\r\n", &tok)) == 0) {
+                arg = "";
+            }
+            if (*arg == '"' || *arg == '\'') {
+                arg++;
+            }
+            if (*arg && (arg[strlen(arg) - 1] == '"' || arg[strlen(arg) - 1] == '\'')) {
+                arg[strlen(arg) - 1] = '\0';
+            }
+            if (cmd && strcmp(cmd, "include") == 0) {
+                if (*arg == '/') {
+                    mprStrcpy(incPath, sizeof(incPath), arg);
+                } else {
+                    mprSprintf(incPath, sizeof(incPath), "%s/%s", mprGetDirName(dir, sizeof(dir), path), arg);
+                }
+                if ((inc = parsePage(job, incPath, 0)) == 0) {
+                    goto done;
+                }
+                mprPutStringToBuf(out, inc);
+                mprFree(inc);
 
-    if (!sourceInfo.valid) {
-        mprLog(web, 3, "Can't find resource %s", source);
-        mprAllocSprintf(web, &web->error, -1, "Can't find resource: \"%s\"", source);
-        return MPR_ERR_NOT_FOUND;
-    }
-    if (moduleInfo.valid && sourceInfo.valid && sourceInfo.mtime < moduleInfo.mtime) {
-        /* Up to date already */
-        mprLog(web, 5, "Resource %s is up to date", source);
-        return 0;
+            } else if (cmd && strcmp(cmd, "layout") == 0) {
+                if (*arg == '\0') {
+                    layout = 0;
+                } else {
+                    if ((cp = strrchr(arg, '.')) != 0 && strcmp(cp, EJS_WEB_EXT) == 0) {
+                        *cp = '\0';
+                    }
+                    if (*arg == '/') {
+                        mprSprintf(layoutPath, sizeof(layoutPath), "%s%s", arg, EJS_WEB_EXT);
+                    } else {
+                        mprSprintf(layoutPath, sizeof(layoutPath), "%s%sviews/layouts/%s%s", job->appDir, delim, arg, 
+                            EJS_WEB_EXT);
+                    }
+                    layout = layoutPath;
+                }
+
+            } else if (cmd && strcmp(cmd, "content") == 0) {
+                mprPutStringToBuf(out, PAGE_CONTENT_MARKER);
+
+            } else {
+                mprAllocSprintf(job, &job->error, -1, "Bad control directive \"%s\" in \"%s\"", cmd ? cmd : "", path);
+                goto done;
+            }
+            break;
+        }
     }
-    if (compile(web, kind, name) != 0) {
-        return MPR_ERR_BAD_STATE;
+    mprAddNullToBuf(out);
+
+    if (layout && strcmp(layout, path) != 0) {
+        if ((layoutText = parsePage(job, layout, layout)) == 0) {
+            goto done;
+        }
+        if ((marker = strstr(layoutText, PAGE_CONTENT_MARKER)) != 0) {
+            *marker = '\0';
+            mprAllocStrcat(job, &result, -1, 0, layoutText, mprGetBufStart(out), 
+                &marker[sizeof(PAGE_CONTENT_MARKER) - 1], NULL);
+            mprFree(layoutText);
+        } else {
+            result = layoutText;
+        }
+    } else {
+        result = mprStealBuf(job, out);
     }
-    return 0;
+
+done:
+    mprFree(out);
+    mprFree(script);
+    return result;
 }
 
 
@@ -33426,7 +35608,10 @@ void ejsConfigureWebResponseType(Ejs *ejs)
 /**
  *  ejsWebSession.c - Native code for the Session class.
  *
- *  The Session class serializes objects that are stored to the session object.
+ *  Session state is held in a native session store that persists past the life of the current request. The store is
+ *  sharded by session ID so that concurrent requests rarely contend for the same lock. The Session class serializes 
+ *  objects that are stored to the session object and stores the serialized form in the session store. Values are 
+ *  deserialized into the requesting interpreter on access.
  *
  *  Copyright (c) All Rights Reserved. See details at the end of the file.
  */
@@ -33435,210 +35620,274 @@ void ejsConfigureWebResponseType(Ejs *ejs)
 
 #if BLD_FEATURE_EJS_WEB
 
-static void sessionActivity(Ejs *ejs, EjsWebSession *sp);
 static void sessionTimer(EjsWebControl *control, MprEvent *event);
 
-#if UNUSED
-static void descape(EjsVar *vp)
+#if BLD_FEATURE_MULTITHREAD
+static inline void lockStore(EjsWebSessionStore *store) {
+    mprLock(store->mutex);
+}
+static inline void unlockStore(EjsWebSessionStore *store) {
+    mprUnlock(store->mutex);
+}
+static inline void lockShard(EjsWebSessionShard *shard) {
+    mprLock(shard->mutex);
+}
+static inline void unlockShard(EjsWebSessionShard *shard) {
+    mprUnlock(shard->mutex);
+}
+#else
+static inline void lockStore(EjsWebSessionStore *store) {}
+static inline void unlockStore(EjsWebSessionStore *store) {}
+static inline void lockShard(EjsWebSessionShard *shard) {}
+static inline void unlockShard(EjsWebSessionShard *shard) {}
+#endif
+
+
+/*
+ *  Create the session store. Sessions are allocated natively in the store and not in any interpreter heap.
+ */
+EjsWebSessionStore *ejsCreateSessionStore(MprCtx ctx)
 {
-    char    *str, *cp, *dp;
-    
-    if (!ejsIsString(vp)) {
-        return;
-    }
-    
-    str = ((EjsString*) vp)->value;
-    
-    if (str == 0 || *str == '\0') {
-        return;
+    EjsWebSessionStore  *store;
+    EjsWebSessionShard  *shard;
+    int                 i;
+
+    store = mprAllocObjZeroed(ctx, EjsWebSessionStore);
+    if (store == 0) {
+        return 0;
     }
-    for (dp = cp = str; *cp; ) {
-        if (*cp == '\\') {
-            cp++;
+    for (i = 0; i < EJS_SESSION_SHARDS; i++) {
+        shard = &store->shards[i];
+        shard->sessions = mprCreateHash(store, EJS_SESSION_HASH_SIZE);
+        if (shard->sessions == 0) {
+            mprFree(store);
+            return 0;
         }
-        *dp++ = *cp++;
+#if BLD_FEATURE_MULTITHREAD
+        shard->mutex = mprCreateLock(store);
+#endif
     }
-    *dp = '\0';
-}
+#if BLD_FEATURE_MULTITHREAD
+    store->mutex = mprCreateLock(store);
 #endif
+    store->wheelTick = mprGetTime(ctx) / EJS_TIMER_PERIOD;
+    return store;
+}
 
 
-static EjsVar *getSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum)
+/*
+ *  Select the store shard for a session ID
+ */
+static EjsWebSessionShard *getShard(EjsWebSessionStore *store, cchar *id)
 {
-    EjsVar      *vp;
-    EjsWeb      *web;
+    uint    hash;
 
-    web = ejs->handle;
-    if (web->session != sp) {
-        return (EjsVar*) ejs->emptyStringValue;
+    for (hash = 0; *id; id++) {
+        hash = hash * 31 + (uchar) *id;
     }
+    return &store->shards[hash % EJS_SESSION_SHARDS];
+}
 
-    vp = ejs->objectHelpers->getProperty(ejs, (EjsVar*) sp, slotNum);
-    if (vp) {
-        vp = ejsDeserialize(ejs, vp);
-#if UNUSED
-        descape(vp);
-#endif
-    }
-    if (vp == ejs->undefinedValue) {
-        vp = (EjsVar*) ejs->emptyStringValue;
+
+/*
+ *  Add a session to the timer wheel slot for its expiry time. Must be called with the store locked.
+ */
+static void scheduleSession(EjsWebSessionStore *store, EjsWebSessionState *state, MprTime expire)
+{
+    MprTime     tick;
+    int         slot;
+
+    tick = max(expire / EJS_TIMER_PERIOD, store->wheelTick);
+    slot = (int) (tick % EJS_SESSION_WHEEL);
+
+    state->slot = slot;
+    state->prevExpire = 0;
+    state->nextExpire = store->wheel[slot];
+    if (state->nextExpire) {
+        state->nextExpire->prevExpire = state;
     }
-    sessionActivity(ejs, sp);
-    return vp;
+    store->wheel[slot] = state;
 }
 
 
-static EjsVar *getSessionPropertyByName(Ejs *ejs, EjsWebSession *sp, EjsName *qname)
+/*
+ *  Update the session expiration time due to activity. The session stays in its current wheel slot and is rescheduled 
+ *  when that slot is next examined by the timer. Must be called with the shard locked.
+ */
+static void sessionActivity(Ejs *ejs, EjsWebSessionState *state)
 {
-    EjsVar      *vp;
-    EjsWeb      *web;
-    int         slotNum;
+    state->expire = mprGetTime(ejs) + state->timeout * MPR_TICKS_PER_SEC;
+}
 
-    web = ejs->handle;
-    if (web->session != sp) {
-        return (EjsVar*) ejs->emptyStringValue;
-    }
 
-    qname->space = EJS_PUBLIC_NAMESPACE;
-    slotNum = ejs->objectHelpers->lookupProperty(ejs, (EjsVar*) sp, qname);
-    if (slotNum < 0) {
+/*
+ *  Check for expired sessions. Only the wheel slots that have come due since the last tick are examined.
+ */
+static void sessionTimer(EjsWebControl *control, MprEvent *event)
+{
+    EjsWebSessionStore  *store;
+    EjsWebSessionShard  *shard;
+    EjsWebSessionState  *state, *next;
+    MprTime             now, nowTick;
+    int                 slot;
+
+    store = control->sessions;
+    now = mprGetTime(control);
+    nowTick = now / EJS_TIMER_PERIOD;
+
+    lockStore(store);
+    if ((nowTick - store->wheelTick) >= EJS_SESSION_WHEEL) {
         /*
-         *  Return empty string so that web pages can access session values without having to test for null/undefined
+         *  The timer has fallen a full revolution behind. Every slot will be examined below.
          */
-        vp = (EjsVar*) ejs->emptyStringValue;
-    } else {
-        vp = ejs->objectHelpers->getProperty(ejs, (EjsVar*) sp, slotNum);
-        if (vp) {
-            vp = ejsDeserialize(ejs, vp);
-#if UNUSED
-            descape(vp);
-#endif
+        store->wheelTick = nowTick - EJS_SESSION_WHEEL + 1;
+    }
+    while (store->wheelTick <= nowTick) {
+        slot = (int) (store->wheelTick % EJS_SESSION_WHEEL);
+        state = store->wheel[slot];
+        store->wheel[slot] = 0;
+        store->wheelTick++;
+
+        for (; state; state = next) {
+            next = state->nextExpire;
+            shard = getShard(store, state->id);
+            lockShard(shard);
+            if ((state->removed || state->expire <= now) && state->refs == 0) {
+                if (!state->removed) {
+                    mprLog(control, 3, "Session %s expired", state->id);
+                    mprRemoveHash(shard->sessions, state->id);
+                }
+                mprFree(state);
+                store->count--;
+
+            } else {
+                scheduleSession(store, state, max(state->expire, now + EJS_TIMER_PERIOD));
+            }
+            unlockShard(shard);
         }
     }
-    sessionActivity(ejs, sp);
-    return vp;
+    unlockStore(store);
 }
 
 
-#if UNUSED
-static char *escape(MprCtx ctx, char *str)
+/*
+ *  Get the session state for the current request. Returns zero if the session object does not belong to the request.
+ */
+static EjsWebSessionState *getState(Ejs *ejs, EjsWebSession *sp)
 {
-    char    *cp, *bp, *buf;
-    int     len;
-
-    len = 0;
-    for (cp = str; *cp; cp++) {
-        if (*cp == '\'' || *cp == '"' || *cp == '\\') {
-            len++;
-        }
-        len++;
-    }
+    EjsWeb      *web;
 
-    bp = buf = mprAlloc(ctx, len + 1);
-    if (bp == 0) {
+    web = ejs->handle;
+    if (web == 0 || web->session != sp || sp->state == 0 || sp->state->removed) {
         return 0;
     }
-
-    for (bp = buf, cp = str; *cp; ) {
-        if (*cp == '\'' || *cp == '"' || *cp == '\\') {
-            *bp++ = '\\';
-        }
-        *bp++ = *cp++;
-    }
-    *bp = '\0';
-    return buf;
+    return sp->state;
 }
-#endif
 
 
-static int setSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum, EjsVar *value)
+static EjsVar *getSessionPropertyByName(Ejs *ejs, EjsWebSession *sp, EjsName *qname)
 {
-    EjsWeb  *web;
-    
-    web = ejs->handle;
-    if (web->session != sp) {
-        mprAssert(0);
-        return EJS_ERR;
-    }
+    EjsWeb              *web;
+    EjsWebSessionState  *state;
+    EjsWebSessionShard  *shard;
+    EjsVar              *vp;
+    cchar               *value;
 
     /*
-     *  Allocate the serialized object using the master interpreter
+     *  Return empty string so that web pages can access session values without having to test for null/undefined
      */
-    if (ejs->master) {
-        ejs = ejs->master;
+    if ((state = getState(ejs, sp)) == 0) {
+        return (EjsVar*) ejs->emptyStringValue;
     }
+    web = ejs->handle;
+    shard = getShard(web->control->sessions, state->id);
 
-#if UNUSED
-    if (value != ejs->undefinedValue && value != ejs->nullValue) {
-        value = (EjsVar*) ejsSerialize(ejs, value, 0, 0, 0);
-        estr = escape(ejs, ((EjsString*) value)->value);
-        value = (EjsVar*) ejsCreateString(ejs, estr);
-        mprFree(estr);
+    vp = 0;
+    lockShard(shard);
+    if ((value = (cchar*) mprLookupHash(state->values, qname->name)) != 0) {
+        vp = (EjsVar*) ejsCreateString(ejs, value);
     }
-#else
-    value = (EjsVar*) ejsSerialize(ejs, value, 0, 0, 0);
-#endif
-    slotNum = ejs->objectHelpers->setProperty(ejs, (EjsVar*) sp, slotNum, value);
-    
-    sessionActivity(ejs, sp);
-    return slotNum;
+    sessionActivity(ejs, state);
+    unlockShard(shard);
+
+    if (vp) {
+        vp = ejsDeserialize(ejs, vp);
+    }
+    if (vp == 0 || vp == ejs->undefinedValue) {
+        vp = (EjsVar*) ejs->emptyStringValue;
+    }
+    return vp;
 }
 
 
-/*
- *  Update the session expiration time due to activity
- */
-static void sessionActivity(Ejs *ejs, EjsWebSession *sp)
+static int deleteSessionPropertyByName(Ejs *ejs, EjsWebSession *sp, EjsName *qname)
 {
-    sp->expire = mprGetTime(ejs) + sp->timeout * MPR_TICKS_PER_SEC;
+    EjsWeb              *web;
+    EjsWebSessionState  *state;
+    EjsWebSessionShard  *shard;
+    char                *value;
+
+    if ((state = getState(ejs, sp)) == 0) {
+        return EJS_ERR;
+    }
+    web = ejs->handle;
+    shard = getShard(web->control->sessions, state->id);
+
+    lockShard(shard);
+    if ((value = (char*) mprLookupHash(state->values, qname->name)) != 0) {
+        mprRemoveHash(state->values, qname->name);
+        mprFree(value);
+    }
+    sessionActivity(ejs, state);
+    unlockShard(shard);
+    return 0;
 }
 
 
 /*
- *  Check for expired sessions
+ *  Store a session value. The value is serialized in the requesting interpreter and a copy of the serialized form is 
+ *  saved in the session store. Storing undefined removes the value.
  */
-static void sessionTimer(EjsWebControl *control, MprEvent *event)
+static int setSessionPropertyByName(Ejs *ejs, EjsWebSession *sp, EjsName *qname, EjsVar *value)
 {
-    Ejs             *master;
-    EjsObject       *sessions;
-    EjsWebSession   *session;
-    MprTime         now;
-    int             i, count, deleted;
+    EjsWeb              *web;
+    EjsWebSessionState  *state;
+    EjsWebSessionShard  *shard;
+    EjsString           *str;
+    char                *old;
 
-    sessions = control->sessions;
-    master = control->master;
-    if (master == 0) {
-        mprAssert(master);
-        return;
+    if ((state = getState(ejs, sp)) == 0) {
+        mprAssert(0);
+        return EJS_ERR;
     }
-
-    now = mprGetTime(control);
-
-    //  TODO - locking MULTITHREAD
- 
-    count = ejsGetPropertyCount(master, (EjsVar*) sessions);
-    deleted = 0;
-    for (i = 0; i < count; i++) {
-        session = (EjsWebSession*) ejsGetProperty(master, (EjsVar*) sessions, i);
-        if (session && session->expire <= now) {
-            ejsDeleteProperty(master, (EjsVar*) sessions, i);
-            deleted++;
-            i--;
-            count--;
-        }
+    if (value == ejs->undefinedValue) {
+        return deleteSessionPropertyByName(ejs, sp, qname);
+    }
+    str = (EjsString*) ejsSerialize(ejs, value, 0, 0, 0);
+    if (str == 0 || !ejsIsString(str)) {
+        return EJS_ERR;
     }
-    if (deleted) {
-        ejsCollectGarbage(master, EJS_GC_ALL);
+    web = ejs->handle;
+    shard = getShard(web->control->sessions, state->id);
+
+    lockShard(shard);
+    if ((old = (char*) mprLookupHash(state->values, qname->name)) != 0) {
+        mprFree(old);
     }
+    mprAddHash(state->values, qname->name, mprStrdup(state->values, str->value));
+    sessionActivity(ejs, state);
+    unlockShard(shard);
+    return 0;
 }
 
 
 void ejsParseWebSessionCookie(EjsWeb *web)
 {
-    EjsName         qname;
-    EjsWebControl   *control;
-    char            *id, *cp, *value;
-    int             quoted, len;
+    EjsWebControl       *control;
+    EjsWebSessionShard  *shard;
+    EjsWebSessionState  *state;
+    char                *id, *cp, *value;
+    int                 quoted, len;
 
     if ((value = strstr(web->cookie, EJS_SESSION)) == 0) {
         return;
@@ -33665,113 +35914,173 @@ void ejsParseWebSessionCookie(EjsWeb *web)
         }
     }
     control = web->control;
+    if (control->sessions == 0) {
+        return;
+    }
 
     len = cp - value;
     id = mprMemdup(web, value, len + 1);
     id[len] = '\0';
 
-    if (control->master) {
-        ejsName(&qname, "", id);
-        web->session = (EjsWebSession*) ejsGetPropertyByName(control->master, (EjsVar*) control->sessions, &qname);
+    shard = getShard(control->sessions, id);
+    lockShard(shard);
+    if ((state = (EjsWebSessionState*) mprLookupHash(shard->sessions, id)) != 0) {
+        if (state->expire > mprGetTime(web)) {
+            state->refs++;
+        } else {
+            state = 0;
+        }
     }
+    unlockShard(shard);
     mprFree(id);
+
+    if (state) {
+        web->session = ejsCreateWebSessionObject(web->ejs, web->handle);
+        if (web->session) {
+            web->session->state = state;
+        } else {
+            lockShard(shard);
+            state->refs--;
+            unlockShard(shard);
+        }
+    }
 }
 
 
 /*
- *  Create a new session object. This is created in the master interpreter and will persist past the life of the current
- *  request. This will allocate a new session ID. Timeout is in seconds.
+ *  Create a new session. The session state is created in the session store and will persist past the life of the 
+ *  current request. This will allocate a new session ID. Timeout is in seconds.
  */
 EjsWebSession *ejsCreateSession(Ejs *ejs, int timeout, bool secure)
 {
-    Ejs             *master;
-    EjsWeb          *web;
-    EjsWebControl   *control;
-    EjsWebSession   *session;
-    EjsType         *sessionType;
-    EjsName         qname;
-    char            idBuf[64], *id;
+    EjsWeb              *web;
+    EjsWebControl       *control;
+    EjsWebSession       *session;
+    EjsWebSessionStore  *store;
+    EjsWebSessionShard  *shard;
+    EjsWebSessionState  *state;
+    MprTime             expire;
+    char                idBuf[64], *id;
+    int                 next;
 
-    master = ejs->master;
-    if (master == 0) {
-        return 0;
-    }
     web = ejsGetHandle(ejs);
+    if (web->session) {
+        return web->session;
+    }
     control = web->control;
-
+    if ((store = control->sessions) == 0) {
+        return 0;
+    }
     if (timeout <= 0) {
         timeout = control->sessionTimeout;
     }
+    expire = mprGetTime(ejs) + timeout * MPR_TICKS_PER_SEC;
 
-#if ES_ejs_web_Session
-    sessionType = ejsGetType(ejs, ES_ejs_web_Session);
-#else
-    sessionType = (EjsType*) ejsGetPropertyByName(ejs, ejs->global, ejsName(&qname, "ejs.web", "Session"));
-#endif
-    if (sessionType == 0) {
-        mprAssert(0);
+    lockStore(store);
+    next = control->nextSession++;
+    unlockStore(store);
+
+    mprSprintf(idBuf, sizeof(idBuf), "%08x%08x%08x", PTOI(ejs) + PTOI(web) + PTOI(expire), (int) time(0), next);
+
+    /*
+     *  We use an MD5 prefix of "x" so we can avoid the hash being interpreted as a numeric index.
+     */
+    id = mprGetMD5Hash(web, (uchar*) idBuf, sizeof(idBuf), "x");
+    if (id == 0) {
         return 0;
     }
-
-    session = (EjsWebSession*) ejsCreateObject(master, sessionType, 0);
+    session = ejsCreateWebSessionObject(ejs, web->handle);
     if (session == 0) {
+        mprFree(id);
         return 0;
     }
 
-    session->timeout = timeout;
-    session->expire = mprGetTime(ejs) + timeout * MPR_TICKS_PER_SEC;
-
-    mprSprintf(idBuf, sizeof(idBuf), "%08x%08x%08x", PTOI(ejs) + PTOI(web) + PTOI(session->expire), 
-        (int) time(0), (int) control->nextSession++);
-    id = mprGetMD5Hash(session, (uchar*) idBuf, sizeof(idBuf), "x");
-    if (id == 0) {
-        mprFree(session);
+    shard = getShard(store, id);
+    lockShard(shard);
+    state = mprAllocObjZeroed(shard->sessions, EjsWebSessionState);
+    if (state == 0) {
+        unlockShard(shard);
+        mprFree(id);
         return 0;
     }
-    session->id = mprStrdup(session, id);
+    state->id = mprStrdup(state, id);
+    state->values = mprCreateHash(state, 0);
+    state->timeout = timeout;
+    state->expire = expire;
+    state->refs = 1;
+    mprAddHash(shard->sessions, state->id, state);
+    unlockShard(shard);
+
+    lockStore(store);
+    scheduleSession(store, state, expire);
+    store->count++;
+    if (store->timer == 0 /* TODO && !mprGetDebugMode(master) */) {
+        store->wheelTick = mprGetTime(ejs) / EJS_TIMER_PERIOD;
+        store->timer = mprCreateTimerEvent(control, (MprEventProc) sessionTimer, EJS_TIMER_PERIOD, MPR_NORMAL_PRIORITY, 
+            control, MPR_EVENT_CONTINUOUS);
+    }
+    unlockStore(store);
 
     /*
      *  Create a cookie that will only live while the browser is not exited. (Set timeout to zero).
      */
     ejsSetCookie(ejs, EJS_SESSION, id, 0, "/", secure);
-
-    /*
-     *  We use an MD5 prefix of "x" above so we can avoid the hash being interpreted as a numeric index.
-     */
-    ejsName(&qname, "", session->id);
-    ejsSetPropertyByName(control->master, (EjsVar*) control->sessions, &qname, (EjsVar*) session);
-    web->session = session;
-
     mprLog(ejs, 3, "Created new session %s", id);
+    mprFree(id);
 
-    if (control->sessions->numProp == 1 /* TODO && !mprGetDebugMode(master) */) {
-        mprCreateTimerEvent(master, (MprEventProc) sessionTimer, EJS_TIMER_PERIOD, MPR_NORMAL_PRIORITY, control, 
-            MPR_EVENT_CONTINUOUS);
-    }
-
+    session->state = state;
+    web->session = session;
     return session;
 }
 
 
+/*
+ *  Destroy the current session. The state is removed from the store immediately and freed by the session timer once 
+ *  no requests are using it.
+ */
 bool ejsDestroySession(Ejs *ejs)
 {
-    EjsWeb          *web;
-    EjsWebControl   *control;
-    EjsName         qname;
-    int             rc;
+    EjsWeb              *web;
+    EjsWebSessionShard  *shard;
+    EjsWebSessionState  *state;
 
     web = ejs->handle;
-    control = web->control;
-
-    if (web->session == 0) {
-        //  TODO - remove
-        mprAssert(0);
+    if (web->session == 0 || (state = web->session->state) == 0) {
         return 0;
     }
+    shard = getShard(web->control->sessions, state->id);
+    lockShard(shard);
+    if (!state->removed) {
+        mprRemoveHash(shard->sessions, state->id);
+        state->removed = 1;
+        mprFree(state->values);
+        state->values = 0;
+    }
+    unlockShard(shard);
 
-    rc = ejsDeletePropertyByName(control->master, (EjsVar*) control->sessions, ejsName(&qname, "", web->session->id));
+    ejsReleaseSession(web);
     web->session = 0;
-    return rc;
+    return 1;
+}
+
+
+/*
+ *  Release the request's reference to its session state. Called when the request completes.
+ */
+void ejsReleaseSession(EjsWeb *web)
+{
+    EjsWebSessionShard  *shard;
+    EjsWebSessionState  *state;
+
+    if (web->session == 0 || (state = web->session->state) == 0) {
+        return;
+    }
+    shard = getShard(web->control->sessions, state->id);
+    lockShard(shard);
+    state->refs--;
+    mprAssert(state->refs >= 0);
+    unlockShard(shard);
+    web->session->state = 0;
 }
 
 
@@ -33782,6 +36091,10 @@ EjsWebSession *ejsCreateWebSessionObject(Ejs *ejs, void *handle)
     EjsName         qname;
 
     requestType = (EjsType*) ejsGetPropertyByName(ejs, ejs->global, ejsName(&qname, "ejs.web", "Session"));
+    if (requestType == 0) {
+        mprAssert(0);
+        return 0;
+    }
     vp = (EjsWebSession*) ejsCreateVar(ejs, requestType, 0);
     ejsSetDebugName(vp, "EjsWeb Session Instance");
 
@@ -33806,11 +36119,11 @@ void ejsConfigureWebSessionType(Ejs *ejs)
     mprAssert(type->hasObject);
 
     /*
-     *  Re-define the helper functions.
+     *  Re-define the helper functions. Session values are held in the session store and not in object slots.
      */
-    type->helpers->getProperty = (EjsGetPropertyHelper) getSessionProperty;
     type->helpers->getPropertyByName = (EjsGetPropertyByNameHelper) getSessionPropertyByName;
-    type->helpers->setProperty = (EjsSetPropertyHelper) setSessionProperty;
+    type->helpers->setPropertyByName = (EjsSetPropertyByNameHelper) setSessionPropertyByName;
+    type->helpers->deletePropertyByName = (EjsDeletePropertyByNameHelper) deleteSessionPropertyByName;
 }
 
 #endif /* BLD_FEATURE_EJS_WEB */
@@ -25629,255 +25629,6 @@ static void logger(MprCtx ctx, int flags, int level, const char *msg)
 
 
 
-/*
- *  Stack effect special values
- */
-#define UNIMP           100             /* Not implemented */
-#define POP1            101             /* Operand 1 specifies the stack change (pop) */
-
-/*
- *  Operands
- */
-#undef NONE
-#define NONE            0x0             /* No operands */
-#define BYTE            0x1             /* 8 bit integer */
-#define SHORT           0x2             /* 16 bit integer */
-#define WORD            0x4             /* 32 bits */
-#define LONG            0x8             /* 64 bit integer */
-#define DOUBLE          0x10            /* 64 bit floating */
-#define NUM             0x40            /* Encoded integer */
-#define STRING          0x80            /* Interned string as an encoded integer*/
-#define GLOBAL          0x100           /* Encode global */
-#define SLOT            0x200           /* Slot number as an encoded integer */
-#define JMP             0x1000          /* 32 bit jump offset */
-#define JMP8            0x2000          /* 8 bit jump offset */
-#define VARCOUNT        0x4000          /* <count> <offset32> ... */
-#define INIT_DEFAULT    0x8000          /* Computed goto table, 32 bit jumps  */
-#define INIT_DEFAULT8   0x10000         /* Computed goto table, 8 bit jumps */
-#define ARGC            0x20000         /* Argument count */
-#define ARGC2           0x40000         /* Argument count  * 2*/
-
-//  TODO - convert STRING, STRING to QNAME
-
-typedef struct Optable {
-    char    *name;
-    int     stackEffect;
-    int     args[8];
-} Optable;
-
-/*  Opcode string                           Stack Effect    Operands, ...                                   */
-Optable optable[] = {
-    {   "Add",                                      -1,         { NONE,                                         },},
-    {   "AddNamespace",                             0,          { STRING,                                       },},
-    {   "AddNamespaceRef",                          -1,         { NONE,                                         },},
-    {   "And",                                      -1,         { NONE,                                         },},
-    {   "BranchEQ",                                 -1,         { JMP,                                          },},
-    {   "BranchStrictlyEQ",                         -1,         { JMP,                                          },},
-    {   "BranchFalse",                              -1,         { JMP,                                          },},
-    {   "BranchGE",                                 -1,         { JMP,                                          },},
-    {   "BranchGT",                                 -1,         { JMP,                                          },},
-    {   "BranchLE",                                 -1,         { JMP,                                          },},
-    {   "BranchLT",                                 -1,         { JMP,                                          },},
-    {   "BranchNE",                                 -1,         { JMP,                                          },},
-    {   "BranchStrictlyNE",                         -1,         { JMP,                                          },},
-    {   "BranchNull",                               -1,         { JMP,                                          },},
-    {   "BranchNotZero",                            -1,         { JMP,                                          },},
-    {   "BranchTrue",                               -1,         { JMP,                                          },},
-    {   "BranchUndefined",                          -1,         { JMP,                                          },},
-    {   "BranchZero",                               -1,         { JMP,                                          },},
-    {   "BranchFalse.8",                            -1,         { JMP8,                                         },},
-    {   "BranchTrue.8",                             -1,         { JMP8,                                         },},
-    {   "Breakpoint",                               0,          { NUM, STRING,                                  },},
-    {   "Call",                                     -2,         { ARGC,                                         },},
-    {   "CallGlobalSlot",                           0,          { SLOT, ARGC,                                   },},
-    {   "CallObjSlot",                              -1,         { SLOT, ARGC,                                   },},
-    {   "CallThisSlot",                             0,          { SLOT, ARGC,                                   },},
-    {   "CallBlockSlot",                            0,          { SLOT, NUM, ARGC,                              },},
-    {   "CallObjInstanceSlot",                      -1,         { SLOT, ARGC,                                   },},
-    {   "CallObjStaticSlot",                        -1,         { SLOT, NUM, ARGC,                              },},
-    {   "CallThisStaticSlot",                       0,          { SLOT, NUM, ARGC,                              },},
-    {   "CallObjName",                              -1,         { STRING, STRING, ARGC,                         },},
-    {   "CallScopedName",                           0,          { STRING, STRING, ARGC,                         },},
-    {   "CallConstructor",                          0,          { ARGC,                                         },},
-    {   "CallNextConstructor",                      0,          { ARGC,                                         },},
-    {   "Cast",                                     -1,         { NONE,                                         },},
-    {   "CastBoolean",                              0,          { NONE,                                         },},
-    {   "CloseBlock",                               0,          { NONE,                                         },},
-    {   "CloseWith",                                0,          { NONE,                                         },},
-    {   "CompareEQ",                                -1,         { NONE,                                         },},
-    {   "CompareStrictlyEQ",                        -1,         { NONE,                                         },},
-    {   "CompareFalse",                             -1,         { NONE,                                         },},
-    {   "CompareGE",                                -1,         { NONE,                                         },},
-    {   "CompareGT",                                -1,         { NONE,                                         },},
-    {   "CompareLE",                                -1,         { NONE,                                         },},
-    {   "CompareLT",                                -1,         { NONE,                                         },},
-    {   "CompareNE",                                -1,         { NONE,                                         },},
-    {   "CompareStrictlyNE",                        -1,         { NONE,                                         },},
-    {   "CompareNull",                              -1,         { NONE,                                         },},
-    {   "CompareNotZero",                           -1,         { NONE,                                         },},
-    {   "CompareTrue",                              -1,         { NONE,                                         },},
-    {   "CompareUndefined",                         -1,         { NONE,                                         },},
-    {   "CompareZero",                              -1,         { NONE,                                         },},
-    {   "Debug",                                    0,          { NUM, STRING,                                  },},
-    {   "DefineClass",                              0,          { GLOBAL,                                       },},
-    {   "DefineFunction",                           0,          { SLOT, NUM,                                    },},
-    {   "DefineGlobalFunction",                     0,          { GLOBAL,                                       },},
-    {   "DeleteNameExp",                            -2,         { NONE,                                         },},
-    {   "Delete",                                   -1,         { STRING, STRING,                               },},
-    {   "DeleteName",                               0,          { STRING, STRING,                               },},
-    {   "Div",                                      -1,         { NONE,                                         },},
-    {   "Dup",                                      1,          { NONE,                                         },},
-    {   "Dup2",                                     2,          { NONE,                                         },},
-    {   "EndCode",                                  0,          { NONE,                                         },},
-    {   "EndException",                             0,          { NONE,                                         },},
-    {   "Goto",                                     0,          { JMP,                                          },},
-    {   "Goto.8",                                   0,          { JMP8,                                         },},
-    {   "Inc",                                      0,          { BYTE,                                         },},
-    {   "InitDefaultArgs",                          0,          { INIT_DEFAULT,                                 },},
-    {   "InitDefaultArgs.8",                        0,          { INIT_DEFAULT8,                                },},
-    {   "InstOf",                                   -1,         { NONE,                                         },},
-    {   "IsA",                                      -1,         { NONE,                                         },},
-    {   "Load0",                                    1,          { NONE,                                         },},
-    {   "Load1",                                    1,          { NONE,                                         },},
-    {   "Load2",                                    1,          { NONE,                                         },},
-    {   "Load3",                                    1,          { NONE,                                         },},
-    {   "Load4",                                    1,          { NONE,                                         },},
-    {   "Load5",                                    1,          { NONE,                                         },},
-    {   "Load6",                                    1,          { NONE,                                         },},
-    {   "Load7",                                    1,          { NONE,                                         },},
-    {   "Load8",                                    1,          { NONE,                                         },},
-    {   "Load9",                                    1,          { NONE,                                         },},
-    {   "LoadDouble",                               1,          { DOUBLE,                                       },},
-    {   "LoadFalse",                                1,          { NONE,                                         },},
-    {   "LoadGlobal",                               1,          { NONE,                                         },},
-    {   "LoadInt.16",                               1,          { SHORT,                                        },},
-    {   "LoadInt.32",                               1,          { WORD,                                         },},
-    {   "LoadInt.64",                               1,          { LONG,                                         },},
-    {   "LoadInt.8",                                1,          { BYTE,                                         },},
-    {   "LoadM1",                                   1,          { NONE,                                         },},
-    {   "LoadName",                                 1,          { STRING, STRING,                               },},
-    {   "LoadNamespace",                            1,          { STRING,                                       },},
-    {   "LoadNull",                                 1,          { NONE,                                         },},
-    {   "LoadRegexp",                               1,          { STRING,                                       },},
-    {   "LoadString",                               1,          { STRING,                                       },},
-    {   "LoadThis",                                 1,          { NONE,                                         },},
-    {   "LoadTrue",                                 1,          { NONE,                                         },},
-    {   "LoadUndefined",                            1,          { NONE,                                         },},
-    {   "LoadXML",                                  1,          { STRING,                                       },},
-    {   "GetLocalSlot_0",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_1",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_2",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_3",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_4",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_5",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_6",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_7",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_8",                           1,          { NONE,                                         },},
-    {   "GetLocalSlot_9",                           1,          { NONE,                                         },},
-    {   "GetObjSlot_0",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_1",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_2",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_3",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_4",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_5",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_6",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_7",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_8",                             1,          { NONE,                                         },},
-    {   "GetObjSlot_9",                             1,          { NONE,                                         },},
-    {   "GetThisSlot_0",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_1",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_2",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_3",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_4",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_5",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_6",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_7",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_8",                            1,          { NONE,                                         },},
-    {   "GetThisSlot_9",                            1,          { NONE,                                         },},
-    {   "GetScopedName",                            1,          { STRING, STRING,                               },},
-    {   "GetObjName",                               0,          { STRING, STRING,                               },},
-    {   "GetObjNameExpr",                           -1,         { NONE,                                         },},
-    {   "GetBlockSlot",                             1,          { SLOT, NUM,                                    },},
-    {   "GetGlobalSlot",                            1,          { BYTE,                                         },},
-    {   "GetLocalSlot",                             1,          { SLOT,                                         },},
-    {   "GetObjSlot",                               0,          { SLOT,                                         },},
-    {   "GetThisSlot",                              1,          { SLOT,                                         },},
-    {   "GetTypeSlot",                              0,          { SLOT, NUM,                                    },},
-    {   "GetThisTypeSlot",                          1,          { SLOT, NUM,                                    },},
-    {   "In",                                       -1,         { NONE,                                         },},
-    {   "Like",                                     -1,         { NONE,                                         },},
-    {   "LogicalNot",                               0,          { NONE,                                         },},
-    {   "Mul",                                      -1,         { NONE,                                         },},
-    {   "Neg",                                      0,          { NONE,                                         },},
-    {   "New",                                      0,          { NONE,                                         },},
-    {   "NewArray",                                 1,          { GLOBAL, ARGC2,                                },},
-    {   "NewObject",                                1,          { GLOBAL, ARGC2,                                },},
-    {   "Nop",                                      0,          { NONE,                                         },},
-    {   "Not",                                      0,          { NONE,                                         },},
-    {   "OpenBlock",                                0,          { SLOT, NUM,                                    },},
-    {   "OpenWith",                                 1,          { NONE,                                         },},
-    {   "Or",                                       -1,         { NONE,                                         },},
-    {   "Pop",                                      -1,         { NONE,                                         },},
-    {   "PopItems",                                 POP1,       { BYTE,                                         },},
-    {   "PushCatchArg",                             1,          { NONE,                                         },},
-    {   "PushResult",                               1,          { NONE,                                         },},
-    {   "PutLocalSlot_0",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_1",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_2",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_3",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_4",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_5",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_6",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_7",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_8",                           -1,         { NONE,                                         },},
-    {   "PutLocalSlot_9",                           -1,         { NONE,                                         },},
-    {   "PutObjSlot_0",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_1",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_2",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_3",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_4",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_5",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_6",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_7",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_8",                             -2,         { NONE,                                         },},
-    {   "PutObjSlot_9",                             -2,         { NONE,                                         },},
-    {   "PutThisSlot_0",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_1",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_2",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_3",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_4",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_5",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_6",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_7",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_8",                            -1,         { NONE,                                         },},
-    {   "PutThisSlot_9",                            -1,         { NONE,                                         },},
-    {   "PutObjNameExpr",                           -3,         { NONE,                                         },},
-    {   "PutScopedNameExpr",                        -2,         { NONE,                                         },},
-    {   "PutObjName",                               -2,         { STRING, STRING,                               },},
-    {   "PutScopedName",                            -1,         { STRING, STRING,                               },},
-    {   "PutBlockSlot",                             -1,         { SLOT, NUM,                                    },},
-    {   "PutGlobalSlot",                            -1,         { BYTE,                                         },},
-    {   "PutLocalSlot",                             -1,         { SLOT,                                         },},
-    {   "PutObjSlot",                               -2,         { SLOT,                                         },},
-    {   "PutThisSlot",                              -1,         { SLOT,                                         },},
-    {   "PutTypeSlot",                              -2,         { SLOT, NUM,                                    },},
-    {   "PutThisTypeSlot",                          -1,         { SLOT, NUM,                                    },},
-    {   "Rem",                                      -1,         { NONE,                                         },},
-    {   "Return",                                   0,          { NONE,                                         },},
-    {   "ReturnValue",                              -1,         { NONE,                                         },},
-    {   "SaveResult",                               -1,         { NONE,                                         },},
-    {   "Shl",                                      -1,         { NONE,                                         },},
-    {   "Shr",                                      -1,         { NONE,                                         },},
-    {   "Sub",                                      -1,         { NONE,                                         },},
-    {   "Super",                                    0,          { NONE,                                         },},
-    {   "Swap",                                     0,          { NONE,                                         },},
-    {   "Throw",                                    0,          { NONE,                                         },},
-    {   "Ushr",                                     -1,         { NONE,                                         },},
-    {   "Xor",                                      -1,         { NONE,                                         },},
-    { 0,                                            0,          { NONE,                                         },},
-};
-
-
 static cchar *getBlockName(EjsMod *mp, EjsVar *block);
 static uchar getByte(EjsMod *mp);
 static ushort getShort(EjsMod *mp);
@@ -26372,7 +26123,7 @@ static void lstModule(EjsMod *mp, EjsModule *module)
 }
 
 
-static int decodeOperands(EjsMod *mp, Optable *opt, char *argbuf, int argbufLen, int address, int *stackEffect)
+static int decodeOperands(EjsMod *mp, EjsOptable *opt, char *argbuf, int argbufLen, int address, int *stackEffect)
 {
     int         *argp;
     char        *sval, *bufp;
@@ -26399,63 +26150,63 @@ static int decodeOperands(EjsMod *mp, Optable *opt, char *argbuf, int argbufLen,
 
     for (i = 0, argp = opt->args; i < argc; i++) {
         switch (opt->args[i]) {
-        case NONE:
+        case EJS_OPT_NONE:
             break;
 
-        case BYTE:
+        case EJS_OPT_BYTE:
             ival = getByte(mp);
             mprSprintf(bufp, buflen,  "<%d> ", ival);
             break;
 
-        case SHORT:
+        case EJS_OPT_SHORT:
             ival = getShort(mp);
             mprSprintf(bufp, buflen,  "<%d> ", ival);
             break;
 
-        case WORD:
+        case EJS_OPT_WORD:
             ival = getWord(mp);
             mprSprintf(bufp, buflen,  "<%d> ", ival);
             break;
 
-        case LONG:
+        case EJS_OPT_LONG:
             lval = getLong(mp);
             mprSprintf(bufp, buflen,  "<%Ld> ", lval);
             break;
 
 #if BLD_FEATURE_FLOATING_POINT
-        case DOUBLE:
+        case EJS_OPT_DOUBLE:
             dval = getDouble(mp);
             mprSprintf(bufp, buflen,  "<%f> ", dval);
             break;
 #endif
 
-        case ARGC:
-        case ARGC2:
+        case EJS_OPT_ARGC:
+        case EJS_OPT_ARGC2:
             ival = getNum(mp);
             mprSprintf(bufp, buflen,  "<argc: %d> ", ival);
             break;
 
-        case SLOT:
+        case EJS_OPT_SLOT:
             ival = getNum(mp);
             mprSprintf(bufp, buflen,  "<slot: %d> ", ival);
             break;
 
-        case NUM:
+        case EJS_OPT_NUM:
             ival = getNum(mp);
             mprSprintf(bufp, buflen,  "<%d> ", ival);
             break;
 
-        case JMP8:
+        case EJS_OPT_JMP8:
             ival = getByte(mp);
-            mprSprintf(bufp, buflen,  "<addr: %d> ", ((char) ival) + address + 1);
+            mprSprintf(bufp, buflen,  "<addr: %d> ", ((char) ival) + address + (int) (mp->pc - start));
             break;
 
-        case JMP:
+        case EJS_OPT_JMP:
             ival = getWord(mp);
-            mprSprintf(bufp, buflen,  "<addr: %d> ", ival + address + 4);
+            mprSprintf(bufp, buflen,  "<addr: %d> ", ival + address + (int) (mp->pc - start));
             break;
 
-        case INIT_DEFAULT8:
+        case EJS_OPT_INIT_DEFAULT8:
             numEntries = getByte(mp);
             len = mprSprintf(bufp, buflen,  "<%d> ", numEntries);
             bufp += len;
@@ -26468,7 +26219,7 @@ static int decodeOperands(EjsMod *mp, Optable *opt, char *argbuf, int argbufLen,
             }
             break;
 
-        case INIT_DEFAULT:
+        case EJS_OPT_INIT_DEFAULT:
             numEntries = getByte(mp);
             len = mprSprintf(bufp, buflen,  "<%d> ", numEntries);
             bufp += len;
@@ -26481,15 +26232,15 @@ static int decodeOperands(EjsMod *mp, Optable *opt, char *argbuf, int argbufLen,
             }
             break;
 
-        case STRING:
+        case EJS_OPT_STRING:
             sval = getString(mp);
             mprSprintf(bufp, buflen,  "<%s> ", sval);
             break;
 
-        case VARCOUNT:
+        case EJS_OPT_VARCOUNT:
             break;
 
-        case GLOBAL:
+        case EJS_OPT_GLOBAL:
             getGlobal(mp, bufp, buflen);
             break;
 
@@ -26501,12 +26252,12 @@ static int decodeOperands(EjsMod *mp, Optable *opt, char *argbuf, int argbufLen,
         bufp += len;
         buflen -= len;
 
-        if (opt->args[i] == ARGC) {
+        if (opt->args[i] == EJS_OPT_ARGC) {
             *stackEffect -= ival;
-        } else if (opt->args[i] == ARGC2) {
+        } else if (opt->args[i] == EJS_OPT_ARGC2) {
             *stackEffect -= (ival * 2);
         }
-        if (i == 0 && opt->stackEffect == POP1) {
+        if (i == 0 && opt->stackEffect == EJS_STACK_POP1) {
             *stackEffect = -ival;
         }
     }
@@ -26519,17 +26270,20 @@ static int decodeOperands(EjsMod *mp, Optable *opt, char *argbuf, int argbufLen,
  */
 static void interp(EjsMod *mp, EjsModule *module, EjsFunction *fun)
 {
-    Optable     *opt;
+    EjsOptable  *optable, *opt;
     EjsCode     *code;
     uchar       *start;
     char        *currentLine, *currentFile;
     char        argbuf[MPR_MAX_STRING], lineInfo[MPR_MAX_STRING];
-    int         opcode, lineNumber, stack, codeLen, address, stackEffect, nbytes, i, lastDebug;
+    int         opcode, lineNumber, stack, codeLen, address, stackEffect, nbytes, i, lastDebug, numOpcodes;
 
     mprAssert(mp);
     mprAssert(module);
     mprAssert(fun);
 
+    optable = ejsGetOptable();
+    for (numOpcodes = 0; optable[numOpcodes].name; numOpcodes++) ;
+
     /*
      *  Store so that getNum and getString can easily read instructions
      */
@@ -26551,7 +26305,7 @@ static void interp(EjsMod *mp, EjsModule *module, EjsFunction *fun)
         argbuf[0] = '\0';
         stackEffect = 0;
 
-        if (opcode < 0 || opcode > (sizeof(optable) / sizeof(Optable))) {
+        if (opcode < 0 || opcode >= numOpcodes) {
             mprError(mp, "Bad opcode %x at address %d.\n", opcode, address);
             return;
         }
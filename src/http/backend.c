@@ -0,0 +1,234 @@
+/*
+ *  backend.c -- Support for handlers that forward requests to backend servers over pooled connections.
+ *
+ *  Backend connections have their own I/O events which run outside the client connection's I/O events. The routines
+ *  here serialize them with the client connection and keep backend connections alive while they are in use.
+ *
+ *  Copyright (c) All Rights Reserved. See copyright notice at the bottom of the file.
+ */
+
+/********************************* Includes ***********************************/
+
+#include    "http.h"
+
+/***************************** Forward Declarations ***************************/
+
+static void poolEvent(MaPoolEvent *pe, MprEvent *event);
+
+/*********************************** Code *************************************/
+
+void maInitBackendPool(MaBackendPool *pool)
+{
+    pool->waiting = mprCreateList(pool);
+#if BLD_FEATURE_MULTITHREAD
+    pool->mutex = mprCreateLock(pool);
+#endif
+}
+
+
+void maLockBackendPool(MaBackendPool *pool)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(pool->mutex);
+#endif
+}
+
+
+void maUnlockBackendPool(MaBackendPool *pool)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(pool->mutex);
+#endif
+}
+
+
+void maHoldBackend(MaBackend *backend)
+{
+    maLockBackendPool(backend->pool);
+    backend->busy++;
+    maUnlockBackendPool(backend->pool);
+}
+
+
+bool maReleaseBackend(MaBackend *backend)
+{
+    MaBackendPool   *pool;
+    bool            open;
+
+    pool = backend->pool;
+    maLockBackendPool(pool);
+    open = (backend->handler != 0);
+    if (--backend->busy == 0 && !open) {
+        /*
+         *  The backend is the first member of the connection structure
+         */
+        mprFree(backend);
+    }
+    maUnlockBackendPool(pool);
+    return open;
+}
+
+
+MaConn *maLockBackendConn(MaBackend *backend)
+{
+    MaBackendPool   *pool;
+    MaConn          *conn;
+
+    pool = backend->pool;
+    maLockBackendPool(pool);
+    backend->busy++;
+    while ((conn = backend->conn) != 0) {
+        maHoldConn(conn);
+        maUnlockBackendPool(pool);
+        maLockConn(conn);
+        maLockBackendPool(pool);
+        if (backend->conn == conn) {
+            break;
+        }
+        /*
+         *  The request was unbound while waiting. The backend may now be servicing another request.
+         */
+        maUnlockBackendPool(pool);
+        maUnlockConn(conn);
+        maReleaseConn(conn);
+        maLockBackendPool(pool);
+    }
+    maUnlockBackendPool(pool);
+    return conn;
+}
+
+
+bool maUnlockBackendConn(MaBackend *backend, MaConn *conn)
+{
+    if (conn) {
+        maUnlockConn(conn);
+        maReleaseConn(conn);
+    }
+#if BLD_FEATURE_MULTITHREAD
+    maLockBackendPool(backend->pool);
+    if (backend->handler) {
+        mprEnableWaitEvents(backend->handler, 1);
+    }
+    maUnlockBackendPool(backend->pool);
+#endif
+    return maReleaseBackend(backend);
+}
+
+
+int maWriteBackendData(MaQueue *q, cchar *buf, int len)
+{
+    MaConn      *conn;
+    int         servicedQueues, rc, written;
+
+    conn = q->conn;
+
+    for (servicedQueues = written = 0; written < len; ) {
+        if (conn->requestFailed) {
+            return len;
+        }
+        rc = maWriteBlock(q, &buf[written], len - written, 0);
+        if (rc > 0) {
+            written += rc;
+        } else if (servicedQueues) {
+            break;
+        } else {
+            maServiceQueues(conn);
+            servicedQueues++;
+        }
+    }
+    maEnableBackendWrites(conn);
+    return written;
+}
+
+
+void maEnableBackendWrites(MaConn *conn)
+{
+    if (conn->response && conn->response->queue[MA_QUEUE_SEND].prevQ->count > 0 &&
+            !(conn->socketEventMask & MPR_WRITEABLE)) {
+        conn->socketEventMask |= MPR_WRITEABLE;
+        mprSetSocketEventMask(conn->sock, conn->socketEventMask);
+    }
+}
+
+
+MaPoolEvent *maCreatePoolEvent(MaBackendPool *pool, MaConn *conn, MaConnEventProc proc, void *data)
+{
+    MaPoolEvent     *pe;
+
+    if ((pe = mprAllocObjZeroed(pool, MaPoolEvent)) == 0) {
+        return 0;
+    }
+    pe->pool = pool;
+    pe->conn = conn;
+    pe->proc = proc;
+    pe->data = data;
+    maHoldConn(conn);
+    if (mprCreateEvent(pe, (MprEventProc) poolEvent, 0, MPR_NORMAL_PRIORITY, pe, 0) == 0) {
+        mprFree(pe);
+        maReleaseConn(conn);
+        return 0;
+    }
+    return pe;
+}
+
+
+void maCancelPoolEvent(MaPoolEvent *pe)
+{
+    if (pe) {
+        pe->proc = 0;
+    }
+}
+
+
+/*
+ *  Cancellation is done with the client connection locked, so the callback is tested once it is locked. The event is
+ *  owned by the pool, so it is freed under the pool lock.
+ */
+static void poolEvent(MaPoolEvent *pe, MprEvent *event)
+{
+    MaBackendPool   *pool;
+    MaConn          *conn;
+
+    pool = pe->pool;
+    conn = pe->conn;
+
+    maLockConn(conn);
+    if (pe->proc && !(conn->flags & MA_CONN_DESTROYED)) {
+        (pe->proc)(conn, pe->data);
+    }
+    maLockBackendPool(pool);
+    mprFree(pe);
+    maUnlockBackendPool(pool);
+    maUnlockConn(conn);
+    maReleaseConn(conn);
+}
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -828,6 +828,16 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
         break;
 
     case 'H':
+        if (mprStrcmpAnyCase(key, "HandshakeThreads") == 0) {
+#if BLD_FEATURE_MULTITHREAD
+            num = atoi(value);
+            if (num < 0 || num > MA_TOP_THREADS) {
+                return MPR_ERR_BAD_SYNTAX;
+            }
+            limits->maxHandshakeThreads = num;
+#endif
+            return 1;
+        }
         break;
 
     case 'K':
@@ -860,6 +870,14 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
             mprSetMaxSocketClients(server, atoi(value));
             return 1;
 
+        } else if (mprStrcmpAnyCase(key, "LimitHandshakeQueue") == 0) {
+            num = atoi(value);
+            if (num < 1 || num > MA_TOP_HANDSHAKE_QUEUE) {
+                return MPR_ERR_BAD_SYNTAX;
+            }
+            limits->maxHandshakeQueue = num;
+            return 1;
+
         } else if (mprStrcmpAnyCase(key, "LimitRequestBody") == 0) {
             num = atoi(value);
             if (num < MA_BOT_BODY || num > MA_TOP_BODY) {
@@ -910,7 +928,7 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
 
         } else if (mprStrcmpAnyCase(key, "LimitUploadSize") == 0) {
             num = atoi(value);
-            if (num != -1 && (num < MA_BOT_UPLOAD_SIZE || num > MA_TOP_URL)){
+            if (num != -1 && (num < MA_BOT_UPLOAD_SIZE || num > MA_TOP_UPLOAD_SIZE)) {
                 return MPR_ERR_BAD_SYNTAX;
             }
             limits->maxUploadSize = num;
@@ -1228,6 +1246,15 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
             limits->minThreads = num;
 #endif
             return 1;
+
+        } else if (mprStrcmpAnyCase(key, "StreamInput") == 0) {
+            /* Scope: server, host, location */
+            if (mprStrcmpAnyCase(value, "on") == 0) {
+                location->flags |= MA_LOC_STREAM_INPUT;
+            } else {
+                location->flags &= ~MA_LOC_STREAM_INPUT;
+            }
+            return 1;
         }
         break;
 
@@ -1558,6 +1585,11 @@ static bool featureSupported(MprCtx ctx, char *key)
         return BLD_FEATURE_EJS;
 #endif
 
+#ifdef BLD_FEATURE_FASTCGI
+    } else if (mprStrcmpAnyCase(key, "FASTCGI_MODULE") == 0) {
+        return BLD_FEATURE_FASTCGI;
+#endif
+
 #ifdef BLD_FEATURE_FILE
     } else if (mprStrcmpAnyCase(key, "FILE_MODULE") == 0) {
         return BLD_FEATURE_FILE;
@@ -1583,6 +1615,11 @@ static bool featureSupported(MprCtx ctx, char *key)
         return BLD_FEATURE_PHP;
 #endif
 
+#ifdef BLD_FEATURE_PROXY
+    } else if (mprStrcmpAnyCase(key, "PROXY_MODULE") == 0) {
+        return BLD_FEATURE_PROXY;
+#endif
+
 #ifdef BLD_FEATURE_RANGE
     } else if (mprStrcmpAnyCase(key, "RANGE_MODULE") == 0) {
         return BLD_FEATURE_RANGE;
@@ -10,12 +10,15 @@
 
 /***************************** Forward Declarations ***************************/
 
+static void connEvent(MaConnEvent *ce, MprEvent *event);
 static int  connectionDestructor(MaConn *conn);
 static inline MaPacket *getPacket(MaConn *conn);
+static void lockHolds(MaHttp *http);
 static void readEvent(MaConn *conn);
 static void ioEvent(MaConn *conn, MprSocket *sock, int mask, bool isPoolThread);
-static void setupConnIO(MaConn *conn);
+static bool setupConnIO(MaConn *conn);
 static void setupHandler(MaConn *conn);
+static void unlockHolds(MaHttp *http);
 
 /*********************************** Code *************************************/
 /*
@@ -49,6 +52,9 @@ static MaConn *createConn(MprCtx ctx, MaHost *host, MprSocket *sock, cchar *ipAd
     conn->originalHost = host;
     conn->input = 0;
     conn->expire = 1;
+#if BLD_FEATURE_MULTITHREAD
+    conn->mutex = mprCreateLock(conn);
+#endif
 
     maInitSchedulerQueue(&conn->serviceq);
 
@@ -84,6 +90,142 @@ void maCloseConn(MaConn *conn)
 }
 
 
+/*
+ *  Close and free a connection. Called with the connection locked and returns with it unlocked. The request stages are
+ *  closed first so handlers revoke any references to the connection that they have handed to other threads. If the 
+ *  connection is still held, it is freed when the last hold is released.
+ */
+void maDestroyConn(MaConn *conn)
+{
+    MaHttp      *http;
+
+    maCloseStage(conn);
+
+    http = conn->http;
+    lockHolds(http);
+    conn->flags |= MA_CONN_DESTROYED;
+    if (conn->holds > 0) {
+        unlockHolds(http);
+        conn->socketEventMask = 0;
+        mprSetSocketEventMask(conn->sock, 0);
+        maUnlockConn(conn);
+        return;
+    }
+    unlockHolds(http);
+    maUnlockConn(conn);
+
+    /*
+     *  This will close the connection and free all connection resources
+     */
+    mprFree(conn->arena);
+}
+
+
+void maLockConn(MaConn *conn)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(conn->mutex);
+#endif
+}
+
+
+void maUnlockConn(MaConn *conn)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(conn->mutex);
+#endif
+}
+
+
+void maHoldConn(MaConn *conn)
+{
+    lockHolds(conn->http);
+    conn->holds++;
+    unlockHolds(conn->http);
+}
+
+
+void maReleaseConn(MaConn *conn)
+{
+    bool    destroy;
+
+    lockHolds(conn->http);
+    mprAssert(conn->holds > 0);
+    destroy = (--conn->holds == 0 && conn->flags & MA_CONN_DESTROYED);
+    unlockHolds(conn->http);
+
+    if (destroy) {
+        mprFree(conn->arena);
+    }
+}
+
+
+/*
+ *  Create an event to run a callback with the connection locked. The event is owned by the connection rather than the
+ *  request so it survives the request. The callback is skipped if it has been cancelled.
+ */
+MaConnEvent *maCreateConnEvent(MaConn *conn, MaConnEventProc proc, int delay, void *data)
+{
+    MaConnEvent     *ce;
+
+    if ((ce = mprAllocObjZeroed(conn, MaConnEvent)) == 0) {
+        return 0;
+    }
+    ce->conn = conn;
+    ce->proc = proc;
+    ce->data = data;
+    maHoldConn(conn);
+    if (mprCreateEvent(ce, (MprEventProc) connEvent, delay, MPR_NORMAL_PRIORITY, ce, 0) == 0) {
+        mprFree(ce);
+        maReleaseConn(conn);
+        return 0;
+    }
+    return ce;
+}
+
+
+void maCancelConnEvent(MaConnEvent *ce)
+{
+    if (ce) {
+        ce->proc = 0;
+    }
+}
+
+
+static void connEvent(MaConnEvent *ce, MprEvent *event)
+{
+    MaConn      *conn;
+
+    conn = ce->conn;
+    maLockConn(conn);
+    if (ce->proc && !(conn->flags & MA_CONN_DESTROYED)) {
+        (ce->proc)(conn, ce->data);
+    }
+    mprFree(ce);
+    maUnlockConn(conn);
+    maReleaseConn(conn);
+}
+
+
+/*
+ *  Holds are counted under the http lock so they may be taken while handler locks are held
+ */
+static void lockHolds(MaHttp *http)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(http->mutex);
+#endif
+}
+
+
+static void unlockHolds(MaHttp *http)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(http->mutex);
+#endif
+}
+
+
 /*
  *  Reset a connection after completing a request. Connection may be kept-alive
  */
@@ -94,6 +236,7 @@ void maResetConn(MaConn *conn)
     conn->response = 0;
     conn->state =  MPR_HTTP_STATE_BEGIN;
     conn->flags &= ~MA_CONN_CLEAN_MASK;
+    conn->deadline = 0;
     conn->expire = conn->time + conn->host->keepAliveTimeout;
 }
 
@@ -154,6 +297,16 @@ void maAcceptConn(MaServer *server, MprSocket *sock, cchar *ip, int port)
         setupHandler(conn);
     }
 
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+    if (listenSock->sslSocket && conn->http->handshakeService) {
+        /*
+         *  Perform the handshake on the handshake pool rather than tying up this request thread
+         */
+        conn->expire = mprGetTime(conn) + host->timeout;
+        maLockConn(conn);
+        maQueueHandshake(conn);
+    } else
+#endif
     ioEvent(conn, sock, MPR_READABLE, 1);
 
     /* WARNING the connection object may be destroyed here */
@@ -169,24 +322,44 @@ void maAcceptConn(MaServer *server, MprSocket *sock, cchar *ip, int port)
 /*
  *  IO event handler. Called in response to accept and when single-threaded, I/O events. If multithreaded, this will be 
  *  run by a pool thread. NOTE: a request is not permanently assigned to a pool thread. Each io event may be serviced by a
- *  different pool thread.
+ *  different pool thread. The connection is locked while the event is processed.
  */
 static void ioEvent(MaConn *conn, MprSocket *sock, int mask, bool isPoolThread)
 {
+    maLockConn(conn);
+    if (conn->flags & MA_CONN_DESTROYED) {
+        maUnlockConn(conn);
+        return;
+    }
     conn->time = mprGetTime(conn);
 
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+    if (conn->flags & MA_CONN_HANDSHAKE) {
+        /*
+         *  Handshake I/O is ready. Return to the handshake pool to continue.
+         */
+        maQueueHandshake(conn);
+        return;
+    }
+#endif
+
     if (mask & MPR_WRITEABLE) {
         maProcessWriteEvent(conn);
     }
     if (mask & MPR_READABLE) {
         readEvent(conn);
     }
-    setupConnIO(conn);
+    if (!setupConnIO(conn)) {
+        maUnlockConn(conn);
+    }
 }
 
 
 static void setupHandler(MaConn *conn) 
 {
+    if (conn->flags & MA_CONN_DESTROYED) {
+        return;
+    }
     if (conn->sock->handler == 0) {
         mprSetSocketCallback(conn->sock, (MprSocketProc) ioEvent, conn, NULL, conn->socketEventMask, MPR_NORMAL_PRIORITY);
     } else {
@@ -196,9 +369,9 @@ static void setupHandler(MaConn *conn)
 
 
 /*
- *  Control the connection's I/O events
+ *  Control the connection's I/O events. Returns true if the connection has been destroyed and unlocked.
  */
-static void setupConnIO(MaConn *conn)
+static bool setupConnIO(MaConn *conn)
 {
     conn->socketEventMask = 0;
     
@@ -209,21 +382,31 @@ static void setupConnIO(MaConn *conn)
              */
             conn->socketEventMask |= MPR_WRITEABLE;
         }
-        if (conn->state <= MPR_HTTP_STATE_CHUNK) {
+        if (conn->state <= MPR_HTTP_STATE_CHUNK && !(conn->flags & MA_CONN_READ_BLOCKED)) {
             conn->socketEventMask |= MPR_READABLE;
             
         } else if (MPR_HTTP_STATE_COMPLETE == conn->state) {
             maProcessReadEvent(conn, 0);
+            if (conn->abandonConnection) {
+                /*
+                 *  The request was rejected. Close without reading the rest of the request.
+                 */
+                maDestroyConn(conn);
+                return 1;
+
+            } else if (conn->request == 0 && conn->keepAliveCount < 0) {
+                /*
+                 *  The response finished from a write event and the connection is not being kept alive
+                 */
+                maDestroyConn(conn);
+                return 1;
+            }
         }
 
     } else {
-        if (mprGetSocketEof(conn->sock) || conn->keepAliveCount < 0) {
-            /*
-             *  This will close the connection and free all connection resources
-             */
-            mprFree(conn->arena);
-            /* mprPrintAllocReport(mprGetMpr(0), "After closing connection"); */
-            return;
+        if (mprGetSocketEof(conn->sock) || conn->keepAliveCount < 0 || conn->abandonConnection) {
+            maDestroyConn(conn);
+            return 1;
 
         } else {
             conn->socketEventMask |= MPR_READABLE;
@@ -237,11 +420,37 @@ static void setupConnIO(MaConn *conn)
 
     //  TODO Locking??
     conn->expire = conn->time + conn->host->timeout;
+    if (conn->deadline && conn->deadline < conn->expire) {
+        conn->expire = conn->deadline;
+    }
+    return 0;
+}
+
+
+/*
+ *  Define the I/O events of interest for a connection and enable the I/O handler
+ */
+void maSetConnEvents(MaConn *conn, int mask)
+{
+    conn->socketEventMask = mask;
+    setupHandler(conn);
+}
+
+
+/*
+ *  Resume reading a streamed request body. Called when the handler has drained its receive queue.
+ */
+void maResumeReading(MaConn *conn)
+{
+    conn->flags &= ~MA_CONN_READ_BLOCKED;
+    if (conn->state <= MPR_HTTP_STATE_CHUNK) {
+        maSetConnEvents(conn, conn->socketEventMask | MPR_READABLE);
+    }
 }
 
 
 /*
- *  TODO MULTITHREAD - race. This is called from cgiCallback on another thread.
+ *  Re-enable I/O events for a connection. Callers on other threads must hold the connection lock.
  */
 void maAwakenConn(MaConn *conn)
 {
@@ -265,6 +474,17 @@ static void readEvent(MaConn *conn)
 
     while (1) {
 
+        if (conn->state == MPR_HTTP_STATE_CONTENT && conn->request->flags & MA_REQ_SPLICE_INPUT &&
+                (conn->input == 0 || mprGetBufLength(conn->input->content) == 0)) {
+            /*
+             *  The handler moves the body directly from the socket. Fall back to reading packets if splicing fails.
+             */
+            if ((nbytes = maSpliceContent(conn)) > 0) {
+                continue;
+            } else if (nbytes == 0) {
+                break;
+            }
+        }
         if ((packet = getPacket(conn)) == 0) {
             return;
         }
@@ -294,6 +514,12 @@ static void readEvent(MaConn *conn)
             mprAdjustBufEnd(content, nbytes);
             packet->count += nbytes;
             maProcessReadEvent(conn, packet);
+            if (conn->flags & MA_CONN_READ_BLOCKED) {
+                /*
+                 *  The handler can't accept more body data. maResumeReading will re-enable read events.
+                 */
+                break;
+            }
     
         } else {
             if (mprGetSocketEof(conn->sock) && 
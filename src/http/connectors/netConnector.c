@@ -32,6 +32,12 @@ static void netOutgoingService(MaQueue *q)
     while (q->first || q->ioIndex) {
 
         if (q->ioIndex == 0 && buildNetVec(q) <= 0) {
+            if (q->flags & MA_QUEUE_EOF) {
+                /*
+                 *  Only the end packet remains. This happens when the handler has written the body directly (splice).
+                 */
+                maCompleteRequest(conn);
+            }
             break;
         }
 
@@ -279,7 +285,7 @@ static void adjustNetVec(MaQueue *q, int written)
         /*
          *  Compact
          */
-        for (j = 0; i < q->ioIndex; j++) {
+        for (j = 0; i < q->ioIndex; ) {
             iovec[j++] = iovec[i++];
         }
         q->ioIndex = j;
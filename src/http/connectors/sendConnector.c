@@ -346,7 +346,7 @@ static void adjustSendVec(MaQueue *q, int written)
         /*
          *  Compact
          */
-        for (j = 0; i < q->ioIndex; j++) {
+        for (j = 0; i < q->ioIndex; ) {
             iovec[j++] = iovec[i++];
         }
         q->ioIndex = j;
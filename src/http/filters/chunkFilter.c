@@ -9,9 +9,34 @@
 #include    "http.h"
 
 #if BLD_FEATURE_CHUNK
+/********************************** Defines ***********************************/
+
+#define CHUNK_PREFIX_POOL   24              /* Preformatted prefixes for power of two chunk sizes */
+#define CHUNK_PREFIX_MAX    16              /* Max prefix: "\r\n" + 8 hex digits + "\r\n" + null */
+
+/*
+ *  Preformatted chunk prefix
+ */
+typedef struct ChunkPrefix {
+    int             len;                    /* Length of text */
+    char            text[CHUNK_PREFIX_MAX]; /* Formatted prefix */
+} ChunkPrefix;
+
+/*
+ *  Filter configuration
+ */
+typedef struct Chunk {
+    int             flushPeriod;            /* Max msec to hold a partial chunk while coalescing. Zero to not coalesce */
+    ChunkPrefix     last;                   /* Prefix for the final zero length chunk */
+    ChunkPrefix     pool[CHUNK_PREFIX_POOL];/* Prefixes for chunks of size 2^index */
+} Chunk;
+
 /********************************** Forwards **********************************/
 
-static void setChunkPrefix(MaQueue *q, MaPacket *packet);
+static bool coalesce(MaQueue *q, MaPacket *packet, Chunk *chunk);
+static int  formatPrefix(char *buf, int size);
+static void setChunkPrefix(MaQueue *q, MaPacket *packet, Chunk *chunk);
+static void startFlushTimer(MaQueue *q, Chunk *chunk);
 
 /*********************************** Code *************************************/
 
@@ -31,17 +56,29 @@ static void openChunk(MaQueue *q)
 }
 
 
+static void closeChunk(MaQueue *q)
+{
+    if (q->queueData) {
+        maCancelConnEvent(q->queueData);
+        q->queueData = 0;
+    }
+}
+
+
 /*
- *  Apply chunks to dynamic outgoing data. 
+ *  Apply chunks to dynamic outgoing data. Small packets are coalesced up to the chunk size. A partial chunk is held
+ *  for at most flushPeriod msec unless the queue is flushed or the end of data is seen.
  */
 static void outgoingChunkService(MaQueue *q)
 {
     MaConn      *conn;
     MaPacket    *packet;
     MaResponse  *resp;
+    Chunk       *chunk;
 
     conn = q->conn;
     resp = conn->response;
+    chunk = q->stage->stageData;
 
     if (!(q->flags & MA_QUEUE_SERVICED)) {
         /*
@@ -56,7 +93,7 @@ static void outgoingChunkService(MaQueue *q)
                 resp->length = q->count;
             }
 
-        } else {
+        } else if (resp->length < 0) {
             resp->chunkSize = min(conn->http->limits.maxChunkSize, q->max);
         }
     }
@@ -69,35 +106,190 @@ static void outgoingChunkService(MaQueue *q)
             if (!(packet->flags & MA_PACKET_HEADER)) {
                 if (packet->count > resp->chunkSize) {
                     maResizePacket(q, packet, resp->chunkSize);
+
+                } else if (packet->count > 0 && !coalesce(q, packet, chunk)) {
+                    /*
+                     *  Hold the partial chunk until more data arrives or the flush timer fires
+                     */
+                    maPutBack(q, packet);
+                    startFlushTimer(q, chunk);
+                    return;
                 }
-                setChunkPrefix(q, packet);
             }
             if (!maWillNextQueueAccept(q, packet)) {
                 maPutBack(q, packet);
                 return;
             }
+            if (!(packet->flags & MA_PACKET_HEADER)) {
+                /*
+                 *  Set the prefix only once the packet is accepted. A packet that is put back may be coalesced later.
+                 */
+                setChunkPrefix(q, packet, chunk);
+            }
             maPutNext(q, packet);
         }
+        q->flags &= ~MA_QUEUE_FLUSH;
     }
 }
 
 
-static void setChunkPrefix(MaQueue *q, MaPacket *packet)
+/*
+ *  Join following data packets into this packet up to the chunk size. Return false if the packet is a partial chunk
+ *  that should be held for more data.
+ */
+static bool coalesce(MaQueue *q, MaPacket *packet, Chunk *chunk)
 {
-    MaConn      *conn;
+    MaResponse  *resp;
+    MaPacket    *next;
 
-    conn = q->conn;
+    resp = q->conn->response;
+
+    while ((next = q->first) != 0 && next->flags & MA_PACKET_DATA && next->content && 
+            (packet->count + next->count) <= resp->chunkSize) {
+        if (maJoinPacket(packet, next) < 0) {
+            return 1;
+        }
+        mprFree(maGet(q));
+    }
+    if (packet->count >= resp->chunkSize || q->first || chunk->flushPeriod <= 0 || q->flags & MA_QUEUE_FLUSH) {
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ *  Flush a held partial chunk. Runs as a connection event so the connection is locked.
+ */
+static void flushTimer(MaConn *conn, MaQueue *q)
+{
+    q->queueData = 0;
+    if (conn->requestFailed || q->first == 0) {
+        return;
+    }
+    q->flags |= MA_QUEUE_FLUSH;
+    if (!(q->flags & MA_QUEUE_DISABLED)) {
+        maScheduleQueue(q);
+    }
+    maServiceQueues(conn);
+
+    if (conn->state == MPR_HTTP_STATE_COMPLETE) {
+        /*
+         *  Flushing released the end of the response and the connector wrote it all. Cycle through the last stage of
+         *  the request pipeline to complete the request. WARNING - the request and this queue are deleted after this.
+         */
+        maProcessReadEvent(conn, 0);
+        maAwakenConn(conn);
+
+    } else if (conn->response->queue[MA_QUEUE_SEND].prevQ->count > 0) {
+        /*
+         *  Connector could not write it all. Listen for writable events so it can drain.
+         */
+        conn->socketEventMask |= MPR_WRITEABLE;
+        mprSetSocketEventMask(conn->sock, conn->socketEventMask);
+    }
+}
+
+
+static void startFlushTimer(MaQueue *q, Chunk *chunk)
+{
+    if (q->queueData == 0) {
+        q->queueData = maCreateConnEvent(q->conn, (MaConnEventProc) flushTimer, chunk->flushPeriod, q);
+    }
+}
+
+
+/*
+ *  Set the chunk prefix. Common sizes (powers of two and the final chunk) use a preformatted prefix from the pool which
+ *  is referenced rather than copied. Other sizes are formatted into a small buffer owned by the packet.
+ */
+static void setChunkPrefix(MaQueue *q, MaPacket *packet, Chunk *chunk)
+{
+    ChunkPrefix     *cp;
+    MprBuf          *buf;
+    int             index;
 
     if (packet->prefix) {
         return;
     }
-    packet->prefix = mprCreateBuf(packet, 32, 32);
-    if (packet->count) {
-        mprPutFmtToBuf(packet->prefix, "\r\n%x\r\n", packet->count);
+    cp = 0;
+    if (packet->count == 0) {
+        cp = &chunk->last;
+
+    } else if ((packet->count & (packet->count - 1)) == 0) {
+        for (index = 0; (1 << index) < packet->count; index++) ;
+        if (index < CHUNK_PREFIX_POOL) {
+            cp = &chunk->pool[index];
+        }
+    }
+
+    if (cp) {
+        if ((buf = mprAllocObjZeroed(packet, MprBuf)) == 0) {
+            return;
+        }
+        buf->data = buf->start = (uchar*) cp->text;
+        buf->end = buf->endbuf = (uchar*) &cp->text[cp->len];
+        buf->buflen = buf->maxsize = cp->len;
+
     } else {
-        mprPutStringToBuf(packet->prefix, "\r\n0\r\n\r\n");
+        if ((buf = mprCreateBuf(packet, CHUNK_PREFIX_MAX, CHUNK_PREFIX_MAX)) == 0) {
+            return;
+        }
+        mprAdjustBufEnd(buf, formatPrefix(mprGetBufEnd(buf), packet->count));
+    }
+    packet->prefix = buf;
+}
+
+
+/*
+ *  Format a chunk prefix of the form "\r\nHEX\r\n" without using printf. Return the length.
+ */
+static int formatPrefix(char *buf, int size)
+{
+    static cchar    hex[] = "0123456789abcdef";
+    char            digits[8], *cp;
+    int             count;
+
+    count = 0;
+    do {
+        digits[count++] = hex[size & 0xf];
+        size >>= 4;
+    } while (size > 0 && count < (int) sizeof(digits));
+
+    cp = buf;
+    *cp++ = '\r';
+    *cp++ = '\n';
+    while (count > 0) {
+        *cp++ = digits[--count];
+    }
+    *cp++ = '\r';
+    *cp++ = '\n';
+    *cp = '\0';
+    return (int) (cp - buf);
+}
+
+
+#if BLD_FEATURE_CONFIG_PARSE
+static int parseChunk(MaHttp *http, cchar *key, char *value, MaConfigState *state)
+{
+    Chunk       *chunk;
+    int         num;
+
+    chunk = maLookupStageData(http, "chunkFilter");
+    mprAssert(chunk);
+
+    if (mprStrcmpAnyCase(key, "ChunkFlushPeriod") == 0) {
+        /*  ChunkFlushPeriod msec. Zero disables coalescing */
+        num = atoi(value);
+        if (num < 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        chunk->flushPeriod = num;
+        return 1;
     }
+    return 0;
 }
+#endif
 
 
 /*
@@ -107,6 +299,9 @@ MprModule *maChunkFilterInit(MaHttp *http, cchar *path)
 {
     MprModule   *module;
     MaStage     *filter;
+    Chunk       *chunk;
+    ChunkPrefix *cp;
+    int         i;
 
     module = mprCreateModule(http, "chunkFilter", BLD_VERSION, NULL, NULL, NULL);
     if (module == 0) {
@@ -121,8 +316,23 @@ MprModule *maChunkFilterInit(MaHttp *http, cchar *path)
     http->chunkFilter = filter;
 
     filter->open = openChunk; 
+    filter->close = closeChunk; 
     filter->outgoingService = outgoingChunkService; 
+#if BLD_FEATURE_CONFIG_PARSE
+    filter->parse = parseChunk; 
+#endif
 
+    filter->stageData = chunk = mprAllocObjZeroed(filter, Chunk);
+    if (chunk == 0) {
+        mprFree(module);
+        return 0;
+    }
+    chunk->flushPeriod = MA_CHUNK_FLUSH_PERIOD;
+    chunk->last.len = mprSprintf(chunk->last.text, sizeof(chunk->last.text), "\r\n0\r\n\r\n");
+    for (i = 0; i < CHUNK_PREFIX_POOL; i++) {
+        cp = &chunk->pool[i];
+        cp->len = formatPrefix(cp->text, 1 << i);
+    }
     return module;
 }
 
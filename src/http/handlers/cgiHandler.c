@@ -12,15 +12,60 @@
 #include    "http.h"
 
 #if BLD_FEATURE_CGI
+/************************************ Locals **********************************/
+/*
+ *  Per-location spawn configuration
+ */
+typedef struct MaCgiConfig {
+    int             spawn;              /* Start scripts via posix_spawn using the cached script resolution */
+    int             warm;               /* Count of idle warm processes to keep per script */
+} MaCgiConfig;
+
+/*
+ *  Cached resolution of a CGI script. Entries are revalidated against the script modification time.
+ */
+typedef struct CgiScript {
+    struct Cgi      *cgi;               /* Owning handler */
+    char            *path;              /* Script filename */
+    char            *program;           /* Program to run. Either the script itself or its "#!" interpreter */
+    char            *interpArg;         /* Optional interpreter argument from the "#!" line */
+    MprTime         mtime;              /* Script modification time when resolved */
+    MprList         *idle;              /* Idle warm processes waiting for a request */
+    MprEvent        *refill;            /* Pending event to refill the warm pool */
+    int             warm;               /* Target count of idle warm processes */
+} CgiScript;
+
+typedef struct Cgi {
+    MaCgiConfig     *config;            /* Default configuration */
+    MprHashTable    *scripts;           /* Resolved scripts indexed by filename */
+    char            **staticEnv;        /* Environment strings common to all requests */
+    int             staticCount;        /* Count of staticEnv strings */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
+} Cgi;
+
 /*********************************** Forwards *********************************/
 
-static void buildArgs(MaConn *conn, MprCmd *cmd, int *argcp, char ***argvp);
+static void buildArgs(MaConn *conn, MprCmd *cmd, CgiScript *script, int *argcp, char ***argvp);
+static char **buildEnv(Cgi *cgi, MprCmd *cmd, MaRequest *req, int *countp);
+static bool canSplice(MaConn *conn, MprCmd *cmd);
 static void cgiCallback(MprCmd *cmd, int fd, int channel, void *data);
 static char *getCgiToken(MprBuf *buf, cchar *delim);
+static MaCgiConfig *getConfig(MaConn *conn);
+#if BLD_FEATURE_CONFIG_PARSE
+static MaCgiConfig *getLocationConfig(MaHttp *http, MaConfigState *state);
+#endif
+static CgiScript *getScript(Cgi *cgi, MaConn *conn, MaCgiConfig *config);
+static bool isNonParsedHeader(cchar *fileName);
+static void lock(Cgi *cgi);
 static bool parseFirstCgiResponse(MaConn *conn, MprCmd *cmd);
 static bool parseHeader(MaConn *conn, MprCmd *cmd);
 static void pushDataToCgi(MaQueue *q);
+static bool spliceToBrowser(MaConn *conn, MprCmd *cmd);
 static void startCmd(MaQueue *q);
+static MprCmd *startWarmRequest(MaQueue *q, CgiScript *script);
+static void unlock(Cgi *cgi);
 
 #if BLD_DEBUG
 static void traceCGIData(MprCmd *cmd, char *src, int size);
@@ -66,98 +111,400 @@ static void startCmd(MaQueue *q)
     MaResponse      *resp;
     MaConn          *conn;
     MprCmd          *cmd;
-    MprHashTable    *vars;
-    MprHash         *hp;
-    cchar           *baseName;
+    Cgi             *cgi;
+    MaCgiConfig     *config;
+    CgiScript       *script;
     char            **argv, **envv, *fileName, dir[MPR_MAX_FNAME];
-    int             index, argc, varCount;
+    int             argc, envc, flags;
 
     argv = 0;
-    vars = 0;
     argc = 0;
+    script = 0;
 
     conn = q->conn;
     req = conn->request;
     resp = conn->response;
+    cgi = (Cgi*) q->stage->stageData;
+    config = getConfig(conn);
 
+    if (config->spawn || config->warm > 0) {
+        /*
+         *  If the script can't be resolved, use the normal path which will report the error
+         */
+        script = getScript(cgi, conn, config);
+        if (script && script->warm > 0 && startWarmRequest(q, script) != 0) {
+            return;
+        }
+    }
     cmd = q->queueData = mprCreateCmd(req);
 
     /*
      *  Build the commmand line arguments
      */
     argc = 1;                                   /* argv[0] == programName */
-    buildArgs(conn, cmd, &argc, &argv);
-    fileName = argv[0];
+    buildArgs(conn, cmd, script, &argc, &argv);
+    fileName = (script) ? script->path : argv[0];
 
     mprGetDirName(dir, sizeof(dir), fileName);
-    baseName = mprGetBaseName(fileName);
-    if (strncmp(baseName, "nph-", 4) == 0 || 
-            (strlen(baseName) > 4 && strcmp(&baseName[strlen(baseName) - 4], "-nph") == 0)) {
+    if (isNonParsedHeader(fileName)) {
         /*
          *  Pretend we've seen the header for Non-parsed Header CGI programs
          */
         cmd->userFlags |= MA_CGI_SEEN_HEADER;
     }
+    envv = buildEnv(cgi, cmd, req, &envc);
 
-    //  TODO - refactor and move this into prepareArgs()
-    /*
-     *  Build environment variables. For unix, also export the PATH and LD_LIBRARY_PATH so add 2.
-     */
-    vars = req->headers;
-    varCount = mprGetHashCount(vars);
-#if BLD_HOST_UNIX
-    varCount += 2;
+#if BLD_DEBUG
+{
+    int     i;
+    mprLog(q, 4, "CGI: running program: %s: ", fileName);
+    for (i = 1; argv[i]; i++) {
+        mprRawLog(q, 4, "%s ", argv[i]);
+    }
+    mprRawLog(q, 4, "\n");
+    for (i = 0; i < envc; i++) {
+        mprLog(q, 4, "CGI ENV %s", envv[i]);
+    }
+}
 #endif
 
+    cmd->stdoutBuf = mprCreateBuf(cmd, MPR_BUFSIZE, -1);
+    cmd->stderrBuf = mprCreateBuf(cmd, MPR_BUFSIZE, -1);
+
+    mprSetCmdDir(cmd, dir);
+    mprSetCmdCallback(cmd, cgiCallback, conn);
+
+    flags = MPR_CMD_IN | MPR_CMD_OUT | MPR_CMD_ERR;
+    if (script) {
+        flags |= MPR_CMD_SPAWN;
+    }
+    if (mprStartCmd(cmd, argc, argv, envv, flags) < 0) {
+        maFailRequest(conn, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "Can't run CGI process: %s, URI %s", fileName, req->url);
+    }
+}
+
+
+static bool isNonParsedHeader(cchar *fileName)
+{
+    cchar   *baseName;
+    int     len;
+
+    baseName = mprGetBaseName(fileName);
+    len = (int) strlen(baseName);
+    return strncmp(baseName, "nph-", 4) == 0 || (len > 4 && strcmp(&baseName[len - 4], "-nph") == 0);
+}
+
+
+/*
+ *  Build environment variables from the request variables. The environment common to all requests is prebuilt when
+ *  the handler is loaded and shared. Return the count of variables in *countp.
+ */
+static char **buildEnv(Cgi *cgi, MprCmd *cmd, MaRequest *req, int *countp)
+{
+    MprHash     *hp;
+    char        **envv;
+    int         index, i;
+
     index = 0;
-    envv = (char**) mprAlloc(cmd, (varCount + 1) * sizeof(char*));
-    hp = mprGetFirstHash(req->headers);
-    while (hp) {
+    envv = (char**) mprAlloc(cmd, (mprGetHashCount(req->headers) + cgi->staticCount + 1) * sizeof(char*));
+    for (hp = mprGetFirstHash(req->headers); hp; hp = mprGetNextHash(req->headers, hp)) {
         if (hp->data) {
             mprAllocSprintf(cmd, &envv[index], MPR_MAX_FNAME, "%s=%s", hp->key, (char*) hp->data);
             index++;
         }
-        hp = mprGetNextHash(req->headers, hp);
     }
+    for (i = 0; i < cgi->staticCount; i++) {
+        envv[index++] = cgi->staticEnv[i];
+    }
+    envv[index] = 0;
+    *countp = index;
+    return envv;
+}
 
-#if BLD_HOST_UNIX
-    {
-        char    *cp;
-        if ((cp = getenv("PATH")) != 0) {
-            mprAllocSprintf(cmd, &envv[index++], MPR_MAX_STRING, "PATH=%s", cp);
-        }
-        if ((cp = getenv("LD_LIBRARY_PATH")) != 0) {
-            mprAllocSprintf(cmd, &envv[index++], MPR_MAX_STRING, "LD_LIBRARY_PATH=%s", cp);
+
+/*
+ *  Get the spawn configuration for the request. A location may define its own.
+ */
+static MaCgiConfig *getConfig(MaConn *conn)
+{
+    MaLocation      *location;
+    Cgi             *cgi;
+
+    location = conn->request->location;
+    cgi = conn->response->handler->stageData;
+
+    if (location->cgiConfig) {
+        return location->cgiConfig;
+    }
+    return cgi->config;
+}
+
+
+/*
+ *  Resolve the program to run for a script. If the script has a "#!" line naming an accessible interpreter, the 
+ *  interpreter is run directly with the script as its argument.
+ */
+static CgiScript *resolveScript(Cgi *cgi, cchar *path, MprFileInfo *info)
+{
+    CgiScript   *script;
+    MprFile     *file;
+    char        buf[MPR_MAX_FNAME + 1], *interp, *arg, *tok;
+    int         len;
+
+    script = mprAllocObjZeroed(cgi->scripts, CgiScript);
+    script->cgi = cgi;
+    script->path = mprStrdup(script, path);
+    script->program = script->path;
+    script->mtime = info->mtime;
+    script->idle = mprCreateList(script);
+
+    if ((file = mprOpen(script, path, O_RDONLY | O_BINARY, 0)) != 0) {
+        len = mprRead(file, buf, MPR_MAX_FNAME);
+        mprFree(file);
+        if (len > 2 && buf[0] == '#' && buf[1] == '!') {
+            buf[len] = '\0';
+            buf[strcspn(buf, "\r\n")] = '\0';
+            if ((interp = mprStrTok(&buf[2], " \t", &tok)) != 0 && interp[0] == '/' && access(interp, X_OK) == 0) {
+                script->program = mprStrdup(script, interp);
+                arg = (tok) ? mprStrTrim(tok, " \t") : 0;
+                if (arg && *arg) {
+                    script->interpArg = mprStrdup(script, arg);
+                }
+            }
         }
     }
-#endif
+    mprLog(cgi->scripts, 4, "CGI: resolved %s to run via %s", path, script->program);
+    return script;
+}
 
-    envv[index] = 0;
-    mprAssert(index <= varCount);
 
-#if BLD_DEBUG
+/*
+ *  Get the cached resolution for the request script. The cache entry is rebuilt if the script has been modified, 
+ *  which also discards any warm processes for the old script.
+ */
+static CgiScript *getScript(Cgi *cgi, MaConn *conn, MaCgiConfig *config)
 {
-    int     i;
-    mprLog(q, 4, "CGI: running program: %s: ", fileName);
-    for (i = 1; argv[i]; i++) {
-        mprRawLog(q, 4, "%s ", argv[i]);
+    MprFileInfo     info;
+    CgiScript       *script;
+    cchar           *path;
+
+    path = conn->response->filename;
+    if (mprGetFileInfo(conn, path, &info) < 0 || !info.isReg || access(path, X_OK) < 0) {
+        return 0;
     }
-    mprRawLog(q, 4, "\n");
-    for (i = 0; i < index; i++) {
-        mprLog(q, 4, "CGI ENV %s", envv[i]);
+    lock(cgi);
+    script = (CgiScript*) mprLookupHash(cgi->scripts, path);
+    if (script && script->mtime != info.mtime) {
+        mprRemoveHash(cgi->scripts, path);
+        mprFree(script);
+        script = 0;
     }
+    if (script == 0) {
+        script = resolveScript(cgi, path, &info);
+        mprAddHash(cgi->scripts, path, script);
+    }
+    script->warm = config->warm;
+    unlock(cgi);
+    return script;
+}
+
+
+/*
+ *  An idle warm process must not produce output before it receives a request. Any event means the process has 
+ *  exited or failed, so discard it.
+ */
+static void warmCallback(MprCmd *cmd, int fd, int channel, void *data)
+{
+    CgiScript   *script;
+    Cgi         *cgi;
+
+    script = (CgiScript*) data;
+    cgi = script->cgi;
+
+    lock(cgi);
+    if (mprRemoveItem(script->idle, cmd) < 0) {
+        /* Already taken by a request */
+        unlock(cgi);
+        return;
+    }
+    unlock(cgi);
+    mprLog(cmd, 4, "CGI: discarding warm process for %s", script->path);
+    mprFree(cmd);
 }
-#endif
+
+
+/*
+ *  Start an idle process for a script. The process is told via CGI_WARM that it must read the request environment
+ *  from stdin before processing the request.
+ */
+static MprCmd *startWarmCmd(Cgi *cgi, CgiScript *script)
+{
+    MprCmd      *cmd;
+    char        **argv, **envv, dir[MPR_MAX_FNAME];
+    int         argc, i;
+
+    cmd = mprCreateCmd(script);
+    argv = (char**) mprAlloc(cmd, 4 * sizeof(char*));
+    argc = 0;
+    argv[argc++] = script->program;
+    if (script->program != script->path) {
+        if (script->interpArg) {
+            argv[argc++] = script->interpArg;
+        }
+        argv[argc++] = script->path;
+    }
+    argv[argc] = 0;
+
+    envv = (char**) mprAlloc(cmd, (cgi->staticCount + 2) * sizeof(char*));
+    for (i = 0; i < cgi->staticCount; i++) {
+        envv[i] = cgi->staticEnv[i];
+    }
+    envv[i++] = "CGI_WARM=1";
+    envv[i] = 0;
 
     cmd->stdoutBuf = mprCreateBuf(cmd, MPR_BUFSIZE, -1);
     cmd->stderrBuf = mprCreateBuf(cmd, MPR_BUFSIZE, -1);
 
+    mprGetDirName(dir, sizeof(dir), script->path);
     mprSetCmdDir(cmd, dir);
-    mprSetCmdCallback(cmd, cgiCallback, conn);
+    mprSetCmdCallback(cmd, warmCallback, script);
 
-    if (mprStartCmd(cmd, argc, argv, envv, MPR_CMD_IN | MPR_CMD_OUT | MPR_CMD_ERR) < 0) {
-        maFailRequest(conn, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "Can't run CGI process: %s, URI %s", fileName, req->url);
+    if (mprStartCmd(cmd, argc, argv, envv, MPR_CMD_IN | MPR_CMD_OUT | MPR_CMD_ERR | MPR_CMD_SPAWN) < 0) {
+        mprError(cgi->scripts, "Can't start warm CGI process for %s", script->path);
+        mprFree(cmd);
+        return 0;
     }
+    return cmd;
+}
+
+
+/*
+ *  Top up the warm pool for a script. This runs from the event loop after the request that took a process.
+ */
+static void refillWarmPool(CgiScript *script, MprEvent *event)
+{
+    Cgi         *cgi;
+    MprCmd      *cmd;
+
+    cgi = script->cgi;
+
+    lock(cgi);
+    while (mprGetListCount(script->idle) < script->warm) {
+        if ((cmd = startWarmCmd(cgi, script)) == 0) {
+            break;
+        }
+        mprAddItem(script->idle, cmd);
+    }
+    script->refill = 0;
+    unlock(cgi);
+    mprFree(event);
+}
+
+
+static MprCmd *takeWarmCmd(Cgi *cgi, CgiScript *script)
+{
+    MprCmd      *cmd;
+
+    lock(cgi);
+    if ((cmd = (MprCmd*) mprGetFirstItem(script->idle)) != 0) {
+        mprRemoveItemAtPos(script->idle, 0);
+    }
+    if (script->refill == 0 && mprGetListCount(script->idle) < script->warm) {
+        script->refill = mprCreateEvent(script, (MprEventProc) refillWarmPool, 0, MPR_NORMAL_PRIORITY, script, 0);
+    }
+    unlock(cgi);
+    return cmd;
+}
+
+
+/*
+ *  Write the request environment to a warm process. The environment is a block of null terminated "NAME=VALUE" 
+ *  strings ending with an empty string. The request body, if any, follows via pushDataToCgi.
+ */
+static int writeEnvBlock(MprCmd *cmd, MaRequest *req)
+{
+    MprHash     *hp;
+    MprBuf      *buf;
+    int         len, rc;
+
+    buf = mprCreateBuf(cmd, MPR_BUFSIZE, -1);
+    for (hp = mprGetFirstHash(req->headers); hp; hp = mprGetNextHash(req->headers, hp)) {
+        if (hp->data) {
+            mprPutStringToBuf(buf, hp->key);
+            mprPutCharToBuf(buf, '=');
+            mprPutStringToBuf(buf, (char*) hp->data);
+            mprPutCharToBuf(buf, '\0');
+        }
+    }
+    mprPutCharToBuf(buf, '\0');
+
+    rc = 0;
+    while ((len = mprGetBufLength(buf)) > 0) {
+        if ((rc = mprWriteCmdPipe(cmd, MPR_CMD_STDIN, mprGetBufStart(buf), len)) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        mprAdjustBufStart(buf, rc);
+    }
+    mprFree(buf);
+    return (rc < 0) ? MPR_ERR_CANT_WRITE : 0;
+}
+
+
+/*
+ *  Run the request using an idle warm process for the script. Warm processes are only used when the script is run 
+ *  directly without command line arguments. Returns the command or zero if no warm process is available.
+ */
+static MprCmd *startWarmRequest(MaQueue *q, CgiScript *script)
+{
+    MaConn      *conn;
+    MaRequest   *req;
+    MprCmd      *cmd;
+    cchar       *query;
+
+    conn = q->conn;
+    req = conn->request;
+
+    query = req->parsedUri->query;
+    if ((query && !strchr(query, '=')) || (req->mimeType && maGetMimeActionProgram(req->host, req->mimeType))) {
+        return 0;
+    }
+    while ((cmd = takeWarmCmd(script->cgi, script)) != 0) {
+        mprStealBlock(req, cmd);
+        if (writeEnvBlock(cmd, req) == 0) {
+            break;
+        }
+        mprLog(q, 4, "CGI: warm process for %s has exited", script->path);
+        mprFree(cmd);
+    }
+    if (cmd == 0) {
+        return 0;
+    }
+    mprLog(q, 4, "CGI: running %s using a warm process", script->path);
+    if (isNonParsedHeader(script->path)) {
+        cmd->userFlags |= MA_CGI_SEEN_HEADER;
+    }
+    mprSetCmdCallback(cmd, cgiCallback, conn);
+    q->queueData = cmd;
+    return cmd;
+}
+
+
+static void lock(Cgi *cgi)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(cgi->mutex);
+#endif
+}
+
+
+static void unlock(Cgi *cgi)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(cgi->mutex);
+#endif
 }
 
 
@@ -270,6 +617,8 @@ static void pushDataToCgi(MaQueue *q)
             mprAdjustBufStart(buf, rc);
             if (mprGetBufLength(buf) > 0) {
                 maPutBack(q, packet);
+            } else {
+                maRecyclePacket(conn, packet);
             }
             if (rc < len) {
                 /*
@@ -363,6 +712,92 @@ static int writeToBrowser(MaQueue *q, MprCmd *cmd, MprBuf *buf, int channel)
 }
 
 
+/*
+ *  Test if the CGI output can be spliced directly from the stdout pipe to the client socket. This requires that the 
+ *  headers and all prior body data have been written to the socket so the pipeline is empty, and that no filter needs 
+ *  to see the content. Chunked and ranged responses and responses to secure sockets not offloaded to the kernel must 
+ *  use the buffered path. Output still buffered in the pipeline is flushed first.
+ */
+static bool canSplice(MaConn *conn, MprCmd *cmd)
+{
+    MaHttp      *http;
+    MaRequest   *req;
+    MaResponse  *resp;
+    MaQueue     *q;
+
+    req = conn->request;
+    resp = conn->response;
+    http = conn->http;
+
+    if (!(cmd->userFlags & MA_CGI_SEEN_HEADER) || (cmd->userFlags & MA_CGI_NO_SPLICE) || 
+            mprGetBufLength(cmd->stdoutBuf) > 0) {
+        return 0;
+    }
+    if (conn->requestFailed || req->ranges || resp->chunkSize > 0 || (resp->flags & MA_RESP_NO_BODY) ||
+            resp->connector != http->netConnector) {
+        return 0;
+    }
+    if (mprSocketIsSecure(conn->sock) && !mprSocketIsOffloaded(conn->sock)) {
+        return 0;
+    }
+    if (resp->queue[MA_QUEUE_SEND].nextQ->first) {
+        maServiceQueues(conn);
+    }
+    if (!(resp->flags & MA_RESP_HEADERS_CREATED)) {
+        return 0;
+    }
+    for (q = resp->queue[MA_QUEUE_SEND].nextQ; q != &resp->queue[MA_QUEUE_SEND]; q = q->nextQ) {
+        if (q->first || q->ioIndex > 0) {
+            return 0;
+        }
+        if (q->stage != resp->handler && q->stage != resp->connector && 
+                q->stage != http->chunkFilter && q->stage != http->rangeFilter) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ *  Move CGI output from the stdout pipe to the client socket without copying through user space. Return true if the 
+ *  CGI program has closed its output. If the socket is full, the caller reads the pending output into the stdout buffer
+ *  and writes it via the pipeline. The net connector then applies the normal flow control and outgoingCgiService 
+ *  re-enables stdout events once the connector has drained.
+ */
+static bool spliceToBrowser(MaConn *conn, MprCmd *cmd)
+{
+    MaResponse  *resp;
+    int         fd, nbytes;
+
+    resp = conn->response;
+    fd = mprGetCmdFd(cmd, MPR_CMD_STDOUT);
+
+    while (1) {
+        nbytes = mprSpliceToSocket(conn->sock, fd, MA_CGI_SPLICE_SIZE);
+        if (nbytes > 0) {
+            mprLog(cmd, 5, "CGI splice to browser %d", nbytes);
+            resp->bytesWritten += nbytes;
+
+        } else if (nbytes == 0) {
+            mprLog(cmd, 5, "CGI splice from stdout got EOF");
+            mprCloseCmdFd(cmd, MPR_CMD_STDOUT);
+            return 1;
+
+        } else if (errno != EINTR) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                /*
+                 *  Splice not supported for this pipe or socket. Socket errors are reported by the connector.
+                 */
+                mprLog(cmd, 5, "CGI splice failed, errno %d, using buffered output", errno);
+                cmd->userFlags |= MA_CGI_NO_SPLICE;
+            }
+            return 0;
+        }
+    }
+}
+
+
 /*
  *  Read the output data from the CGI script and return it to the client
  */
@@ -391,6 +826,9 @@ static void cgiCallback(MprCmd *cmd, int fd, int channel, void *data)
 
     case MPR_CMD_STDOUT:
         buf = cmd->stdoutBuf;
+        if (canSplice(conn, cmd)) {
+            closed = spliceToBrowser(conn, cmd);
+        }
         break;
 
     case MPR_CMD_STDERR:
@@ -404,7 +842,7 @@ static void cgiCallback(MprCmd *cmd, int fd, int channel, void *data)
     /*
      *  Come here for CGI stdout, stderr events. ie. we can read data from the CGI program.
      */
-    while (!cmd->completed) {
+    while (!cmd->completed && !closed) {
 
         /*
          *  Read data from the CGI pipe and try to totally fill the buffer
@@ -593,6 +1031,12 @@ static bool parseHeader(MaConn *conn, MprCmd *cmd)
             } else if (strcmp(key, "content-type") == 0) {
                 maSetResponseMimeType(conn, value);
 
+            } else if (strcmp(key, "content-length") == 0) {
+                /*
+                 *  A known length avoids chunking the response and permits the body to be spliced
+                 */
+                maSetEntityLength(conn, atoi(value));
+
             } else {
                 /*
                  *  Now pass all other headers back to the client
@@ -613,7 +1057,7 @@ static bool parseHeader(MaConn *conn, MprCmd *cmd)
 /*
  *  Build the command arguments. NOTE: argv is untrusted input.
  */
-static void buildArgs(MaConn *conn, MprCmd *cmd, int *argcp, char ***argvp)
+static void buildArgs(MaConn *conn, MprCmd *cmd, CgiScript *script, int *argcp, char ***argvp)
 {
     MaRequest   *req;
     MaResponse  *resp;
@@ -731,12 +1175,25 @@ static void buildArgs(MaConn *conn, MprCmd *cmd, int *argcp, char ***argvp)
     }
 }
 #else
+    if (script && script->program != script->path && !actionProgram) {
+        /*
+         *  Run the cached "#!" interpreter directly with the script as an argument
+         */
+        argc += (script->interpArg) ? 2 : 1;
+    } else {
+        script = 0;
+    }
     len = (argc + 1) * sizeof(char*);
     argv = (char**) mprAlloc(cmd, len);
     memset(argv, 0, len);
 
     if (actionProgram) {
         argv[argind++] = mprStrdup(cmd, actionProgram);
+    } else if (script) {
+        argv[argind++] = mprStrdup(cmd, script->program);
+        if (script->interpArg) {
+            argv[argind++] = mprStrdup(cmd, script->interpArg);
+        }
     }
     argv[argind++] = mprStrdup(cmd, fileName);
 
@@ -988,10 +1445,42 @@ static int parseCgi(MaHttp *http, cchar *key, char *value, MaConfigState *state)
 #endif
         maSetHandler(http, host, location, "cgiHandler");
         return 1;
+
+    } else if (mprStrcmpAnyCase(key, "CgiSpawn") == 0) {
+        getLocationConfig(http, state)->spawn = (mprStrcmpAnyCase(value, "on") == 0);
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "CgiWarmPool") == 0) {
+        getLocationConfig(http, state)->warm = atoi(value);
+        return 1;
     }
 
     return 0;
 }
+
+
+/*
+ *  Get the configuration to modify for the current config block. Directives at the host level modify the handler
+ *  defaults. Directives inside a Location block create a configuration for that location.
+ */
+static MaCgiConfig *getLocationConfig(MaHttp *http, MaConfigState *state)
+{
+    MaLocation      *location;
+    MaCgiConfig     *config;
+    Cgi             *cgi;
+
+    cgi = maLookupStageData(http, "cgiHandler");
+    location = state->location;
+    if (location == 0 || location == state->host->location) {
+        return cgi->config;
+    }
+    if ((config = location->cgiConfig) == 0) {
+        config = mprAllocObjZeroed(location, MaCgiConfig);
+        *config = *cgi->config;
+        location->cgiConfig = config;
+    }
+    return config;
+}
 #endif
 
 
@@ -1002,6 +1491,7 @@ MprModule *maCgiHandlerInit(MaHttp *http, cchar *path)
 {
     MprModule   *module;
     MaStage     *handler;
+    Cgi         *cgi;
 
     module = mprCreateModule(http, "cgiHandler", BLD_VERSION, NULL, NULL, NULL);
     if (module == 0) {
@@ -1009,7 +1499,7 @@ MprModule *maCgiHandlerInit(MaHttp *http, cchar *path)
     }
 
     handler = maCreateHandler(http, "cgiHandler", 
-        MA_STAGE_ALL | MA_STAGE_FORM_VARS | MA_STAGE_ENV_VARS | MA_STAGE_PATH_INFO);
+        MA_STAGE_ALL | MA_STAGE_FORM_VARS | MA_STAGE_ENV_VARS | MA_STAGE_PATH_INFO | MA_STAGE_STREAM_INPUT);
     if (handler == 0) {
         mprFree(module);
         return 0;
@@ -1022,6 +1512,28 @@ MprModule *maCgiHandlerInit(MaHttp *http, cchar *path)
     handler->run = runCgi; 
     handler->parse = parseCgi; 
 
+    handler->stageData = cgi = mprAllocObjZeroed(handler, Cgi);
+    cgi->config = mprAllocObjZeroed(cgi, MaCgiConfig);
+    cgi->scripts = mprCreateHash(cgi, -1);
+#if BLD_FEATURE_MULTITHREAD
+    cgi->mutex = mprCreateLock(cgi);
+#endif
+
+    /*
+     *  For unix, also export the PATH and LD_LIBRARY_PATH. These are built once and shared by all requests.
+     */
+    cgi->staticEnv = (char**) mprAllocZeroed(cgi, 2 * sizeof(char*));
+#if BLD_HOST_UNIX
+    {
+        char    *cp;
+        if ((cp = getenv("PATH")) != 0) {
+            mprAllocSprintf(cgi, &cgi->staticEnv[cgi->staticCount++], MPR_MAX_STRING, "PATH=%s", cp);
+        }
+        if ((cp = getenv("LD_LIBRARY_PATH")) != 0) {
+            mprAllocSprintf(cgi, &cgi->staticEnv[cgi->staticCount++], MPR_MAX_STRING, "LD_LIBRARY_PATH=%s", cp);
+        }
+    }
+#endif
     return module;
 }
 
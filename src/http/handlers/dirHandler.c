@@ -11,10 +11,19 @@
 #if BLD_FEATURE_DIR
 /********************************** Defines ***********************************/
 
+#define DIR_SORT_NONE       0               /* Directory order */
+#define DIR_SORT_NAME       1
+#define DIR_SORT_DATE       2
+#define DIR_SORT_SIZE       3
+#define DIR_SORT_MAX        4
+
+
 /*
  *  Handler configuration
  */
 typedef struct Dir {
+    MprHashTable    *cache;                 /* Cached directory listings indexed by path */
+    int             cacheCount;             /* Number of cached listings */
     cchar           *defaultIcon;
     MprList         *dirList;
     bool            enabled;
@@ -22,22 +31,72 @@ typedef struct Dir {
     int             fancyIndexing;
     bool            foldersFirst;
     MprList         *ignoreList;
-    cchar           *pattern;
     char            *sortField;
     int             sortOrder;              /* 1 == ascending, -1 descending */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
 } Dir;
 
+/*
+ *  Directory entry with its display values. These are formatted once when the directory is read.
+ */
+typedef struct DirItem {
+    MprDirEntry     *entry;
+    char            date[20];               /* Last modified date */
+    char            size[16];               /* Abbreviated size */
+} DirItem;
+
+/*
+ *  Cached directory listing. The items are sorted once per sort key when the directory is read. Listings are shared
+ *  by requests and are reference counted so they can be replaced while a response is still rendering.
+ */
+typedef struct DirListing {
+    char            *path;
+    MprTime         mtime;                  /* Directory modification time (seconds) */
+    MprTime         loaded;                 /* Time the directory was read */
+    MprTime         lastUsed;               /* Time the listing was last used by a request */
+    DirItem         *items;
+    DirItem         **sorted[DIR_SORT_MAX]; /* Item views sorted ascending. Folders first if FoldersFirst */
+    int             count;                  /* Number of items */
+    int             dirCount;               /* Number of leading folders in the sorted views */
+    int             nameSize;               /* Width of the name column */
+    int             refs;                   /* Requests using the listing */
+    bool            cached;                 /* Listing is in the cache */
+} DirListing;
+
+/*
+ *  Listing state for a request. Query parameters override the handler defaults for this request only.
+ */
+typedef struct DirRequest {
+    MprBuf          *buf;                   /* Formatted output not yet queued */
+    DirListing      *listing;
+    char            *pattern;               /* Filename pattern */
+    int             fancyIndexing;
+    int             sortKey;
+    int             sortOrder;
+    int             start;                  /* Index of the first item to display */
+    int             limit;                  /* Max items to display. Zero for all */
+    int             pos;                    /* Next position in the sorted view */
+    int             matched;                /* Count of items matching the pattern so far */
+    int             shown;                  /* Count of items displayed */
+    bool            finished;               /* All output has been formatted */
+    bool            sent;                   /* All output has been queued */
+} DirRequest;
 
 /****************************** Forward Declarations **************************/
 
-static void filterDirList(MaConn *conn, MprList *list);
+static void formatItem(MprCtx ctx, DirItem *item);
+static DirListing *getListing(MaConn *conn, Dir *dir, cchar *path);
+static int  getSortKey(cchar *field);
 static int  match(cchar *pattern, cchar *file);
-static void outputFooter(MaQueue *q);
-static void outputHeader(MaQueue *q, cchar *dir, int nameSize);
-static void outputLine(MaQueue *q, MprDirEntry *ep, cchar *dir, int nameSize);
-static void parseQuery(MaConn *conn);
+static void outputFooter(MaQueue *q, MprBuf *buf);
+static void outputHeader(MaQueue *q, MprBuf *buf, cchar *dir, int nameSize);
+static void outputLine(MaQueue *q, MprBuf *buf, DirItem *item, int nameSize);
+static void parseQuery(MaConn *conn, DirRequest *dr);
 static void parseWords(MprList *list, cchar *str);
-static void sortList(MaConn *conn, MprList *list);
+static void releaseListing(Dir *dir, DirListing *listing);
+static void sortListing(Dir *dir, DirListing *listing);
 
 /************************************* Code ***********************************/
 /*
@@ -60,76 +119,200 @@ static bool matchDir(MaConn *conn, MaStage *handler, cchar *url)
 }
 
 
+static void closeDir(MaQueue *q)
+{
+    DirRequest      *dr;
+
+    if ((dr = q->queueData) != 0 && dr->listing) {
+        releaseListing(q->stage->stageData, dr->listing);
+        dr->listing = 0;
+    }
+}
+
+
 static void runDir(MaQueue *q)
 {
     MaConn          *conn;
     MaResponse      *resp;
     MaRequest       *req;
-    MprList         *list;
-    MprDirEntry     *dp;
+    DirRequest      *dr;
     Dir             *dir;
-    cchar           *filename;
-    uint            nameSize;
-    int             next;
 
     conn = q->conn;
     req = conn->request;
     resp = conn->response;
     dir = q->stage->stageData;
-
-    filename = resp->filename;
-    mprAssert(filename);
+    mprAssert(resp->filename);
 
     maDontCacheResponse(conn);
     maSetHeader(conn, 0, "Last-Modified", req->host->currentDate);
     maPutForService(q, maCreateHeaderPacket(conn), 0);
 
-    parseQuery(conn);
-
-    list = mprGetDirList(conn, filename, 1);
-    if (list == 0) {
-        maWrite(q, "<h2>Can't get file list</h2>\r\n");
-        outputFooter(q);
+    q->queueData = dr = mprAllocObjZeroed(resp, DirRequest);
+    if (dr == 0 || (dr->buf = mprCreateBuf(dr, q->packetSize * 2, -1)) == 0) {
+        maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't allocate listing state");
         return;
     }
+    dr->fancyIndexing = dir->fancyIndexing;
+    dr->sortKey = getSortKey(dir->sortField);
+    dr->sortOrder = dir->sortOrder;
+    parseQuery(conn, dr);
+
+    dr->listing = getListing(conn, dir, resp->filename);
+    if (dr->listing == 0) {
+        mprPutStringToBuf(dr->buf, "<h2>Can't get file list</h2>\r\n");
+        outputFooter(q, dr->buf);
+        dr->finished = 1;
+    } else {
+        outputHeader(q, dr->buf, req->url, dr->listing->nameSize);
+    }
+    maScheduleQueue(q);
+}
+
+
+/*
+ *  Map a position in the listing to an item. Descending order reverses the folders and the files separately so 
+ *  folders stay first.
+ */
+static DirItem *getItem(DirRequest *dr, int pos)
+{
+    DirListing  *listing;
+    int         dirCount;
 
-    if (dir->pattern) {
-        filterDirList(conn, list);
+    listing = dr->listing;
+    if (dr->sortOrder > 0 || dr->sortKey == DIR_SORT_NONE) {
+        return listing->sorted[dr->sortKey][pos];
     }
+    dirCount = listing->dirCount;
+    if (pos < dirCount) {
+        return listing->sorted[dr->sortKey][dirCount - pos - 1];
+    }
+    return listing->sorted[dr->sortKey][listing->count - pos + dirCount - 1];
+}
 
-    sortList(conn, list);
 
-    /*
-     *  Get max filename
-     */
-    nameSize = 0;
-    for (next = 0; (dp = mprGetNextItem(list, &next)) != 0; ) {
-        nameSize = max((int) strlen(dp->name), nameSize);
+/*
+ *  Format lines until there is at least a full packet of output. The footer is added after the last item.
+ */
+static void outputBatch(MaQueue *q, DirRequest *dr)
+{
+    DirListing  *listing;
+    DirItem     *item;
+
+    listing = dr->listing;
+
+    if (dr->pattern == 0 && dr->pos < dr->start) {
+        /*
+         *  Without a pattern, every item is displayed so skip directly to the first item
+         */
+        dr->pos = dr->matched = min(dr->start, listing->count);
+    }
+    while (dr->pos < listing->count && mprGetBufLength(dr->buf) < q->packetSize) {
+        if (dr->limit > 0 && dr->shown >= dr->limit) {
+            break;
+        }
+        item = getItem(dr, dr->pos++);
+        if (dr->pattern && !match(dr->pattern, item->entry->name)) {
+            continue;
+        }
+        if (dr->matched++ < dr->start) {
+            continue;
+        }
+        outputLine(q, dr->buf, item, listing->nameSize);
+        dr->shown++;
+    }
+    if (dr->pos >= listing->count || (dr->limit > 0 && dr->shown >= dr->limit)) {
+        outputFooter(q, dr->buf);
+        dr->finished = 1;
+    }
+}
+
+
+/*
+ *  Queue the formatted output as packets of the queue packet size. Full size packets pass through the chunk filter 
+ *  without being held for coalescing. The remainder is kept for the next batch unless the listing is finished.
+ */
+static int queueOutput(MaQueue *q, DirRequest *dr)
+{
+    MaConn      *conn;
+    MaPacket    *packet;
+    int         len;
+
+    conn = q->conn;
+
+    while ((len = mprGetBufLength(dr->buf)) >= q->packetSize || (dr->finished && len > 0)) {
+        len = min(len, q->packetSize);
+        if ((packet = maCreateDataPacket(conn, len)) == 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't allocate listing packet");
+            return MPR_ERR_NO_MEMORY;
+        }
+        mprPutBlockToBuf(packet->content, mprGetBufStart(dr->buf), len);
+        packet->count = len;
+        mprAdjustBufStart(dr->buf, len);
+        maPutForService(q, packet, 0);
+    }
+    mprCompactBuf(dr->buf);
+    if (dr->finished) {
+        maPutForService(q, maCreateEndPacket(conn), 0);
     }
-    nameSize = max(nameSize, 22);
+    return 0;
+}
 
-    outputHeader(q, req->url, nameSize);
-    for (next = 0; (dp = mprGetNextItem(list, &next)) != 0; ) {
-        outputLine(q, dp, filename, nameSize);
+
+/*
+ *  Send the listing downstream a batch at a time. If the downstream queue is full, this routine will be recalled 
+ *  when it has drained, so only the lines that can be sent are formatted.
+ */
+static void outgoingDirService(MaQueue *q)
+{
+    MaPacket    *packet;
+    DirRequest  *dr;
+
+    dr = q->queueData;
+
+    while (1) {
+        for (packet = maGet(q); packet; packet = maGet(q)) {
+            if (packet->flags & MA_PACKET_DATA && !maWillNextQueueAccept(q, packet)) {
+                maPutBack(q, packet);
+                return;
+            }
+            maPutNext(q, packet);
+        }
+        if (dr == 0 || dr->sent || q->conn->requestFailed) {
+            break;
+        }
+        if (!dr->finished) {
+            outputBatch(q, dr);
+        }
+        if (queueOutput(q, dr) < 0) {
+            break;
+        }
+        dr->sent = dr->finished;
     }
-    outputFooter(q);
+}
 
-    maPutForService(q, maCreateEndPacket(conn), 1);
 
-    mprFree(list);
+static int getSortKey(cchar *field)
+{
+    if (field == 0) {
+        return DIR_SORT_NONE;
+    } else if (mprStrcmpAnyCase(field, "Name") == 0) {
+        return DIR_SORT_NAME;
+    } else if (mprStrcmpAnyCase(field, "Date") == 0) {
+        return DIR_SORT_DATE;
+    } else if (mprStrcmpAnyCase(field, "Size") == 0) {
+        return DIR_SORT_SIZE;
+    }
+    return DIR_SORT_NONE;
 }
- 
 
-static void parseQuery(MaConn *conn)
+
+static void parseQuery(MaConn *conn, DirRequest *dr)
 {
     MaRequest   *req;
-    MaResponse  *resp;
-    Dir         *dir;
     char        *value, *query, *next, *tok;
 
     req = conn->request;
-    resp = conn->response;
-    dir = resp->handler->stageData;
     
     query = mprStrdup(req, req->parsedUri->query);
     if (query == 0) {
@@ -140,35 +323,39 @@ static void parseQuery(MaConn *conn)
     while (tok) {
         if ((value = strchr(tok, '=')) != 0) {
             *value++ = '\0';
-            if (*tok == 'C') {                  /* Sort column */
-                mprFree(dir->sortField);
+            if (strcmp(tok, "start") == 0) {    /* First item to display */
+                dr->start = max(mprAtoi(value, 10), 0);
+
+            } else if (strcmp(tok, "count") == 0) {  /* Items per page */
+                dr->limit = max(mprAtoi(value, 10), 0);
+
+            } else if (*tok == 'C') {           /* Sort column */
                 if (*value == 'N') {
-                    dir->sortField = "Name";
+                    dr->sortKey = DIR_SORT_NAME;
                 } else if (*value == 'M') {
-                    dir->sortField = "Date";
+                    dr->sortKey = DIR_SORT_DATE;
                 } else if (*value == 'S') {
-                    dir->sortField = "Size";
+                    dr->sortKey = DIR_SORT_SIZE;
                 }
-                dir->sortField = mprStrdup(dir, dir->sortField);
 
             } else if (*tok == 'O') {           /* Sort order */
                 if (*value == 'A') {
-                    dir->sortOrder = 1;
+                    dr->sortOrder = 1;
                 } else if (*value == 'D') {
-                    dir->sortOrder = -1;
+                    dr->sortOrder = -1;
                 }
 
             } else if (*tok == 'F') {           /* Format */ 
                 if (*value == '0') {
-                    dir->fancyIndexing = 0;
+                    dr->fancyIndexing = 0;
                 } else if (*value == '1') {
-                    dir->fancyIndexing = 1;
+                    dr->fancyIndexing = 1;
                 } else if (*value == '2') {
-                    dir->fancyIndexing = 2;
+                    dr->fancyIndexing = 2;
                 }
 
             } else if (*tok == 'P') {           /* Pattern */ 
-                dir->pattern = mprStrdup(dir, value);
+                dr->pattern = (*value) ? mprStrdup(dr, value) : 0;
             }
         }
         tok = mprStrTok(next, ";&", &next);
@@ -178,105 +365,217 @@ static void parseQuery(MaConn *conn)
 }
 
 
-static void sortList(MaConn *conn, MprList *list)
+/*
+ *  Get the listing for a directory. Cached listings are used while the directory modification time is unchanged.
+ *  The caller must release the listing via releaseListing.
+ */
+static DirListing *getListing(MaConn *conn, Dir *dir, cchar *path)
 {
-    MaRequest       *req;
-    MaResponse      *resp;
-    MprDirEntry     *tmp, **items;
-    Dir             *dir;
-    int             count, i, j, rc;
+    MprFileInfo     *info;
+    MprList         *list;
+    MprDirEntry     *dp;
+    DirListing      *listing, *lp, *oldest;
+    DirItem         *item;
+    MprHash         *hp;
+    MprTime         now;
+    int             next;
 
-    req = conn->request;
-    resp = conn->response;
-    dir = resp->handler->stageData;
-    
-    if (dir->sortField == 0) {
-        return;
+    info = &conn->response->fileInfo;
+    now = mprGetTime(conn);
+
+    mprLock(dir->mutex);
+    if ((listing = (DirListing*) mprLookupHash(dir->cache, path)) != 0) {
+        /*
+         *  The modification time has a one second resolution. A listing read in the same second as a modification
+         *  may be incomplete, so it is not trusted.
+         */
+        if (listing->mtime == info->mtime && (listing->mtime * MPR_TICKS_PER_SEC) < (listing->loaded - 1000) &&
+                (now - listing->loaded) < MA_DIR_CACHE_TIMEOUT) {
+            listing->refs++;
+            listing->lastUsed = now;
+            mprUnlock(dir->mutex);
+            return listing;
+        }
+        mprRemoveHash(dir->cache, path);
+        dir->cacheCount--;
+        listing->cached = 0;
+        if (listing->refs == 0) {
+            mprFree(listing);
+        }
     }
+    mprUnlock(dir->mutex);
 
-    count = mprGetListCount(list);
-    items = (MprDirEntry**) list->items;
-    if (mprStrcmpAnyCase(dir->sortField, "Name") == 0) {
-        for (i = 1; i < count; i++) {
-            for (j = 0; j < i; j++) {
-                rc = strcmp(items[i]->name, items[j]->name);
-                if (dir->foldersFirst) {
-                    if (items[i]->isDir && !items[j]->isDir) {
-                        rc = -dir->sortOrder;
-                    } else if (items[j]->isDir && !items[i]->isDir) {
-                        rc = dir->sortOrder;
-                    } 
-                }
-                rc *= dir->sortOrder;
-                if (rc < 0) {
-                    tmp = items[i];
-                    items[i] = items[j];
-                    items[j] = tmp;
-                }
-            }
-        }
+    /*
+     *  Read, format and sort the directory outside the lock
+     */
+    listing = mprAllocObjZeroed(dir, DirListing);
+    if (listing == 0) {
+        return 0;
+    }
+    listing->path = mprStrdup(listing, path);
+    listing->mtime = info->mtime;
+    listing->loaded = listing->lastUsed = now;
+    listing->refs = 1;
 
-    } else if (mprStrcmpAnyCase(dir->sortField, "Size") == 0) {
-        for (i = 1; i < count; i++) {
-            for (j = 0; j < i; j++) {
-                rc = (items[i]->size < items[j]->size) ? -1 : 1;
-                if (dir->foldersFirst) {
-                    if (items[i]->isDir && !items[j]->isDir) {
-                        rc = -dir->sortOrder;
-                    } else if (items[j]->isDir && !items[i]->isDir) {
-                        rc = dir->sortOrder;
-                    }
+    if ((list = mprGetDirList(listing, path, 1)) == 0) {
+        mprFree(listing);
+        return 0;
+    }
+    listing->count = mprGetListCount(list);
+    listing->items = (DirItem*) mprAllocZeroed(listing, sizeof(DirItem) * max(listing->count, 1));
+    if (listing->items == 0) {
+        mprFree(listing);
+        return 0;
+    }
+    listing->nameSize = 22;
+    for (next = 0; (dp = mprGetNextItem(list, &next)) != 0; ) {
+        item = &listing->items[next - 1];
+        item->entry = dp;
+        listing->nameSize = max((int) strlen(dp->name), listing->nameSize);
+    }
+    for (next = 0; next < listing->count; next++) {
+        item = &listing->items[next];
+        formatItem(conn, item);
+    }
+    sortListing(dir, listing);
+
+    mprLock(dir->mutex);
+    if (mprLookupHash(dir->cache, path) == 0) {
+        if (dir->cacheCount >= MA_DIR_CACHE_SIZE) {
+            /*
+             *  Evict the least recently used listing
+             */
+            oldest = 0;
+            for (hp = mprGetFirstHash(dir->cache); hp; hp = mprGetNextHash(dir->cache, hp)) {
+                lp = (DirListing*) hp->data;
+                if (oldest == 0 || lp->lastUsed < oldest->lastUsed) {
+                    oldest = lp;
                 }
-                rc *= dir->sortOrder;
-                if (rc < 0) {
-                    tmp = items[i];
-                    items[i] = items[j];
-                    items[j] = tmp;
+            }
+            if (oldest) {
+                mprRemoveHash(dir->cache, oldest->path);
+                dir->cacheCount--;
+                oldest->cached = 0;
+                if (oldest->refs == 0) {
+                    mprFree(oldest);
                 }
             }
         }
+        mprAddHash(dir->cache, listing->path, listing);
+        dir->cacheCount++;
+        listing->cached = 1;
+    }
+    mprUnlock(dir->mutex);
+    return listing;
+}
+
+
+static void releaseListing(Dir *dir, DirListing *listing)
+{
+    mprLock(dir->mutex);
+    if (--listing->refs == 0 && !listing->cached) {
+        mprFree(listing);
+    }
+    mprUnlock(dir->mutex);
+}
+
 
-    } else if (mprStrcmpAnyCase(dir->sortField, "Date") == 0) {
-        for (i = 1; i < count; i++) {
-            for (j = 0; j < i; j++) {
-                rc = (items[i]->lastModified < items[j]->lastModified) ? -1: 1;
-                if (dir->foldersFirst) {
-                    if (items[i]->isDir && !items[j]->isDir) {
-                        rc = -dir->sortOrder;
-                    } else if (items[j]->isDir && !items[i]->isDir) {
-                        rc = dir->sortOrder;
-                    }
+static int compareName(DirItem **i1, DirItem **i2)
+{
+    return strcmp((*i1)->entry->name, (*i2)->entry->name);
+}
+
+
+static int compareDate(DirItem **i1, DirItem **i2)
+{
+    MprDirEntry     *e1, *e2;
+
+    e1 = (*i1)->entry;
+    e2 = (*i2)->entry;
+    if (e1->lastModified == e2->lastModified) {
+        return strcmp(e1->name, e2->name);
+    }
+    return (e1->lastModified < e2->lastModified) ? -1 : 1;
+}
+
+
+static int compareSize(DirItem **i1, DirItem **i2)
+{
+    MprDirEntry     *e1, *e2;
+
+    e1 = (*i1)->entry;
+    e2 = (*i2)->entry;
+    if (e1->size == e2->size) {
+        return strcmp(e1->name, e2->name);
+    }
+    return (e1->size < e2->size) ? -1 : 1;
+}
+
+
+/*
+ *  Create the sorted views of the listing. With FoldersFirst, folders are moved ahead of files before sorting each 
+ *  group so that both sort orders can be rendered from one view.
+ */
+static void sortListing(Dir *dir, DirListing *listing)
+{
+    DirItem         **view;
+    MprListCompareProc compare;
+    int             count, key, i, j;
+
+    count = listing->count;
+    for (key = 0; key < DIR_SORT_MAX; key++) {
+        view = listing->sorted[key] = (DirItem**) mprAlloc(listing, sizeof(DirItem*) * max(count, 1));
+        j = 0;
+        if (dir->foldersFirst && key != DIR_SORT_NONE) {
+            for (i = 0; i < count; i++) {
+                if (listing->items[i].entry->isDir) {
+                    view[j++] = &listing->items[i];
                 }
-                rc *= dir->sortOrder;
-                if (rc < 0) {
-                    tmp = items[i];
-                    items[i] = items[j];
-                    items[j] = tmp;
+            }
+            listing->dirCount = j;
+            for (i = 0; i < count; i++) {
+                if (!listing->items[i].entry->isDir) {
+                    view[j++] = &listing->items[i];
                 }
             }
+        } else {
+            for (i = 0; i < count; i++) {
+                view[i] = &listing->items[i];
+            }
+        }
+        if (key == DIR_SORT_NAME) {
+            compare = (MprListCompareProc) compareName;
+        } else if (key == DIR_SORT_DATE) {
+            compare = (MprListCompareProc) compareDate;
+        } else if (key == DIR_SORT_SIZE) {
+            compare = (MprListCompareProc) compareSize;
+        } else {
+            continue;
         }
+        qsort(view, listing->dirCount, sizeof(DirItem*), compare);
+        qsort(&view[listing->dirCount], count - listing->dirCount, sizeof(DirItem*), compare);
     }
 }
 
 
-static void outputHeader(MaQueue *q, cchar *path, int nameSize)
+static void outputHeader(MaQueue *q, MprBuf *buf, cchar *path, int nameSize)
 {
-    Dir     *dir;
-    char    parent[MPR_MAX_FNAME], *parentSuffix;
-    int     order, reverseOrder, fancy, isRootDir;
+    DirRequest  *dr;
+    char        parent[MPR_MAX_FNAME], *parentSuffix, page[32];
+    int         order, reverseOrder, fancy, isRootDir;
 
-    dir = q->stage->stageData;
+    dr = q->queueData;
     
     fancy = 1;
 
-    maWrite(q, "<!DOCTYPE HTML PUBLIC \"-/*W3C//DTD HTML 3.2 Final//EN\">\r\n");
-    maWrite(q, "<html>\r\n <head>\r\n  <title>Index of %s</title>\r\n", path);
-    maWrite(q, " </head>\r\n");
-    maWrite(q, "<body>\r\n");
+    mprPutStringToBuf(buf, "<!DOCTYPE HTML PUBLIC \"-/*W3C//DTD HTML 3.2 Final//EN\">\r\n");
+    mprPutFmtToBuf(buf, "<html>\r\n <head>\r\n  <title>Index of %s</title>\r\n", path);
+    mprPutStringToBuf(buf, " </head>\r\n");
+    mprPutStringToBuf(buf, "<body>\r\n");
 
-    maWrite(q, "<h1>Index of %s</h1>\r\n", path);
+    mprPutFmtToBuf(buf, "<h1>Index of %s</h1>\r\n", path);
 
-    if (dir->sortOrder > 0) {
+    if (dr->sortOrder > 0) {
         order = 'A';
         reverseOrder = 'D';
     } else {
@@ -284,14 +583,22 @@ static void outputHeader(MaQueue *q, cchar *path, int nameSize)
         reverseOrder = 'A';
     }
 
-    if (dir->fancyIndexing == 0) {
+    if (dr->fancyIndexing == 0) {
         fancy = '0';
-    } else if (dir->fancyIndexing == 1) {
+    } else if (dr->fancyIndexing == 1) {
         fancy = '1';
-    } else if (dir->fancyIndexing == 2) {
+    } else if (dr->fancyIndexing == 2) {
         fancy = '2';
     }
 
+    /*
+     *  Keep the page size when changing the sort order
+     */
+    page[0] = '\0';
+    if (dr->limit > 0) {
+        mprSprintf(page, sizeof(page), ";count=%d", dr->limit);
+    }
+
     mprGetDirName(parent, sizeof(parent), (char*) path);
 
     if (parent[strlen(parent) - 1] != '/') {
@@ -302,53 +609,53 @@ static void outputHeader(MaQueue *q, cchar *path, int nameSize)
 
     isRootDir = (strcmp(path, "/") == 0);
 
-    if (dir->fancyIndexing == 2) {
-        maWrite(q, "<table><tr><th><img src=\"/icons/blank.gif\" alt=\"[ICO]\" /></th>");
+    if (dr->fancyIndexing == 2) {
+        mprPutStringToBuf(buf, "<table><tr><th><img src=\"/icons/blank.gif\" alt=\"[ICO]\" /></th>");
 
-        maWrite(q, "<th><a href=\"?C=N;O=%c;F=%c\">Name</a></th>", reverseOrder, fancy);
-        maWrite(q, "<th><a href=\"?C=M;O=%c;F=%c\">Last modified</a></th>", reverseOrder, fancy);
-        maWrite(q, "<th><a href=\"?C=S;O=%c;F=%c\">Size</a></th>", reverseOrder, fancy);
-        maWrite(q, "<th><a href=\"?C=D;O=%c;F=%c\">Description</a></th>\r\n", reverseOrder, fancy);
+        mprPutFmtToBuf(buf, "<th><a href=\"?C=N;O=%c;F=%c%s\">Name</a></th>", reverseOrder, fancy, page);
+        mprPutFmtToBuf(buf, "<th><a href=\"?C=M;O=%c;F=%c%s\">Last modified</a></th>", reverseOrder, fancy, page);
+        mprPutFmtToBuf(buf, "<th><a href=\"?C=S;O=%c;F=%c%s\">Size</a></th>", reverseOrder, fancy, page);
+        mprPutFmtToBuf(buf, "<th><a href=\"?C=D;O=%c;F=%c%s\">Description</a></th>\r\n", reverseOrder, fancy, page);
 
-        maWrite(q, "</tr><tr><th colspan=\"5\"><hr /></th></tr>\r\n");
+        mprPutStringToBuf(buf, "</tr><tr><th colspan=\"5\"><hr /></th></tr>\r\n");
 
         if (! isRootDir) {
-            maWrite(q, "<tr><td valign=\"top\"><img src=\"/icons/back.gif\"");
-            maWrite(q, "alt=\"[DIR]\" /></td><td><a href=\"%s%s\">", parent, parentSuffix);
-            maWrite(q, "Parent Directory</a></td>");
-            maWrite(q, "<td align=\"right\">  - </td></tr>\r\n");
+            mprPutStringToBuf(buf, "<tr><td valign=\"top\"><img src=\"/icons/back.gif\"");
+            mprPutFmtToBuf(buf, "alt=\"[DIR]\" /></td><td><a href=\"%s%s\">", parent, parentSuffix);
+            mprPutStringToBuf(buf, "Parent Directory</a></td>");
+            mprPutStringToBuf(buf, "<td align=\"right\">  - </td></tr>\r\n");
         }
 
-    } else if (dir->fancyIndexing == 1) {
-        maWrite(q, "<pre><img src=\"/icons/space.gif\" alt=\"Icon\" /> ");
+    } else if (dr->fancyIndexing == 1) {
+        mprPutStringToBuf(buf, "<pre><img src=\"/icons/space.gif\" alt=\"Icon\" /> ");
 
-        maWrite(q, "<a href=\"?C=N;O=%c;F=%c\">Name</a>%*s", reverseOrder, fancy, nameSize - 3, " ");
-        maWrite(q, "<a href=\"?C=M;O=%c;F=%c\">Last modified</a>       ", reverseOrder, fancy);
-        maWrite(q, "<a href=\"?C=S;O=%c;F=%c\">Size</a>               ", reverseOrder, fancy);
-        maWrite(q, "<a href=\"?C=D;O=%c;F=%c\">Description</a>\r\n", reverseOrder, fancy);
+        mprPutFmtToBuf(buf, "<a href=\"?C=N;O=%c;F=%c%s\">Name</a>%*s", reverseOrder, fancy, page, nameSize - 3, " ");
+        mprPutFmtToBuf(buf, "<a href=\"?C=M;O=%c;F=%c%s\">Last modified</a>       ", reverseOrder, fancy, page);
+        mprPutFmtToBuf(buf, "<a href=\"?C=S;O=%c;F=%c%s\">Size</a>               ", reverseOrder, fancy, page);
+        mprPutFmtToBuf(buf, "<a href=\"?C=D;O=%c;F=%c%s\">Description</a>\r\n", reverseOrder, fancy, page);
 
-        maWrite(q, "<hr />");
+        mprPutStringToBuf(buf, "<hr />");
 
         if (! isRootDir) {
-            maWrite(q, "<img src=\"/icons/parent.gif\" alt=\"[DIR]\" />");
-            maWrite(q, " <a href=\"%s%s\">Parent Directory</a>\r\n", parent, parentSuffix);
+            mprPutStringToBuf(buf, "<img src=\"/icons/parent.gif\" alt=\"[DIR]\" />");
+            mprPutFmtToBuf(buf, " <a href=\"%s%s\">Parent Directory</a>\r\n", parent, parentSuffix);
         }
 
     } else {
-        maWrite(q, "<ul>\n");
+        mprPutStringToBuf(buf, "<ul>\n");
         if (! isRootDir) {
-            maWrite(q, "<li><a href=\"%s%s\"> Parent Directory</a></li>\r\n", parent, parentSuffix);
+            mprPutFmtToBuf(buf, "<li><a href=\"%s%s\"> Parent Directory</a></li>\r\n", parent, parentSuffix);
         }
     }
 }
 
 
-static void fmtNum(char *buf, int bufsize, int num, int divisor, char *suffix)
+static void fmtNum(char *buf, int bufsize, MprOffset num, MprOffset divisor, char *suffix)
 {
     int     whole, point;
 
-    whole = num / divisor;
-    point = (num % divisor) / (divisor / 10);
+    whole = (int) (num / divisor);
+    point = (int) ((num % divisor) / (divisor / 10));
 
     if (point == 0) {
         mprSprintf(buf, bufsize, "%6d%s", whole, suffix);
@@ -358,48 +665,53 @@ static void fmtNum(char *buf, int bufsize, int num, int divisor, char *suffix)
 }
 
 
-static void outputLine(MaQueue *q, MprDirEntry *ep, cchar *path, int nameSize)
+/*
+ *  Format the display values for an item
+ */
+static void formatItem(MprCtx ctx, DirItem *item)
 {
-    MprFileInfo fileInfo;
-    Dir         *dir;
-    MprTime     when;
-    MaHost      *host;
-    char        newpath[MPR_MAX_FNAME], sizeBuf[16], timeBuf[48], *icon;
+    MprDirEntry *ep;
     struct tm   tm;
-    bool        isDir;
-    int         len;
-    cchar       *ext, *mimeType;
-    char        *dirSuffix;
     char        *months[] = { 
                     "Jan", "Feb", "Mar", "Apr", "May", "Jun",
                     "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" 
                 };
 
-    dir = q->stage->stageData;
+    ep = item->entry;
     if (ep->size >= (1024*1024*1024)) {
-        fmtNum(sizeBuf, sizeof(sizeBuf), (int) ep->size, 1024 * 1024 * 1024, "G");
+        fmtNum(item->size, sizeof(item->size), ep->size, 1024 * 1024 * 1024, "G");
 
     } else if (ep->size >= (1024*1024)) {
-        fmtNum(sizeBuf, sizeof(sizeBuf), (int) ep->size, 1024 * 1024, "M");
+        fmtNum(item->size, sizeof(item->size), ep->size, 1024 * 1024, "M");
 
     } else if (ep->size >= 1024) {
-        fmtNum(sizeBuf, sizeof(sizeBuf), (int) ep->size, 1024, "K");
+        fmtNum(item->size, sizeof(item->size), ep->size, 1024, "K");
 
     } else {
-        mprSprintf(sizeBuf, sizeof(sizeBuf), "%6d", (int) ep->size);
+        mprSprintf(item->size, sizeof(item->size), "%6d", (int) ep->size);
     }
 
-    mprSprintf(newpath, sizeof(newpath), "%s/%s", path, ep->name);
+    mprLocaltime(ctx, &tm, (MprTime) ep->lastModified * MPR_TICKS_PER_SEC);
+    mprSprintf(item->date, sizeof(item->date), "%02d-%3s-%4d %02d:%02d",
+        tm.tm_mday, months[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour,  tm.tm_min);
+}
 
-    if (mprGetFileInfo(q, newpath, &fileInfo) < 0) {
-        when = mprGetTime(q);
-        isDir = 0;
 
-    } else {
-        isDir = fileInfo.isDir ? 1 : 0;
-    }
+/*
+ *  Output one line. The name is written twice, so lines are assembled from strings rather than formatted.
+ */
+static void outputLine(MaQueue *q, MprBuf *buf, DirItem *item, int nameSize)
+{
+    DirRequest  *dr;
+    MprDirEntry *ep;
+    MaHost      *host;
+    cchar       *ext, *mimeType, *icon, *dirSuffix;
+    int         len;
+
+    dr = q->queueData;
+    ep = item->entry;
 
-    if (isDir) {
+    if (ep->isDir) {
         icon = "folder";
         dirSuffix = "/";
     } else {
@@ -419,77 +731,96 @@ static void outputLine(MaQueue *q, MprDirEntry *ep, cchar *path, int nameSize)
         dirSuffix = "";
     }
 
-    when = (MprTime) fileInfo.mtime * MPR_TICKS_PER_SEC;
-    mprLocaltime(q, &tm, when);
-
-    mprSprintf(timeBuf, sizeof(timeBuf), "%02d-%3s-%4d %02d:%02d",
-        tm.tm_mday, months[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour,  tm.tm_min);
-
-    len = (int) strlen(ep->name) + (int) strlen(dirSuffix);
-
-    if (dir->fancyIndexing == 2) {
-
-        maWrite(q, "<tr><td valign=\"top\">");
-        maWrite(q, "<img src=\"/icons/%s.gif\" alt=\"[   ]\", /></td>", icon);
-        maWrite(q, "<td><a href=\"%s%s\">%s%s</a></td>", ep->name, dirSuffix, ep->name, dirSuffix);
-        maWrite(q, "<td>%s</td><td>%s</td></tr>\r\n", timeBuf, sizeBuf);
-
-    } else if (dir->fancyIndexing == 1) {
-
-        maWrite(q, "<img src=\"/icons/%s.gif\" alt=\"[   ]\", /> ", icon);
-        maWrite(q, "<a href=\"%s%s\">%s%s</a>%-*s %17s %4s\r\n", ep->name, dirSuffix, ep->name, dirSuffix, nameSize - len, "", 
-            timeBuf, sizeBuf);
+    if (dr->fancyIndexing == 2) {
+        mprPutStringToBuf(buf, "<tr><td valign=\"top\"><img src=\"/icons/");
+        mprPutStringToBuf(buf, icon);
+        mprPutStringToBuf(buf, ".gif\" alt=\"[   ]\", /></td><td><a href=\"");
+        mprPutStringToBuf(buf, ep->name);
+        mprPutStringToBuf(buf, dirSuffix);
+        mprPutStringToBuf(buf, "\">");
+        mprPutStringToBuf(buf, ep->name);
+        mprPutStringToBuf(buf, dirSuffix);
+        mprPutStringToBuf(buf, "</a></td><td>");
+        mprPutStringToBuf(buf, item->date);
+        mprPutStringToBuf(buf, "</td><td>");
+        mprPutStringToBuf(buf, item->size);
+        mprPutStringToBuf(buf, "</td></tr>\r\n");
+
+    } else if (dr->fancyIndexing == 1) {
+        mprPutStringToBuf(buf, "<img src=\"/icons/");
+        mprPutStringToBuf(buf, icon);
+        mprPutStringToBuf(buf, ".gif\" alt=\"[   ]\", /> <a href=\"");
+        mprPutStringToBuf(buf, ep->name);
+        mprPutStringToBuf(buf, dirSuffix);
+        mprPutStringToBuf(buf, "\">");
+        mprPutStringToBuf(buf, ep->name);
+        mprPutStringToBuf(buf, dirSuffix);
+        mprPutStringToBuf(buf, "</a>");
+        for (len = (int) strlen(ep->name) + (int) strlen(dirSuffix); len < nameSize; len++) {
+            mprPutCharToBuf(buf, ' ');
+        }
+        mprPutCharToBuf(buf, ' ');
+        mprPutStringToBuf(buf, item->date);
+        mprPutCharToBuf(buf, ' ');
+        mprPutStringToBuf(buf, item->size);
+        mprPutStringToBuf(buf, "\r\n");
 
     } else {
-        maWrite(q, "<li><a href=\"%s%s\"> %s%s</a></li>\r\n", ep->name, dirSuffix, ep->name, dirSuffix);
+        mprPutStringToBuf(buf, "<li><a href=\"");
+        mprPutStringToBuf(buf, ep->name);
+        mprPutStringToBuf(buf, dirSuffix);
+        mprPutStringToBuf(buf, "\"> ");
+        mprPutStringToBuf(buf, ep->name);
+        mprPutStringToBuf(buf, dirSuffix);
+        mprPutStringToBuf(buf, "</a></li>\r\n");
     }
 }
 
 
-static void outputFooter(MaQueue *q)
+static void outputFooter(MaQueue *q, MprBuf *buf)
 {
     MaRequest   *req;
     MaConn      *conn;
     MprSocket   *sock;
-    Dir         *dir;
+    DirRequest  *dr;
+    cchar       *pattern, *sep;
     
     conn = q->conn;
     req = conn->request;
-    dir = q->stage->stageData;
+    dr = q->queueData;
     
-    if (dir->fancyIndexing == 2) {
-        maWrite(q, "<tr><th colspan=\"5\"><hr /></th></tr>\r\n</table>\r\n");
+    if (dr->fancyIndexing == 2) {
+        mprPutStringToBuf(buf, "<tr><th colspan=\"5\"><hr /></th></tr>\r\n</table>\r\n");
         
-    } else if (dir->fancyIndexing == 1) {
-        maWrite(q, "<hr /></pre>\r\n");
+    } else if (dr->fancyIndexing == 1) {
+        mprPutStringToBuf(buf, "<hr /></pre>\r\n");
     } else {
-        maWrite(q, "</ul>\r\n");
+        mprPutStringToBuf(buf, "</ul>\r\n");
     }
-    
-    sock = conn->sock->listenSock;
-    maWrite(q, "<address>%s %s at %s Port %d</address>\r\n", BLD_NAME, BLD_VERSION, sock->ipAddr, sock->port);
-    maWrite(q, "</body></html>\r\n");
-}
-
-
-static void filterDirList(MaConn *conn, MprList *list)
-{
-    Dir             *dir;
-    MprDirEntry     *dp;
-    int             next;
 
-    dir = conn->response->handler->stageData;
-    
-    /*
-     *  Do pattern matching. Entries that don't match, free the name to mark
-     */
-    for (next = 0; (dp = mprGetNextItem(list, &next)) != 0; ) {
-        if (! match(dir->pattern, dp->name)) {
-            mprRemoveItem(list, dp);
-            mprFree(dp);
-            next--;
+    if (dr->limit > 0 && dr->listing) {
+        /*
+         *  Links to the adjacent pages
+         */
+        sep = (dr->pattern) ? ";P=" : "";
+        pattern = (dr->pattern) ? dr->pattern : "";
+        mprPutStringToBuf(buf, "<p>");
+        if (dr->start > 0) {
+            mprPutFmtToBuf(buf, "<a href=\"?C=%c;O=%c;F=%d%s%s;start=%d;count=%d\">Previous</a> ", 
+                "NNMS"[dr->sortKey], (dr->sortOrder > 0) ? 'A' : 'D', dr->fancyIndexing, sep, pattern, 
+                max(dr->start - dr->limit, 0), dr->limit);
+        }
+        if (dr->pos < dr->listing->count) {
+            mprPutFmtToBuf(buf, "<a href=\"?C=%c;O=%c;F=%d%s%s;start=%d;count=%d\">Next</a>", 
+                "NNMS"[dr->sortKey], (dr->sortOrder > 0) ? 'A' : 'D', dr->fancyIndexing, sep, pattern, 
+                dr->start + dr->limit, dr->limit);
         }
+        mprPutStringToBuf(buf, "</p>\r\n");
     }
+    
+    sock = conn->sock->listenSock;
+    mprPutFmtToBuf(buf, "<address>%s %s at %s Port %d</address>\r\n", BLD_NAME, BLD_VERSION, sock->ipAddr, sock->port);
+    mprPutStringToBuf(buf, "</body></html>\r\n");
 }
 
 
@@ -656,10 +987,16 @@ MprModule *maDirHandlerInit(MaHttp *http, cchar *path)
 
     handler->match = matchDir; 
     handler->run = runDir; 
+    handler->close = closeDir; 
+    handler->outgoingService = outgoingDirService; 
     handler->parse = parseDir; 
 
     handler->stageData = dir = mprAllocObjZeroed(handler, Dir);
     dir->sortOrder = 1;
+    dir->cache = mprCreateHash(dir, MA_DIR_CACHE_SIZE * 2);
+#if BLD_FEATURE_MULTITHREAD
+    dir->mutex = mprCreateLock(dir);
+#endif
     http->dirHandler = handler;
 
     return module;
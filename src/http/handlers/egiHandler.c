@@ -26,16 +26,26 @@ static void printQueryData(MaQueue *q);
 static void printBodyData(MaQueue *q);
 #endif
 
+/**************************** Forward Declarations ****************************/
+
+static void finishEgi(MaQueue *q);
+static void lock(MaEgi *egi);
+static void resumeEgi(MaEgiRequest *er, MprEvent *event);
+static void scheduleResume(MaEgiRequest *er);
+static void transferEgiData(MaQueue *q, MprBuf *buf);
+static void unlock(MaEgi *egi);
+
 /************************************* Code ***********************************/
 /*
- *  This runs when all input data has been received. The egi form must write all the data.
- *  It currently does not support forms that return before writing all the data.
+ *  This runs when all input data has been received. The egi form must write all the data unless it suspends the 
+ *  request via maSuspendEgi, in which case the request is finished later by maCompleteEgi.
  */
 static void runEgi(MaQueue *q)
 {
     MaConn          *conn;
     MaRequest       *req;
     MaEgiForm       *form;
+    MaEgiRequest    *er;
     MaEgi           *egi;
 
     conn = q->conn;
@@ -52,11 +62,293 @@ static void runEgi(MaQueue *q)
         
     } else {
         (*form)(q);
+        if ((er = (MaEgiRequest*) q->queueData) != 0) {
+            /*
+             *  The form suspended the request. Any data written or completion while the form was running is 
+             *  transferred once this thread has released the pipeline.
+             */
+            lock(egi);
+            er->flags &= ~MA_EGI_RUNNING;
+            if (mprGetBufLength(er->pending) > 0 || er->flags & MA_EGI_COMPLETE) {
+                scheduleResume(er);
+            }
+            unlock(egi);
+            return;
+        }
     }
     maPutForService(q, maCreateEndPacket(conn), 1);
 }
 
 
+/*
+ *  Close the handler. If the request is suspended, detach it so later writes and completion from the form are ignored.
+ *  The handle is freed here only if the form has already completed it.
+ */
+static void closeEgi(MaQueue *q)
+{
+    MaEgiRequest    *er;
+    MaEgi           *egi;
+
+    if ((er = (MaEgiRequest*) q->queueData) == 0) {
+        return;
+    }
+    egi = er->egi;
+    lock(egi);
+    er->q = 0;
+    q->queueData = 0;
+    if (er->flags & MA_EGI_COMPLETE && er->resume == 0) {
+        mprFree(er);
+    }
+    unlock(egi);
+}
+
+
+/*
+ *  User API to suspend a request. The form returns without finishing the response and the thread is released.
+ */
+MaEgiRequest *maSuspendEgi(MaQueue *q, int timeout)
+{
+    MaConn          *conn;
+    MaEgiRequest    *er;
+    MaEgi           *egi;
+
+    conn = q->conn;
+    egi = (MaEgi*) q->stage->stageData;
+
+    if (q->queueData || conn->requestFailed) {
+        return 0;
+    }
+    /*
+     *  The handle is owned by the handler and not the request as it may outlive the request.
+     */
+    if ((er = mprAllocObjZeroed(egi, MaEgiRequest)) == 0) {
+        return 0;
+    }
+    er->egi = egi;
+    er->conn = conn;
+    er->q = q;
+    er->flags = MA_EGI_RUNNING;
+    er->pending = mprCreateBuf(er, MPR_BUFSIZE, -1);
+    q->queueData = er;
+
+    /*
+     *  The host timer enforces the deadline. See maProcessWriteEvent.
+     */
+    if (timeout <= 0) {
+        timeout = conn->host->timeout;
+    }
+    conn->deadline = mprGetTime(conn) + timeout;
+    return er;
+}
+
+
+/*
+ *  User API to write data to a suspended request. This may be called from any thread.
+ */
+int maWriteEgiBlock(MaEgiRequest *er, cchar *buf, int len)
+{
+    MaEgi       *egi;
+    int         rc;
+
+    egi = er->egi;
+    lock(egi);
+    if (er->q == 0 || er->flags & MA_EGI_COMPLETE) {
+        unlock(egi);
+        return MPR_ERR_CANT_WRITE;
+    }
+    rc = mprPutBlockToBuf(er->pending, buf, len);
+    scheduleResume(er);
+    unlock(egi);
+    return rc;
+}
+
+
+int maWriteEgi(MaEgiRequest *er, cchar *fmt, ...)
+{
+    va_list     vargs;
+    char        *buf;
+    int         len, rc;
+
+    va_start(vargs, fmt);
+    len = mprAllocVsprintf(er, &buf, -1, fmt, vargs);
+    va_end(vargs);
+
+    rc = maWriteEgiBlock(er, buf, len);
+    mprFree(buf);
+    return rc;
+}
+
+
+/*
+ *  User API to complete a suspended request. This may be called from any thread. The handle is invalid after this call.
+ */
+int maCompleteEgi(MaEgiRequest *er, int status)
+{
+    MaEgi       *egi;
+
+    egi = er->egi;
+    lock(egi);
+    if (er->flags & MA_EGI_COMPLETE) {
+        unlock(egi);
+        return MPR_ERR_BAD_STATE;
+    }
+    er->flags |= MA_EGI_COMPLETE;
+    er->status = status;
+    if (er->q == 0) {
+        /*
+         *  The request has already been closed (timeout or client disconnect)
+         */
+        if (er->resume == 0) {
+            mprFree(er);
+        }
+        unlock(egi);
+        return MPR_ERR_ABORTED;
+    }
+    scheduleResume(er);
+    unlock(egi);
+    return 0;
+}
+
+
+/*
+ *  Schedule an event to run the pipeline for a suspended request. Must be called locked with the request open. 
+ *  Deferred while the form is still running in runEgi. The event is owned by the handle and holds the connection.
+ */
+static void scheduleResume(MaEgiRequest *er)
+{
+    if (!(er->flags & MA_EGI_RUNNING) && er->resume == 0) {
+        maHoldConn(er->conn);
+        er->resume = mprCreateEvent(er, (MprEventProc) resumeEgi, 0, MPR_NORMAL_PRIORITY, er, 0);
+        if (er->resume == 0) {
+            maReleaseConn(er->conn);
+        }
+    }
+}
+
+
+/*
+ *  Transfer data written by the form to the pipeline and finish the request if the form has completed it.
+ *  This runs from the event loop. The connection is locked first so the request can't be closed underneath, e.g. by
+ *  a request timeout.
+ */
+static void resumeEgi(MaEgiRequest *er, MprEvent *event)
+{
+    MaConn      *conn;
+    MaQueue     *q;
+    MaEgi       *egi;
+    int         complete, status;
+
+    egi = er->egi;
+    conn = er->conn;
+    maLockConn(conn);
+    lock(egi);
+    mprFree(event);
+    er->resume = 0;
+
+    if ((q = er->q) == 0) {
+        if (er->flags & MA_EGI_COMPLETE) {
+            mprFree(er);
+        }
+        unlock(egi);
+        maUnlockConn(conn);
+        maReleaseConn(conn);
+        return;
+    }
+    transferEgiData(q, er->pending);
+
+    complete = er->flags & MA_EGI_COMPLETE;
+    status = er->status;
+    if (complete) {
+        q->queueData = 0;
+        mprFree(er);
+    }
+    unlock(egi);
+
+    if (complete) {
+        conn->deadline = 0;
+        if (status) {
+            maFailRequest(conn, status, "Egi form failed to complete the request");
+        }
+        finishEgi(q);
+    } else {
+        maServiceQueues(conn);
+        maEnableBackendWrites(conn);
+    }
+    maUnlockConn(conn);
+    maReleaseConn(conn);
+}
+
+
+/*
+ *  Move pending data into packets on the handler queue. Packets are sized to match the chunk size so downstream
+ *  stages can send them without coalescing.
+ */
+static void transferEgiData(MaQueue *q, MprBuf *buf)
+{
+    MaConn      *conn;
+    MaResponse  *resp;
+    MaPacket    *packet;
+    int         len, packetSize;
+
+    conn = q->conn;
+    resp = conn->response;
+    packetSize = (resp->chunkSize > 0) ? resp->chunkSize : q->max;
+
+    while ((len = mprGetBufLength(buf)) > 0) {
+        len = min(len, packetSize);
+        if ((packet = maCreateDataPacket(conn, len)) == 0) {
+            break;
+        }
+        mprPutBlockToBuf(packet->content, mprGetBufStart(buf), len);
+        packet->count = len;
+        mprAdjustBufStart(buf, len);
+        maPutForService(q, packet, 1);
+    }
+    mprFlushBuf(buf);
+}
+
+
+/*
+ *  Write the end of the response and cycle the pipeline. This mirrors the tail of a synchronous request.
+ */
+static void finishEgi(MaQueue *q)
+{
+    MaConn      *conn;
+
+    conn = q->conn;
+    maPutForService(q, maCreateEndPacket(conn), 1);
+    maServiceQueues(conn);
+
+    if (conn->state == MPR_HTTP_STATE_COMPLETE) {
+        /*
+         *  Issue a dummy read event to cycle through the last stage of the request pipeline. This will complete
+         *  the request and cleanup. WARNING - the request will be deleted after this.
+         */
+        maProcessReadEvent(conn, 0);
+        maAwakenConn(conn);
+
+    } else {
+        maEnableBackendWrites(conn);
+    }
+}
+
+
+static void lock(MaEgi *egi)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(egi->mutex);
+#endif
+}
+
+
+static void unlock(MaEgi *egi)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(egi->mutex);
+#endif
+}
+
+
 /*
  *  User API to define a form
  */
@@ -98,9 +390,13 @@ MprModule *maEgiHandlerInit(MaHttp *http, cchar *path)
     http->egiHandler = handler;
 
     handler->run = runEgi; 
+    handler->close = closeEgi; 
 
     handler->stageData = egi = mprAllocObjZeroed(handler, MaEgi);
     egi->forms = mprCreateHash(egi, MA_EGI_HASH_SIZE);
+#if BLD_FEATURE_MULTITHREAD
+    egi->mutex = mprCreateLock(egi);
+#endif
 
 #if EGI_TEST
     egiTestInit(http, path);
@@ -132,6 +428,140 @@ static void bigTest(MaQueue *q)
 }
 
 
+/*
+ *  Complete a suspended request from a timer. This runs long after the form has returned.
+ */
+static void asyncComplete(MaEgiRequest *er, MprEvent *event)
+{
+    mprFree(event);
+    maWriteEgi(er, "<p>RESULT=done</p>\r\n");
+    maCompleteEgi(er, 0);
+}
+
+
+static void asyncTest(MaQueue *q)
+{
+    MaEgiRequest    *er;
+
+    if ((er = maSuspendEgi(q, 0)) != 0) {
+        maWriteEgi(er, "<p>STATE=started</p>\r\n");
+        mprCreateTimerEvent(er, (MprEventProc) asyncComplete, 200, MPR_NORMAL_PRIORITY, er, 0);
+    }
+}
+
+
+/*
+ *  The request times out before the form completes it
+ */
+static void asyncTimeoutTest(MaQueue *q)
+{
+    MaEgiRequest    *er;
+
+    if ((er = maSuspendEgi(q, 1000)) != 0) {
+        mprCreateTimerEvent(er, (MprEventProc) asyncComplete, 5000, MPR_NORMAL_PRIORITY, er, 0);
+    }
+}
+
+
+/*
+ *  Write many small packets and complete the request later. The chunk filter should coalesce the packets and its flush
+ *  timer should send them long before the request completes. With "flush", the first packet is flushed on its own.
+ */
+static void chunkTest(MaQueue *q)
+{
+    MaConn          *conn;
+    MaEgiRequest    *er;
+    MaPacket        *packet;
+    int             i, flush;
+
+    conn = q->conn;
+    flush = maGetFormVar(conn, "flush", 0) != 0;
+
+    for (i = 0; i < 50; i++) {
+        if ((packet = maCreateDataPacket(conn, 10)) == 0) {
+            return;
+        }
+        mprPutBlockToBuf(packet->content, "0123456789", 10);
+        packet->count = 10;
+        maPutForService(q, packet, 1);
+        if (flush && i == 0) {
+            maFlushQueue(q);
+        }
+    }
+    if ((er = maSuspendEgi(q, 0)) != 0) {
+        mprCreateTimerEvent(er, (MprEventProc) asyncComplete, 1000, MPR_NORMAL_PRIORITY, er, 0);
+    }
+}
+
+
+/*
+ *  Stream state for chunkStreamTest
+ */
+typedef struct ChunkStream {
+    MaEgiRequest    *er;
+    int             tick;
+    int             offset;
+} ChunkStream;
+
+#define CHUNK_STREAM_TICKS      40
+#define CHUNK_STREAM_PERIOD     40
+#define CHUNK_STREAM_BIG        ((32 * 1024) + 37)
+#define CHUNK_STREAM_SMALL      100
+
+/*
+ *  Write the next block of the stream. Blocks alternate between a large block that fills the client socket and leaves
+ *  a partial chunk, and a small block that arrives after the chunk filter flush timer has fired. The body is the 
+ *  alphabet repeated so the client can verify it.
+ */
+static void chunkStreamWrite(ChunkStream *cs, MprEvent *event)
+{
+    MaEgiRequest    *er;
+    char            *buf;
+    int             i, len, rc;
+
+    mprFree(event);
+    er = cs->er;
+    len = (cs->tick & 1) ? CHUNK_STREAM_SMALL : CHUNK_STREAM_BIG;
+    if ((buf = mprAlloc(cs, len)) == 0) {
+        maCompleteEgi(er, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR);
+        return;
+    }
+    for (i = 0; i < len; i++) {
+        buf[i] = 'a' + (cs->offset + i) % 26;
+    }
+    cs->offset += len;
+    rc = maWriteEgiBlock(er, buf, len);
+    mprFree(buf);
+
+    if (rc < 0) {
+        maCompleteEgi(er, MPR_HTTP_CODE_COMMS_ERROR);
+    } else if (++cs->tick >= CHUNK_STREAM_TICKS) {
+        maCompleteEgi(er, 0);
+    } else {
+        mprCreateTimerEvent(er, (MprEventProc) chunkStreamWrite, CHUNK_STREAM_PERIOD, MPR_NORMAL_PRIORITY, cs, 0);
+    }
+}
+
+
+/*
+ *  Stream a body of about 650K over a couple of seconds. Used to test chunking while the client reads slowly.
+ */
+static void chunkStreamTest(MaQueue *q)
+{
+    MaEgiRequest    *er;
+    ChunkStream     *cs;
+
+    if ((er = maSuspendEgi(q, 0)) != 0) {
+        if ((cs = mprAllocObjZeroed(er, ChunkStream)) == 0) {
+            maCompleteEgi(er, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR);
+            return;
+        }
+        cs->er = er;
+        mprCreateTimerEvent(er, (MprEventProc) chunkStreamWrite, 0, MPR_NORMAL_PRIORITY, cs, 0);
+    }
+}
+
+
 static void printVars(MaQueue *q)
 {
     MaConn      *conn;
@@ -400,6 +830,10 @@ static int egiTestInit(MaHttp *http, cchar *path)
     maDefineEgiForm(http, "/egi/test", simpleTest);
     maDefineEgiForm(http, "/test.egi", simpleTest);
     maDefineEgiForm(http, "/big.egi", bigTest);
+    maDefineEgiForm(http, "/egi/async", asyncTest);
+    maDefineEgiForm(http, "/egi/asyncTimeout", asyncTimeoutTest);
+    maDefineEgiForm(http, "/egi/chunk", chunkTest);
+    maDefineEgiForm(http, "/egi/chunkStream", chunkStreamTest);
 
     return 0;
 }
@@ -0,0 +1,1264 @@
+/*
+ *  fastcgiHandler.c -- FastCGI Handler
+ *
+ *  Forward requests to long-lived FastCGI responders. Responders are either spawned locally as a pool of workers
+ *  sharing a listening Unix socket, or are external processes reached over a Unix socket. Connections to responders
+ *  are kept alive and reused for subsequent requests. Requests are multiplexed onto idle connections and wait when
+ *  all connections are busy. Request and response bodies are streamed through the queue pipeline. Crashed workers
+ *  are restarted.
+ *
+ *  Copyright (c) All Rights Reserved. See copyright notice at the bottom of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "http.h"
+
+#if BLD_FEATURE_FASTCGI && BLD_UNIX_LIKE
+
+#include    <sys/un.h>
+#if LINUX
+#include    <sys/prctl.h>
+#endif
+
+/*********************************** Locals ***********************************/
+/*
+ *  FastCGI protocol definitions
+ */
+#define FCGI_VERSION            1
+#define FCGI_HEADER_LEN         8
+#define FCGI_MAX_CONTENT        65535
+#define FCGI_BEGIN_REQUEST      1
+#define FCGI_ABORT_REQUEST      2
+#define FCGI_END_REQUEST        3
+#define FCGI_PARAMS             4
+#define FCGI_STDIN              5
+#define FCGI_STDOUT             6
+#define FCGI_STDERR             7
+#define FCGI_RESPONDER          1
+#define FCGI_KEEP_CONN          1
+#define FCGI_REQUEST_COMPLETE   0
+
+/*
+ *  Each connection services one request at a time, so the request ID is constant
+ */
+#define FCGI_REQUEST_ID         1
+
+/*
+ *  Request flags
+ */
+#define FCGI_SEEN_HEADER        0x1         /* Response header parsed */
+#define FCGI_INPUT_DONE         0x2         /* All request body data received from the client */
+#define FCGI_STDIN_CLOSED       0x4         /* Empty stdin record written to the responder */
+#define FCGI_COMPLETE           0x8         /* End request record received */
+#define FCGI_SENT_BODY          0x10        /* Some body data has been written to the responder */
+#define FCGI_RECEIVED           0x20        /* Some response data has been received */
+#define FCGI_BLOCKED            0x40        /* Client queue is full. Waiting for outgoingFastCgiService */
+
+/*
+ *  Responder pool for a location
+ */
+typedef struct FastCgi {
+    MaBackendPool   pool;                   /* Connection pool. Must be first */
+    char            *program;               /* Responder program to spawn. Null for external responders */
+    char            *path;                  /* Unix socket path */
+    int             listenFd;               /* Listening socket handed to spawned workers on descriptor zero */
+    int             workers;                /* Number of workers to spawn */
+    int             *pids;                  /* Worker process IDs */
+    int             restarts;               /* Number of worker restarts */
+    int             maxConnections;         /* Maximum connections to the responders */
+    int             numConnections;         /* Current number of connections */
+    MprList         *idle;                  /* Idle keep-alive connections */
+    MprEvent        *timer;                 /* Worker health check timer */
+} FastCgi;
+
+/*
+ *  Connection to a responder
+ */
+typedef struct FastCgiConn {
+    MaBackend       backend;                /* Backend connection. Must be first */
+    FastCgi         *fcgi;                  /* Owning pool */
+    int             fd;                     /* Socket to the responder */
+    int             mask;                   /* Current I/O event mask */
+    MprBuf          *input;                 /* Records read from the responder */
+    MprBuf          *output;                /* Records waiting to be written to the responder */
+    struct FastCgiRequest *req;             /* Request being serviced */
+} FastCgiConn;
+
+/*
+ *  State for a request
+ */
+typedef struct FastCgiRequest {
+    MaQueue         *q;                     /* Handler send queue */
+    FastCgi         *fcgi;                  /* Responder pool */
+    FastCgiConn     *fc;                    /* Connection servicing the request */
+    MprBuf          *header;                /* Response header being accumulated */
+    MprBuf          *pending;               /* Response data waiting for the client queue to drain */
+    int             flags;                  /* Request flags */
+    int             retries;                /* Retries on stale keep-alive connections */
+    MaConnEvent     *resume;                /* Event to resume processing outside the pipeline */
+    MaPoolEvent     *start;                 /* Event to start the request when a connection is available */
+} FastCgiRequest;
+
+/*********************************** Forwards *********************************/
+
+static FastCgiConn *acquireConn(FastCgi *fcgi);
+static void bindRequest(FastCgiRequest *fr, bool first);
+static void closeConn(FastCgiConn *fc);
+static void connError(FastCgiConn *fc, cchar *msg);
+static FastCgiConn *connectResponder(FastCgi *fcgi, FastCgiRequest *fr);
+static void failRequest(FastCgiRequest *fr, int code, cchar *msg);
+static void fastcgiEvent(FastCgiConn *fc, int mask, int isPoolThread);
+static void finishRequest(FastCgiRequest *fr);
+static int  flushConn(FastCgiConn *fc);
+static bool parseHeader(FastCgiRequest *fr);
+static void processInput(FastCgiConn *fc);
+static void pushInput(FastCgiRequest *fr);
+static void readConn(FastCgiConn *fc);
+static void releaseConn(FastCgiConn *fc);
+static void resumeRequest(MaConn *conn, FastCgiRequest *fr);
+static void scheduleResume(FastCgiRequest *fr);
+static void setConnEvents(FastCgiConn *fc, int mask);
+static void startRequest(FastCgiRequest *fr, FastCgiConn *fc);
+static void startWaiting(FastCgi *fcgi);
+static void startWaitingRequest(MaConn *conn, FastCgiRequest *fr);
+static int  startWorkers(FastCgi *fcgi);
+
+/************************************* Code ***********************************/
+/*
+ *  Open this handler instance for a new request
+ */
+static void openFastCgi(MaQueue *q)
+{
+    MaRequest       *req;
+    MaResponse      *resp;
+    MaConn          *conn;
+    FastCgi         *fcgi;
+    FastCgiRequest  *fr;
+
+    conn = q->conn;
+    req = conn->request;
+    resp = conn->response;
+
+    maSetHeader(conn, 0, "Last-Modified", req->host->currentDate);
+    maDontCacheResponse(conn);
+    maPutForService(q, maCreateHeaderPacket(conn), 0);
+
+    fcgi = (req->location->handler == resp->handler) ? (FastCgi*) req->location->handlerData : 0;
+    if (fcgi == 0) {
+        maFailRequest(conn, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "No FastCGI responder defined for %s", req->url);
+        return;
+    }
+    fr = mprAllocObjZeroed(resp, FastCgiRequest);
+    fr->q = q;
+    fr->fcgi = fcgi;
+    fr->header = mprCreateBuf(fr, MPR_BUFSIZE, conn->http->limits.maxHeader);
+    fr->pending = mprCreateBuf(fr, MPR_BUFSIZE, -1);
+    q->queueData = fr;
+
+    mprLock(fcgi->pool.mutex);
+    if (fcgi->program && fcgi->listenFd < 0 && startWorkers(fcgi) < 0) {
+        mprUnlock(fcgi->pool.mutex);
+        maFailRequest(conn, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "Can't start FastCGI responder %s", fcgi->program);
+        return;
+    }
+    mprUnlock(fcgi->pool.mutex);
+    bindRequest(fr, 0);
+}
+
+
+/*
+ *  Close the handler. If the request is still bound to a connection, the response is incomplete and the responder
+ *  is still producing output, so the connection can't be reused.
+ */
+static void closeFastCgi(MaQueue *q)
+{
+    FastCgiRequest  *fr;
+    FastCgi         *fcgi;
+    FastCgiConn     *fc;
+
+    if ((fr = (FastCgiRequest*) q->queueData) == 0) {
+        return;
+    }
+    q->queueData = 0;
+    fcgi = fr->fcgi;
+    maCancelConnEvent(fr->resume);
+
+    mprLock(fcgi->pool.mutex);
+    maCancelPoolEvent(fr->start);
+    if (mprGetListCount(fcgi->pool.waiting) > 0) {
+        mprRemoveItem(fcgi->pool.waiting, fr);
+    }
+    if ((fc = fr->fc) != 0) {
+        fr->fc = 0;
+        fc->req = 0;
+        fc->backend.conn = 0;
+    }
+    mprUnlock(fcgi->pool.mutex);
+
+    if (fc) {
+        mprLog(q, 4, "FastCGI: closing connection for incomplete request");
+        closeConn(fc);
+        startWaiting(fcgi);
+    }
+}
+
+
+/*
+ *  Accept a new packet of data destined for the browser. The header packet is queued until the responder's response
+ *  header has been parsed.
+ */
+static void outgoingFastCgiData(MaQueue *q, MaPacket *packet)
+{
+    maPutForService(q, packet, 0);
+}
+
+
+/*
+ *  Service outgoing data destined for the browser. When the queue drains, resume processing the responder output.
+ *  This is like enabling I/O events for the CGI handler. As the responder data may already be buffered, an event is
+ *  scheduled to process it rather than doing so while the pipeline is being serviced.
+ */
+static void outgoingFastCgiService(MaQueue *q)
+{
+    FastCgiRequest  *fr;
+
+    fr = (FastCgiRequest*) q->queueData;
+
+    maDefaultOutgoingServiceStage(q);
+
+    if (fr && (fr->flags & FCGI_BLOCKED) && q->count < q->low) {
+        fr->flags &= ~FCGI_BLOCKED;
+        scheduleResume(fr);
+    }
+}
+
+
+static void scheduleResume(FastCgiRequest *fr)
+{
+    if (fr->resume == 0) {
+        fr->resume = maCreateConnEvent(fr->q->conn, (MaConnEventProc) resumeRequest, 0, fr);
+    }
+}
+
+
+/*
+ *  Write pending response data and resume reading from the responder. Completes the request if the responder has
+ *  finished. Runs with the client connection locked. The event is cancelled if the handler is closed first.
+ */
+static void resumeRequest(MaConn *conn, FastCgiRequest *fr)
+{
+    FastCgi         *fcgi;
+    FastCgiConn     *fc;
+    int             len;
+
+    fr->resume = 0;
+
+    if ((len = mprGetBufLength(fr->pending)) > 0) {
+        mprAdjustBufStart(fr->pending, maWriteBackendData(fr->q, mprGetBufStart(fr->pending), len));
+        if (mprGetBufLength(fr->pending) > 0) {
+            fr->flags |= FCGI_BLOCKED;
+            return;
+        }
+        mprFlushBuf(fr->pending);
+    }
+    if ((fc = fr->fc) != 0) {
+        fcgi = fc->fcgi;
+        maHoldBackend(&fc->backend);
+        setConnEvents(fc, fc->mask | MPR_READABLE);
+        processInput(fc);
+        maReleaseBackend(&fc->backend);
+        startWaiting(fcgi);
+
+    } else if (fr->flags & FCGI_COMPLETE) {
+        finishRequest(fr);
+    }
+}
+
+
+/*
+ *  Accept incoming body data from the browser destined for the responder
+ */
+static void incomingFastCgiData(MaQueue *q, MaPacket *packet)
+{
+    MaConn          *conn;
+    MaRequest       *req;
+    FastCgiRequest  *fr;
+
+    conn = q->conn;
+    req = conn->request;
+
+    if ((fr = (FastCgiRequest*) q->pair->queueData) == 0) {
+        return;
+    }
+    if (packet->count == 0) {
+        if (req->remainingContent > 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_BAD_REQUEST, "Client supplied insufficient body data");
+        }
+    } else {
+        /*
+         *  No service routine. Packets are queued here until pushInput can write them to the responder.
+         */
+        maPutForService(q, packet, 0);
+    }
+    pushInput(fr);
+}
+
+
+/*
+ *  Run after all incoming data has been received. Close the responder's stdin stream.
+ */
+static void runFastCgi(MaQueue *q)
+{
+    MaConn          *conn;
+    FastCgiRequest  *fr;
+
+    conn = q->conn;
+    fr = (FastCgiRequest*) q->queueData;
+
+    if (fr) {
+        fr->flags |= FCGI_INPUT_DONE;
+        pushInput(fr);
+    }
+    if (conn->requestFailed) {
+        maPutForService(q, maCreateEndPacket(conn), 1);
+    }
+}
+
+
+/*
+ *  Append a record to a buffer
+ */
+static void putRecord(MprBuf *buf, int type, cchar *data, int len)
+{
+    uchar   header[FCGI_HEADER_LEN];
+
+    mprAssert(len <= FCGI_MAX_CONTENT);
+
+    header[0] = FCGI_VERSION;
+    header[1] = (uchar) type;
+    header[2] = (FCGI_REQUEST_ID >> 8) & 0xFF;
+    header[3] = FCGI_REQUEST_ID & 0xFF;
+    header[4] = (len >> 8) & 0xFF;
+    header[5] = len & 0xFF;
+    header[6] = 0;
+    header[7] = 0;
+    mprPutBlockToBuf(buf, (char*) header, FCGI_HEADER_LEN);
+    if (len > 0) {
+        mprPutBlockToBuf(buf, data, len);
+    }
+}
+
+
+/*
+ *  Append a stream of data as a sequence of records
+ */
+static void putStream(MprBuf *buf, int type, cchar *data, int len)
+{
+    int     count;
+
+    while (len > 0) {
+        count = min(len, FCGI_MAX_CONTENT);
+        putRecord(buf, type, data, count);
+        data += count;
+        len -= count;
+    }
+}
+
+
+/*
+ *  Encode a name/value length. Lengths over 127 bytes use four bytes with the high bit set.
+ */
+static void putLength(MprBuf *buf, int len)
+{
+    if (len < 0x80) {
+        mprPutCharToBuf(buf, len);
+    } else {
+        mprPutCharToBuf(buf, ((len >> 24) & 0x7F) | 0x80);
+        mprPutCharToBuf(buf, (len >> 16) & 0xFF);
+        mprPutCharToBuf(buf, (len >> 8) & 0xFF);
+        mprPutCharToBuf(buf, len & 0xFF);
+    }
+}
+
+
+/*
+ *  Write the begin request and parameter records for a request bound to a connection
+ */
+static void startRequest(FastCgiRequest *fr, FastCgiConn *fc)
+{
+    MaConn      *conn;
+    MaRequest   *req;
+    MprHash     *hp;
+    MprBuf      *params;
+    char        begin[8];
+    int         keyLen, valueLen;
+
+    conn = fr->q->conn;
+    req = conn->request;
+
+    fr->flags &= ~FCGI_STDIN_CLOSED;
+
+    memset(begin, 0, sizeof(begin));
+    begin[1] = FCGI_RESPONDER;
+    begin[2] = FCGI_KEEP_CONN;
+    putRecord(fc->output, FCGI_BEGIN_REQUEST, begin, sizeof(begin));
+
+    /*
+     *  The request headers hold the CGI environment variables created for this handler
+     */
+    params = mprCreateBuf(fr, MPR_BUFSIZE, -1);
+    for (hp = mprGetFirstHash(req->headers); hp; hp = mprGetNextHash(req->headers, hp)) {
+        if (hp->data) {
+            keyLen = (int) strlen(hp->key);
+            valueLen = (int) strlen((char*) hp->data);
+            putLength(params, keyLen);
+            putLength(params, valueLen);
+            mprPutBlockToBuf(params, hp->key, keyLen);
+            mprPutBlockToBuf(params, (char*) hp->data, valueLen);
+        }
+    }
+    putStream(fc->output, FCGI_PARAMS, mprGetBufStart(params), mprGetBufLength(params));
+    putRecord(fc->output, FCGI_PARAMS, 0, 0);
+    mprFree(params);
+
+    mprLog(fr->q, 5, "FastCGI: start request %s on fd %d", req->url, fc->fd);
+    pushInput(fr);
+}
+
+
+/*
+ *  Write queued body data to the responder as stdin records. Data is only taken from the queue while the connection
+ *  output buffer is below the queue packet size. If the socket is full, this is called again when it is writeable.
+ */
+static void pushInput(FastCgiRequest *fr)
+{
+    FastCgiConn     *fc;
+    MaQueue         *q;
+    MaPacket        *packet;
+    MprBuf          *buf;
+
+    if ((fc = fr->fc) == 0 || fr->q->conn->requestFailed) {
+        return;
+    }
+    /*
+     *  The receive queue only exists if the request has a body
+     */
+    q = fr->q->pair;
+
+    do {
+        while (q && mprGetBufLength(fc->output) < MA_BUFSIZE && (packet = maGet(q)) != 0) {
+            buf = packet->content;
+            if (buf && mprGetBufLength(buf) > 0) {
+                putStream(fc->output, FCGI_STDIN, mprGetBufStart(buf), mprGetBufLength(buf));
+                fr->flags |= FCGI_SENT_BODY;
+            }
+            mprFree(packet);
+        }
+        if ((fr->flags & FCGI_INPUT_DONE) && !(fr->flags & FCGI_STDIN_CLOSED) && (q == 0 || q->first == 0)) {
+            putRecord(fc->output, FCGI_STDIN, 0, 0);
+            fr->flags |= FCGI_STDIN_CLOSED;
+        }
+        /*
+         *  Stop if the socket is full or the connection failed. The connection may have been freed on errors.
+         */
+        if (flushConn(fc) != 0) {
+            break;
+        }
+    } while (q && q->first);
+}
+
+
+/*
+ *  Write buffered records to the responder. Returns zero if all data was written.
+ */
+static int flushConn(FastCgiConn *fc)
+{
+    MprBuf      *buf;
+    int         len, rc;
+
+    if (fc->fd < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+    buf = fc->output;
+    while ((len = mprGetBufLength(buf)) > 0) {
+        rc = write(fc->fd, mprGetBufStart(buf), len);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                setConnEvents(fc, fc->mask | MPR_WRITEABLE);
+                return 1;
+            }
+            connError(fc, "Can't write to FastCGI responder");
+            return MPR_ERR_CANT_WRITE;
+        }
+        mprAdjustBufStart(buf, rc);
+    }
+    mprFlushBuf(buf);
+    setConnEvents(fc, (fc->mask & ~MPR_WRITEABLE) | MPR_READABLE);
+    return 0;
+}
+
+
+static void setConnEvents(FastCgiConn *fc, int mask)
+{
+    if (fc->mask != mask && fc->backend.handler) {
+        fc->mask = mask;
+        mprSetWaitInterest(fc->backend.handler, mask);
+    }
+}
+
+
+/*
+ *  I/O event callback for responder connections. The request pipeline is only touched with the client connection
+ *  locked. Releasing the connection may make it available to waiting requests.
+ */
+static void fastcgiEvent(FastCgiConn *fc, int mask, int isPoolThread)
+{
+    FastCgi     *fcgi;
+    MaConn      *conn;
+
+    fcgi = fc->fcgi;
+    conn = maLockBackendConn(&fc->backend);
+    if ((mask & MPR_WRITEABLE) && flushConn(fc) >= 0 && fc->req) {
+        pushInput(fc->req);
+    }
+    if ((mask & MPR_READABLE) && fc->fd >= 0) {
+        readConn(fc);
+    }
+    maUnlockBackendConn(&fc->backend, conn);
+    startWaiting(fcgi);
+}
+
+
+/*
+ *  Read available data from the responder and process complete records
+ */
+static void readConn(FastCgiConn *fc)
+{
+    MprBuf      *buf;
+    int         rc;
+
+    buf = fc->input;
+    while (1) {
+        if (mprGetBufSpace(buf) < MPR_BUFSIZE) {
+            mprCompactBuf(buf);
+            if (mprGetBufSpace(buf) < MPR_BUFSIZE && mprGrowBuf(buf, MPR_BUFSIZE) < 0) {
+                break;
+            }
+        }
+        rc = read(fc->fd, mprGetBufEnd(buf), mprGetBufSpace(buf));
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            connError(fc, "Can't read from FastCGI responder");
+            return;
+
+        } else if (rc == 0) {
+            connError(fc, "FastCGI responder closed the connection");
+            return;
+        }
+        mprAdjustBufEnd(buf, rc);
+        if (fc->req) {
+            fc->req->flags |= FCGI_RECEIVED;
+        }
+        if (mprGetBufLength(buf) >= (FCGI_HEADER_LEN + FCGI_MAX_CONTENT)) {
+            break;
+        }
+    }
+    processInput(fc);
+}
+
+
+/*
+ *  Process complete records in the input buffer. Stops if the client queue is full.
+ */
+static void processInput(FastCgiConn *fc)
+{
+    FastCgiRequest  *fr;
+    MaConn          *conn;
+    MprBuf          *buf;
+    uchar           *header;
+    char            *content, *msg;
+    int             type, len, padding, protocolStatus, written;
+
+    buf = fc->input;
+    while (fc->fd >= 0 && (fr = fc->req) != 0 && mprGetBufLength(fr->pending) == 0 &&
+            mprGetBufLength(buf) >= FCGI_HEADER_LEN) {
+        conn = fr->q->conn;
+        header = (uchar*) mprGetBufStart(buf);
+        type = header[1];
+        len = (header[4] << 8) | header[5];
+        padding = header[6];
+        if (mprGetBufLength(buf) < (FCGI_HEADER_LEN + len + padding)) {
+            break;
+        }
+        content = (char*) &header[FCGI_HEADER_LEN];
+        mprAdjustBufStart(buf, FCGI_HEADER_LEN + len + padding);
+
+        switch (type) {
+        case FCGI_STDOUT:
+            if (len == 0) {
+                break;
+            }
+            if (!(fr->flags & FCGI_SEEN_HEADER)) {
+                if (mprPutBlockToBuf(fr->header, content, len) != len) {
+                    maFailRequest(conn, MPR_HTTP_CODE_BAD_GATEWAY, "FastCGI response header is too big");
+                    fr->flags |= FCGI_SEEN_HEADER;
+                    break;
+                }
+                if (!parseHeader(fr)) {
+                    break;
+                }
+                content = mprGetBufStart(fr->header);
+                len = mprGetBufLength(fr->header);
+            }
+            written = maWriteBackendData(fr->q, content, len);
+            if (fc->fd < 0 || fc->req != fr) {
+                /*
+                 *  The request was closed while servicing the client queues
+                 */
+                return;
+            }
+            if (written < len) {
+                /*
+                 *  The client queue is full. Stop reading until outgoingFastCgiService drains the queue.
+                 */
+                mprPutBlockToBuf(fr->pending, &content[written], len - written);
+                setConnEvents(fc, fc->mask & ~MPR_READABLE);
+                fr->flags |= FCGI_BLOCKED;
+            }
+            if (fr->header) {
+                mprFree(fr->header);
+                fr->header = 0;
+            }
+            break;
+
+        case FCGI_STDERR:
+            if (len > 0) {
+                msg = (char*) mprAlloc(fr, len + 1);
+                memcpy(msg, content, len);
+                msg[len] = '\0';
+                mprError(conn, "FastCGI: %s", msg);
+                mprFree(msg);
+            }
+            break;
+
+        case FCGI_END_REQUEST:
+            protocolStatus = (len >= 5) ? ((uchar*) content)[4] : FCGI_REQUEST_COMPLETE;
+            if (protocolStatus != FCGI_REQUEST_COMPLETE) {
+                maFailRequest(conn, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "FastCGI responder rejected the request");
+            } else if (!(fr->flags & FCGI_SEEN_HEADER)) {
+                maFailRequest(conn, MPR_HTTP_CODE_BAD_GATEWAY, "FastCGI header not seen");
+            }
+            fr->flags |= FCGI_COMPLETE;
+            releaseConn(fc);
+            if (mprGetBufLength(fr->pending) == 0) {
+                finishRequest(fr);
+            }
+            return;
+
+        default:
+            mprLog(conn, 3, "FastCGI: ignoring unexpected record type %d", type);
+            break;
+        }
+    }
+}
+
+
+/*
+ *  Parse the response header. Returns true when the complete header has been seen.
+ */
+static bool parseHeader(FastCgiRequest *fr)
+{
+    MaConn      *conn;
+    MaResponse  *resp;
+    MprBuf      *buf;
+    char        *start, *endHeaders, *line, *key, *value, *location, *tok;
+    int         len;
+
+    conn = fr->q->conn;
+    resp = conn->response;
+    buf = fr->header;
+    location = 0;
+
+    mprAddNullToBuf(buf);
+    start = mprGetBufStart(buf);
+    if ((endHeaders = strstr(start, "\r\n\r\n")) != 0) {
+        len = 4;
+    } else if ((endHeaders = strstr(start, "\n\n")) != 0) {
+        len = 2;
+    } else {
+        return 0;
+    }
+    *endHeaders = '\0';
+    mprAdjustBufStart(buf, (int) (endHeaders - start) + len);
+
+    for (line = mprStrTok(start, "\r\n", &tok); line; line = mprStrTok(0, "\r\n", &tok)) {
+        if ((value = strchr(line, ':')) == 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_BAD_GATEWAY, "Bad FastCGI header format");
+            break;
+        }
+        *value++ = '\0';
+        while (isspace((int) *value)) {
+            value++;
+        }
+        key = mprStrLower(line);
+
+        if (strcmp(key, "location") == 0) {
+            location = value;
+
+        } else if (strcmp(key, "status") == 0) {
+            maSetResponseCode(conn, atoi(value));
+
+        } else if (strcmp(key, "content-type") == 0) {
+            maSetResponseMimeType(conn, value);
+
+        } else {
+            maSetHeader(conn, 0, key, "%s", value);
+        }
+    }
+    if (location) {
+        maRedirect(conn, resp->code, location);
+    }
+    fr->flags |= FCGI_SEEN_HEADER;
+    return 1;
+}
+
+
+/*
+ *  Complete the response once the end request record has been received and all data written to the client
+ */
+static void finishRequest(FastCgiRequest *fr)
+{
+    MaConn      *conn;
+    MaQueue     *q;
+
+    q = fr->q;
+    conn = q->conn;
+    q->queueData = 0;
+
+    maPutForService(q, maCreateEndPacket(conn), 1);
+    maServiceQueues(conn);
+
+    if (conn->state == MPR_HTTP_STATE_COMPLETE) {
+        /*
+         *  Issue a dummy read event to cycle through the last stage of the request pipeline. This will complete
+         *  the request and cleanup. WARNING - the request will be deleted after this.
+         */
+        maProcessReadEvent(conn, 0);
+        maAwakenConn(conn);
+
+    } else if (conn->requestFailed) {
+        maServiceQueues(conn);
+    }
+}
+
+
+/*
+ *  Handle an I/O error or responder disconnect. A request that has not yet sent body data or received any response
+ *  is retried once on another connection. This handles keep-alive connections whose worker has exited.
+ */
+static void connError(FastCgiConn *fc, cchar *msg)
+{
+    FastCgiRequest  *fr;
+    FastCgi         *fcgi;
+    MaConn          *conn;
+
+    fcgi = fc->fcgi;
+    mprLock(fcgi->pool.mutex);
+    if ((fr = fc->req) != 0) {
+        fr->fc = 0;
+        fc->req = 0;
+        fc->backend.conn = 0;
+    }
+    mprUnlock(fcgi->pool.mutex);
+    closeConn(fc);
+
+    if (fr) {
+        conn = fr->q->conn;
+        if (!(fr->flags & (FCGI_SENT_BODY | FCGI_RECEIVED)) && fr->retries++ == 0) {
+            mprLog(conn, 3, "FastCGI: %s, retrying request", msg);
+            bindRequest(fr, 1);
+        } else {
+            failRequest(fr, MPR_HTTP_CODE_BAD_GATEWAY, msg);
+        }
+    } else {
+        mprLog(fcgi, 4, "FastCGI: %s", msg);
+    }
+    startWaiting(fcgi);
+}
+
+
+/*
+ *  Fail a request that has no responder connection
+ */
+static void failRequest(FastCgiRequest *fr, int code, cchar *msg)
+{
+    maFailRequest(fr->q->conn, code, "%s", msg);
+    fr->flags |= FCGI_COMPLETE;
+    mprFlushBuf(fr->pending);
+    if (fr->flags & FCGI_INPUT_DONE) {
+        /*
+         *  Otherwise runFastCgi will complete the failed request. This may be called while the pipeline is
+         *  running, so complete the request from an event.
+         */
+        scheduleResume(fr);
+    }
+}
+
+
+/*
+ *  Return a connection to the idle pool and start the next waiting request
+ */
+static void releaseConn(FastCgiConn *fc)
+{
+    FastCgi     *fcgi;
+
+    fcgi = fc->fcgi;
+    mprLock(fcgi->pool.mutex);
+    if (fc->req) {
+        fc->req->fc = 0;
+        fc->req = 0;
+        fc->backend.conn = 0;
+    }
+    mprFlushBuf(fc->input);
+    mprAddItem(fcgi->idle, fc);
+    mprUnlock(fcgi->pool.mutex);
+    startWaiting(fcgi);
+}
+
+
+/*
+ *  Start waiting requests while connections are available. Each request is started from an event that locks its own
+ *  client connection.
+ */
+static void startWaiting(FastCgi *fcgi)
+{
+    FastCgiRequest  *fr;
+    int             available;
+
+    mprLock(fcgi->pool.mutex);
+    available = mprGetListCount(fcgi->idle) + fcgi->maxConnections - fcgi->numConnections;
+    while (available-- > 0 && (fr = mprGetFirstItem(fcgi->pool.waiting)) != 0) {
+        fr->start = maCreatePoolEvent(&fcgi->pool, fr->q->conn, (MaConnEventProc) startWaitingRequest, fr);
+        if (fr->start == 0) {
+            break;
+        }
+        mprRemoveItemAtPos(fcgi->pool.waiting, 0);
+    }
+    mprUnlock(fcgi->pool.mutex);
+}
+
+
+static void startWaitingRequest(MaConn *conn, FastCgiRequest *fr)
+{
+    fr->start = 0;
+    bindRequest(fr, 1);
+}
+
+
+/*
+ *  Bind a request to an idle connection or to a new connection if below the connection limit. Otherwise the request
+ *  waits for a connection to be released, at the head of the queue if first is set. Called with the client
+ *  connection locked. The connect is done outside the pool lock as it may block.
+ */
+static void bindRequest(FastCgiRequest *fr, bool first)
+{
+    FastCgi         *fcgi;
+    FastCgiConn     *fc;
+
+    fcgi = fr->fcgi;
+    mprLock(fcgi->pool.mutex);
+    if ((fc = acquireConn(fcgi)) != 0) {
+        fr->fc = fc;
+        fc->req = fr;
+        fc->backend.conn = fr->q->conn;
+
+    } else if (fcgi->numConnections < fcgi->maxConnections) {
+        /*
+         *  Reserve the connection slot before unlocking
+         */
+        fcgi->numConnections++;
+
+    } else {
+        if (first) {
+            mprInsertItemAtPos(fcgi->pool.waiting, 0, fr);
+        } else {
+            mprAddItem(fcgi->pool.waiting, fr);
+        }
+        mprLog(fr->q, 5, "FastCGI: all connections busy, %d requests waiting",
+            mprGetListCount(fcgi->pool.waiting));
+        mprUnlock(fcgi->pool.mutex);
+        return;
+    }
+    mprUnlock(fcgi->pool.mutex);
+
+    if (fc == 0 && (fc = connectResponder(fcgi, fr)) == 0) {
+        failRequest(fr, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "Can't connect to FastCGI responder");
+        return;
+    }
+    startRequest(fr, fc);
+}
+
+
+/*
+ *  Get an idle connection. Connections held by an I/O event are skipped. Called locked.
+ */
+static FastCgiConn *acquireConn(FastCgi *fcgi)
+{
+    FastCgiConn     *fc;
+    int             i;
+
+    for (i = mprGetListCount(fcgi->idle) - 1; i >= 0; i--) {
+        fc = (FastCgiConn*) mprGetItem(fcgi->idle, i);
+        if (fc->backend.busy == 0) {
+            mprRemoveItemAtPos(fcgi->idle, i);
+            return fc;
+        }
+    }
+    return 0;
+}
+
+
+static int destroyConn(FastCgiConn *fc)
+{
+    if (fc->fd >= 0) {
+        mprFree(fc->backend.handler);
+        fc->backend.handler = 0;
+        close(fc->fd);
+        fc->fd = -1;
+        fc->fcgi->numConnections--;
+    }
+    return 0;
+}
+
+
+/*
+ *  Open a new connection to the responder for a request. The caller has reserved a connection slot which is given
+ *  back on errors. Called unlocked. The connection is bound to the request before it can receive I/O events.
+ */
+static FastCgiConn *connectResponder(FastCgi *fcgi, FastCgiRequest *fr)
+{
+    FastCgiConn         *fc;
+    struct sockaddr_un  addr;
+    int                 fd;
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        mprError(fcgi, "FastCGI: can't create socket, errno %d", errno);
+        fd = -1;
+
+    } else {
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        mprStrcpy(addr.sun_path, sizeof(addr.sun_path), fcgi->path);
+        if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+            mprError(fcgi, "FastCGI: can't connect to %s, errno %d", fcgi->path, errno);
+            close(fd);
+            fd = -1;
+        }
+    }
+    mprLock(fcgi->pool.mutex);
+    if (fd < 0) {
+        fcgi->numConnections--;
+        mprUnlock(fcgi->pool.mutex);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    fc = mprAllocObjWithDestructorZeroed(fcgi, FastCgiConn, destroyConn);
+    fc->backend.pool = &fcgi->pool;
+    fc->fcgi = fcgi;
+    fc->fd = fd;
+    fc->input = mprCreateBuf(fc, MPR_BUFSIZE, -1);
+    fc->output = mprCreateBuf(fc, MPR_BUFSIZE, -1);
+    fc->mask = MPR_READABLE;
+    fc->req = fr;
+    fc->backend.conn = fr->q->conn;
+    fr->fc = fc;
+    fc->backend.handler = mprCreateWaitHandler(fc, fd, fc->mask, (MprWaitProc) fastcgiEvent, fc,
+        MPR_NORMAL_PRIORITY, 0);
+
+    mprLog(fcgi, 4, "FastCGI: opened connection %d of %d to %s", fcgi->numConnections, fcgi->maxConnections,
+        fcgi->path);
+    mprUnlock(fcgi->pool.mutex);
+    return fc;
+}
+
+
+/*
+ *  Close a connection. The connection object is freed immediately unless it is held by an active caller.
+ */
+static void closeConn(FastCgiConn *fc)
+{
+    FastCgi     *fcgi;
+
+    fcgi = fc->fcgi;
+    mprLock(fcgi->pool.mutex);
+    if (mprGetListCount(fcgi->idle) > 0) {
+        mprRemoveItem(fcgi->idle, fc);
+    }
+    destroyConn(fc);
+    if (fc->backend.busy == 0) {
+        mprFree(fc);
+    }
+    mprUnlock(fcgi->pool.mutex);
+}
+
+
+/*
+ *  Spawn a worker with the listening socket on descriptor zero
+ */
+static int spawnWorker(FastCgi *fcgi, int index)
+{
+    char    dir[MPR_MAX_FNAME], *argv[2];
+    int     pid, i;
+
+    pid = fork();
+    if (pid < 0) {
+        mprError(fcgi, "FastCGI: can't fork worker for %s, errno %d", fcgi->program, errno);
+        return MPR_ERR_CANT_CREATE;
+
+    } else if (pid == 0) {
+#if LINUX
+        /*
+         *  Don't leave orphaned workers blocked in accept if the server exits without stopping them
+         */
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+        dup2(fcgi->listenFd, 0);
+        for (i = 3; i < FD_SETSIZE; i++) {
+            close(i);
+        }
+        mprGetDirName(dir, sizeof(dir), fcgi->program);
+        if (chdir(dir) < 0) {
+            _exit(126);
+        }
+        argv[0] = fcgi->program;
+        argv[1] = 0;
+        execv(fcgi->program, argv);
+        _exit(127);
+    }
+    fcgi->pids[index] = pid;
+    mprLog(fcgi, 3, "FastCGI: started worker %d for %s, pid %d", index, fcgi->program, pid);
+    return 0;
+}
+
+
+static bool workerRunning(int pid)
+{
+    int     status;
+
+    if (pid <= 0 || waitpid(pid, &status, WNOHANG) == pid) {
+        return 0;
+    }
+    return kill(pid, 0) == 0;
+}
+
+
+/*
+ *  Restart workers that have exited. Runs periodically.
+ */
+static void checkWorkers(FastCgi *fcgi, MprEvent *event)
+{
+    int     i;
+
+    for (i = 0; i < fcgi->workers; i++) {
+        if (!workerRunning(fcgi->pids[i])) {
+            if (fcgi->pids[i] > 0) {
+                mprLog(fcgi, 2, "FastCGI: worker %d for %s exited, restarting", fcgi->pids[i], fcgi->program);
+                fcgi->restarts++;
+            }
+            fcgi->pids[i] = 0;
+            spawnWorker(fcgi, i);
+        }
+    }
+}
+
+
+/*
+ *  Create a listening socket for the workers and spawn them. This is deferred until the first request so the workers
+ *  and socket are created after the server has changed to its configured user and group. Called locked.
+ */
+static int startWorkers(FastCgi *fcgi)
+{
+    struct sockaddr_un  addr;
+    char                path[MPR_MAX_FNAME];
+    int                 fd;
+
+    if (mprMakeTempFileName(fcgi, path, sizeof(path), 0) < 0) {
+        mprError(fcgi, "FastCGI: can't create socket name");
+        return MPR_ERR_CANT_CREATE;
+    }
+    unlink(path);
+    fcgi->path = mprStrdup(fcgi, path);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        mprError(fcgi, "FastCGI: can't create socket, errno %d", errno);
+        return MPR_ERR_CANT_OPEN;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    mprStrcpy(addr.sun_path, sizeof(addr.sun_path), fcgi->path);
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, MA_FASTCGI_BACKLOG) < 0) {
+        mprError(fcgi, "FastCGI: can't listen on %s, errno %d", fcgi->path, errno);
+        close(fd);
+        return MPR_ERR_CANT_OPEN;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcgi->listenFd = fd;
+
+    fcgi->pids = (int*) mprAllocZeroed(fcgi, fcgi->workers * sizeof(int));
+    checkWorkers(fcgi, 0);
+    fcgi->timer = mprCreateTimerEvent(fcgi, (MprEventProc) checkWorkers, MA_FASTCGI_CHECK_PERIOD,
+        MPR_NORMAL_PRIORITY, fcgi, MPR_EVENT_CONTINUOUS);
+    return 0;
+}
+
+
+/*
+ *  Stop workers and remove the socket when the location is freed
+ */
+static int destroyFastCgi(FastCgi *fcgi)
+{
+    int     i;
+
+    if (fcgi->pids) {
+        for (i = 0; i < fcgi->workers; i++) {
+            if (fcgi->pids[i] > 0) {
+                kill(fcgi->pids[i], SIGTERM);
+            }
+        }
+    }
+    if (fcgi->listenFd >= 0) {
+        close(fcgi->listenFd);
+        unlink(fcgi->path);
+    }
+    return 0;
+}
+
+
+static FastCgi *createFastCgi(MaLocation *location)
+{
+    FastCgi     *fcgi;
+
+    fcgi = mprAllocObjWithDestructorZeroed(location, FastCgi, destroyFastCgi);
+    fcgi->listenFd = -1;
+    fcgi->idle = mprCreateList(fcgi);
+    maInitBackendPool(&fcgi->pool);
+    return fcgi;
+}
+
+
+#if BLD_FEATURE_CONFIG_PARSE
+static int parseFastCgi(MaHttp *http, cchar *key, char *value, MaConfigState *state)
+{
+    MaLocation  *location;
+    FastCgi     *fcgi;
+    char        pathBuf[MPR_MAX_FNAME], *path, *count, *tok;
+
+    location = state->location;
+
+    if (mprStrcmpAnyCase(key, "FastCgiProgram") == 0 || mprStrcmpAnyCase(key, "FastCgiConnect") == 0) {
+        if (location->handlerData) {
+            mprError(http, "FastCGI responder already defined for %s", location->prefix);
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        path = mprStrTok(value, " \t", &tok);
+        count = mprStrTok(0, " \t", &tok);
+        if (path == 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        maMakePath(state->host, pathBuf, sizeof(pathBuf), mprStrTrim(path, "\""));
+
+        fcgi = createFastCgi(location);
+        fcgi->maxConnections = count ? mprAtoi(count, 10) : MA_FASTCGI_WORKERS;
+        if (fcgi->maxConnections <= 0) {
+            mprFree(fcgi);
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        if (mprStrcmpAnyCase(key, "FastCgiProgram") == 0) {
+            fcgi->program = mprStrdup(fcgi, pathBuf);
+            fcgi->workers = fcgi->maxConnections;
+        } else {
+            fcgi->path = mprStrdup(fcgi, pathBuf);
+        }
+        location->handlerData = fcgi;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+
+/*
+ *  Dynamic module initialization
+ */
+MprModule *maFastcgiHandlerInit(MaHttp *http, cchar *path)
+{
+    MprModule   *module;
+    MaStage     *handler;
+
+    module = mprCreateModule(http, "fastcgiHandler", BLD_VERSION, NULL, NULL, NULL);
+    if (module == 0) {
+        return 0;
+    }
+    handler = maCreateHandler(http, "fastcgiHandler", MA_STAGE_ALL | MA_STAGE_ENV_VARS | MA_STAGE_VIRTUAL);
+    if (handler == 0) {
+        mprFree(module);
+        return 0;
+    }
+    handler->open = openFastCgi;
+    handler->close = closeFastCgi;
+    handler->outgoingData = outgoingFastCgiData;
+    handler->outgoingService = outgoingFastCgiService;
+    handler->incomingData = incomingFastCgiData;
+    handler->run = runFastCgi;
+#if BLD_FEATURE_CONFIG_PARSE
+    handler->parse = parseFastCgi;
+#endif
+    return module;
+}
+
+
+#else
+void mprFastcgiHandlerDummy() {}
+
+#endif /* BLD_FEATURE_FASTCGI */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
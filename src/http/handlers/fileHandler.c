@@ -12,9 +12,21 @@
 #include    "http.h"
 
 #if BLD_FEATURE_FILE
+/*********************************** Locals ***********************************/
+/*
+ *  Per-request PUT state. Stored as the queue data of the handler receive queue.
+ */
+typedef struct FilePut {
+    MprFile     *file;              /* File being written */
+    char        *path;              /* Document path */
+    char        *tempPath;          /* Temporary file renamed to the document path when the body is complete */
+    int         pipe[2];            /* Pipe to splice the body from the socket to the file */
+} FilePut;
 
 /***************************** Forward Declarations ***************************/
 
+static void closePut(FilePut *put);
+static int  drainPipe(MaConn *conn, FilePut *put, int bytes);
 static void handleDeleteRequest(MaQueue *q);
 static int  readFileData(MaQueue *q, MaPacket *packet);
 static void handlePutRequest(MaQueue *q);
@@ -157,6 +169,41 @@ static void outgoingFileService(MaQueue *q)
 }
 
 
+static void closeFile(MaQueue *q)
+{
+    FilePut     *put;
+
+    if (q->pair && (put = (FilePut*) q->pair->queueData) != 0) {
+        closePut(put);
+        q->pair->queueData = 0;
+    }
+}
+
+
+/*
+ *  Release the PUT resources. An incomplete temporary file is removed so the document is left unchanged.
+ */
+static void closePut(FilePut *put)
+{
+    if (put->file) {
+        mprFree(put->file);
+        put->file = 0;
+    }
+    if (put->tempPath) {
+        unlink(put->tempPath);
+        put->tempPath = 0;
+    }
+#if LINUX
+    if (put->pipe[0] >= 0) {
+        close(put->pipe[0]);
+        close(put->pipe[1]);
+        put->pipe[0] = put->pipe[1] = -1;
+    }
+#endif
+    mprFree(put);
+}
+
+
 static void incomingFileData(MaQueue *q, MaPacket *packet)
 {
     MaConn      *conn;
@@ -165,28 +212,37 @@ static void incomingFileData(MaQueue *q, MaPacket *packet)
     MaRange     *range;
     MprBuf      *buf;
     MprFile     *file;
+    FilePut     *put;
     int         len;
 
     conn = q->conn;
     resp = conn->response;
     req = conn->request;
 
-    file = (MprFile*) q->queueData;
-  
-    if (file == 0) {
+    put = (FilePut*) q->queueData;
+    if (put == 0) {
         /* 
          *  Not a PUT so just ignore the incoming data.
          */
         mprFree(packet);
         return;
     }
+    file = put->file;
 
     if (packet->count == 0) {
         /*
-         *  End of input
-         *  TODO - BUG does this free the file before it is served? Okay for PUT. Okay for PUT. Okay for PUT. Okay for PUT.
+         *  End of input. Atomically replace the document with the completed temporary file.
          */
         mprFree(file);
+        put->file = 0;
+        if (put->tempPath) {
+            if (rename(put->tempPath, put->path) < 0) {
+                maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't PUT to %s", resp->filename);
+            } else {
+                put->tempPath = 0;
+            }
+        }
+        closePut(put);
         q->queueData = 0;
         return;
     }
@@ -203,8 +259,11 @@ static void incomingFileData(MaQueue *q, MaPacket *packet)
         if (mprWrite(file, mprGetBufStart(buf), len) != len) {
             maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't PUT to %s", resp->filename);
 
-        } else if (req->remainingContent > 0) {
-            return;
+        } else {
+            maRecyclePacket(conn, packet);
+            if (req->remainingContent > 0) {
+                return;
+            }
         }
 #if UNUSED && KEEP
         status = mprGetHttpCodeString(conn, resp->code);
@@ -261,7 +320,65 @@ static int readFileData(MaQueue *q, MaPacket *packet)
 
 
 /*
- *  This is called to setup for a HTTP PUT request. It is called before receiving the post data via incomingFileData
+ *  Splice PUT body data from the socket to the file via a pipe. The pipe is always drained before returning.
+ */
+static int spliceFileData(MaQueue *q, int bytes)
+{
+    MaConn      *conn;
+    FilePut     *put;
+    int         nbytes, written, rc;
+
+    conn = q->conn;
+    put = (FilePut*) q->queueData;
+    if (put == 0 || put->file == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    nbytes = mprSpliceFromSocket(conn->sock, put->pipe[1], bytes);
+    if (nbytes <= 0) {
+        return nbytes;
+    }
+    for (written = 0; written < nbytes; written += rc) {
+        rc = mprSpliceToFile(put->file, put->pipe[0], nbytes - written);
+        if (rc <= 0) {
+            /*
+             *  The file system can't accept spliced data. Copy out what is in the pipe and read the rest of the body
+             *  via packets.
+             */
+            mprLog(q, 5, "PUT splice to file failed, errno %d, using buffered input", errno);
+            conn->request->flags &= ~MA_REQ_SPLICE_INPUT;
+            if (drainPipe(conn, put, nbytes - written) < 0) {
+                maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't PUT to %s", conn->response->filename);
+            }
+            break;
+        }
+    }
+    mprLog(q, 6, "PUT splice to file %d", nbytes);
+    return nbytes;
+}
+
+
+static int drainPipe(MaConn *conn, FilePut *put, int bytes)
+{
+    char    buf[MPR_BUFSIZE];
+    int     nbytes;
+
+    while (bytes > 0) {
+        nbytes = (int) read(put->pipe[0], buf, min(bytes, (int) sizeof(buf)));
+        if (nbytes <= 0 || mprWrite(put->file, buf, nbytes) != nbytes) {
+            return MPR_ERR_CANT_WRITE;
+        }
+        bytes -= nbytes;
+    }
+    return 0;
+}
+
+
+/*
+ *  This is called to setup for a HTTP PUT request. It is called before receiving the post data via incomingFileData.
+ *  Whole documents are written to a temporary file in the same directory which replaces the document when the body 
+ *  is complete. If possible, the body is spliced from the socket to the file without being copied via user space.
  */
 static void handlePutRequest(MaQueue *q)
 {
@@ -269,7 +386,8 @@ static void handlePutRequest(MaQueue *q)
     MaRequest       *req;
     MaResponse      *resp;
     MprFile         *file;
-    char            *path;
+    FilePut         *put;
+    char            *path, dir[MPR_MAX_FNAME], tempPath[MPR_MAX_FNAME];
 
     mprAssert(q->pair->queueData == 0);
 
@@ -282,16 +400,24 @@ static void handlePutRequest(MaQueue *q)
         maFailRequest(conn, MPR_HTTP_CODE_NOT_FOUND, "Can't map URI to file storage");
         return;
     }
+    put = mprAllocObjZeroed(q->pair, FilePut);
+    if (put == 0) {
+        maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't create the put URI");
+        return;
+    }
+    put->path = mprStrdup(put, path);
+    put->pipe[0] = put->pipe[1] = -1;
 
     if (req->ranges) {
         /*
          *  Open an existing file with fall-back to create
          */
-        file = mprOpen(q, path, O_BINARY | O_WRONLY, 0644);
+        file = mprOpen(put, path, O_BINARY | O_WRONLY, 0644);
         if (file == 0) {
-            file = mprOpen(q, path, O_CREAT | O_TRUNC | O_BINARY | O_WRONLY, 0644);
+            file = mprOpen(put, path, O_CREAT | O_TRUNC | O_BINARY | O_WRONLY, 0644);
             if (file == 0) {
                 maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't create the put URI");
+                mprFree(put);
                 return;
             }
         } else {
@@ -299,15 +425,35 @@ static void handlePutRequest(MaQueue *q)
         }
 
     } else {
-        file = mprOpen(q, path, O_CREAT | O_TRUNC | O_BINARY | O_WRONLY, 0644);
-        if (file == 0) {
+        mprGetDirName(dir, sizeof(dir), path);
+        if (mprMakeTempFileName(put, tempPath, sizeof(tempPath), dir) < 0 ||
+                (file = mprOpen(put, tempPath, O_CREAT | O_TRUNC | O_BINARY | O_WRONLY, 0644)) == 0) {
             maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't create the put URI");
+            mprFree(put);
             return;
         }
+        put->tempPath = mprStrdup(put, tempPath);
+#if BLD_UNIX_LIKE
+        /*
+         *  The temporary file replaces the document, so give it the document's permissions
+         */
+        chmod(tempPath, resp->fileInfo.isReg ? resp->fileInfo.perms : 0644);
+#endif
     }
+    put->file = file;
 
     maSetResponseCode(conn, resp->fileInfo.isReg ? MPR_HTTP_CODE_NO_CONTENT : MPR_HTTP_CODE_CREATED);
-    q->pair->queueData = (void*) file;
+    q->pair->queueData = (void*) put;
+
+#if LINUX
+    /*
+     *  Splicing requires a known body length, a socket that is not secure and no incoming filters
+     */
+    if (put->tempPath && req->remainingContent > 0 && !(req->flags & MA_REQ_CHUNKED) && !mprSocketIsSecure(conn->sock) &&
+            q->pair->prevQ == resp->queue[MA_QUEUE_RECEIVE].nextQ && pipe(put->pipe) == 0) {
+        req->flags |= MA_REQ_SPLICE_INPUT;
+    }
+#endif
 }
 
 
@@ -355,16 +501,19 @@ MprModule *maFileHandlerInit(MaHttp *http, cchar *path)
         return 0;
     }
 
-    handler = maCreateHandler(http, "fileHandler", MA_STAGE_GET | MA_STAGE_HEAD | MA_STAGE_PUT | MA_STAGE_DELETE);
+    handler = maCreateHandler(http, "fileHandler", 
+        MA_STAGE_GET | MA_STAGE_HEAD | MA_STAGE_PUT | MA_STAGE_DELETE | MA_STAGE_STREAM_INPUT);
     if (handler == 0) {
         mprFree(module);
         return 0;
     }
 
     handler->open = openFile;
+    handler->close = closeFile;
     handler->run = runFile;
     handler->outgoingService = outgoingFileService;
     handler->incomingData = incomingFileData;
+    handler->incomingSplice = spliceFileData;
     http->fileHandler = handler;
 
     return module;
@@ -0,0 +1,1541 @@
+/*
+ *  proxyHandler.c -- Reverse Proxy Handler
+ *
+ *  Forward requests to upstream HTTP servers. Each upstream has a pool of persistent keep-alive connections that are
+ *  reused for subsequent requests. Requests are balanced over the upstreams either round-robin or to the upstream with
+ *  the fewest busy connections. Request and response bodies are streamed through the queue pipeline and are never
+ *  fully buffered. Upstreams that repeatedly fail are passively taken out of rotation for a retry period.
+ *
+ *  Copyright (c) All Rights Reserved. See copyright notice at the bottom of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "http.h"
+
+#if BLD_FEATURE_PROXY && BLD_UNIX_LIKE
+
+/*********************************** Locals ***********************************/
+/*
+ *  Load balancing modes
+ */
+#define PROXY_ROUND_ROBIN       0           /* Rotate through the upstreams */
+#define PROXY_LEAST_CONN        1           /* Use the upstream with the fewest busy connections */
+
+/*
+ *  Request flags
+ */
+#define PROXY_INPUT_DONE        0x1         /* All request body data received from the client */
+#define PROXY_BODY_CLOSED       0x2         /* All request body data buffered for the upstream */
+#define PROXY_COMPLETE          0x4         /* Response fully received */
+#define PROXY_SENT_BODY         0x8         /* Some body data has been written to the upstream */
+#define PROXY_RECEIVED          0x10        /* Some response data has been received */
+#define PROXY_BLOCKED           0x20        /* Client queue is full. Waiting for outgoingProxyService */
+#define PROXY_CHUNKED           0x40        /* Request body is sent to the upstream with chunked encoding */
+#define PROXY_EOF               0x80        /* Upstream closed the connection */
+
+/*
+ *  Response parse states
+ */
+#define PROXY_STATE_HEADER      0           /* Reading the status line and headers */
+#define PROXY_STATE_BODY        1           /* Reading a body with a known content length */
+#define PROXY_STATE_CHUNK_SIZE  2           /* Reading a chunk size line */
+#define PROXY_STATE_CHUNK_DATA  3           /* Reading chunk data */
+#define PROXY_STATE_CHUNK_END   4           /* Reading the line ending after chunk data */
+#define PROXY_STATE_TRAILER     5           /* Reading trailer headers after the last chunk */
+#define PROXY_STATE_CLOSE       6           /* Reading a body delimited by the upstream closing the connection */
+#define PROXY_STATE_DONE        7           /* Response complete */
+
+#define PROXY_MAX_READ          (64 * 1024) /* Max response data to buffer per read event */
+#define PROXY_MAX_LINE          1024        /* Max chunk size or trailer line */
+
+/*
+ *  Upstreams for a location
+ */
+typedef struct Proxy {
+    MaBackendPool   pool;                   /* Connection pool. Must be first */
+    MprList         *upstreams;             /* List of ProxyUpstream */
+    int             balance;                /* Load balancing mode */
+    int             nextUpstream;           /* Next upstream for round-robin balancing */
+    int             maxConnections;         /* Maximum connections per upstream */
+    int             maxFailures;            /* Consecutive failures before an upstream is marked down */
+    int             retryPeriod;            /* Time in msec an upstream stays down */
+    int             generation;             /* Selection counter to avoid retrying the same upstream */
+} Proxy;
+
+/*
+ *  Upstream server
+ */
+typedef struct ProxyUpstream {
+    Proxy           *proxy;                 /* Owning proxy */
+    char            *name;                  /* Upstream host:port used for the Host header */
+    char            *prefix;                /* URL prefix on the upstream. Empty for the root */
+    struct sockaddr_storage addr;           /* Resolved upstream address */
+    int             addrLen;                /* Length of addr */
+    int             numConnections;         /* Current number of connections */
+    MprList         *idle;                  /* Idle keep-alive connections */
+    int             failures;               /* Consecutive failures */
+    int             tried;                  /* Generation of the last failed connect */
+    MprTime         downUntil;              /* Time the upstream returns to rotation after failures */
+} ProxyUpstream;
+
+/*
+ *  Connection to an upstream
+ */
+typedef struct ProxyConn {
+    MaBackend       backend;                /* Backend connection. Must be first */
+    ProxyUpstream   *upstream;              /* Owning upstream */
+    int             fd;                     /* Socket to the upstream */
+    int             mask;                   /* Current I/O event mask */
+    bool            connecting;             /* Non-blocking connect in progress */
+    bool            reused;                 /* Connection taken from the idle pool */
+    MprBuf          *input;                 /* Response data read from the upstream */
+    MprBuf          *output;                /* Request data waiting to be written to the upstream */
+    struct ProxyRequest *req;               /* Request being serviced */
+} ProxyConn;
+
+/*
+ *  State for a request
+ */
+typedef struct ProxyRequest {
+    MaQueue         *q;                     /* Handler send queue */
+    Proxy           *proxy;                 /* Owning proxy */
+    ProxyConn       *pc;                    /* Connection servicing the request */
+    MprBuf          *pending;               /* Response data waiting for the client queue to drain */
+    int             flags;                  /* Request flags */
+    int             state;                  /* Response parse state */
+    int             remaining;              /* Remaining bytes of body or chunk data */
+    int             attempts;               /* Retries on failed connections */
+    bool            keepAlive;              /* Upstream connection can be reused */
+    MaConnEvent     *resume;                /* Event to resume processing outside the pipeline */
+    MaPoolEvent     *start;                 /* Event to start the request when a connection is available */
+} ProxyRequest;
+
+/*********************************** Forwards *********************************/
+
+static void abortResponse(ProxyConn *pc, cchar *msg);
+static ProxyConn *acquireConn(Proxy *proxy);
+static void bindRequest(ProxyRequest *pr, bool first);
+static bool canWait(Proxy *proxy);
+static void closeConn(ProxyConn *pc);
+static void completeResponse(ProxyConn *pc, ProxyRequest *pr);
+static void connError(ProxyConn *pc, cchar *msg);
+static ProxyConn *connectUpstream(ProxyUpstream *up);
+static int  countAvailable(Proxy *proxy);
+static void failRequest(ProxyRequest *pr, int code, cchar *msg);
+static void finishRequest(ProxyRequest *pr);
+static int  flushConn(ProxyConn *pc);
+static ProxyConn *getIdleConn(ProxyUpstream *up);
+static bool parseHeader(ProxyRequest *pr);
+static void processInput(ProxyConn *pc);
+static void proxyEvent(ProxyConn *pc, int mask, int isPoolThread);
+static void pushInput(ProxyRequest *pr);
+static void readConn(ProxyConn *pc);
+static void releaseConn(ProxyConn *pc);
+static void resumeRequest(MaConn *conn, ProxyRequest *pr);
+static void scheduleResume(ProxyRequest *pr);
+static void setConnEvents(ProxyConn *pc, int mask);
+static void startRequest(ProxyRequest *pr, ProxyConn *pc);
+static void startWaiting(Proxy *proxy);
+static void startWaitingRequest(MaConn *conn, ProxyRequest *pr);
+static void unbindRequest(ProxyConn *pc);
+
+/************************************* Code ***********************************/
+/*
+ *  Open this handler instance for a new request
+ */
+static void openProxy(MaQueue *q)
+{
+    MaRequest       *req;
+    MaResponse      *resp;
+    MaConn          *conn;
+    Proxy           *proxy;
+    ProxyRequest    *pr;
+
+    conn = q->conn;
+    req = conn->request;
+    resp = conn->response;
+
+    maPutForService(q, maCreateHeaderPacket(conn), 0);
+
+    proxy = (req->location->handler == resp->handler) ? (Proxy*) req->location->handlerData : 0;
+    if (proxy == 0 || mprGetListCount(proxy->upstreams) == 0) {
+        maFailRequest(conn, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "No proxy upstream defined for %s", req->url);
+        return;
+    }
+    pr = mprAllocObjZeroed(resp, ProxyRequest);
+    pr->q = q;
+    pr->proxy = proxy;
+    pr->pending = mprCreateBuf(pr, MPR_BUFSIZE, -1);
+    q->queueData = pr;
+
+    bindRequest(pr, 0);
+}
+
+
+/*
+ *  Close the handler. If the request is still bound to a connection, the response is incomplete and the upstream
+ *  is still producing output, so the connection can't be reused.
+ */
+static void closeProxy(MaQueue *q)
+{
+    ProxyRequest    *pr;
+    Proxy           *proxy;
+    ProxyConn       *pc;
+
+    if ((pr = (ProxyRequest*) q->queueData) == 0) {
+        return;
+    }
+    q->queueData = 0;
+    proxy = pr->proxy;
+    maCancelConnEvent(pr->resume);
+
+    mprLock(proxy->pool.mutex);
+    maCancelPoolEvent(pr->start);
+    if (mprGetListCount(proxy->pool.waiting) > 0) {
+        mprRemoveItem(proxy->pool.waiting, pr);
+    }
+    if ((pc = pr->pc) != 0) {
+        pr->pc = 0;
+        pc->req = 0;
+        pc->backend.conn = 0;
+    }
+    mprUnlock(proxy->pool.mutex);
+
+    if (pc) {
+        mprLog(q, 4, "Proxy: closing connection for incomplete request");
+        closeConn(pc);
+        startWaiting(proxy);
+    }
+}
+
+
+/*
+ *  Accept a new packet of data destined for the browser. The header packet is queued until the upstream response
+ *  header has been parsed.
+ */
+static void outgoingProxyData(MaQueue *q, MaPacket *packet)
+{
+    maPutForService(q, packet, 0);
+}
+
+
+/*
+ *  Service outgoing data destined for the browser. When the queue drains, resume reading from the upstream. As the
+ *  upstream data may already be buffered, an event is scheduled to process it rather than doing so while the pipeline
+ *  is being serviced.
+ */
+static void outgoingProxyService(MaQueue *q)
+{
+    ProxyRequest    *pr;
+
+    pr = (ProxyRequest*) q->queueData;
+
+    maDefaultOutgoingServiceStage(q);
+
+    if (pr && (pr->flags & PROXY_BLOCKED) && q->count < q->low) {
+        pr->flags &= ~PROXY_BLOCKED;
+        scheduleResume(pr);
+    }
+}
+
+
+static void scheduleResume(ProxyRequest *pr)
+{
+    if (pr->resume == 0) {
+        pr->resume = maCreateConnEvent(pr->q->conn, (MaConnEventProc) resumeRequest, 0, pr);
+    }
+}
+
+
+/*
+ *  Write pending response data and resume reading from the upstream. Completes the request if the response has been
+ *  fully received. Runs with the client connection locked. The event is cancelled if the handler is closed first.
+ */
+static void resumeRequest(MaConn *conn, ProxyRequest *pr)
+{
+    ProxyConn       *pc;
+    Proxy           *proxy;
+    int             len;
+
+    pr->resume = 0;
+
+    if ((len = mprGetBufLength(pr->pending)) > 0) {
+        mprAdjustBufStart(pr->pending, maWriteBackendData(pr->q, mprGetBufStart(pr->pending), len));
+        if (mprGetBufLength(pr->pending) > 0) {
+            pr->flags |= PROXY_BLOCKED;
+            return;
+        }
+        mprFlushBuf(pr->pending);
+    }
+    if ((pc = pr->pc) != 0) {
+        proxy = pr->proxy;
+        maHoldBackend(&pc->backend);
+        setConnEvents(pc, pc->mask | MPR_READABLE);
+        processInput(pc);
+        maReleaseBackend(&pc->backend);
+        startWaiting(proxy);
+
+    } else if (pr->flags & PROXY_COMPLETE) {
+        finishRequest(pr);
+    }
+}
+
+
+/*
+ *  Accept incoming body data from the browser destined for the upstream
+ */
+static void incomingProxyData(MaQueue *q, MaPacket *packet)
+{
+    MaConn          *conn;
+    MaRequest       *req;
+    ProxyRequest    *pr;
+
+    conn = q->conn;
+    req = conn->request;
+
+    if ((pr = (ProxyRequest*) q->pair->queueData) == 0) {
+        return;
+    }
+    if (packet->count == 0) {
+        if (req->remainingContent > 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_BAD_REQUEST, "Client supplied insufficient body data");
+        }
+    } else {
+        /*
+         *  No service routine. Packets are queued here until pushInput can write them to the upstream.
+         */
+        maPutForService(q, packet, 0);
+    }
+    pushInput(pr);
+}
+
+
+/*
+ *  Run after all incoming data has been received. Terminate the request body sent to the upstream.
+ */
+static void runProxy(MaQueue *q)
+{
+    MaConn          *conn;
+    ProxyRequest    *pr;
+
+    conn = q->conn;
+    pr = (ProxyRequest*) q->queueData;
+
+    if (pr) {
+        pr->flags |= PROXY_INPUT_DONE;
+        pushInput(pr);
+    }
+    if (conn->requestFailed) {
+        maPutForService(q, maCreateEndPacket(conn), 1);
+    }
+}
+
+
+/*
+ *  Test if a request header is a hop-by-hop header or is otherwise regenerated for the upstream. Keys are in the
+ *  request header form: upper case with dashes mapped to underscores.
+ */
+static bool isHopHeader(cchar *key)
+{
+    static cchar *hopHeaders[] = {
+        "CONNECTION", "CONTENT_LENGTH", "EXPECT", "HOST", "IF_RANGE", "KEEP_ALIVE", "PROXY_AUTHORIZATION",
+        "PROXY_CONNECTION", "RANGE", "TE", "TRAILER", "TRANSFER_ENCODING", "UPGRADE", "X_FORWARDED_FOR",
+        "X_FORWARDED_HOST", 0
+    };
+    cchar   **cp;
+
+    for (cp = hopHeaders; *cp; cp++) {
+        if (strcmp(key, *cp) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Append a request header, mapping the stored key back to its conventional form. "ACCEPT_ENCODING" is written as
+ *  "Accept-Encoding".
+ */
+static void putRequestHeader(MprBuf *buf, cchar *key, cchar *value)
+{
+    cchar   *cp;
+    int     upper;
+
+    for (upper = 1, cp = key; *cp; cp++) {
+        if (*cp == '_') {
+            mprPutCharToBuf(buf, '-');
+            upper = 1;
+        } else {
+            mprPutCharToBuf(buf, upper ? toupper((int) *cp) : tolower((int) *cp));
+            upper = 0;
+        }
+    }
+    mprPutFmtToBuf(buf, ": %s\r\n", value);
+}
+
+
+/*
+ *  Write the request line and headers for a request bound to a connection
+ */
+static void startRequest(ProxyRequest *pr, ProxyConn *pc)
+{
+    MaConn          *conn;
+    MaRequest       *req;
+    ProxyUpstream   *up;
+    MprHash         *hp;
+    MprBuf          *buf;
+    cchar           *path, *forwarded;
+
+    conn = pr->q->conn;
+    req = conn->request;
+    up = pc->upstream;
+    buf = pc->output;
+
+    pr->flags &= ~(PROXY_BODY_CLOSED | PROXY_CHUNKED);
+    pr->state = PROXY_STATE_HEADER;
+
+    /*
+     *  Map the request path below the location prefix onto the upstream prefix
+     */
+    path = req->parsedUri->url;
+    if ((int) strlen(path) >= req->location->prefixLen) {
+        path += req->location->prefixLen;
+    }
+    mprPutFmtToBuf(buf, "%s %s%s%s", req->methodName, up->prefix, (*path == '/') ? "" : "/", path);
+    if (req->parsedUri->query && *req->parsedUri->query) {
+        mprPutFmtToBuf(buf, "?%s", req->parsedUri->query);
+    }
+    mprPutFmtToBuf(buf, " HTTP/1.1\r\nHost: %s\r\n", up->name);
+
+    for (hp = mprGetFirstHash(req->headers); hp; hp = mprGetNextHash(req->headers, hp)) {
+        if (hp->data && strncmp(hp->key, "HTTP_", 5) == 0 && !isHopHeader(&hp->key[5])) {
+            putRequestHeader(buf, &hp->key[5], (char*) hp->data);
+        }
+    }
+    if ((forwarded = mprLookupHash(req->headers, "HTTP_X_FORWARDED_FOR")) != 0) {
+        mprPutFmtToBuf(buf, "X-Forwarded-For: %s, %s\r\n", forwarded, conn->remoteIpAddr);
+    } else {
+        mprPutFmtToBuf(buf, "X-Forwarded-For: %s\r\n", conn->remoteIpAddr);
+    }
+    if (req->hostName) {
+        mprPutFmtToBuf(buf, "X-Forwarded-Host: %s\r\n", req->hostName);
+    }
+    if (req->flags & MA_REQ_CHUNKED) {
+        mprPutStringToBuf(buf, "Transfer-Encoding: chunked\r\n");
+        pr->flags |= PROXY_CHUNKED;
+    } else if (req->length > 0) {
+        mprPutFmtToBuf(buf, "Content-Length: %d\r\n", req->length);
+    }
+    mprPutStringToBuf(buf, "\r\n");
+
+    mprLog(pr->q, 5, "Proxy: start request %s on %s fd %d%s", req->url, up->name, pc->fd,
+        pc->reused ? " (reused)" : "");
+    pushInput(pr);
+}
+
+
+/*
+ *  Write queued body data to the upstream. Data is only taken from the queue while the connection output buffer is
+ *  below the queue packet size. If the socket is full, this is called again when it is writeable.
+ */
+static void pushInput(ProxyRequest *pr)
+{
+    ProxyConn       *pc;
+    MaQueue         *q;
+    MaPacket        *packet;
+    MprBuf          *buf;
+    int             len;
+
+    if ((pc = pr->pc) == 0 || pr->q->conn->requestFailed) {
+        return;
+    }
+    /*
+     *  The receive queue only exists if the request has a body
+     */
+    q = pr->q->pair;
+
+    do {
+        while (q && mprGetBufLength(pc->output) < MA_BUFSIZE && (packet = maGet(q)) != 0) {
+            buf = packet->content;
+            if (buf && (len = mprGetBufLength(buf)) > 0) {
+                if (pr->flags & PROXY_CHUNKED) {
+                    mprPutFmtToBuf(pc->output, "%x\r\n", len);
+                }
+                mprPutBlockToBuf(pc->output, mprGetBufStart(buf), len);
+                if (pr->flags & PROXY_CHUNKED) {
+                    mprPutStringToBuf(pc->output, "\r\n");
+                }
+                pr->flags |= PROXY_SENT_BODY;
+            }
+            mprFree(packet);
+        }
+        if ((pr->flags & PROXY_INPUT_DONE) && !(pr->flags & PROXY_BODY_CLOSED) && (q == 0 || q->first == 0)) {
+            if (pr->flags & PROXY_CHUNKED) {
+                mprPutStringToBuf(pc->output, "0\r\n\r\n");
+            }
+            pr->flags |= PROXY_BODY_CLOSED;
+        }
+        /*
+         *  Stop if the socket is full or the connection failed. The connection may have been freed on errors.
+         */
+        if (flushConn(pc) != 0) {
+            break;
+        }
+    } while (q && q->first);
+}
+
+
+/*
+ *  Write buffered request data to the upstream. Returns zero if all data was written.
+ */
+static int flushConn(ProxyConn *pc)
+{
+    MprBuf      *buf;
+    int         len, rc;
+
+    if (pc->fd < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+    if (pc->connecting) {
+        return 1;
+    }
+    buf = pc->output;
+    while ((len = mprGetBufLength(buf)) > 0) {
+        rc = write(pc->fd, mprGetBufStart(buf), len);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                setConnEvents(pc, pc->mask | MPR_WRITEABLE);
+                return 1;
+            }
+            connError(pc, "Can't write to proxy upstream");
+            return MPR_ERR_CANT_WRITE;
+        }
+        mprAdjustBufStart(buf, rc);
+    }
+    mprFlushBuf(buf);
+    setConnEvents(pc, (pc->mask & ~MPR_WRITEABLE) | MPR_READABLE);
+    return 0;
+}
+
+
+static void setConnEvents(ProxyConn *pc, int mask)
+{
+    if (pc->mask != mask && pc->backend.handler) {
+        pc->mask = mask;
+        mprSetWaitInterest(pc->backend.handler, mask);
+    }
+}
+
+
+/*
+ *  I/O event callback for upstream connections. A pending non-blocking connect completes when the socket becomes
+ *  writeable. The request pipeline is only touched with the client connection locked. Releasing the connection may 
+ *  make it available to waiting requests.
+ */
+static void proxyEvent(ProxyConn *pc, int mask, int isPoolThread)
+{
+    Proxy       *proxy;
+    MaConn      *conn;
+    int         err;
+    socklen_t   errLen;
+
+    proxy = pc->upstream->proxy;
+    conn = maLockBackendConn(&pc->backend);
+    if (pc->connecting) {
+        err = 0;
+        errLen = sizeof(err);
+        if (getsockopt(pc->fd, SOL_SOCKET, SO_ERROR, (char*) &err, &errLen) < 0 || err != 0) {
+            connError(pc, "Can't connect to proxy upstream");
+            mask = 0;
+        } else {
+            pc->connecting = 0;
+            mask |= MPR_WRITEABLE;
+        }
+    }
+    if ((mask & MPR_WRITEABLE) && flushConn(pc) >= 0 && pc->req) {
+        pushInput(pc->req);
+    }
+    if ((mask & MPR_READABLE) && pc->fd >= 0) {
+        readConn(pc);
+    }
+    maUnlockBackendConn(&pc->backend, conn);
+    startWaiting(proxy);
+}
+
+
+/*
+ *  Read available data from the upstream and process the response. An idle connection is only readable if the
+ *  upstream has closed it.
+ */
+static void readConn(ProxyConn *pc)
+{
+    MprBuf      *buf;
+    int         rc;
+
+    buf = pc->input;
+    while (1) {
+        if (mprGetBufSpace(buf) < MPR_BUFSIZE) {
+            mprCompactBuf(buf);
+            if (mprGetBufSpace(buf) < MPR_BUFSIZE && mprGrowBuf(buf, MPR_BUFSIZE) < 0) {
+                break;
+            }
+        }
+        rc = read(pc->fd, mprGetBufEnd(buf), mprGetBufSpace(buf));
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            connError(pc, "Can't read from proxy upstream");
+            return;
+
+        } else if (rc == 0) {
+            if (pc->req && pc->req->state == PROXY_STATE_CLOSE) {
+                /*
+                 *  The response body is delimited by the upstream closing the connection
+                 */
+                pc->req->flags |= PROXY_EOF;
+                setConnEvents(pc, pc->mask & ~MPR_READABLE);
+                break;
+            }
+            connError(pc, "Proxy upstream closed the connection");
+            return;
+        }
+        mprAdjustBufEnd(buf, rc);
+        if (pc->req == 0) {
+            connError(pc, "Unexpected data from proxy upstream");
+            return;
+        }
+        pc->req->flags |= PROXY_RECEIVED;
+        if (mprGetBufLength(buf) >= PROXY_MAX_READ) {
+            break;
+        }
+    }
+    processInput(pc);
+}
+
+
+/*
+ *  Find a line in the input buffer. Returns the line length including the line ending or zero if a complete line has
+ *  not yet been received.
+ */
+static int getLine(MprBuf *buf)
+{
+    char    *start, *nl;
+
+    start = mprGetBufStart(buf);
+    if ((nl = memchr(start, '\n', mprGetBufLength(buf))) == 0) {
+        return 0;
+    }
+    return (int) (nl - start) + 1;
+}
+
+
+/*
+ *  Process buffered response data. Stops if the client queue is full.
+ */
+static void processInput(ProxyConn *pc)
+{
+    ProxyRequest    *pr;
+    MprBuf          *buf;
+    char            *start, line[PROXY_MAX_LINE];
+    int             len, written;
+
+    buf = pc->input;
+    while (pc->fd >= 0 && (pr = pc->req) != 0 && pr->state != PROXY_STATE_DONE &&
+            mprGetBufLength(pr->pending) == 0) {
+        start = mprGetBufStart(buf);
+
+        switch (pr->state) {
+        case PROXY_STATE_HEADER:
+            if (!parseHeader(pr)) {
+                return;
+            }
+            break;
+
+        case PROXY_STATE_BODY:
+        case PROXY_STATE_CHUNK_DATA:
+        case PROXY_STATE_CLOSE:
+            if ((len = mprGetBufLength(buf)) == 0) {
+                if (pr->flags & PROXY_EOF) {
+                    pr->state = PROXY_STATE_DONE;
+                    break;
+                }
+                return;
+            }
+            if (pr->state != PROXY_STATE_CLOSE) {
+                len = min(len, pr->remaining);
+            }
+            written = maWriteBackendData(pr->q, start, len);
+            if (pc->fd < 0 || pc->req != pr) {
+                /*
+                 *  The request was closed while servicing the client queues
+                 */
+                return;
+            }
+            if (written < len) {
+                /*
+                 *  The client queue is full. Stop reading until outgoingProxyService drains the queue.
+                 */
+                mprPutBlockToBuf(pr->pending, &start[written], len - written);
+                setConnEvents(pc, pc->mask & ~MPR_READABLE);
+                pr->flags |= PROXY_BLOCKED;
+            }
+            mprAdjustBufStart(buf, len);
+            if (pr->state != PROXY_STATE_CLOSE && (pr->remaining -= len) == 0) {
+                pr->state = (pr->state == PROXY_STATE_BODY) ? PROXY_STATE_DONE : PROXY_STATE_CHUNK_END;
+            }
+            break;
+
+        case PROXY_STATE_CHUNK_SIZE:
+        case PROXY_STATE_CHUNK_END:
+        case PROXY_STATE_TRAILER:
+            if ((len = getLine(buf)) == 0) {
+                if (mprGetBufLength(buf) >= PROXY_MAX_LINE) {
+                    abortResponse(pc, "Bad chunk specification from proxy upstream");
+                }
+                return;
+            }
+            if (len >= PROXY_MAX_LINE) {
+                abortResponse(pc, "Bad chunk specification from proxy upstream");
+                return;
+            }
+            memcpy(line, start, len);
+            line[len] = '\0';
+            mprAdjustBufStart(buf, len);
+
+            if (pr->state == PROXY_STATE_CHUNK_SIZE) {
+                if (!isxdigit((int) line[0]) || (pr->remaining = (int) strtol(line, 0, 16)) < 0) {
+                    abortResponse(pc, "Bad chunk specification from proxy upstream");
+                    return;
+                }
+                pr->state = (pr->remaining == 0) ? PROXY_STATE_TRAILER : PROXY_STATE_CHUNK_DATA;
+
+            } else if (pr->state == PROXY_STATE_CHUNK_END) {
+                pr->state = PROXY_STATE_CHUNK_SIZE;
+
+            } else if (line[0] == '\r' || line[0] == '\n') {
+                pr->state = PROXY_STATE_DONE;
+            }
+            break;
+        }
+    }
+    if (pc->fd >= 0 && (pr = pc->req) != 0 && pr->state == PROXY_STATE_DONE) {
+        completeResponse(pc, pr);
+    }
+}
+
+
+/*
+ *  The response has been fully received. Return the connection to the pool if it can be reused and complete the
+ *  request once all data has been written to the client.
+ */
+static void completeResponse(ProxyConn *pc, ProxyRequest *pr)
+{
+    Proxy       *proxy;
+
+    proxy = pc->upstream->proxy;
+    pr->flags |= PROXY_COMPLETE;
+
+    if (pr->keepAlive && (pr->flags & PROXY_BODY_CLOSED) && mprGetBufLength(pc->output) == 0 &&
+            mprGetBufLength(pc->input) == 0) {
+        releaseConn(pc);
+    } else {
+        unbindRequest(pc);
+        closeConn(pc);
+        startWaiting(proxy);
+    }
+    if (mprGetBufLength(pr->pending) == 0) {
+        finishRequest(pr);
+    }
+}
+
+
+/*
+ *  Test if a response header is a hop-by-hop header or is generated by this server
+ */
+static bool isHopResponseHeader(cchar *key)
+{
+    static cchar *hopHeaders[] = {
+        "connection", "date", "keep-alive", "proxy-authenticate", "server", "te", "trailer", "transfer-encoding",
+        "upgrade", 0
+    };
+    cchar   **cp;
+
+    for (cp = hopHeaders; *cp; cp++) {
+        if (mprStrcmpAnyCase(key, *cp) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Parse the response status line and headers. Returns true when a complete header has been parsed. Interim 1xx
+ *  responses are discarded.
+ */
+static bool parseHeader(ProxyRequest *pr)
+{
+    MaConn          *conn;
+    MaRequest       *req;
+    ProxyConn       *pc;
+    ProxyUpstream   *up;
+    MprBuf          *buf;
+    char            *start, *endHeaders, *line, *key, *value, *tok, *location;
+    int             len, code, contentLength, chunked, prefixLen;
+
+    conn = pr->q->conn;
+    req = conn->request;
+    pc = pr->pc;
+    up = pc->upstream;
+    buf = pc->input;
+
+    mprAddNullToBuf(buf);
+    start = mprGetBufStart(buf);
+    if ((endHeaders = strstr(start, "\r\n\r\n")) != 0) {
+        len = 4;
+    } else if ((endHeaders = strstr(start, "\n\n")) != 0) {
+        len = 2;
+    } else {
+        if (mprGetBufLength(buf) > conn->http->limits.maxHeader) {
+            abortResponse(pc, "Proxy upstream response header is too big");
+        }
+        return 0;
+    }
+    *endHeaders = '\0';
+    mprAdjustBufStart(buf, (int) (endHeaders - start) + len);
+
+    line = mprStrTok(start, "\r\n", &tok);
+    if (line == 0 || strncmp(line, "HTTP/1.", 7) != 0 || (value = strchr(line, ' ')) == 0 ||
+            (code = atoi(value)) < 100) {
+        abortResponse(pc, "Bad proxy upstream response");
+        return 0;
+    }
+    if (code < 200) {
+        return 1;
+    }
+    pr->keepAlive = (line[7] != '0');
+    contentLength = -1;
+    chunked = 0;
+
+    for (line = mprStrTok(0, "\r\n", &tok); line; line = mprStrTok(0, "\r\n", &tok)) {
+        if ((value = strchr(line, ':')) == 0) {
+            continue;
+        }
+        *value++ = '\0';
+        while (isspace((int) *value)) {
+            value++;
+        }
+        key = line;
+
+        if (mprStrcmpAnyCase(key, "content-length") == 0) {
+            contentLength = atoi(value);
+
+        } else if (mprStrcmpAnyCase(key, "transfer-encoding") == 0) {
+            chunked = (strstr(mprStrLower(value), "chunked") != 0);
+
+        } else if (mprStrcmpAnyCase(key, "connection") == 0) {
+            if (mprStrcmpAnyCase(value, "close") == 0) {
+                pr->keepAlive = 0;
+            } else if (mprStrcmpAnyCase(value, "keep-alive") == 0) {
+                pr->keepAlive = 1;
+            }
+
+        } else if (mprStrcmpAnyCase(key, "content-type") == 0) {
+            maSetResponseMimeType(conn, value);
+
+        } else if (mprStrcmpAnyCase(key, "location") == 0) {
+            /*
+             *  Rewrite redirects to the upstream so they refer back to this location
+             */
+            location = value;
+            if (mprStrcmpAnyCaseCount(location, "http://", 7) == 0 &&
+                    mprStrcmpAnyCaseCount(&location[7], up->name, (int) strlen(up->name)) == 0) {
+                location += 7 + strlen(up->name);
+                prefixLen = (int) strlen(up->prefix);
+                if (strncmp(location, up->prefix, prefixLen) == 0) {
+                    location += prefixLen;
+                }
+                maSetHeader(conn, 0, "Location", "%s%s", req->location->prefix, location);
+            } else {
+                maSetHeader(conn, 0, "Location", "%s", location);
+            }
+
+        } else if (mprStrcmpAnyCase(key, "set-cookie") == 0) {
+            maSetHeader(conn, 1, key, "%s", value);
+
+        } else if (!isHopResponseHeader(key)) {
+            maSetHeader(conn, 0, key, "%s", value);
+        }
+    }
+    maSetResponseCode(conn, code);
+
+    mprLock(up->proxy->pool.mutex);
+    up->failures = 0;
+    mprUnlock(up->proxy->pool.mutex);
+
+    if (contentLength >= 0 && !chunked) {
+        maSetEntityLength(conn, contentLength);
+    }
+    if ((req->method & MA_REQ_HEAD) || code == MPR_HTTP_CODE_NO_CONTENT || code == MPR_HTTP_CODE_NOT_MODIFIED) {
+        pr->state = PROXY_STATE_DONE;
+
+    } else if (chunked) {
+        pr->state = PROXY_STATE_CHUNK_SIZE;
+
+    } else if (contentLength >= 0) {
+        pr->remaining = contentLength;
+        pr->state = (contentLength > 0) ? PROXY_STATE_BODY : PROXY_STATE_DONE;
+
+    } else {
+        pr->keepAlive = 0;
+        pr->state = PROXY_STATE_CLOSE;
+    }
+    return 1;
+}
+
+
+/*
+ *  Complete the response once it has been fully received and all data written to the client
+ */
+static void finishRequest(ProxyRequest *pr)
+{
+    MaConn      *conn;
+    MaQueue     *q;
+
+    q = pr->q;
+    conn = q->conn;
+    q->queueData = 0;
+
+    maPutForService(q, maCreateEndPacket(conn), 1);
+    maServiceQueues(conn);
+
+    if (conn->state == MPR_HTTP_STATE_COMPLETE) {
+        /*
+         *  Issue a dummy read event to cycle through the last stage of the request pipeline. This will complete
+         *  the request and cleanup. WARNING - the request will be deleted after this.
+         */
+        maProcessReadEvent(conn, 0);
+        maAwakenConn(conn);
+
+    } else {
+        if (conn->requestFailed) {
+            maServiceQueues(conn);
+        }
+        maEnableBackendWrites(conn);
+    }
+}
+
+
+/*
+ *  Fail a request that has no connection. This may be called while the pipeline is running, so the request is
+ *  completed from an event. If the client body has not yet been received, runProxy completes the request.
+ */
+static void failRequest(ProxyRequest *pr, int code, cchar *msg)
+{
+    maFailRequest(pr->q->conn, code, "%s", msg);
+    pr->flags |= PROXY_COMPLETE;
+    pr->state = PROXY_STATE_DONE;
+    mprFlushBuf(pr->pending);
+    if (pr->pc) {
+        unbindRequest(pr->pc);
+    }
+    if (pr->flags & PROXY_INPUT_DONE) {
+        scheduleResume(pr);
+    }
+}
+
+
+/*
+ *  Abandon a response after a protocol error from the upstream. The connection can't be reused.
+ */
+static void abortResponse(ProxyConn *pc, cchar *msg)
+{
+    Proxy       *proxy;
+
+    proxy = pc->upstream->proxy;
+    mprError(proxy, "Proxy: %s %s", msg, pc->upstream->name);
+    if (pc->req) {
+        failRequest(pc->req, MPR_HTTP_CODE_BAD_GATEWAY, msg);
+    }
+    closeConn(pc);
+    startWaiting(proxy);
+}
+
+
+/*
+ *  Record a failure for an upstream. After too many consecutive failures, the upstream is taken out of rotation for
+ *  the retry period. Called locked.
+ */
+static void markFailure(ProxyUpstream *up)
+{
+    Proxy       *proxy;
+
+    proxy = up->proxy;
+    if (++up->failures >= proxy->maxFailures) {
+        up->failures = 0;
+        up->downUntil = mprGetTime(proxy) + proxy->retryPeriod;
+        mprError(proxy, "Proxy: upstream %s failed, retry in %d secs", up->name, proxy->retryPeriod / 1000);
+    }
+}
+
+
+/*
+ *  Handle an I/O error or upstream disconnect. A request that has not yet sent body data or received any response
+ *  is retried on another connection. This handles keep-alive connections the upstream has closed and upstreams that
+ *  have failed. Failures on reused connections don't count against the upstream.
+ */
+static void connError(ProxyConn *pc, cchar *msg)
+{
+    ProxyRequest    *pr;
+    ProxyUpstream   *up;
+    Proxy           *proxy;
+    MaConn          *conn;
+
+    up = pc->upstream;
+    proxy = up->proxy;
+
+    mprLock(proxy->pool.mutex);
+    if ((pr = pc->req) != 0) {
+        pr->pc = 0;
+        pc->req = 0;
+        pc->backend.conn = 0;
+        if (!pc->reused) {
+            markFailure(up);
+        }
+    }
+    mprUnlock(proxy->pool.mutex);
+    closeConn(pc);
+
+    if (pr) {
+        conn = pr->q->conn;
+        if (!(pr->flags & (PROXY_SENT_BODY | PROXY_RECEIVED)) &&
+                pr->attempts++ < mprGetListCount(proxy->upstreams)) {
+            mprLog(conn, 3, "Proxy: %s %s, retrying request", msg, up->name);
+            bindRequest(pr, 1);
+        } else {
+            mprError(conn, "Proxy: %s %s", msg, up->name);
+            failRequest(pr, MPR_HTTP_CODE_BAD_GATEWAY, msg);
+        }
+    } else {
+        mprLog(proxy, 4, "Proxy: %s %s", msg, up->name);
+    }
+    startWaiting(proxy);
+}
+
+
+/*
+ *  Return a connection to the idle pool of its upstream and start the next waiting request
+ */
+static void releaseConn(ProxyConn *pc)
+{
+    Proxy       *proxy;
+
+    proxy = pc->upstream->proxy;
+    mprFlushBuf(pc->input);
+    setConnEvents(pc, MPR_READABLE);
+    mprLock(proxy->pool.mutex);
+    if (pc->req) {
+        pc->req->pc = 0;
+        pc->req = 0;
+        pc->backend.conn = 0;
+    }
+    mprAddItem(pc->upstream->idle, pc);
+    mprUnlock(proxy->pool.mutex);
+    startWaiting(proxy);
+}
+
+
+/*
+ *  Unbind a request from its connection
+ */
+static void unbindRequest(ProxyConn *pc)
+{
+    maLockBackendPool(pc->backend.pool);
+    if (pc->req) {
+        pc->req->pc = 0;
+        pc->req = 0;
+        pc->backend.conn = 0;
+    }
+    maUnlockBackendPool(pc->backend.pool);
+}
+
+
+/*
+ *  Start waiting requests while connections are available. If no connection can become available, the waiting
+ *  requests are failed. Each request is started or failed from an event that locks its own client connection.
+ */
+static void startWaiting(Proxy *proxy)
+{
+    ProxyRequest    *pr;
+    int             available;
+
+    mprLock(proxy->pool.mutex);
+    available = canWait(proxy) ? countAvailable(proxy) : mprGetListCount(proxy->pool.waiting);
+    while (available-- > 0 && (pr = mprGetFirstItem(proxy->pool.waiting)) != 0) {
+        pr->start = maCreatePoolEvent(&proxy->pool, pr->q->conn, (MaConnEventProc) startWaitingRequest, pr);
+        if (pr->start == 0) {
+            break;
+        }
+        mprRemoveItemAtPos(proxy->pool.waiting, 0);
+    }
+    mprUnlock(proxy->pool.mutex);
+}
+
+
+static void startWaitingRequest(MaConn *conn, ProxyRequest *pr)
+{
+    pr->start = 0;
+    bindRequest(pr, 1);
+}
+
+
+/*
+ *  Bind a request to a connection. Otherwise the request waits for a connection to be released, at the head of the
+ *  queue if first is set. If no connection can become available, the request is failed. Called with the client 
+ *  connection locked.
+ */
+static void bindRequest(ProxyRequest *pr, bool first)
+{
+    Proxy       *proxy;
+    ProxyConn   *pc;
+
+    proxy = pr->proxy;
+    mprLock(proxy->pool.mutex);
+    if ((pc = acquireConn(proxy)) != 0) {
+        pr->pc = pc;
+        pc->req = pr;
+        pc->backend.conn = pr->q->conn;
+
+    } else if (canWait(proxy)) {
+        if (first) {
+            mprInsertItemAtPos(proxy->pool.waiting, 0, pr);
+        } else {
+            mprAddItem(proxy->pool.waiting, pr);
+        }
+        mprLog(pr->q, 5, "Proxy: all connections busy, %d requests waiting", mprGetListCount(proxy->pool.waiting));
+        mprUnlock(proxy->pool.mutex);
+        return;
+    }
+    mprUnlock(proxy->pool.mutex);
+
+    if (pc) {
+        startRequest(pr, pc);
+    } else {
+        failRequest(pr, MPR_HTTP_CODE_SERVICE_UNAVAILABLE, "No proxy upstream available");
+    }
+}
+
+
+/*
+ *  Count the connections that may be given to waiting requests. Called locked.
+ */
+static int countAvailable(Proxy *proxy)
+{
+    ProxyUpstream   *up;
+    MprTime         now;
+    int             next, count;
+
+    now = mprGetTime(proxy);
+    count = 0;
+    for (next = 0; (up = mprGetNextItem(proxy->upstreams, &next)) != 0; ) {
+        if (now >= up->downUntil) {
+            count += mprGetListCount(up->idle) + proxy->maxConnections - up->numConnections;
+        }
+    }
+    return count;
+}
+
+
+/*
+ *  Test if an upstream is in rotation and has an idle connection or room for a new one. Called locked.
+ */
+static bool isAvailable(ProxyUpstream *up, MprTime now)
+{
+    Proxy       *proxy;
+
+    proxy = up->proxy;
+    if (now < up->downUntil || up->tried == proxy->generation) {
+        return 0;
+    }
+    return mprGetListCount(up->idle) > 0 || up->numConnections < proxy->maxConnections;
+}
+
+
+/*
+ *  Select the next upstream according to the balancing mode. Called locked.
+ */
+static ProxyUpstream *selectUpstream(Proxy *proxy, MprTime now)
+{
+    ProxyUpstream   *up, *best;
+    int             count, busy, bestBusy, i, index;
+
+    count = mprGetListCount(proxy->upstreams);
+    best = 0;
+    bestBusy = 0;
+
+    for (i = 0; i < count; i++) {
+        index = (proxy->nextUpstream + i) % count;
+        up = (ProxyUpstream*) mprGetItem(proxy->upstreams, index);
+        if (!isAvailable(up, now)) {
+            continue;
+        }
+        if (proxy->balance == PROXY_ROUND_ROBIN) {
+            proxy->nextUpstream = (index + 1) % count;
+            return up;
+        }
+        busy = up->numConnections - mprGetListCount(up->idle);
+        if (best == 0 || busy < bestBusy) {
+            best = up;
+            bestBusy = busy;
+        }
+    }
+    if (best) {
+        /*
+         *  Rotate the starting point so equally loaded upstreams share the requests
+         */
+        proxy->nextUpstream = (proxy->nextUpstream + 1) % count;
+    }
+    return best;
+}
+
+
+/*
+ *  Get an idle connection or open a new one to the selected upstream. Upstreams that refuse a connection are skipped.
+ *  Called locked.
+ */
+static ProxyConn *acquireConn(Proxy *proxy)
+{
+    ProxyUpstream   *up;
+    ProxyConn       *pc;
+    MprTime         now;
+
+    now = mprGetTime(proxy);
+    proxy->generation++;
+
+    while ((up = selectUpstream(proxy, now)) != 0) {
+        if ((pc = getIdleConn(up)) != 0) {
+            pc->reused = 1;
+            return pc;
+        }
+        if ((pc = connectUpstream(up)) != 0) {
+            return pc;
+        }
+        up->tried = proxy->generation;
+    }
+    return 0;
+}
+
+
+/*
+ *  Get an idle connection. Connections held by an I/O event are skipped. Called locked.
+ */
+static ProxyConn *getIdleConn(ProxyUpstream *up)
+{
+    ProxyConn   *pc;
+    int         i;
+
+    for (i = mprGetListCount(up->idle) - 1; i >= 0; i--) {
+        pc = (ProxyConn*) mprGetItem(up->idle, i);
+        if (pc->backend.busy == 0) {
+            mprRemoveItemAtPos(up->idle, i);
+            return pc;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Test if a busy connection may be released to service a waiting request. Called locked.
+ */
+static bool canWait(Proxy *proxy)
+{
+    ProxyUpstream   *up;
+    MprTime         now;
+    int             next;
+
+    now = mprGetTime(proxy);
+    for (next = 0; (up = mprGetNextItem(proxy->upstreams, &next)) != 0; ) {
+        if (now >= up->downUntil && up->numConnections > 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static int destroyConn(ProxyConn *pc)
+{
+    if (pc->fd >= 0) {
+        mprFree(pc->backend.handler);
+        pc->backend.handler = 0;
+        close(pc->fd);
+        pc->fd = -1;
+        pc->upstream->numConnections--;
+    }
+    return 0;
+}
+
+
+/*
+ *  Open a new non-blocking connection to an upstream. Called locked.
+ */
+static ProxyConn *connectUpstream(ProxyUpstream *up)
+{
+    ProxyConn   *pc;
+    Proxy       *proxy;
+    int         fd, rc, one;
+
+    proxy = up->proxy;
+    if ((fd = socket(up->addr.ss_family, SOCK_STREAM, 0)) < 0) {
+        mprError(proxy, "Proxy: can't create socket, errno %d", errno);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char*) &one, sizeof(one));
+
+    do {
+        rc = connect(fd, (struct sockaddr*) &up->addr, up->addrLen);
+    } while (rc < 0 && errno == EINTR);
+
+    if (rc < 0 && errno != EINPROGRESS) {
+        mprLog(proxy, 3, "Proxy: can't connect to %s, errno %d", up->name, errno);
+        close(fd);
+        markFailure(up);
+        return 0;
+    }
+    pc = mprAllocObjWithDestructorZeroed(proxy, ProxyConn, destroyConn);
+    pc->backend.pool = &proxy->pool;
+    pc->upstream = up;
+    pc->fd = fd;
+    pc->connecting = (rc < 0);
+    pc->input = mprCreateBuf(pc, MPR_BUFSIZE, -1);
+    pc->output = mprCreateBuf(pc, MPR_BUFSIZE, -1);
+    pc->mask = pc->connecting ? MPR_WRITEABLE : MPR_READABLE;
+    pc->backend.handler = mprCreateWaitHandler(pc, fd, pc->mask, (MprWaitProc) proxyEvent, pc,
+        MPR_NORMAL_PRIORITY, 0);
+    up->numConnections++;
+
+    mprLog(proxy, 4, "Proxy: opened connection %d of %d to %s", up->numConnections, proxy->maxConnections, up->name);
+    return pc;
+}
+
+
+/*
+ *  Close a connection. The connection object is freed immediately unless it is held by an active caller.
+ */
+static void closeConn(ProxyConn *pc)
+{
+    MaBackendPool   *pool;
+    ProxyUpstream   *up;
+
+    up = pc->upstream;
+    pool = pc->backend.pool;
+    maLockBackendPool(pool);
+    if (mprGetListCount(up->idle) > 0) {
+        mprRemoveItem(up->idle, pc);
+    }
+    destroyConn(pc);
+    if (pc->backend.busy == 0) {
+        mprFree(pc);
+    }
+    maUnlockBackendPool(pool);
+}
+
+
+static Proxy *getProxy(MaLocation *location)
+{
+    Proxy       *proxy;
+
+    if ((proxy = (Proxy*) location->handlerData) == 0) {
+        proxy = mprAllocObjZeroed(location, Proxy);
+        maInitBackendPool(&proxy->pool);
+        proxy->upstreams = mprCreateList(proxy);
+        proxy->maxConnections = MA_PROXY_CONNECTIONS;
+        proxy->maxFailures = MA_PROXY_MAX_FAILURES;
+        proxy->retryPeriod = MA_PROXY_RETRY_PERIOD;
+        location->handlerData = proxy;
+    }
+    return proxy;
+}
+
+
+/*
+ *  Define an upstream of the form "http://host:port/prefix". The address is resolved once when parsed.
+ */
+static int addUpstream(MaHttp *http, Proxy *proxy, char *uri)
+{
+    ProxyUpstream   *up;
+    struct addrinfo hints, *res;
+    char            *host, *port, *path, *cp;
+    int             rc, len;
+
+    if (mprStrcmpAnyCaseCount(uri, "http://", 7) != 0) {
+        mprError(http, "Proxy upstream must be an http URI: %s", uri);
+        return MPR_ERR_BAD_SYNTAX;
+    }
+    up = mprAllocObjZeroed(proxy, ProxyUpstream);
+    up->proxy = proxy;
+    up->idle = mprCreateList(up);
+
+    host = mprStrdup(up, &uri[7]);
+    if ((path = strchr(host, '/')) != 0) {
+        up->prefix = mprStrdup(up, path);
+        *path = '\0';
+        len = (int) strlen(up->prefix);
+        if (len > 0 && up->prefix[len - 1] == '/') {
+            up->prefix[len - 1] = '\0';
+        }
+    } else {
+        up->prefix = mprStrdup(up, "");
+    }
+    up->name = mprStrdup(up, host);
+
+    port = "80";
+    if (*host == '[' && (cp = strchr(host, ']')) != 0) {
+        host++;
+        *cp++ = '\0';
+        if (*cp == ':') {
+            port = &cp[1];
+        }
+    } else if ((cp = strrchr(host, ':')) != 0) {
+        *cp = '\0';
+        port = &cp[1];
+    }
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if ((rc = getaddrinfo(host, port, &hints, &res)) != 0 || res == 0) {
+        mprError(http, "Can't resolve proxy upstream %s", uri);
+        mprFree(up);
+        return MPR_ERR_NOT_FOUND;
+    }
+    memcpy(&up->addr, res->ai_addr, res->ai_addrlen);
+    up->addrLen = (int) res->ai_addrlen;
+    freeaddrinfo(res);
+
+    mprAddItem(proxy->upstreams, up);
+    return 0;
+}
+
+
+#if BLD_FEATURE_CONFIG_PARSE
+static int parseProxy(MaHttp *http, cchar *key, char *value, MaConfigState *state)
+{
+    Proxy       *proxy;
+    char        *failures, *period, *tok;
+
+    if (mprStrcmpAnyCase(key, "ProxyUpstream") == 0) {
+        proxy = getProxy(state->location);
+        return addUpstream(http, proxy, mprStrTrim(value, "\"")) < 0 ? MPR_ERR_BAD_SYNTAX : 1;
+
+    } else if (mprStrcmpAnyCase(key, "ProxyBalance") == 0) {
+        proxy = getProxy(state->location);
+        if (mprStrcmpAnyCase(value, "round-robin") == 0) {
+            proxy->balance = PROXY_ROUND_ROBIN;
+        } else if (mprStrcmpAnyCase(value, "least-connections") == 0) {
+            proxy->balance = PROXY_LEAST_CONN;
+        } else {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "ProxyConnections") == 0) {
+        proxy = getProxy(state->location);
+        if ((proxy->maxConnections = mprAtoi(value, 10)) <= 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "ProxyHealth") == 0) {
+        proxy = getProxy(state->location);
+        failures = mprStrTok(value, " \t", &tok);
+        period = mprStrTok(0, " \t", &tok);
+        if (failures == 0 || (proxy->maxFailures = mprAtoi(failures, 10)) <= 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        if (period) {
+            proxy->retryPeriod = mprAtoi(period, 10) * 1000;
+        }
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+
+/*
+ *  Dynamic module initialization
+ */
+MprModule *maProxyHandlerInit(MaHttp *http, cchar *path)
+{
+    MprModule   *module;
+    MaStage     *handler;
+
+    module = mprCreateModule(http, "proxyHandler", BLD_VERSION, NULL, NULL, NULL);
+    if (module == 0) {
+        return 0;
+    }
+    handler = maCreateHandler(http, "proxyHandler", MA_STAGE_ALL | MA_STAGE_VIRTUAL);
+    if (handler == 0) {
+        mprFree(module);
+        return 0;
+    }
+    handler->open = openProxy;
+    handler->close = closeProxy;
+    handler->outgoingData = outgoingProxyData;
+    handler->outgoingService = outgoingProxyService;
+    handler->incomingData = incomingProxyData;
+    handler->run = runProxy;
+#if BLD_FEATURE_CONFIG_PARSE
+    handler->parse = parseProxy;
+#endif
+    return module;
+}
+
+
+#else
+void mprProxyHandlerDummy() {}
+
+#endif /* BLD_FEATURE_PROXY */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -17,7 +17,20 @@
 #if BLD_FEATURE_UPLOAD
 /*********************************** Locals ***********************************/
 
-#define UPLOAD_BUF_SIZE         4096        /* Post data buffer size */
+#define UPLOAD_BUF_SIZE         (64 * 1024) /* Input parse buffer size */
+#define UPLOAD_MAX_BOUNDARY     70          /* Max boundary length (RFC 2046) */
+
+#define UPLOAD_SYNC_NONE        0           /* Leave write back to the O/S */
+#define UPLOAD_SYNC_COMPLETE    1           /* Synchronize the files when the upload is complete */
+#define UPLOAD_SYNC_STREAM      2           /* Start write back as data is received and synchronize on completion */
+
+/*
+ *  Upload configuration. The handler has a default configuration and locations may define their own.
+ */
+typedef struct MaUploadConfig {
+    char            *uploadDir;         /* Upload directory */
+    int             sync;               /* File durability mode */
+} MaUploadConfig;
 
 /*
  *  Configuration for the upload handler
@@ -25,9 +38,9 @@
 typedef struct UploadHandler {
     MaUploadCallback callback;          /* User fn to process upload data */
     void            *callbackData;      /* User fn callback data */
+    MaUploadConfig  *config;            /* Default configuration */
     MprList         *handlerHeaders;    /* List of handler headers */
     MaLocation      *location;          /* Upload URL location prefix */
-    char            *uploadDir;         /* Default upload directory */
 #if BLD_FEATURE_MULTITHREAD
     MprMutex        *mutex;
 #endif
@@ -40,32 +53,66 @@ typedef struct UploadHandler {
 #define MA_UPLOAD_CONTENT_END           5   /* End of multipart message */
 
 /*
- *  State for an upload request
+ *  State for an upload request. The input is parsed as it arrives using a fixed size buffer, so the memory used by
+ *  an upload does not depend on the size of the request body.
  */
 typedef struct Upload {
     char            *boundary;          /* Boundary signature */
     int             boundaryLen;        /* Length of boundary */
+    MprBuf          *buf;               /* Unparsed input */
     MaUploadCallback callback;          /* User fn to process upload data */
     void            *callbackData;      /* User fn callback data */
     int             contentState;       /* Input states */
+    char            *delimiter;         /* Boundary delimiter in content data. Includes the preceding CRLF */
+    int             delimiterLen;       /* Length of delimiter */
     MaUploadFile    *file;              /* Current file */
     MprHashTable    *files;             /* List of uploaded files */
+    int             fileOffset;         /* Offset in the current file of the pending write data */
     char            *fileName;          /* Current file filename */
     char            *filePath;          /* Current file incoming filename */
     //  TODO - remove this fileSize as we can use file->size
     int             fileSize;           /* Current file size */
     MaLocation      *location;          /* Upload URL location prefix */
     char            *nameField;         /* Current name keyword value */
+    int             skip[256];          /* Boyer-Moore-Horspool skip table for the delimiter */
+    int             preallocated;       /* Storage has been reserved for the current file */
+    int             sync;               /* File durability mode */
+    MprList         *unsynced;          /* Completed files waiting to be synchronized */
+    struct UploadSync *syncer;          /* Pending synchronization of the completed files */
     MprFile         *upfile;            /* Incoming file object */
     char            *uploadDir;         /* Upload dir */
+    MprBuf          *value;             /* Current form field value */
+    char            *writeBuf;          /* File data pending write */
+    int             writeLen;           /* Length of data in writeBuf */
 } Upload;
 
+/*
+ *  Synchronization of the completed files. This runs on a pool thread so waiting for the disk does not hold the 
+ *  thread servicing the connection. It owns the files, so the upload may be closed first.
+ */
+typedef struct UploadSync {
+    MaConn          *conn;              /* Client connection */
+    MaQueue         *q;                 /* Handler queue */
+    Upload          *up;                /* Upload state. Null if the upload is closed first */
+    MprList         *files;             /* Files to synchronize */
+} UploadSync;
+
 /********************************** Forwards **********************************/
 
-static char *findBoundary(void *buf, int bufLen, void *boundary, int boundaryLen);
+static char *findBoundary(Upload *up, char *buf, int bufLen);
+static int  closeFile(MaQueue *q);
+static int  flushFile(MaQueue *q);
+static char *getBoundary(MaConn *conn);
+static char *getLine(Upload *up);
+static MaUploadConfig *getConfig(MaConn *conn);
 static int  processContentBoundary(MaQueue *q, char *line);
 static int  processContentHeader(MaQueue *q, char *line);
 static int  processContentData(MaQueue *q);
+static int  processInput(MaQueue *q);
+static void reportFiles(MaQueue *q);
+static void startSync(MaQueue *q);
+static void syncFiles(UploadSync *us, MprEvent *event);
+static int  writeContent(MaQueue *q, char *data, int len);
 
 /************************************* Code ***********************************/
 
@@ -86,133 +133,275 @@ static void uploadOpen(MaQueue *q)
     MaResponse      *resp;
     Upload          *up;
     UploadHandler   *uph;
+    MaUploadConfig  *config;
+    char            *boundary;
+    int             i;
 
     conn = q->conn;
     resp = conn->response;
 
     uph = resp->handler->stageData;
     mprAssert(uph);
+    config = getConfig(conn);
 
     up = mprAllocObjZeroed(resp, Upload);
     if (up == 0) {
         return;
     }
+    /*
+     *  Incoming data is delivered to the receive queue, so share the upload state with the queue pair.
+     */
     q->queueData = up;
+    if (q->pair) {
+        q->pair->queueData = up;
+    }
 
-    up->contentState = MA_UPLOAD_REQUEST_HEADER;
+    up->contentState = MA_UPLOAD_BOUNDARY;
     up->files = mprCreateHash(up, -1);
     
-    //  TDOO - why replicate this
-    up->uploadDir = mprStrdup(up, uph->uploadDir);
+    up->uploadDir = mprStrdup(up, config->uploadDir);
+    up->sync = config->sync;
     up->callback = uph->callback;
     up->callbackData = uph->callbackData;
+
+    if ((boundary = getBoundary(conn)) == 0) {
+        maFailRequest(conn, MPR_HTTP_CODE_BAD_REQUEST, "Bad boundary");
+        return;
+    }
+    up->boundaryLen = mprAllocSprintf(up, &up->boundary, MPR_MAX_STRING, "--%s", boundary);
+    up->delimiterLen = mprAllocSprintf(up, &up->delimiter, MPR_MAX_STRING, "\r\n%s", up->boundary);
+
+    /*
+     *  Build the Boyer-Moore-Horspool skip table for the delimiter. This permits most of the content data to be
+     *  skipped without examining every byte.
+     */
+    for (i = 0; i < 256; i++) {
+        up->skip[i] = up->delimiterLen;
+    }
+    for (i = 0; i < up->delimiterLen - 1; i++) {
+        up->skip[(uchar) up->delimiter[i]] = up->delimiterLen - 1 - i;
+    }
+    up->buf = mprCreateBuf(up, UPLOAD_BUF_SIZE, UPLOAD_BUF_SIZE);
+    up->value = mprCreateBuf(up, MPR_BUFSIZE, UPLOAD_BUF_SIZE);
+
+    maSetFormVar(conn, "UPLOAD_DIR", up->uploadDir);
+}
+
+
+/*
+ *  Get the upload configuration for the request. A location may define its own.
+ */
+static MaUploadConfig *getConfig(MaConn *conn)
+{
+    MaLocation      *location;
+    UploadHandler   *uph;
+
+    location = conn->request->location;
+    uph = conn->response->handler->stageData;
+
+    if (location->uploadConfig) {
+        return location->uploadConfig;
+    }
+    return uph->config;
+}
+
+
+/*
+ *  Extract the boundary from the request content type. Returns zero if missing or invalid.
+ */
+static char *getBoundary(MaConn *conn)
+{
+    char    *cp, *boundary;
+    int     len;
+
+    for (cp = conn->request->mimeType; cp && *cp; cp++) {
+        if (mprStrcmpAnyCaseCount(cp, "boundary=", 9) == 0) {
+            break;
+        }
+    }
+    if (cp == 0 || *cp == '\0') {
+        return 0;
+    }
+    cp += 9;
+    if (*cp == '"') {
+        cp++;
+        len = (int) strcspn(cp, "\"");
+    } else {
+        len = (int) strcspn(cp, "; \t");
+    }
+    if (len <= 0 || len > UPLOAD_MAX_BOUNDARY) {
+        return 0;
+    }
+    boundary = mprStrdup(conn->response, cp);
+    boundary[len] = '\0';
+    return boundary;
 }
 
 
+/*
+ *  Remove any uploaded files. The upload callback must rename files it wishes to keep.
+ */
 static void uploadClose(MaQueue *q)
 {
-    Upload      *up;
+    Upload          *up;
+    MaUploadFile    *file;
+    MprFile         *upfile;
+    MprHash         *hp;
+    int             next;
 
     up = q->queueData;
-    if (up->filePath && *up->filePath) {
-        mprDelete(q, up->filePath);
+    if (up == 0) {
+        return;
+    }
+    if (up->upfile) {
+        mprFree(up->upfile);
+        up->upfile = 0;
+    }
+    if (up->unsynced) {
+        for (next = 0; (upfile = mprGetNextItem(up->unsynced, &next)) != 0; ) {
+            mprFree(upfile);
+        }
+        up->unsynced = 0;
+    }
+    if (up->syncer) {
+        up->syncer->up = 0;
+        up->syncer = 0;
+    }
+    for (hp = mprGetFirstHash(up->files); hp; hp = mprGetNextHash(up->files, hp)) {
+        file = (MaUploadFile*) hp->data;
+        if (file->filename && mprAccess(q, file->filename, R_OK)) {
+            mprDelete(q, file->filename);
+        }
     }
 }
 
 
+/*
+ *  Accept incoming request body data. Data is copied into the parse buffer and parsed as it arrives. File data is
+ *  written to disk once parsed, so packets are not retained.
+ */
 static void uploadIncomingData(MaQueue *q, MaPacket *packet)
 {
     MaConn      *conn;
-    MaRequest   *req;
-    MprBuf      *content;
-    MprHash     *hp;
     Upload      *up;
-    char        *line, *nextTok;
+    char        *data;
+    int         len, nbytes;
     
     mprAssert(packet);
     
     conn = q->conn;
-    req = conn->request;
     up = q->queueData;
     
-    if (packet->count == 0) {
-        /* TODO END OF INPUT */
-    }
-    
     mprLog(conn, 5, "uploadIncomingData: %d bytes", packet->count);
-    
-    maJoinPacket(q->first, packet);
-
-    content = q->first->content;
 
-    line = 0;
-
-    while (1) {
+    if (up == 0 || up->buf == 0 || conn->requestFailed || packet->count == 0) {
         /*
-         *  Read the next line
+         *  Discard data after a failure and the end of input packet
          */
-        switch (up->contentState) {
-        case MA_UPLOAD_BOUNDARY:
-        case MA_UPLOAD_CONTENT_HEADER:
-            line = mprGetBufStart(content);
-            mprStrTok(line, "\n", &nextTok);
-            if (nextTok == 0) {
-                return;                         /* Incomplete line */
-            }
-            mprAdjustBufStart(content, (int) (nextTok - line));
-            mprStrTrim(line, "\r");
+        mprFree(packet);
+        return;
+    }
+    data = mprGetBufStart(packet->content);
+    len = mprGetBufLength(packet->content);
+
+    while (len > 0) {
+        nbytes = mprPutBlockToBuf(up->buf, data, len);
+        data += nbytes;
+        len -= nbytes;
+        if (processInput(q) < 0) {
+            break;
+        }
+        mprCompactBuf(up->buf);
+        if (nbytes == 0 && mprGetBufSpace(up->buf) == 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_BAD_REQUEST, "Bad upload state. Header too long");
             break;
-
-        case MA_UPLOAD_CONTENT_DATA:
-        default:
-            /* Data read below */
-            ;
         }
+    }
+    /*
+     *  Rather than free the consumed packet, give it back to the connection for the next read. This keeps memory 
+     *  bounded regardless of the upload size.
+     */
+    maRecyclePacket(conn, packet);
+}
 
-        /*
-         *  Do per state processing
-         */
+
+/*
+ *  Parse as much of the buffered input as possible.
+ *
+ *  Returns  < 0 on a request or state error
+ *          == 0 when more data is needed
+ */
+static int processInput(MaQueue *q)
+{
+    MaConn      *conn;
+    MprHash     *hp;
+    Upload      *up;
+    char        *line;
+    int         rc;
+
+    conn = q->conn;
+    up = q->queueData;
+
+    while (!conn->requestFailed) {
         switch (up->contentState) {
         case MA_UPLOAD_BOUNDARY:
-            if (processContentBoundary(q, line) < 0) {
-                return;
-            }
-            break;
-
         case MA_UPLOAD_CONTENT_HEADER:
-            if (processContentHeader(q, line) < 0) {
-                return;
+            if ((line = getLine(up)) == 0) {
+                return 0;                       /* Incomplete line */
             }
-            break;
-
-        case MA_UPLOAD_CONTENT_DATA:
-            if (processContentData(q) < 0) {
-                return;
+            if (up->contentState == MA_UPLOAD_BOUNDARY) {
+                rc = processContentBoundary(q, line);
+            } else {
+                rc = processContentHeader(q, line);
             }
-            if (mprGetBufLength(content) < up->boundaryLen) {
-                /*  Incomplete boundary. Return and get more data */
-                return;
+            if (rc < 0) {
+                return rc;
             }
-            break;
-
-        case MA_UPLOAD_CONTENT_END:
-            if (up->callback) {
+            if (up->contentState == MA_UPLOAD_CONTENT_END && up->callback) {
                 hp = mprGetFirstHash(up->files);
                 while (hp) {
                     (*up->callback)(conn, up->callbackData, (MaUploadFile*) hp->data);
                     hp = mprGetNextHash(up->files, hp);
                 }
             }
-            return;
+            break;
+
+        case MA_UPLOAD_CONTENT_DATA:
+            if ((rc = processContentData(q)) <= 0) {
+                return rc;
+            }
+            break;
+
+        case MA_UPLOAD_CONTENT_END:
+        default:
+            /*
+             *  Discard any epilogue after the final boundary
+             */
+            mprFlushBuf(up->buf);
+            return 0;
         }
     }
+    return MPR_ERR_BAD_STATE;
+}
 
-    if (req->remainingContent <= 0) {
-        /*
-         *  All done. TODO - see above.
-         */
-        up->contentState = MA_UPLOAD_CONTENT_END;
+
+/*
+ *  Get the next line from the parse buffer. The line is null terminated and the trailing CRLF is removed.
+ */
+static char *getLine(Upload *up)
+{
+    char    *line, *cp;
+
+    line = mprGetBufStart(up->buf);
+    if ((cp = memchr(line, '\n', mprGetBufLength(up->buf))) == 0) {
+        return 0;
+    }
+    *cp = '\0';
+    mprAdjustBufStart(up->buf, (int) (cp - line) + 1);
+    if (cp > line && cp[-1] == '\r') {
+        cp[-1] = '\0';
     }
+    return line;
 }
 
 
@@ -258,12 +447,15 @@ static int processContentBoundary(MaQueue *q, char *line)
 static int processContentHeader(MaQueue *q, char *line)
 {
     MaConn          *conn;
+    MaRequest       *req;
     MaUploadFile    *file;
     Upload          *up;
+    MprOffset       size;
     char            tmpFile[MPR_MAX_FNAME];
     char            *key, *headerTok, *rest, *nextPair, *value;
 
     conn = q->conn;
+    req = conn->request;
     up = q->queueData;
     
     if (line[0] == '\0') {
@@ -322,11 +514,24 @@ static int processContentHeader(MaQueue *q, char *line)
 
                 mprLog(conn, 5, "File upload of: %s stored as %s", up->fileName, up->filePath);
 
-                up->upfile = mprOpen(up, up->filePath, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0600);
+                /*
+                 *  The file is owned by the connection so it may be synchronized after the request is freed
+                 */
+                up->upfile = mprOpen(conn, up->filePath, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0600);
                 if (up->upfile == 0) {
                     maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't open upload temp file %s", up->filePath);
                     return MPR_ERR_BAD_STATE;
                 }
+                up->fileSize = 0;
+                up->fileOffset = 0;
+
+                /*
+                 *  If the request length is known, the rest of the body bounds the file size. Reserve the storage so
+                 *  the file is written contiguously. The excess is released when the file is closed.
+                 */
+                size = (MprOffset) req->remainingContent + mprGetBufLength(up->buf) + MA_BUFSIZE;
+                up->preallocated = req->length > 0 && size >= MA_UPLOAD_WRITE_SIZE && 
+                    mprPreallocFile(up->upfile, size) == 0;
 
                 /*
                  *  Create the files[entry]
@@ -353,186 +558,337 @@ static int processContentHeader(MaQueue *q, char *line)
 
 
 /*
- *  Process the content data.
+ *  Process the content data. The buffered data is searched for the boundary delimiter. Data before the delimiter is
+ *  written to the current file or form field. If the delimiter is not found, all but the trailing delimiterLen - 1 
+ *  bytes are written, as the trailing bytes may be the start of a delimiter that completes in the next packet.
  *
  *  Returns < 0 on error
  *          == 0 when more data is needed
- *          == 1 when data successfully written
+ *          == 1 when the end of the part has been processed
  */
 static int processContentData(MaQueue *q)
 {
-    MaLimits    *limits;
     MaConn      *conn;
     Upload      *up;
     MprBuf      *content;
-    char        *fileData, *bp;
-    int         size, fileDataLen, rc;
+    char        *data, *bp;
+    int         size, len;
 
     conn = q->conn;
     up = q->queueData;
-    content = q->first->content;
-    limits = conn->host->limits;
+    content = up->buf;
 
+    data = mprGetBufStart(content);
     size = mprGetBufLength(content);
-    if (size < up->boundaryLen) {
-        /*  Incomplete boundary. Return and get more data */
-        return 0;
-    }
-
-    bp = findBoundary(mprGetBufStart(content), size, up->boundary, up->boundaryLen);
-    if (bp == 0) {
-
-        if (up->fileName) {
-            /*
-             *  No signature found yet. probably more data to come. Since we did not match the boundary above we 
-             *  know there is no boundary. But there could be most of the boundary with the boundary tail in the 
-             *  next block of data. Must always preserve boundary-1 bytes.
-             */
-            fileData = mprGetBufStart(content);
-            fileDataLen = ((int) (mprGetBufEnd(content) - fileData)) - (up->boundaryLen - 1);
 
-            if ((up->fileSize + fileDataLen) > limits->maxUploadSize) {
-                maFailRequest(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, 
-                    "Uploaded file %s exceeds maximum %d\n", up->filePath, limits->maxUploadSize);
+    if ((bp = findBoundary(up, data, size)) == 0) {
+        len = size - (up->delimiterLen - 1);
+        if (len > 0) {
+            if (writeContent(q, data, len) < 0) {
                 return MPR_ERR_CANT_WRITE;
             }
-            if (fileDataLen > 0) {
-                mprAdjustBufStart(content, fileDataLen);
-
-                /*
-                 *  File upload. Write the file data.
-                 */
-                rc = mprWrite(up->upfile, fileData, fileDataLen);
-                if (rc != fileDataLen) {
-                    maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, 
-                        "Can't write to upload temp file %s, rc %d, errno %d\n", up->filePath, rc, mprGetOsError(up));
-                    return MPR_ERR_CANT_WRITE;
-                }
-                up->fileSize += fileDataLen;
-                up->file->size = up->fileSize;
-            }
+            mprAdjustBufStart(content, len);
         }
         return 0;       /* Get more data */
     }
 
     mprLog(conn, 7, "Boundary found");
-    fileData = mprGetBufStart(content);
-    fileDataLen = (int) (bp - fileData);
-
-    if (fileDataLen > 0) {
+    len = (int) (bp - data);
+    if (writeContent(q, data, len) < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
 
-        mprAdjustBufStart(content, fileDataLen);
+    /*
+     *  Skip the CRLF that starts the delimiter. The boundary line is then parsed in the boundary state.
+     */
+    mprAdjustBufStart(content, len + 2);
 
+    if (up->upfile) {
         /*
-         *  This is the CRLF before the boundary
+         *  Now have all the data (we've seen the boundary)
          */
-        if (fileDataLen >= 2 && fileData[fileDataLen - 2] == '\r' && fileData[fileDataLen - 1] == '\n') {
-            fileDataLen -= 2;
+        if (closeFile(q) < 0) {
+            return MPR_ERR_CANT_WRITE;
         }
 
-        if (up->fileName) {
-            /*
-             *  File upload. Write the file data
-             */
-            rc = mprWrite(up->upfile, fileData, fileDataLen);
-            if (rc != fileDataLen) {
-                maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't write trailing data to upload temp file %s, "
-                    "rc %d, errno %d\n", 
-                    up->filePath, rc, mprGetOsError());
-                return MPR_ERR_CANT_WRITE;
-            }
-            up->fileSize += fileDataLen;
-            up->file->size = up->fileSize;
-
-            /*
-             *  Now have all the data (we've seen the boundary)
-             */
-            mprFree(up->upfile);
-            up->upfile = 0;
-            //  TODO - free?
-            up->fileName = 0;
-
-        } else {
-            /*
-             *  Normal string form data variables
-             */
-            fileData[fileDataLen] = '\0';
-            mprLog(conn, 5, "Set form[%s] = %s", up->nameField, fileData);
-            //  TODO - not right
-            maSetFormVar(conn, up->nameField, fileData);
-        }
+    } else if (up->nameField) {
+        /*
+         *  Normal string form data variables
+         */
+        mprAddNullToBuf(up->value);
+        mprLog(conn, 5, "Set form[%s] = %s", up->nameField, mprGetBufStart(up->value));
+        maSetFormVar(conn, up->nameField, mprStrdup(conn->request, mprGetBufStart(up->value)));
+        mprFlushBuf(up->value);
     }
     up->contentState = MA_UPLOAD_BOUNDARY;
     return 1;
 }
 
 
-static void uploadOutgoingService(MaQueue *q)
+/*
+ *  Write part content. File data is accumulated and written in MA_UPLOAD_WRITE_SIZE blocks so that writes are large 
+ *  and aligned in the file regardless of the packet sizes. Form field values are buffered up to UPLOAD_BUF_SIZE.
+ */
+static int writeContent(MaQueue *q, char *data, int len)
 {
-    MaRequest   *req;
     MaConn      *conn;
+    MaLimits    *limits;
     Upload      *up;
-    char        *mimeType, *param;
+    int         nbytes;
 
     conn = q->conn;
-    req = conn->request;
     up = q->queueData;
+    limits = conn->host->limits;
+
+    if (len <= 0) {
+        return 0;
+    }
+    if (up->upfile == 0) {
+        if (mprPutBlockToBuf(up->value, data, len) != len) {
+            maFailRequest(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, "Upload form field %s is too large", up->nameField);
+            return MPR_ERR_WONT_FIT;
+        }
+        return 0;
+    }
+    if ((up->fileSize + len) > limits->maxUploadSize) {
+        maFailRequest(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, 
+            "Uploaded file %s exceeds maximum %d\n", up->filePath, limits->maxUploadSize);
+        return MPR_ERR_CANT_WRITE;
+    }
+    up->fileSize += len;
+    up->file->size = up->fileSize;
+
+    if (up->writeBuf == 0) {
+        up->writeBuf = (char*) mprAlloc(up, MA_UPLOAD_WRITE_SIZE);
+        if (up->writeBuf == 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't allocate upload write buffer");
+            return MPR_ERR_NO_MEMORY;
+        }
+    }
+    while (len > 0) {
+        nbytes = min(len, MA_UPLOAD_WRITE_SIZE - up->writeLen);
+        memcpy(&up->writeBuf[up->writeLen], data, nbytes);
+        up->writeLen += nbytes;
+        if (up->writeLen == MA_UPLOAD_WRITE_SIZE && flushFile(q) < 0) {
+            return MPR_ERR_CANT_WRITE;
+        }
+        data += nbytes;
+        len -= nbytes;
+    }
+    return 0;
+}
 
 
-//  TODO BUG  - what should param be set to
-param = "";
-    /*
-     *  The string to use as the multipart boundary divider is the next token
-     */
-    if (mprStrcmpAnyCaseCount(param, "boundary=", 9) == 0) {
-        param += 9;
+/*
+ *  Write any pending file data. In stream sync mode, start write back of the new block without waiting for it. This 
+ *  spreads the I/O over the upload so little dirty data remains when the file is synchronized.
+ */
+static int flushFile(MaQueue *q)
+{
+    Upload      *up;
+    int         rc;
+
+    up = q->queueData;
+    if (up->writeLen > 0) {
+        rc = mprWrite(up->upfile, up->writeBuf, up->writeLen);
+        if (rc != up->writeLen) {
+            maFailRequest(q->conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, 
+                "Can't write to upload temp file %s, rc %d, errno %d\n", up->filePath, rc, mprGetOsError(up));
+            return MPR_ERR_CANT_WRITE;
+        }
+        if (up->sync == UPLOAD_SYNC_STREAM) {
+            mprSyncFile(up->upfile, up->fileOffset, up->writeLen, 0);
+        }
+        up->fileOffset += up->writeLen;
+        up->writeLen = 0;
     }
+    return 0;
+}
 
-    up->boundaryLen = mprAllocSprintf(up, &up->boundary, MPR_MAX_STRING, "--%s", param);
 
-//  TODO BUG
-//  mprFree(mimeType);
-    mimeType = 0;
+/*
+ *  Complete the current file and release any unused reserved storage. If the file must be synchronized, it is kept
+ *  open until the upload is complete.
+ */
+static int closeFile(MaQueue *q)
+{
+    Upload      *up;
 
-    if (up->boundaryLen == 0 || *up->boundary == '\0') {
-        maFailRequest(conn, MPR_HTTP_CODE_BAD_REQUEST, "Bad boundary");
+    up = q->queueData;
+
+    if (flushFile(q) < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+    if (up->preallocated && mprTruncateFile(up->upfile, up->fileOffset) < 0) {
+        maFailRequest(q->conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't truncate upload temp file %s, errno %d\n",
+            up->filePath, mprGetOsError(up));
+        return MPR_ERR_CANT_WRITE;
+    }
+    if (up->sync != UPLOAD_SYNC_NONE) {
+        if (up->unsynced == 0) {
+            up->unsynced = mprCreateList(up);
+        }
+        mprAddItem(up->unsynced, up->upfile);
+    } else {
+        mprFree(up->upfile);
+    }
+    up->upfile = 0;
+    up->preallocated = 0;
+    up->fileName = 0;
+    return 0;
+}
+
+
+/*
+ *  Run after all the request body has been received. Report the uploaded files once they are synchronized.
+ */
+static void uploadRun(MaQueue *q)
+{
+    MaConn          *conn;
+    Upload          *up;
+
+    conn = q->conn;
+    up = q->queueData;
+
+    if (!conn->requestFailed && up && up->contentState != MA_UPLOAD_CONTENT_END) {
+        maFailRequest(conn, MPR_HTTP_CODE_BAD_REQUEST, "Bad upload state. Incomplete upload");
+    }
+    if (!conn->requestFailed && up && up->unsynced) {
+        startSync(q);
+    } else {
+        reportFiles(q);
+    }
+}
+
+
+/*
+ *  Start synchronizing the completed files. The files are given to the sync request which runs on a pool thread. 
+ *  Single-threaded builds run it from the event loop. The sync request and the files are owned by the connection.
+ */
+static void startSync(MaQueue *q)
+{
+    MaConn          *conn;
+    MprFile         *file;
+    UploadSync      *us;
+    Upload          *up;
+    int             next;
+
+    conn = q->conn;
+    up = q->queueData;
+
+    us = mprAllocObjZeroed(conn, UploadSync);
+    us->conn = conn;
+    us->q = q;
+    us->up = up;
+    us->files = mprCreateList(us);
+    for (next = 0; (file = mprGetNextItem(up->unsynced, &next)) != 0; ) {
+        mprStealBlock(us, file);
+        mprAddItem(us->files, file);
+    }
+    up->unsynced = 0;
+
+    maHoldConn(conn);
+    if (mprCreateEvent(us, (MprEventProc) syncFiles, 0, MPR_NORMAL_PRIORITY, us, MPR_EVENT_THREAD) == 0) {
+        mprFree(us);
+        maReleaseConn(conn);
+        maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't schedule upload file synchronization");
+        reportFiles(q);
         return;
     }
+    up->syncer = us;
+}
 
-    maSetFormVar(conn, "UPLOAD_DIR", up->uploadDir);
 
-    up->contentState = MA_UPLOAD_BOUNDARY;
+/*
+ *  Synchronize the files without the connection locked, then lock the connection to report the files.
+ */
+static void syncFiles(UploadSync *us, MprEvent *event)
+{
+    MaConn          *conn;
+    MprFile         *file;
+    int             next, rc;
+
+    for (rc = 0, next = 0; (file = mprGetNextItem(us->files, &next)) != 0; ) {
+        if (mprSyncFile(file, 0, 0, 1) < 0) {
+            rc = MPR_ERR_CANT_WRITE;
+        }
+    }
+    conn = us->conn;
+    maLockConn(conn);
+    if (us->up && !(conn->flags & MA_CONN_DESTROYED)) {
+        us->up->syncer = 0;
+        if (rc < 0) {
+            maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't sync upload files");
+        }
+        reportFiles(us->q);
+        maServiceQueues(conn);
+        if (conn->state == MPR_HTTP_STATE_COMPLETE) {
+            maProcessReadEvent(conn, 0);
+            maAwakenConn(conn);
+        } else {
+            maEnableBackendWrites(conn);
+        }
+    }
+    mprFree(us);
+    maUnlockConn(conn);
+    maReleaseConn(conn);
 }
 
 
 /*
- *  Find the boundary signature in memory. Returns pointer to the first match.
+ *  Write the response listing the uploaded files
+ */
+static void reportFiles(MaQueue *q)
+{
+    MaConn          *conn;
+    MaUploadFile    *file;
+    MprHash         *hp;
+    Upload          *up;
+
+    conn = q->conn;
+    up = q->queueData;
+
+    maDontCacheResponse(conn);
+    maPutForService(q, maCreateHeaderPacket(conn), 0);
+
+    if (!conn->requestFailed) {
+        maWrite(q, "<HTML><BODY>\r\n");
+        for (hp = mprGetFirstHash(up->files); hp; hp = mprGetNextHash(up->files, hp)) {
+            file = (MaUploadFile*) hp->data;
+            maWrite(q, "<P>FILE %s=%s SIZE=%d</P>\r\n", file->name, file->clientFilename, file->size);
+        }
+        maWrite(q, "</BODY></HTML>\r\n");
+    }
+    maPutForService(q, maCreateEndPacket(conn), 1);
+}
+
+
+/*
+ *  Find the boundary delimiter using the Boyer-Moore-Horspool algorithm. Returns pointer to the first match.
  */ 
-static char *findBoundary(void *buf, int bufLen, void *boundary, int boundaryLen)
+static char *findBoundary(Upload *up, char *buf, int bufLen)
 {
-    char    *cp, *endp;
-    char    first;
+    uchar   *cp, *endp, *pat;
+    int     last, i;
 
     mprAssert(buf);
-    mprAssert(boundary);
-    mprAssert(boundaryLen > 0);
-
-    first = *((char*) boundary);
-    cp = (char*) buf;
+    mprAssert(up->delimiterLen > 0);
 
-    if (bufLen < boundaryLen) {
+    if (bufLen < up->delimiterLen) {
         return 0;
     }
-    endp = cp + (bufLen - boundaryLen) + 1;
+    pat = (uchar*) up->delimiter;
+    last = up->delimiterLen - 1;
+    cp = (uchar*) buf;
+    endp = cp + (bufLen - up->delimiterLen) + 1;
+
     while (cp < endp) {
-        cp = (char *) memchr(cp, first, endp - cp);
-        if (!cp) {
-            return 0;
-        }
-        if (memcmp(cp, boundary, boundaryLen) == 0) {
-            return cp;
+        for (i = last; cp[i] == pat[i]; i--) {
+            if (i == 0) {
+                return (char*) cp;
+            }
         }
-        cp++;
+        cp += up->skip[cp[last]];
     }
     return 0;
 }
@@ -553,9 +909,33 @@ extern void maSetUploadCallback(MaHttp *http, MaUploadCallback userCallback, voi
 
 
 #if BLD_FEATURE_CONFIG_PARSE || 1
+/*
+ *  Get the configuration to modify for the current config block. Directives at the host level modify the handler
+ *  defaults. Directives inside a Location block create a configuration for that location.
+ */
+static MaUploadConfig *getLocationConfig(UploadHandler *uph, MaConfigState *state)
+{
+    MaLocation      *location;
+    MaUploadConfig  *config;
+
+    location = state->location;
+    if (location == 0 || location == state->host->location) {
+        return uph->config;
+    }
+    if ((config = location->uploadConfig) == 0) {
+        config = mprAllocObjZeroed(location, MaUploadConfig);
+        config->uploadDir = mprStrdup(config, uph->config->uploadDir);
+        config->sync = uph->config->sync;
+        location->uploadConfig = config;
+    }
+    return config;
+}
+
+
 static int uploadParseConfig(MaHttp *http, cchar *key, char *value, MaConfigState *state)
 {
     UploadHandler       *uph;
+    MaUploadConfig      *config;
     MaHost              *host;
     char                pathBuf[MPR_MAX_FNAME], pathBuf2[MPR_MAX_FNAME];
 
@@ -572,11 +952,27 @@ static int uploadParseConfig(MaHttp *http, cchar *key, char *value, MaConfigStat
         }
         mprAssert(pathBuf2[0]);
 
-        mprFree(uph->uploadDir);
-        uph->uploadDir = mprStrdup(uph, pathBuf);
+        config = getLocationConfig(uph, state);
+        mprFree(config->uploadDir);
+        config->uploadDir = mprStrdup(config, pathBuf);
         uph->location = state->location;
 
-        mprLog(http, MPR_CONFIG, "Upload directory: %s", uph->uploadDir);
+        mprLog(http, MPR_CONFIG, "Upload directory: %s", config->uploadDir);
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "FileUploadSync") == 0) {
+        config = getLocationConfig(uph, state);
+        value = mprStrTrim(value, "\"");
+        if (mprStrcmpAnyCase(value, "none") == 0) {
+            config->sync = UPLOAD_SYNC_NONE;
+        } else if (mprStrcmpAnyCase(value, "complete") == 0) {
+            config->sync = UPLOAD_SYNC_COMPLETE;
+        } else if (mprStrcmpAnyCase(value, "stream") == 0) {
+            config->sync = UPLOAD_SYNC_STREAM;
+        } else {
+            mprError(http, "Bad FileUploadSync value \"%s\". Use none, complete or stream", value);
+            return -1;
+        }
         return 1;
     }
     return 0;
@@ -598,7 +994,8 @@ MprModule *maUploadHandlerInit(MaHttp *http, cchar *path)
         return 0;
     }
 
-    handler = maCreateHandler(http, "uploadHandler", MA_STAGE_POST | MA_STAGE_HEAD | MA_STAGE_FORM_VARS | MA_STAGE_VIRTUAL);
+    handler = maCreateHandler(http, "uploadHandler", 
+        MA_STAGE_POST | MA_STAGE_HEAD | MA_STAGE_FORM_VARS | MA_STAGE_VIRTUAL | MA_STAGE_STREAM_INPUT);
     if (handler == 0) {
         mprFree(module);
         return 0;
@@ -609,23 +1006,26 @@ MprModule *maUploadHandlerInit(MaHttp *http, cchar *path)
     handler->open = uploadOpen; 
     handler->close = uploadClose; 
     handler->incomingData = uploadIncomingData; 
-    handler->outgoingService = uploadOutgoingService; 
+    handler->run = uploadRun; 
 
+    http->uploadHandler = handler;
     handler->stageData = uph = mprAllocObjZeroed(handler, UploadHandler);
+    uph->config = mprAllocObjZeroed(uph, MaUploadConfig);
+    uph->config->sync = UPLOAD_SYNC_NONE;
 
 #if WIN
 {
     char *cp;
-    uph->uploadDir = mprStrdup(uph, getenv("TEMP"));
+    uph->config->uploadDir = mprStrdup(uph->config, getenv("TEMP"));
     //  TODO - Need an MPR routine to do this
-    for (cp = uph->uploadDir; *cp; cp++) {
+    for (cp = uph->config->uploadDir; *cp; cp++) {
         if (*cp == '\\') {
             *cp = '/';
         }
     }
 }
 #else
-    uph->uploadDir = mprStrdup(uph, "/tmp");
+    uph->config->uploadDir = mprStrdup(uph->config, "/tmp");
 #endif
     
 #if BLD_FEATURE_MULTITHREAD && FUTURE && TODO
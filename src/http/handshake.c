@@ -0,0 +1,299 @@
+/*
+ *  handshake.c -- Perform SSL handshakes on a dedicated thread pool.
+ *
+ *  New secure connections are queued here instead of performing their handshake on whichever request pool thread
+ *  services the first I/O event. A small, bounded set of handshake threads performs the key exchange work. When the 
+ *  handshake needs more I/O, the connection waits for the socket event and is then requeued. Once complete, the 
+ *  connection is handed back to the normal I/O event path and is serviced by the request pool.
+ *
+ *  Copyright (c) All Rights Reserved. See copyright notice at the bottom of the file.
+ */
+
+/********************************* Includes ***********************************/
+
+#include    "http.h"
+
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+/***************************** Forward Declarations ***************************/
+
+static void closeHandshakeConn(MaConn *conn);
+static void handshakeMain(MaHandshakeService *hs, MprThread *tp);
+static void runHandshake(MaHandshakeService *hs, MaConn *conn);
+
+/*********************************** Code *************************************/
+
+MaHandshakeService *maCreateHandshakeService(MaHttp *http, int threads, int maxQueue)
+{
+    MaHandshakeService  *hs;
+    MprThread           *tp;
+    char                name[16];
+    int                 i;
+
+    if ((hs = mprAllocObjZeroed(http, MaHandshakeService)) == 0) {
+        return 0;
+    }
+    hs->queue = mprCreateList(hs);
+    hs->mutex = mprCreateLock(hs);
+    hs->cond = mprCreateCond(hs);
+    hs->maxQueue = maxQueue;
+
+    /*
+     *  Threads free themselves on exit so they are not owned by the service which may be freed first
+     */
+    for (i = 0; i < threads; i++) {
+        mprSprintf(name, sizeof(name), "ssl.%d", i);
+        if ((tp = mprCreateThread(http, name, (MprThreadProc) handshakeMain, hs, MPR_NORMAL_PRIORITY, 0)) == 0) {
+            break;
+        }
+        mprLock(hs->mutex);
+        hs->running++;
+        mprUnlock(hs->mutex);
+        if (mprStartThread(tp) < 0) {
+            mprLock(hs->mutex);
+            hs->running--;
+            mprUnlock(hs->mutex);
+            mprFree(tp);
+            break;
+        }
+    }
+    if (hs->running == 0) {
+        mprError(http, "Can't start SSL handshake threads");
+        mprFree(hs);
+        return 0;
+    }
+    mprLog(http, 3, "Started %d SSL handshake threads, queue limit %d", hs->running, maxQueue);
+    return hs;
+}
+
+
+/*
+ *  Stop the handshake threads. Queued connections are closed and this waits for the threads to exit so the service 
+ *  may then be freed. Threads exit after their current handshake which never blocks as the sockets are non-blocking.
+ */
+void maStopHandshakeService(MaHandshakeService *hs)
+{
+    MaHandshakeStats    st;
+    MaConn              *conn;
+
+    mprLock(hs->mutex);
+    hs->stopping = 1;
+    while ((conn = mprGetFirstItem(hs->queue)) != 0) {
+        mprRemoveItemAtPos(hs->queue, 0);
+        mprUnlock(hs->mutex);
+        maLockConn(conn);
+        closeHandshakeConn(conn);
+        mprLock(hs->mutex);
+    }
+    hs->stats.queued = 0;
+    mprUnlock(hs->mutex);
+
+    /*
+     *  Each wakeup releases one thread which wakes the next. Keep signalling in case a wakeup is consumed here.
+     */
+    mprLock(hs->mutex);
+    while (hs->running > 0) {
+        mprUnlock(hs->mutex);
+        mprSignalCond(hs->cond);
+        mprWaitForCond(hs->cond, 10);
+        mprLock(hs->mutex);
+    }
+    st = hs->stats;
+    mprUnlock(hs->mutex);
+
+    mprLog(hs, 2, "SSL handshakes %d, failed %d, rejected %d, max queued %d, avg wait %d msec, avg duration %d msec",
+        st.handshakes, st.failed, st.rejected, st.maxQueued,
+        (int) (st.handshakes ? (st.totalWait / st.handshakes) : 0),
+        (int) (st.handshakes ? (st.totalDuration / st.handshakes) : 0));
+}
+
+
+/*
+ *  Queue a connection for a handshake thread. Called with the connection locked when a secure connection is accepted 
+ *  and when a connection waiting for handshake I/O gets an I/O event. Returns with the connection unlocked.
+ */
+void maQueueHandshake(MaConn *conn)
+{
+    MaHandshakeService  *hs;
+
+    hs = conn->http->handshakeService;
+    mprAssert(hs);
+
+    mprLock(hs->mutex);
+    if (conn->handshakeQueued) {
+        mprUnlock(hs->mutex);
+        maUnlockConn(conn);
+        return;
+    }
+    if (hs->stopping || mprGetListCount(hs->queue) >= hs->maxQueue) {
+        hs->stats.rejected++;
+        mprUnlock(hs->mutex);
+        mprLog(conn, 3, "SSL handshake queue full, rejecting connection from %s", conn->remoteIpAddr);
+        closeHandshakeConn(conn);
+        return;
+    }
+    conn->flags |= MA_CONN_HANDSHAKE;
+    conn->handshakeQueued = mprGetTime(conn);
+    mprAddItem(hs->queue, conn);
+    hs->stats.queued = mprGetListCount(hs->queue);
+    hs->stats.maxQueued = max(hs->stats.maxQueued, hs->stats.queued);
+    mprUnlock(hs->mutex);
+    maUnlockConn(conn);
+
+    mprSignalCond(hs->cond);
+}
+
+
+void maGetHandshakeStats(MaHttp *http, MaHandshakeStats *stats)
+{
+    MaHandshakeService  *hs;
+
+    memset(stats, 0, sizeof(MaHandshakeStats));
+    if ((hs = http->handshakeService) != 0) {
+        mprLock(hs->mutex);
+        *stats = hs->stats;
+        mprUnlock(hs->mutex);
+    }
+}
+
+
+/*
+ *  Handshake thread main loop
+ */
+static void handshakeMain(MaHandshakeService *hs, MprThread *tp)
+{
+    MaConn      *conn;
+    int         queued;
+
+    while (1) {
+        mprLock(hs->mutex);
+        if (hs->stopping) {
+            mprUnlock(hs->mutex);
+            break;
+        }
+        if ((conn = mprGetFirstItem(hs->queue)) != 0) {
+            mprRemoveItemAtPos(hs->queue, 0);
+            hs->stats.queued = mprGetListCount(hs->queue);
+        }
+        queued = hs->stats.queued;
+        mprUnlock(hs->mutex);
+
+        if (conn == 0) {
+            mprWaitForCond(hs->cond, -1);
+            continue;
+        }
+        if (queued > 0) {
+            /*
+             *  The condition wakes only one thread. Wake another to help drain the queue.
+             */
+            mprSignalCond(hs->cond);
+        }
+        runHandshake(hs, conn);
+    }
+
+    /*
+     *  Signal while locked. The service may be freed as soon as the lock is released.
+     */
+    mprLock(hs->mutex);
+    hs->running--;
+    mprSignalCond(hs->cond);
+    mprUnlock(hs->mutex);
+}
+
+
+/*
+ *  Advance the handshake for a connection. On completion, hand the connection back to the request pool by enabling
+ *  normal read events. Otherwise wait for the I/O the handshake needs.
+ */
+static void runHandshake(MaHandshakeService *hs, MaConn *conn)
+{
+    MaHandshakeStats    *st;
+    MprTime             start, wait, duration;
+    int                 mask;
+
+    maLockConn(conn);
+    start = mprGetTime(conn);
+    wait = start - conn->handshakeQueued;
+
+    if (start >= conn->expire) {
+        mask = MPR_ERR_TIMEOUT;
+    } else {
+        mask = mprHandshakeSocket(conn->sock);
+    }
+    duration = mprGetTime(conn) - start;
+    conn->handshakeDuration += duration;
+    conn->time = start + duration;
+
+    mprLock(hs->mutex);
+    conn->handshakeQueued = 0;
+    st = &hs->stats;
+    st->totalWait += wait;
+    st->maxWait = max(st->maxWait, wait);
+    if (mask < 0) {
+        st->failed++;
+    } else if (mask == 0) {
+        st->handshakes++;
+        st->totalDuration += conn->handshakeDuration;
+        st->maxDuration = max(st->maxDuration, conn->handshakeDuration);
+    }
+    mprUnlock(hs->mutex);
+
+    if (mask < 0) {
+        mprLog(conn, 4, "SSL handshake failed for %s", conn->remoteIpAddr);
+        closeHandshakeConn(conn);
+
+    } else if (mask == 0) {
+        mprLog(conn, 5, "SSL handshake complete for %s, waited %d msec, took %d msec", conn->remoteIpAddr, (int) wait,
+            (int) conn->handshakeDuration);
+        conn->flags &= ~MA_CONN_HANDSHAKE;
+        maSetConnEvents(conn, MPR_READABLE);
+        maUnlockConn(conn);
+
+    } else {
+        maSetConnEvents(conn, mask);
+        maUnlockConn(conn);
+    }
+}
+
+
+/*
+ *  Called with the connection locked. Returns with it unlocked and freed.
+ */
+static void closeHandshakeConn(MaConn *conn)
+{
+    maDestroyConn(conn);
+}
+
+#else
+void __maHandshakeDummy() {}
+#endif /* BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL */
+
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
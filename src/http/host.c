@@ -620,10 +620,12 @@ static void hostTimer(MaHost *host, MprEvent *event)
         }
     }
 
-    if (event) {
-        if (connCount == 0) {
-            mprStopContinuousEvent(event);
-        }
+    if (event && connCount == 0) {
+        /*
+         *  The timer is restarted by maAddConn when a new connection arrives. Don't free the event while connections 
+         *  remain, otherwise the continuous timer stops and connections never expire.
+         */
+        mprStopContinuousEvent(event);
         mprFree(event);
     }
     unlock(host);
@@ -37,6 +37,9 @@ void maLoadStaticModules(MaHttp *http)
 #if BLD_FEATURE_EJS
     staticModules[index++] = maEjsHandlerInit(http, NULL);
 #endif
+#if BLD_FEATURE_FASTCGI
+    staticModules[index++] = maFastcgiHandlerInit(http, NULL);
+#endif
 #if BLD_FEATURE_FILE
     staticModules[index++] = maFileHandlerInit(http, NULL);
 #endif
@@ -49,6 +52,9 @@ void maLoadStaticModules(MaHttp *http)
 #if BLD_FEATURE_PHP
     staticModules[index++] = maPhpHandlerInit(http, NULL);
 #endif
+#if BLD_FEATURE_PROXY
+    staticModules[index++] = maProxyHandlerInit(http, NULL);
+#endif
 #if BLD_FEATURE_RANGE
     staticModules[index++] = maRangeFilterInit(http, NULL);
 #endif
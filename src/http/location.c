@@ -21,6 +21,7 @@ MaLocation *maCreateBareLocation(MprCtx ctx)
         return 0;
     }
 
+    location->flags = MA_LOC_MODULE_CACHE;
     location->errorDocuments = mprCreateHash(location, MA_ERROR_HASH_SIZE);
     location->handlers = mprCreateList(location);
     location->extensions = mprCreateHash(location, MA_HANDLER_HASH_SIZE);
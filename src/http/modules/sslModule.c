@@ -18,7 +18,7 @@ static int parseSsl(MaHttp *http, cchar *key, char *value, MaConfigState *state)
     MaServer    *server;
     MaHost      *host;
     char        pathBuf[MPR_MAX_FNAME], prefix[MPR_MAX_FNAME];
-    char        *tok, *word, *enable, *provider;
+    char        *tok, *word, *enable, *provider, *recordSize, *rampUp;
     int         protoMask, mask;
 
     host = state->host;
@@ -86,6 +86,33 @@ static int parseSsl(MaHttp *http, cchar *key, char *value, MaConfigState *state)
         }
         return 1;
 
+    } else if (mprStrcmpAnyCase(key, "SSLKernelOffload") == 0) {
+        mprSetSslOffload(location->ssl, mprStrcmpAnyCase(value, "on") == 0);
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "SSLSessionCache") == 0) {
+        mprSetSslSessionCache(location->ssl, mprAtoi(value, 10));
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "SSLSessionTimeout") == 0) {
+        mprSetSslSessionTimeout(location->ssl, mprAtoi(value, 10));
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "SSLSessionTickets") == 0) {
+        mprSetSslSessionTickets(location->ssl, mprStrcmpAnyCase(value, "on") == 0);
+        return 1;
+
+    } else if (mprStrcmpAnyCase(key, "SSLDynamicRecords") == 0) {
+        /*  SSLDynamicRecords smallRecordSize [rampUpBytes] */
+        recordSize = mprStrTok(value, " \t", &tok);
+        rampUp = mprStrTok(0, " \t", &tok);
+        if (recordSize == 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        mprSetSslRecordSizing(location->ssl, mprAtoi(recordSize, 10), 
+            rampUp ? mprAtoi(rampUp, 10) : MPR_SSL_RECORD_RAMP);
+        return 1;
+
     } else if (mprStrcmpAnyCase(key, "SSLProtocol") == 0) {
         protoMask = 0;
         word = mprStrTok(value, " \t", &tok);
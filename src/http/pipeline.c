@@ -164,10 +164,12 @@ void maCreatePipeline(MaConn *conn)
     
     connector = location->connector;
 #if BLD_FEATURE_SEND
-    if (resp->handler == http->fileHandler && connector == http->netConnector && 
-        http->sendConnector && !req->ranges && !host->secure) {
+    if (resp->handler == http->fileHandler && connector == http->netConnector && req->method & (MA_REQ_GET | MA_REQ_HEAD) &&
+        http->sendConnector && !req->ranges && (!host->secure || mprSocketIsOffloaded(conn->sock))) {
         /*
-         *  Switch (transparently) to the send connector if serving whole static file content via the net connector
+         *  Switch (transparently) to the send connector if serving whole static file content via the net connector.
+         *  PUT and DELETE responses have no file content to send.
+         *  Secure connections qualify only if the kernel is doing the encryption (kTLS).
          */
         connector = http->sendConnector;
     }
@@ -206,7 +208,7 @@ void maCreatePipeline(MaConn *conn)
                 mprAddItem(req->inputPipeline, filter->stage);
             }
         }
-        mprAddItem(req->inputPipeline, handler);
+        mprAddItem(req->inputPipeline, resp->handler);
 
         /*
          *  Create the incoming queue heads and open the queues.
@@ -140,6 +140,12 @@ MaPacket *maGet(MaQueue *q)
             q->first = packet->next;
             packet->next = 0;
             q->count -= packet->count;
+            if (packet == q->pending) {
+                /*
+                 *  Packet is leaving this queue, so maWriteBlock must not append to it any more.
+                 */
+                q->pending = 0;
+            }
             mprAssert(q->count >= 0);
             if (packet == q->last) {
                 q->last = 0;
@@ -148,12 +154,17 @@ MaPacket *maGet(MaQueue *q)
         }
         if (q->flags & MA_QUEUE_FULL && q->count < q->low) {
             /*
-             *  This queue was full and now is below the low water mark. Back-enable the previous queue.
+             *  This queue was full and now is below the low water mark. Back-enable the previous queue. If reading a 
+             *  streamed request body was paused because this queue was full, resume reading.
              */
             q->flags &= ~MA_QUEUE_FULL;
-            prev = findPreviousQueue(q);
-            if (prev && prev->flags & MA_QUEUE_DISABLED) {
-                maEnableQueue(prev);
+            if (q->direction == MA_QUEUE_RECEIVE && conn->flags & MA_CONN_READ_BLOCKED) {
+                maResumeReading(conn);
+            } else {
+                prev = findPreviousQueue(q);
+                if (prev && prev->flags & MA_QUEUE_DISABLED) {
+                    maEnableQueue(prev);
+                }
             }
         }
         return packet;
@@ -452,6 +463,27 @@ void maEnableQueue(MaQueue *q)
 }
 
 
+/*
+ *  Flush buffered data in this queue and all downstream queues. Stages that coalesce data test MA_QUEUE_FLUSH and
+ *  clear it once they have sent all they hold.
+ */
+void maFlushQueue(MaQueue *q)
+{
+    MaQueue     *head, *next;
+
+    head = &q->conn->response->queue[q->direction];
+    q->pending = 0;
+
+    for (next = q; next != head; next = next->nextQ) {
+        next->flags |= MA_QUEUE_FLUSH;
+        if (next->first && !(next->flags & MA_QUEUE_DISABLED)) {
+            maScheduleQueue(next);
+        }
+    }
+    maServiceQueues(q->conn);
+}
+
+
 /*
  *  Return the number of bytes the queue will accept. Always positive.
  */
@@ -682,6 +714,25 @@ MaPacket *maSplitPacket(MaConn *conn, MaPacket *orig, int offset)
 }
 
 
+/*
+ *  Give a consumed input packet back to the connection to use for the next read. The packet holding the request 
+ *  headers must be preserved.
+ */
+void maRecyclePacket(MaConn *conn, MaPacket *packet)
+{
+    if (conn->input || packet == conn->request->headerPacket || packet->content == 0 || conn->requestFailed) {
+        mprFree(packet);
+        return;
+    }
+    mprStealBlock(conn, packet);
+    mprFlushBuf(packet->content);
+    packet->count = 0;
+    packet->flags = 0;
+    packet->next = 0;
+    conn->input = packet;
+}
+
+
 /*
  *  Remove packets from a queue which do not need to be processed.
  *  Remove data packets if no body is required (HEAD|TRACE|OPTIONS|PUT|DELETE method, not modifed content, or error)
@@ -17,6 +17,7 @@
 static void addMatchEtag(MaConn *conn, char *etag);
 static int  destroyRequest(MaRequest *req);
 static bool getChunkSize(MaConn *conn, MprBuf *buf, int *boundaryLen, int *size);
+static int  getMaxBody(MaConn *conn);
 static char *getToken(MaConn *conn, cchar *delim);
 static bool matchEtag(MaConn *conn, char *requestedEtag);
 static bool matchModified(MaConn *conn, MprTime time);
@@ -28,6 +29,7 @@ static void processChunk(MaConn *conn, MaPacket *packet);
 static void processContent(MaConn *conn, MaPacket *packet);
 static bool processCompletion(MaConn *conn);
 static void setIfModifiedDate(MaConn *conn, MprTime when, bool ifMod);
+static void setStreamInput(MaConn *conn);
 
 #if BLD_DEBUG
 static void traceContent(MaConn *conn, MaPacket *packet);
@@ -83,6 +85,15 @@ void maProcessWriteEvent(MaConn *conn)
     mprLog(conn, 6, "maProcessWriteEvent, state %d", conn->state);
 
     if (unlikely(conn->expire <= conn->time)) {
+        if (conn->deadline && conn->deadline <= conn->time && conn->request && 
+                conn->state < MPR_HTTP_STATE_COMPLETE) {
+            /*
+             *  The request has a deadline (suspended EGI requests) and has not completed in time. The host timer
+             *  triggers this event. Fail the request and close the connection.
+             */
+            maFailConnection(conn, MPR_HTTP_CODE_REQUEST_TIME_OUT, "Request exceeded its timeout");
+            return;
+        }
         /*
          *  Ignore the event if we have expired. TODO - who cleans up?
          */
@@ -184,7 +195,14 @@ static bool parseRequest(MaConn *conn, MaPacket *packet)
      */
     maCreatePipeline(conn);
 
-    if (req->remainingContent > 0) {
+    if (conn->abandonConnection) {
+        /*
+         *  The request was rejected while parsing the headers (e.g. body too large). Remain in the complete state so
+         *  the connection is closed without reading the body.
+         */
+        mprAssert(conn->state == MPR_HTTP_STATE_COMPLETE);
+
+    } else if (req->remainingContent > 0) {
         conn->state = (req->flags & MA_REQ_CHUNKED) ? MPR_HTTP_STATE_CHUNK : MPR_HTTP_STATE_CONTENT;
     } else {
         /*
@@ -406,11 +424,6 @@ static bool parseHeaders(MaConn *conn, MaPacket *packet)
                     maFailConnection(conn, MPR_HTTP_CODE_BAD_REQUEST, "Bad content length");
                     continue;
                 }
-                if (req->length >= host->limits->maxBody) {
-                    maFailConnection(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, 
-                        "Request content length %d is too big. Limit %d", req->length, host->limits->maxBody);
-                    continue;
-                }
                 mprAssert(req->length >= 0);
                 req->remainingContent = req->length;
                 req->contentLengthStr = value;
@@ -608,11 +621,52 @@ static bool parseHeaders(MaConn *conn, MaPacket *packet)
     mprAdjustBufStart(content, 2);
 
     maMatchHandler(conn);
-    
+    setStreamInput(conn);
+
+    if (req->length >= getMaxBody(conn)) {
+        maFailConnection(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, 
+            "Request content length %d is too big. Limit %d", req->length, getMaxBody(conn));
+    }
     return 1;
 }
 
 
+/*
+ *  Stream the request body to the handler as it arrives if the handler supports it and streaming is enabled for the
+ *  location. The upload handler always streams.
+ */
+static void setStreamInput(MaConn *conn)
+{
+    MaRequest   *req;
+    MaStage     *handler;
+
+    req = conn->request;
+    handler = conn->response->handler;
+
+    if (handler && handler->flags & MA_STAGE_STREAM_INPUT) {
+        if (handler == conn->http->uploadHandler || (req->location && req->location->flags & MA_LOC_STREAM_INPUT)) {
+            req->flags |= MA_REQ_STREAM_INPUT;
+        }
+    }
+}
+
+
+/*
+ *  Get the request body limit. Streamed bodies are consumed as they arrive without buffering them, so they are 
+ *  limited by LimitUploadSize rather than LimitRequestBody.
+ */
+static int getMaxBody(MaConn *conn)
+{
+    MaLimits    *limits;
+
+    limits = conn->request->host->limits;
+    if (conn->request->flags & MA_REQ_STREAM_INPUT) {
+        return max(limits->maxBody, limits->maxUploadSize);
+    }
+    return limits->maxBody;
+}
+
+
 /*
  *  Process post or put content data. Packet will be null if the client closed the connection to signify end of data.
  */
@@ -629,12 +683,6 @@ static void processContent(MaConn *conn, MaPacket *packet)
     resp = conn->response;
     q = &resp->queue[MA_QUEUE_RECEIVE];
 
-    if (conn->requestFailed) {
-        conn->canProceed = 0;
-        mprFree(packet);
-        return;
-    }
-
     /*
      *  Transfer ownership of the packet. If it contains header data for the next pipelined request, it will be split below.
      */
@@ -657,11 +705,10 @@ static void processContent(MaConn *conn, MaPacket *packet)
             req->remainingContent -= nbytes;
             req->receivedContent += nbytes;
 
-            if (req->receivedContent >= conn->host->limits->maxBody) {
+            if (req->receivedContent >= getMaxBody(conn)) {
                 conn->keepAliveCount = 0;
                 maFailConnection(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, 
-                    "Request content body is too big %d vs limit %d", 
-                    req->receivedContent, conn->host->limits->maxBody);
+                    "Request content body is too big %d vs limit %d", req->receivedContent, getMaxBody(conn));
                 return;
             } 
 
@@ -680,6 +727,27 @@ static void processContent(MaConn *conn, MaPacket *packet)
             if (!conn->requestFailed) {
                 packet->count = mprGetBufLength(packet->content);
                 maPutNext(q, packet);
+                if (req->flags & MA_REQ_STREAM_INPUT && q->prevQ->count >= q->prevQ->max) {
+                    /*
+                     *  The handler's receive queue is full. Stop reading until the handler drains the queue below
+                     *  its low water mark. maGet will then resume reading.
+                     */
+                    q->prevQ->flags |= MA_QUEUE_FULL;
+                    conn->flags |= MA_CONN_READ_BLOCKED;
+                }
+
+            } else if (conn->input == 0 && packet != req->headerPacket) {
+                /*
+                 *  Discard the body of a failed request. Reuse the packet for the next read as arena memory is not
+                 *  reclaimed until the request completes. The header packet must be preserved.
+                 */
+                mprStealBlock(conn, packet);
+                mprFlushBuf(packet->content);
+                packet->count = 0;
+                conn->input = packet;
+
+            } else {
+                mprFree(packet);
             }
         }
     }
@@ -692,7 +760,9 @@ static void processContent(MaConn *conn, MaPacket *packet)
             maFailConnection(conn, MPR_HTTP_CODE_COMMS_ERROR, "Insufficient content data sent with request");
 
         } else {
-            maPutNext(q, maCreateEndPacket(conn));
+            if (!conn->requestFailed) {
+                maPutNext(q, maCreateEndPacket(conn));
+            }
             conn->state = MPR_HTTP_STATE_PROCESSING;
             maRunPipeline(conn);
         }
@@ -704,6 +774,51 @@ static void processContent(MaConn *conn, MaPacket *packet)
 }
 
 
+/*
+ *  Splice request body data from the socket directly to the handler's destination. Return the number of bytes moved,
+ *  zero if the connection must wait for more data, or -1 if the body must be read via packets.
+ */
+int maSpliceContent(MaConn *conn)
+{
+    MaRequest   *req;
+    MaQueue     *q;
+    int         nbytes;
+
+    req = conn->request;
+    q = conn->response->queue[MA_QUEUE_RECEIVE].prevQ;
+    mprAssert(q->stage->incomingSplice);
+
+    nbytes = q->stage->incomingSplice(q, min(req->remainingContent, MA_INPUT_SPLICE_SIZE));
+    if (nbytes > 0) {
+        req->remainingContent -= nbytes;
+        req->receivedContent += nbytes;
+        if (req->remainingContent == 0 || conn->requestFailed) {
+            req->flags &= ~MA_REQ_SPLICE_INPUT;
+        }
+        if (req->remainingContent == 0) {
+            /*
+             *  Signal end of input and process the request
+             */
+            maProcessReadEvent(conn, 0);
+        }
+        return nbytes;
+
+    } else if (nbytes == 0) {
+        /*
+         *  Client closed the connection
+         */
+        maProcessReadEvent(conn, 0);
+        return 0;
+
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0;
+    }
+    mprLog(conn, 5, "Can't splice request content, errno %d, using buffered input", errno);
+    req->flags &= ~MA_REQ_SPLICE_INPUT;
+    return -1;
+}
+
+
 /*
  *  Complete the request and return true if there is a pipelined request following
  */
@@ -114,6 +114,13 @@ void maFillHeaders(MaConn *conn, MaPacket *packet)
 
     } else if (resp->length > 0) {
         putFormattedHeader(packet, "Content-Length", "%d", resp->length);
+
+    } else if (resp->flags & MA_RESP_NO_BODY && !(req->method & MA_REQ_HEAD) && 
+            resp->code != MPR_HTTP_CODE_NO_CONTENT && resp->code != MPR_HTTP_CODE_NOT_MODIFIED) {
+        /*
+         *  An omitted body (e.g. PUT created) must still be delimited for keep-alive clients
+         */
+        putHeader(packet, "Content-Length", "0");
     }
 
     if (req->ranges) {
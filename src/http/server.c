@@ -11,6 +11,9 @@
 /********************************** Includes **********************************/
 
 #include    "http.h"
+#if BLD_FEATURE_SSL
+    #include    "mprSsl.h"
+#endif
 
 /***************************** Forward Declarations ***************************/
 
@@ -257,6 +260,13 @@ int maStartHttp(MaHttp *http)
     /*
      *  Start servers (and hosts)
      */
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+    if (mprHasSecureSockets(http) && http->limits.maxHandshakeThreads > 0 && http->handshakeService == 0) {
+        http->handshakeService = maCreateHandshakeService(http, http->limits.maxHandshakeThreads, 
+            http->limits.maxHandshakeQueue);
+    }
+#endif
+
     for (next = 0; (server = mprGetNextItem(http->servers, &next)) != 0; ) {
         if (maStartServer(server) < 0) {
             return MPR_ERR_CANT_INITIALIZE;
@@ -275,6 +285,18 @@ int maStopHttp(MaHttp *http)
     for (next = 0; (server = mprGetNextItem(http->servers, &next)) != 0; ) {
         maStopServer(server);
     }
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+    if (http->handshakeService) {
+        maStopHandshakeService(http->handshakeService);
+        mprFree(http->handshakeService);
+        http->handshakeService = 0;
+    }
+#endif
+#if BLD_FEATURE_SSL
+    if (mprHasSecureSockets(http)) {
+        mprLog(http, 2, "SSL sockets offloaded to kernel TLS %d", mprGetOffloadedSockets(http));
+    }
+#endif
     return 0;
 }
 
@@ -423,6 +445,8 @@ static void initLimits(MaHttp *http)
     limits->maxUploadSize = MA_MAX_UPLOAD_SIZE;
     limits->maxThreads = MA_DEFAULT_MAX_THREADS;
     limits->minThreads = 0;
+    limits->maxHandshakeThreads = MA_HANDSHAKE_THREADS;
+    limits->maxHandshakeQueue = MA_MAX_HANDSHAKE_QUEUE;
 
     /*
      *  Zero means use O/S defaults
@@ -531,9 +555,20 @@ int maStopServer(MaServer *server)
 {
     MaHost      *host;
     MaListen    *listen;
+#if BLD_FEATURE_SSL
+    MprSslStats stats;
+#endif
     int         next;
 
     for (next = 0; (listen = mprGetNextItem(server->listens, &next)) != 0; ) {
+#if BLD_FEATURE_SSL
+        if (listen->ssl) {
+            mprGetSslStats(listen->ssl, &stats);
+            mprLog(server, 2, "SSL on %s:%d: full handshakes %d, resumed %d, session cache hits %d, misses %d", 
+                listen->ipAddr, listen->port, stats.fullHandshakes, stats.resumedHandshakes, stats.sessionHits, 
+                stats.sessionMisses);
+        }
+#endif
         maStopListening(listen);
     }
 
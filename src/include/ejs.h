@@ -32,6 +32,7 @@ extern "C" {
     #define EJS_MAX_RECURSION       10000           /* Maximum recursion */
     #define EJS_MAX_REGEX_MATCHES   32              /* Maximum regular sub-expressions */
     #define EJS_MAX_DB_MEM          (2*1024*1024)   /* Maximum regular sub-expressions */
+    #define EJS_DB_STATEMENTS       8               /* Prepared SQL statements cached per database */
 
     #define E4X_BUF_SIZE            512             /* Initial buffer size for tokens */
     #define E4X_BUF_MAX             (32 * 1024)     /* Max size for tokens */
@@ -42,6 +43,11 @@ extern "C" {
     #define EJS_MAX_DEBUG_NAME      32
     #define EJS_MAX_TYPE            256             /**< Maximum number of types */
     #define EJS_NUM_CROSS_GEN       256             /* Number of cross generational GC root objects */
+    #define EJS_PROP_CACHE_SIZE     64              /* Property lookup inline cache entries (power of 2) */
+    #define EJS_MAX_SMALL_INT       127             /* Largest pre-created shared integer value */
+    #define EJS_SESSION_SHARDS      4               /* Session store hash shards, each with its own lock */
+    #define EJS_SESSION_WHEEL       64              /* Session expiry timer wheel slots */
+    #define EJS_SESSION_HASH_SIZE   53              /* Session hash size per shard */
 
     #define EJS_CGI_MIN_BUF         (32 * 1024)     /* CGI output buffering */
     #define EJS_CGI_MAX_BUF         (128 * 1024)
@@ -60,6 +66,7 @@ extern "C" {
     #define EJS_MAX_RECURSION       (1000000)
     #define EJS_MAX_REGEX_MATCHES   64
     #define EJS_MAX_DB_MEM          (20*1024*1024)
+    #define EJS_DB_STATEMENTS       32
 
     #define E4X_BUF_SIZE            4096
     #define E4X_BUF_MAX             (128 * 1024)
@@ -70,6 +77,11 @@ extern "C" {
     #define EJS_MAX_DEBUG_NAME      64
     #define EJS_MAX_TYPE            512
     #define EJS_NUM_CROSS_GEN       1024 
+    #define EJS_PROP_CACHE_SIZE     256
+    #define EJS_MAX_SMALL_INT       511
+    #define EJS_SESSION_SHARDS      16
+    #define EJS_SESSION_WHEEL       256
+    #define EJS_SESSION_HASH_SIZE   509
 
     #define EJS_CGI_MIN_BUF         (64 * 1024)     /* CGI output buffering */
     #define EJS_CGI_MAX_BUF         (256 * 1024)
@@ -87,6 +99,7 @@ extern "C" {
     #define EJS_MAX_RECURSION       (1000000)
     #define EJS_MAX_REGEX_MATCHES   128
     #define EJS_MAX_DB_MEM          (20*1024*1024)
+    #define EJS_DB_STATEMENTS       64
 
     #define E4X_BUF_SIZE            4096
     #define E4X_BUF_MAX             (128 * 1024)
@@ -97,13 +110,22 @@ extern "C" {
     #define EJS_MAX_DEBUG_NAME      96
     #define EJS_MAX_TYPE            1024
     #define EJS_NUM_CROSS_GEN       4096 
+    #define EJS_PROP_CACHE_SIZE     512
+    #define EJS_MAX_SMALL_INT       1023
+    #define EJS_SESSION_SHARDS      32
+    #define EJS_SESSION_WHEEL       1024
+    #define EJS_SESSION_HASH_SIZE   4093
 
     #define EJS_CGI_MIN_BUF         (128 * 1024)     /* CGI output buffering */
     #define EJS_CGI_MAX_BUF         (512 * 1024)
     #define EJS_CGI_HDR_HASH        (101)
 #endif
 
+#define EJS_MIN_SMALL_INT           -128            /* Smallest pre-created shared integer value */
 #define EJS_SESSION_TIMEOUT         1800
+#define EJS_MODULE_CHECK            2000            /* Period to check cached web modules for changes (msec) */
+#define EJS_MAX_WEB_POOL            16              /* Maximum idle interpreters pooled per web application */
+#define EJS_MAX_WEB_REUSE           1000            /* Requests served by a pooled interpreter before it is freed */
 #define EJS_TIMER_PERIOD            1000            /* Timer checks ever 1 second */
 
 /*
@@ -465,10 +487,71 @@ typedef enum EjsOpCode {
     EJS_OP_USHR,
     EJS_OP_XOR,
 
+    /*
+     *  Superinstructions. These are only generated by the compiler peephole optimizer which fuses common sequences.
+     */
+    EJS_OP_GET_LOCAL_PROPERTY_SLOT,
+    EJS_OP_COMPARE_BRANCH_FALSE,
+    EJS_OP_COMPARE_BRANCH_TRUE,
+    EJS_OP_COMPARE_BRANCH_FALSE_8,
+    EJS_OP_COMPARE_BRANCH_TRUE_8,
+    EJS_OP_INC_LOCAL_SLOT,
+
 } EjsOpCode;
 
 #define ejsIsCall(opcode) (EJS_OP_CALL <= opcode && opcode <= EJS_OP_CALL_NEXT_CONSTRUCTOR
 
+/*
+ *  Maximum number of opcodes. Opcodes are encoded as a single byte.
+ */
+#define EJS_MAX_OPCODES     256
+
+/*
+ *  Opcode operand encodings
+ */
+#define EJS_OPT_NONE            0x0             /* No operands */
+#define EJS_OPT_BYTE            0x1             /* 8 bit integer */
+#define EJS_OPT_SHORT           0x2             /* 16 bit integer */
+#define EJS_OPT_WORD            0x4             /* 32 bits */
+#define EJS_OPT_LONG            0x8             /* 64 bit integer */
+#define EJS_OPT_DOUBLE          0x10            /* 64 bit floating */
+#define EJS_OPT_NUM             0x40            /* Encoded integer */
+#define EJS_OPT_STRING          0x80            /* Interned string as an encoded integer*/
+#define EJS_OPT_GLOBAL          0x100           /* Encode global */
+#define EJS_OPT_SLOT            0x200           /* Slot number as an encoded integer */
+#define EJS_OPT_JMP             0x1000          /* 32 bit jump offset */
+#define EJS_OPT_JMP8            0x2000          /* 8 bit jump offset */
+#define EJS_OPT_VARCOUNT        0x4000          /* <count> <offset32> ... */
+#define EJS_OPT_INIT_DEFAULT    0x8000          /* Computed goto table, 32 bit jumps  */
+#define EJS_OPT_INIT_DEFAULT8   0x10000         /* Computed goto table, 8 bit jumps */
+#define EJS_OPT_ARGC            0x20000         /* Argument count */
+#define EJS_OPT_ARGC2           0x40000         /* Argument count  * 2*/
+
+/*
+ *  Stack effect special values
+ */
+#define EJS_STACK_UNIMP         100             /* Not implemented */
+#define EJS_STACK_POP1          101             /* Operand 1 specifies the stack change (pop) */
+
+/**
+ *  Opcode table entry
+ *  @description Describes the name, stack effect and operand encodings for an opcode. The table is indexed by opcode.
+ *      The Debug instruction does not follow the table and is encoded as <filename> <lineNumber> <sourceLine>.
+ *  @stability Prototype
+ */
+typedef struct EjsOptable {
+    char    *name;                              /**< Opcode name */
+    int     stackEffect;                        /**< Change in stack depth */
+    int     args[8];                            /**< Operand encodings */
+} EjsOptable;
+
+/**
+ *  Get the opcode table
+ *  @return A table of EjsOptable entries indexed by opcode. The table is terminated by an entry with a null name.
+ *  @ingroup EjsVm
+ */
+extern EjsOptable *ejsGetOptable();
+
 #ifdef __cplusplus
 }
 #endif
@@ -617,6 +700,7 @@ typedef struct EjsGC {
     int         overflow;               /* Cross generational overflow - must do full gc */
     int         workQuota;              /* Quota of work before GC */
     int         workDone;               /* Count of allocations */
+    MprList     *sharedRoots;           /* Master objects holding references to objects of this interpreter */
 
     uint        allocatedTypes;         /* Count of types allocated */
     uint        peakAllocatedTypes;     /* Peak allocated types */ 
@@ -657,6 +741,7 @@ extern int      ejsCreateGCService(struct Ejs *ejs);
 extern int      ejsIsTimeForGC(struct Ejs *ejs, int timeTillNextEvent);
 //DDD
 extern void     ejsCollectGarbage(struct Ejs *ejs, int mode);
+extern void     ejsDiscardObjects(struct Ejs *ejs, struct EjsVar *lastEternal);
 extern void     ejsEnableGC(struct Ejs *ejs, bool on);
 extern void     ejsTraceMark(struct Ejs *ejs, struct EjsVar *vp);
 extern void     ejsGracefulDegrade(struct Ejs *ejs);
@@ -826,6 +911,37 @@ typedef struct EjsStack {
 } EjsStack;
 
 
+/*
+ *  Inline cache for by-name property access. Each entry caches the result of a lookup for one instruction and one
+ *  receiver type. Entries are indexed by instruction address. See lookupCachedVar in ejsInterp.c.
+ */
+#define EJS_PROP_CACHE_WAYS         2               /* Receiver types cached per instruction */
+
+typedef struct EjsPropCacheEntry {
+    struct EjsType  *type;                  /* Receiver type */
+    struct EjsNames *names;                 /* Receiver property names for inherited properties */
+    struct EjsVar   *owner;                 /* Type owning an inherited property. Null if the receiver owns it */
+    EjsName         qname;                  /* Property name including the resolved namespace */
+    int             slotNum;                /* Property slot in the receiver or owner */
+    int             nthBase;                /* Count of base types traversed to the owner */
+} EjsPropCacheEntry;
+
+typedef struct EjsPropCache {
+    uchar               *pc;                /* Instruction address */
+    int                 next;               /* Next entry to replace */
+    EjsPropCacheEntry   entries[EJS_PROP_CACHE_WAYS];
+} EjsPropCache;
+
+
+/*
+ *  Opcode pair execution counts. Used to select sequences to fuse into superinstructions. See ejsEnableOpcodeProfile.
+ */
+typedef struct EjsOpProfile {
+    int             lastOpcode;             /* Previously executed opcode */
+    uint            counts[EJS_MAX_OPCODES][EJS_MAX_OPCODES];  /* Counts indexed by [previous][current] opcode */
+} EjsOpProfile;
+
+
 /**
  *  Lookup State.
  *  @description Location information returned when looking up properties.
@@ -908,6 +1024,7 @@ typedef struct Ejs {
     struct EjsNumber    *negativeInfinityValue; /* The negative infinity number value */
     struct EjsVar       *nullValue;         /* The "null" value */
     struct EjsNumber    *oneValue;          /* The 1 number value */
+    struct EjsNumber    **smallInts;        /* Shared integer values from EJS_MIN_SMALL_INT to EJS_MAX_SMALL_INT */
     struct EjsBoolean   *trueValue;         /* The "true" value */
     struct EjsVar       *undefinedValue;    /* The "void" value */
     struct EjsNumber    *zeroValue;         /* The 0 number value */
@@ -946,6 +1063,11 @@ typedef struct Ejs {
     MprList             *modules;           /* Loaded modules */
     MprList             *typeFixups;        /* Loaded types to fixup */
 
+    EjsPropCache        *propCache;         /* Inline property lookup cache */
+    uint                propCacheHits;      /* Lookups satisfied by the property cache */
+    uint                propCacheMisses;    /* Lookups requiring a full search */
+    EjsOpProfile        *opProfile;         /* Opcode pair profile */
+
     void                (*loaderCallback)(struct Ejs *ejs, int kind, ...);
     void                *userData;          /* User data */
     void                *handle;            /* Hosting environment handle */
@@ -1097,6 +1219,27 @@ extern struct EjsVar *ejsThrowException(Ejs *ejs, struct EjsVar *error);
  */
 extern void ejsReportError(Ejs *ejs, char *fmt, ...);
 
+/**
+ *  Enable or disable opcode pair profiling
+ *  @description When enabled, the interpreter counts each pair of consecutively executed opcodes. The most frequent 
+ *      pairs are the best candidates to be fused into superinstructions by the compiler. Use #ejsPrintOpcodeProfile 
+ *      to report the results. Profiling slows execution and should not be enabled in production.
+ *  @param ejs Interpeter object returned from #ejsCreate
+ *  @param on Set to true to enable profiling. Set to false to disable and discard the counts.
+ *  @return Zero if successful, otherwise a negative MPR error code.
+ *  @ingroup Ejs
+ */
+extern int ejsEnableOpcodeProfile(Ejs *ejs, bool on);
+
+/**
+ *  Print the opcode pair profile
+ *  @description Log the most frequently executed opcode pairs using the MprLog channel at level 0.
+ *  @param ejs Interpeter object returned from #ejsCreate
+ *  @param count Maximum number of opcode pairs to report.
+ *  @ingroup Ejs
+ */
+extern void ejsPrintOpcodeProfile(Ejs *ejs, int count);
+
 extern int ejsAddModule(Ejs *ejs, struct EjsModule *up);
 extern struct EjsVar *ejsCastOperands(Ejs *ejs, struct EjsVar *lhs, int opcode,  struct EjsVar *rhs);
 extern int ejsCheckModuleLoaded(Ejs *ejs, cchar *name);
@@ -1107,6 +1250,7 @@ extern struct EjsVar *ejsGetVarByName(Ejs *ejs, struct EjsVar *vp, EjsName *name
 extern int ejsInitStack(Ejs *ejs);
 extern void ejsLog(Ejs *ejs, cchar *fmt, ...);
 extern int ejsLookupVar(Ejs *ejs, struct EjsVar *vp, EjsName *name, bool anySpace, EjsLookup *lookup);
+extern void ejsFlushPropertyCache(Ejs *ejs);
 extern int ejsLookupVarInBlock(Ejs *ejs, struct EjsVar *vp, EjsName *name, bool anySpace, EjsLookup *lookup);
 extern struct EjsModule *ejsLookupModule(Ejs *ejs, cchar *name);
 extern int ejsLookupScope(Ejs *ejs, EjsName *name, bool anySpace, EjsLookup *lookup);
@@ -1525,7 +1669,7 @@ typedef struct EjsVar {
     uint    permanent         :  1;             /**< Object is immune from GC */
     uint    survived          :  1;             /**< Object has survived one GC pass */
     uint    visited           :  1;             /**< Has been traversed */
-    uint    reserved          :  1;             /**< Future expansion */
+    uint    master            :  1;             /**< Owned by a master interpreter and shared by its clones */
 
 #if BLD_DEBUG
     int             magic;                      /**< Magic signature for GC */
@@ -3194,6 +3338,8 @@ typedef struct EjsNumber {
 
 /**
  *  Create a number object
+ *  @description Integer values between EJS_MIN_SMALL_INT and EJS_MAX_SMALL_INT are not allocated. A shared, 
+ *      pre-created number object is returned instead. Number objects must therefore never be modified after creation.
  *  @param ejs Ejs reference returned from #ejsCreate
  *  @param value Numeric value to initialize the number object
  *  @return A number object
@@ -3923,7 +4069,7 @@ typedef struct EjsTypeFixup
  *  TODO - rename EJS_MODULE_MAJOR
  */
 #define EJS_MAJOR               1
-#define EJS_MINOR               4
+#define EJS_MINOR               5
 #define EJS_MODULE_VERSION      (EJS_MAJOR << 8 | EJS_MINOR)
 
 
@@ -4239,6 +4385,120 @@ extern "C" {
 #define EJS_WEB_RESPONSE_VAR    2           /* Fields of the Response object */
 
 /*********************************** Types ************************************/
+/*
+ *  Pooled request interpreter. The state after cloning is saved so the interpreter can be reset for reuse.
+ */
+typedef struct EjsWebInterp {
+    struct EjsWebInterp *next;              /* Next idle interpreter */
+    Ejs             *ejs;                   /* Interpreter cloned from the cache interpreter */
+    EjsVar          **slots;                /* Global property values after cloning */
+    EjsVar          *lastEternal;           /* Most recent eternal object after cloning */
+    int             numProp;                /* Global property count after cloning */
+    int             numSpaces;              /* Global namespace count after cloning */
+    int             numModules;             /* Loaded module count after cloning */
+    int             flags;                  /* Interpreter flags after cloning */
+    int             generation;             /* Cache generation when cloned */
+    int             uses;                   /* Count of requests served */
+} EjsWebInterp;
+
+/*
+ *  Static properties of a class defined by a cached module, saved after the module is loaded
+ */
+typedef struct EjsWebStatics {
+    EjsType         *type;                  /* Class defined by the cached module */
+    EjsVar          **slots;                /* Static property values after loading */
+    int             numProp;                /* Count of static properties after loading */
+} EjsWebStatics;
+
+/*
+ *  Application module cache. Modules are loaded once into a clone of the master interpreter. Request interpreters are
+ *  cloned from the cache interpreter and so bind to the cached definitions without reading the modules. Applications
+ *  that do not cache modules have a cache with no modules that only holds the interpreter pool.
+ */
+typedef struct EjsWebCache {
+    char            *appDir;                /* Application directory. Caches are per application */
+    Ejs             *interp;                /* Interpreter holding the cached module definitions */
+    MprHashTable    *modules;               /* Cached modules (EjsWebModule) indexed by module path */
+    MprList         *statics;               /* Initial class static properties (EjsWebStatics) */
+    MprTime         checked;                /* When the cached modules were last checked for changes */
+    int             generation;             /* Incremented when a module is added to the cache */
+    int             refs;                   /* Count of requests cloned from the cache interpreter */
+    int             retired;                /* Cache is stale. Freed when the last request completes */
+    EjsWebInterp    *idle;                  /* Pool of idle request interpreters */
+    int             numIdle;                /* Count of idle interpreters */
+} EjsWebCache;
+
+/*
+ *  Cached module entry
+ */
+typedef struct EjsWebModule {
+    char            *source;                /* Source file compiled to the module. Null for application modules */
+    MprTime         mtime;                  /* Module file modification time when loaded */
+    int             generation;             /* Cache generation when the module was loaded */
+} EjsWebModule;
+
+/*
+ *  Compilation of a web component into a module. Concurrent requests for the same module share one compilation.
+ */
+typedef struct EjsWebCompile {
+    char            *kind;                  /* Component kind: "controller", "view" or "" for web pages */
+    char            *name;                  /* Component name relative to the kind directory */
+    char            *appDir;                /* Application directory */
+    char            *base;                  /* Module path without extension. Key in the compiling table */
+    char            *source;                /* Source file */
+    char            *prefix;                /* Class name prefix for views and web pages */
+    char            *error;                 /* Error message if the compilation failed */
+    int             status;                 /* Compilation status. Valid when done */
+    int             done;                   /* Compilation complete */
+    int             waiters;                /* Count of requests waiting for the compilation */
+#if BLD_FEATURE_MULTITHREAD
+    MprCond         *cond;                  /* Signalled when the compilation completes */
+#endif
+} EjsWebCompile;
+
+/*
+ *  Session state. Sessions are held natively in the session store outside any interpreter heap and so persist past the
+ *  life of a request. Session values are stored serialized and are deserialized into the requesting interpreter.
+ */
+typedef struct EjsWebSessionState {
+    char            *id;                    /* Session ID */
+    MprHashTable    *values;                /* Serialized session values indexed by property name */
+    MprTime         expire;                 /* When the session should expire */
+    int             timeout;                /* Session inactivity lifespan (sec) */
+    int             refs;                   /* Count of requests using the session */
+    int             removed;                /* Session has been destroyed. Freed by the session timer */
+    struct EjsWebSessionState *nextExpire;  /* Timer wheel slot linkage */
+    struct EjsWebSessionState *prevExpire;
+    int             slot;                   /* Timer wheel slot */
+} EjsWebSessionState;
+
+/*
+ *  Session store shard. Sessions are distributed over the shards by ID hash so requests for different sessions 
+ *  rarely contend for the same lock.
+ */
+typedef struct EjsWebSessionShard {
+    MprHashTable    *sessions;              /* Sessions (EjsWebSessionState) indexed by session ID */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;                 /* Lock for the sessions and their state */
+#endif
+} EjsWebSessionShard;
+
+/*
+ *  Session store. Sessions are scheduled for expiry on a timer wheel with one slot per timer period. Each timer tick
+ *  only examines the sessions in the due slot. Sessions that were active since being scheduled are moved to the slot 
+ *  of their new expiry time.
+ */
+typedef struct EjsWebSessionStore {
+    EjsWebSessionShard  shards[EJS_SESSION_SHARDS];
+    EjsWebSessionState  *wheel[EJS_SESSION_WHEEL];  /* Sessions by expiry slot */
+    MprTime         wheelTick;              /* Next timer wheel tick to examine */
+    MprEvent        *timer;                 /* Expiry timer. Started when the first session is created */
+    int             count;                  /* Count of sessions */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;                 /* Lock for the timer wheel. Acquired before any shard lock */
+#endif
+} EjsWebSessionStore;
+
 /*
  *  Service control block. This defines the function callbacks for a web server module to implement.
  *  Aall these functions as required to interact with the web server.
@@ -4247,10 +4507,27 @@ typedef struct EjsWebControl {
     EjsService  *service;                   /* EJS service */
     Ejs         *master;                    /* Master interpreter */
     EjsVar      *applications;              /* Application cache */
-    EjsObject   *sessions;                  /* Session cache */
+    EjsWebSessionStore *sessions;           /* Session store */
     cchar       *modulePath;                /* Path to the ejs web server module and handler */
     int         sessionTimeout;             /* Default session timeout */
     int         nextSession;                /* Session ID counter */
+    MprHashTable *caches;                   /* Module caches (EjsWebCache) indexed by application directory */
+    MprHashTable *pools;                    /* Interpreter pools (EjsWebCache) for applications not caching modules */
+    int         moduleCheck;                /* Period to check cached modules for changes (msec) */
+    MprHashTable *compiling;                /* Compilations in progress (EjsWebCompile) indexed by module path */
+    int         active;                     /* Count of requests running on clones of the master */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex    *mutex;                     /* Module cache synchronization */
+    MprList     *compileQueue;              /* Compilations waiting for the compile thread */
+    MprCond     *compileCond;               /* Signalled when a compilation is queued */
+    MprThread   *compileThread;             /* Background compile thread. Started on first use */
+#endif
+
+    /*
+     *  In-process compiler. Compile the files (sources and modules to preload) into a module. If not defined, the 
+     *  ejsweb program is run to compile components.
+     */
+    int         (*compile)(MprCtx ctx, cchar *module, int argc, char **files);
 
     void        (*defineParams)(void *handle);
     void        (*discardOutput)(void *handle);
@@ -4282,6 +4559,7 @@ typedef struct EjsWebControl {
 #define EJS_WEB_FLAG_SESSION             0x2    /* Auto create sessions for each request */
 #define EJS_WEB_FLAG_APP                 0x4    /* Request for content inside an Ejscript Application*/
 #define EJS_WEB_FLAG_SOLO                0x8    /* Solo ejs file */
+#define EJS_WEB_FLAG_CACHE               0x10   /* Create the request from the application module cache */
 
 /*
  *  Per request control block
@@ -4313,6 +4591,9 @@ typedef struct EjsWeb {
     EjsVar          *controller;    /* Controller instance to run */
     EjsVar          *doAction;      /* doAction() function to run. May be renderView() for Stand-Alone views. */
 
+    EjsWebCache     *cache;         /* Module cache or pool the interpreter was cloned from */
+    EjsWebInterp    *interp;        /* Pooled interpreter. Returned to the cache pool when the request completes */
+    int             cacheGeneration;/* Cache generation when the interpreter was cloned */
 } EjsWeb;
 
 
@@ -4360,12 +4641,13 @@ typedef struct EjsWebResponse
 } EjsWebResponse;
 
 
+/*
+ *  Session class. Session objects are created in the request interpreter and access the session state in the store.
+ */
 typedef struct EjsWebSession
 {
     EjsObject   obj;
-    MprTime     expire;                     /* When the session should expire */
-    cchar       *id;                        /* Session ID */
-    int         timeout;                    /* Session inactivity lifespan */
+    EjsWebSessionState *state;              /* Session state in the session store */
 } EjsWebSession;
 
 
@@ -4382,6 +4664,8 @@ extern void         ejsConfigureWebResponseType(Ejs *ejs);
 extern void         ejsConfigureWebHostType(Ejs *ejs);
 extern void         ejsConfigureWebControllerType(Ejs *ejs);
 extern void         ejsConfigureWebSessionType(Ejs *ejs);
+extern EjsWebSessionStore *ejsCreateSessionStore(MprCtx ctx);
+extern void         ejsReleaseSession(EjsWeb *web);
 
 //DDD
 extern EjsWeb       *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *req, cchar *scriptName, cchar *uri,
@@ -41,29 +41,31 @@
 #define ES_ejs_db_Database_close                                       10
 #define ES_ejs_db_Database_sql                                         11
 #define ES_ejs_db_Database_query                                       12
-#define ES_ejs_db_Database_connection                                  13
-#define ES_ejs_db_Database_name                                        14
-#define ES_ejs_db_Database_getTables                                   15
-#define ES_ejs_db_Database_getColumns                                  16
-#define ES_ejs_db_Database_defaultDatabase                             17
-#define ES_ejs_db_Database_set_defaultDatabase                         18
-#define ES_ejs_db_Database_DatatypeToSqlite                            19
-#define ES_ejs_db_Database_SqliteToDatatype                            20
-#define ES_ejs_db_Database_SqliteToEjs                                 21
-#define ES_ejs_db_Database_createDatabase                              22
-#define ES_ejs_db_Database_destroyDatabase                             23
-#define ES_ejs_db_Database_createTable                                 24
-#define ES_ejs_db_Database_renameTable                                 25
-#define ES_ejs_db_Database_destroyTable                                26
-#define ES_ejs_db_Database_addIndex                                    27
-#define ES_ejs_db_Database_removeIndex                                 28
-#define ES_ejs_db_Database_addColumn                                   29
-#define ES_ejs_db_Database_changeColumn                                30
-#define ES_ejs_db_Database_renameColumn                                31
-#define ES_ejs_db_Database_removeColumns                               32
-#define ES_ejs_db_Database_log                                         33
-#define ES_ejs_db_Database_trace                                       34
-#define ES_ejs_db_Database_NUM_CLASS_PROP                              35
+#define ES_ejs_db_Database_statementCache                              13
+#define ES_ejs_db_Database_cursor                                      14
+#define ES_ejs_db_Database_connection                                  15
+#define ES_ejs_db_Database_name                                        16
+#define ES_ejs_db_Database_getTables                                   17
+#define ES_ejs_db_Database_getColumns                                  18
+#define ES_ejs_db_Database_defaultDatabase                             19
+#define ES_ejs_db_Database_set_defaultDatabase                         20
+#define ES_ejs_db_Database_DatatypeToSqlite                            21
+#define ES_ejs_db_Database_SqliteToDatatype                            22
+#define ES_ejs_db_Database_SqliteToEjs                                 23
+#define ES_ejs_db_Database_createDatabase                              24
+#define ES_ejs_db_Database_destroyDatabase                             25
+#define ES_ejs_db_Database_createTable                                 26
+#define ES_ejs_db_Database_renameTable                                 27
+#define ES_ejs_db_Database_destroyTable                                28
+#define ES_ejs_db_Database_addIndex                                    29
+#define ES_ejs_db_Database_removeIndex                                 30
+#define ES_ejs_db_Database_addColumn                                   31
+#define ES_ejs_db_Database_changeColumn                                32
+#define ES_ejs_db_Database_renameColumn                                33
+#define ES_ejs_db_Database_removeColumns                               34
+#define ES_ejs_db_Database_log                                         35
+#define ES_ejs_db_Database_trace                                       36
+#define ES_ejs_db_Database_NUM_CLASS_PROP                              37
 
 /**
  * Instance slots for "Database" type 
@@ -79,7 +81,11 @@
 #define ES_ejs_db_Database_Database_connectionString                   0
 #define ES_ejs_db_Database_connect_connectionString                    0
 #define ES_ejs_db_Database_sql_cmd                                     0
+#define ES_ejs_db_Database_sql_params                                  1
 #define ES_ejs_db_Database_query_cmd                                   0
+#define ES_ejs_db_Database_query_params                                1
+#define ES_ejs_db_Database_cursor_cmd                                  0
+#define ES_ejs_db_Database_cursor_params                               1
 #define ES_ejs_db_Database_getTables_cmd                               0
 #define ES_ejs_db_Database_getTables_grid                              1
 #define ES_ejs_db_Database_getTables_result                            2
@@ -129,6 +135,20 @@
 #define ES_ejs_db_Database_trace_on                                    0
 
 
+/**
+ *   Class property slots for the "Cursor" class 
+ */
+#define ES_ejs_db_Cursor__origin                                       5
+#define ES_ejs_db_Cursor_next                                          5
+#define ES_ejs_db_Cursor_close                                         6
+#define ES_ejs_db_Cursor_NUM_CLASS_PROP                                7
+
+/**
+ * Instance slots for "Cursor" type 
+ */
+#define ES_ejs_db_Cursor_NUM_INSTANCE_PROP                             0
+
+
 /**
  *   Class property slots for the "Record" class 
  */
@@ -338,7 +358,7 @@
 #define ES_ejs_db_Record_coerceTypes__hoisted_0_field                  0
 #define ES_ejs_db_Record_coerceTypes__hoisted_1_value                  1
 
-#define _ES_CHECKSUM_ejs_db 1141514
+#define _ES_CHECKSUM_ejs_db 1179833
 
 #endif
 /*
@@ -579,8 +599,8 @@
  *    Local slots for methods in type BinaryStream 
  */
 #define ES_ejs_io_BinaryStream_BinaryStream_stream                     0
-#define ES_ejs_io_BinaryStream_BinaryStream___fun_9733__               1
-#define ES_ejs_io_BinaryStream_BinaryStream___fun_9754__               2
+#define ES_ejs_io_BinaryStream_BinaryStream___fun_9788__               1
+#define ES_ejs_io_BinaryStream_BinaryStream___fun_9809__               2
 #define ES_ejs_io_BinaryStream_close_graceful                          0
 #define ES_ejs_io_BinaryStream_set_endian_value                        0
 #define ES_ejs_io_BinaryStream_read_buffer                             0
@@ -999,7 +1019,7 @@
 #define ES_ejs_io_XMLHttp_callback_hp                                  1
 #define ES_ejs_io_XMLHttp_callback_count                               2
 
-#define _ES_CHECKSUM_ejs_io 1375817
+#define _ES_CHECKSUM_ejs_io 1375828
 
 #endif
 /*
@@ -1097,61 +1117,62 @@
 #define ES_Type                                                        72
 #define ES_Void                                                        73
 #define ES_ejs_db_Database                                             74
-#define ES_ejs_db_Record                                               75
-#define ES_ejs_db_pluralize                                            76
-#define ES_ejs_events_Dispatcher                                       77
-#define ES_Endpoint                                                    78
-#define ES_ejs_events_Event                                            79
-#define ES_ejs_events_Timer                                            80
-#define ES_ejs_events_TimerEvent                                       81
-#define ES_ejs_io_BinaryStream                                         82
-#define ES_ejs_io_File                                                 83
-#define ES_ejs_io_Http                                                 84
-#define ES_ejs_io_HttpDataEvent                                        85
-#define ES_ejs_io_HttpErrorEvent                                       86
-#define ES_ejs_io_TextStream                                           87
-#define ES_ejs_io_XMLHttp                                              88
-#define ES_ejs_sys_App                                                 89
-#define ES_Config                                                      90
-#define ES_ejs_sys_GC                                                  91
-#define ES_ejs_sys_Memory                                              92
-#define ES_ejs_sys_System                                              93
-#define ES_basename                                                    94
-#define ES_close                                                       95
-#define ES_cp                                                          96
-#define ES_dirname                                                     97
-#define ES_exists                                                      98
-#define ES_extension                                                   99
-#define ES_freeSpace                                                   100
-#define ES_isDir                                                       101
-#define ES_ls                                                          102
-#define ES_mkdir                                                       103
-#define ES_mv                                                          104
-#define ES_open                                                        105
-#define ES_pwd                                                         106
-#define ES_read                                                        107
-#define ES_rm                                                          108
-#define ES_rmdir                                                       109
-#define ES_tempname                                                    110
-#define ES_write                                                       111
-#define ES_ejs_web_GoogleConnector                                     112
-#define ES_ejs_web_HtmlConnector                                       113
-#define ES_ejs_web_action                                              114
-#define ES_ejs_web_view                                                115
-#define ES_ejs_web_Controller                                          116
-#define ES_ejs_web__SoloController                                     117
-#define ES_ejs_web_Cookie                                              118
-#define ES_ejs_web_Host                                                119
-#define ES_ejs_web_Request                                             120
-#define ES_ejs_web_Response                                            121
-#define ES_ejs_web_sessions                                            122
-#define ES_ejs_web_Session                                             123
-#define ES_ejs_web_UploadFile                                          124
-#define ES_ejs_web_View                                                125
-#define ES_Model                                                       126
-#define ES_XML                                                         127
-#define ES_XMLList                                                     128
-#define ES_global_NUM_CLASS_PROP                                       129
+#define ES_ejs_db_Cursor                                               75
+#define ES_ejs_db_Record                                               76
+#define ES_ejs_db_pluralize                                            77
+#define ES_ejs_events_Dispatcher                                       78
+#define ES_Endpoint                                                    79
+#define ES_ejs_events_Event                                            80
+#define ES_ejs_events_Timer                                            81
+#define ES_ejs_events_TimerEvent                                       82
+#define ES_ejs_io_BinaryStream                                         83
+#define ES_ejs_io_File                                                 84
+#define ES_ejs_io_Http                                                 85
+#define ES_ejs_io_HttpDataEvent                                        86
+#define ES_ejs_io_HttpErrorEvent                                       87
+#define ES_ejs_io_TextStream                                           88
+#define ES_ejs_io_XMLHttp                                              89
+#define ES_ejs_sys_App                                                 90
+#define ES_Config                                                      91
+#define ES_ejs_sys_GC                                                  92
+#define ES_ejs_sys_Memory                                              93
+#define ES_ejs_sys_System                                              94
+#define ES_basename                                                    95
+#define ES_close                                                       96
+#define ES_cp                                                          97
+#define ES_dirname                                                     98
+#define ES_exists                                                      99
+#define ES_extension                                                   100
+#define ES_freeSpace                                                   101
+#define ES_isDir                                                       102
+#define ES_ls                                                          103
+#define ES_mkdir                                                       104
+#define ES_mv                                                          105
+#define ES_open                                                        106
+#define ES_pwd                                                         107
+#define ES_read                                                        108
+#define ES_rm                                                          109
+#define ES_rmdir                                                       110
+#define ES_tempname                                                    111
+#define ES_write                                                       112
+#define ES_ejs_web_GoogleConnector                                     113
+#define ES_ejs_web_HtmlConnector                                       114
+#define ES_ejs_web_action                                              115
+#define ES_ejs_web_view                                                116
+#define ES_ejs_web_Controller                                          117
+#define ES_ejs_web__SoloController                                     118
+#define ES_ejs_web_Cookie                                              119
+#define ES_ejs_web_Host                                                120
+#define ES_ejs_web_Request                                             121
+#define ES_ejs_web_Response                                            122
+#define ES_ejs_web_sessions                                            123
+#define ES_ejs_web_Session                                             124
+#define ES_ejs_web_UploadFile                                          125
+#define ES_ejs_web_View                                                126
+#define ES_Model                                                       127
+#define ES_XML                                                         128
+#define ES_XMLList                                                     129
+#define ES_global_NUM_CLASS_PROP                                       130
 
 /**
  * Instance slots for "global" type 
@@ -2302,7 +2323,7 @@
 #define ES_XMLList_setSettings_settings                                0
 #define ES_XMLList_text_name                                           0
 
-#define _ES_CHECKSUM_ejs 2089289
+#define _ES_CHECKSUM_ejs 2091700
 
 #endif
 /*
@@ -3199,11 +3220,11 @@
 #define ES_ejs_web_View_ejs_web_getValue_typeName                      4
 #define ES_ejs_web_View_ejs_web_getValue_fmt                           5
 #define ES_ejs_web_View_ejs_web_date_fmt                               0
-#define ES_ejs_web_View_ejs_web_date___fun_21788__                     1
+#define ES_ejs_web_View_ejs_web_date___fun_21843__                     1
 #define ES_ejs_web_View_ejs_web_currency_fmt                           0
-#define ES_ejs_web_View_ejs_web_currency___fun_21822__                 1
+#define ES_ejs_web_View_ejs_web_currency___fun_21877__                 1
 #define ES_ejs_web_View_ejs_web_number_fmt                             0
-#define ES_ejs_web_View_ejs_web_number___fun_21852__                   1
+#define ES_ejs_web_View_ejs_web_number___fun_21907__                   1
 #define ES_ejs_web_View_ejs_web_getOptions_options                     0
 #define ES_ejs_web_View_ejs_web_getOptions_result                      1
 #define ES_ejs_web_View_ejs_web_getOptions__hoisted_2_option           2
@@ -3428,6 +3449,6 @@
 #define ES_Model_coerceTypes__hoisted_1_value                          1
 #define ES_Model_Model_fields                                          0
 
-#define _ES_CHECKSUM_ejs_web 3386549
+#define _ES_CHECKSUM_ejs_web 3386552
 
 #endif
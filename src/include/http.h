@@ -79,6 +79,8 @@ typedef struct MaLimits {
     int             maxStageBuffer;         /**< Max buffering by any pipeline stage */
     int             maxThreads;             /**< Max number of pool threads */
     int             minThreads;             /**< Min number of pool threads */
+    int             maxHandshakeThreads;    /**< Number of SSL handshake threads. Zero to handshake inline */
+    int             maxHandshakeQueue;      /**< Max connections waiting for an SSL handshake thread */
     int             maxUploadSize;          /**< Max size of an uploaded file */
     int             maxUrl;                 /**< Max size of a URL */
     int             threadStackSize;        /**< Stack size for each pool thread */
@@ -112,6 +114,7 @@ typedef struct MaHttp {
     struct MaStage  *ejsHandler;            /**< Ejscript Web Framework handler */
     struct MaStage  *fileHandler;           /**< Static file handler */
     struct MaStage  *passHandler;           /**< Pass through handler */
+    struct MaStage  *uploadHandler;         /**< Multipart file upload handler */
 
     char            *username;              /**< Http server user name */
     char            *groupname;             /**< Http server group name */
@@ -119,6 +122,9 @@ typedef struct MaHttp {
     int             gid;                    /**< Group Id */
 
 #if BLD_FEATURE_MULTITHREAD
+#if BLD_FEATURE_SSL
+    struct MaHandshakeService *handshakeService; /**< Dedicated SSL handshake thread pool */
+#endif
     MprMutex        *mutex;                 /**< Multi-thread sync */
 #endif
 } MaHttp;
@@ -187,9 +193,11 @@ extern MprModule *maChunkFilterInit(MaHttp *http, cchar *path);
 extern MprModule *maDirHandlerInit(MaHttp *http, cchar *path);
 extern MprModule *maEgiHandlerInit(MaHttp *http, cchar *path);
 extern MprModule *maEjsHandlerInit(MaHttp *http, cchar *path);
+extern MprModule *maFastcgiHandlerInit(MaHttp *http, cchar *path);
 extern MprModule *maFileHandlerInit(MaHttp *http, cchar *path);
 extern MprModule *maNetConnectorInit(MaHttp *http, cchar *path);
 extern MprModule *maPhpHandlerInit(MaHttp *http, cchar *path);
+extern MprModule *maProxyHandlerInit(MaHttp *http, cchar *path);
 extern MprModule *maRangeFilterInit(MaHttp *http, cchar *path);
 extern MprModule *maSslModuleInit(MaHttp *http, cchar *path);
 extern MprModule *maUploadHandlerInit(MaHttp *http, cchar *path);
@@ -592,6 +600,8 @@ extern void maSetUploadCallback(MaHttp *http, MaUploadCallback userCallback, voi
 #define MA_LOC_APP_DIR          0x4         /**< Location defines a directory of applications */
 #define MA_LOC_AUTO_SESSION     0x8         /**< Auto create sessions in this location */
 #define MA_LOC_BROWSER          0x10        /**< Send errors back to the browser for this location */
+#define MA_LOC_STREAM_INPUT     0x20        /**< Stream request bodies to handlers that support it */
+#define MA_LOC_MODULE_CACHE     0x40        /**< Create Ejscript requests from the application module cache */
 
 /**
  *  Location Control
@@ -606,7 +616,13 @@ typedef struct MaLocation {
     int             prefixLen;              /**< Length of the prefix name */
     int             sessionTimeout;         /**< Session timeout for this location */
     struct MaStage  *handler;               /**< Set handler */
-    void            *handlerData;           /**< Data reserved for the handler */
+    void            *handlerData;           /**< Data reserved for the set handler */
+#if BLD_FEATURE_CGI
+    struct MaCgiConfig *cgiConfig;          /**< CGI handler configuration for the location */
+#endif
+#if BLD_FEATURE_UPLOAD
+    struct MaUploadConfig *uploadConfig;    /**< Upload handler configuration for the location */
+#endif
     MprHashTable    *extensions;            /**< Hash of handlers by extensions */
     MprList         *handlers;              /**< List of handlers for this location */
     MprList         *inputStages;           /**< Input stages */
@@ -940,6 +956,18 @@ extern int maJoinPacket(MaPacket *packet, MaPacket *other);
  */
 extern MaPacket *maSplitPacket(struct MaConn *conn, MaPacket *packet, int offset);
 
+/**
+ *  Recycle a consumed input packet
+ *  @description Packets are allocated from the connection arena and memory freed from an arena is not reclaimed 
+ *      until the arena is freed. Handlers that consume request body data as it arrives should call this rather than
+ *      free the packet. The packet is given back to the connection to use for the next read, which keeps memory
+ *      bounded regardless of the body size.
+ *  @param conn MaConn connection object
+ *  @param packet Consumed packet
+ *  @ingroup MaPacket
+ */
+extern void maRecyclePacket(struct MaConn *conn, MaPacket *packet);
+
 /**
  *  Get the length of the packet data contents
  *  @description Get the content length of a packet. This does not include the prefix or suffix data length -- just
@@ -967,6 +995,7 @@ extern int maGetPacketLength(MaPacket *packet);
 #define MA_QUEUE_ALL            0x8         /**< Queue has all the data there is and will be */
 #define MA_QUEUE_SERVICED       0x10        /**< Queue has been serviced at least once */
 #define MA_QUEUE_EOF            0x20        /**< Queue at end of data */
+#define MA_QUEUE_FLUSH          0x40        /**< Queue should send buffered data without waiting for more */
 
 /*
  *  Queue callback prototypes
@@ -993,7 +1022,7 @@ typedef void (*MaQueueService)(struct MaQueue *q);
  *  @stability Evolving
  *  @defgroup MaQueue MaQueue
  *  @see MaQueue MaPacket MaConn maDiscardData maGet maJoinForService maPutForService maDefaultPut maDisableQueue
- *      maEnableQueue maGetQueueRoom maIsQueueEmpty maPacketTooBig maPut maPutBack maPutForService maPutNext
+ *      maEnableQueue maFlushQueue maGetQueueRoom maIsQueueEmpty maPacketTooBig maPut maPutBack maPutForService maPutNext
  *      maRemoveQueue maResizePacket maScheduleQueue maSendPacket maSendPackets maSendEndPacket maServiceQueue
  *      maWillNextQueueAccept maWrite maWriteBlock maWriteBody maWriteString
  */
@@ -1091,6 +1120,16 @@ extern void maDisableQueue(MaQueue *q);
  */
 extern void maEnableQueue(MaQueue *q);
 
+/**
+ *  Flush buffered output data
+ *  @description Mark this queue and all downstream queues for flushing and service them. Stages that aggregate
+ *      data before sending (such as the chunk filter) will send what they have without waiting for more data.
+ *      Handlers that favor latency over throughput should call this after writing a unit of output.
+ *  @param q Queue reference
+ *  @ingroup MaQueue
+ */
+extern void maFlushQueue(MaQueue *q);
+
 /**
  *  Get the room in the queue
  *  @description Get the amount of data the queue can accept before being full.
@@ -1295,6 +1334,7 @@ extern void maInsertQueue(MaQueue *prev, MaQueue *q);
 #define MA_STAGE_VIRTUAL    0x40000         /**< Handler serves virtual resources not the physical file system */
 #define MA_STAGE_PATH_INFO  0x80000         /**< Always do path info processing */
 #define MA_STAGE_AUTO_DIR   0x100000        /**< Want auto directory redirection */
+#define MA_STAGE_STREAM_INPUT 0x200000      /**< Handler consumes request body data as it arrives */
 
 /**
  *  Pipeline Stages
@@ -1395,6 +1435,18 @@ typedef struct MaStage {
      */
     void            (*incomingService)(MaQueue *q);
 
+    /**
+     *  Receive incoming data directly from the socket
+     *  @description Optional. Move request body data from the connection socket to its destination without copying
+     *      it through user space. Only invoked for requests where the handler has set MA_REQ_SPLICE_INPUT.
+     *  @param q Queue instance object
+     *  @param bytes Maximum number of bytes to move
+     *  @return A count of bytes moved. Returns zero if the client closed the connection. Returns -1 on errors with
+     *      errno set. Errno is set to EAGAIN if no data is available and to EINVAL if splicing is not possible.
+     *  @ingroup MaStage
+     */
+    int             (*incomingSplice)(MaQueue *q, int bytes);
+
     void            *stageData;             /**< Per-stage data */
 } MaStage;
 
@@ -1520,8 +1572,11 @@ extern bool maMatchFilterByExtension(MaFilter *filter, cchar *ext);
  *  Connection flags
  */
 #define MA_CONN_CLOSE               0x1     /**< Connection needs to be closed */
-#define MA_CONN_CLEAN_MASK          0x1     /**< Mask to clear flags after a request completes */
+#define MA_CONN_CLEAN_MASK          0x9     /**< Mask to clear flags after a request completes */
 #define MA_CONN_CASE_INSENSITIVE    0x2     /**< System case-insensitive for file matches */
+#define MA_CONN_HANDSHAKE           0x4     /**< SSL handshake is in progress on the handshake pool */
+#define MA_CONN_READ_BLOCKED        0x8     /**< Reading the request body is paused until the handler drains */
+#define MA_CONN_DESTROYED           0x10    /**< Connection is closed and is freed when the last hold is released */
 
 /**
  *  Http Connections
@@ -1549,6 +1604,7 @@ typedef struct MaConn {
     char            *remoteIpAddr;          /**< Remote client IP address (REMOTE_ADDR) */
     MprTime         started;                /**< When the connection started */
     MprTime         expire;                 /**< When the connection should expire */
+    MprTime         deadline;               /**< When the current request must complete. Zero if no deadline */
     MprTime         time;                   /**< Cached current time */
 
     int             requestFailed;          /**< Request failed. Abbreviate request processing */
@@ -1561,6 +1617,15 @@ typedef struct MaConn {
     int             socketEventMask;        /**< Mask of events to receive */
     int             state;                  /**< Connection state */
     int             timeout;                /**< Timeout period in msec */
+    int             holds;                  /**< Holds preventing the connection being freed. See maHoldConn */
+
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;                 /**< Serialize activity on the connection. See maLockConn */
+#endif
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+    MprTime         handshakeQueued;        /**< When queued for a handshake thread. Zero if not queued */
+    MprTime         handshakeDuration;      /**< Total time spent performing the SSL handshake */
+#endif
 } MaConn;
 
 
@@ -1569,10 +1634,13 @@ extern void maAwakenConn(MaConn *conn);
 extern void maCloseConn(MaConn *conn);
 extern void maCreateEnvVars(MaConn *conn);
 extern void maCreatePipeline(MaConn *conn);
+extern void maDestroyConn(MaConn *conn);
 extern void maDiscardPipeData(MaConn *conn);
 extern void *maGetHandlerQueueData(struct MaConn *conn);
 extern void maMatchHandler(MaConn *conn);
 extern void maResetConn(MaConn *conn);
+extern void maResumeReading(MaConn *conn);
+extern void maSetConnEvents(MaConn *conn, int mask);
 extern bool maRunPipeline(MaConn *conn);
 extern void maStartPipeline(MaConn *conn);
 extern bool maServiceQueues(MaConn *conn);
@@ -1580,6 +1648,297 @@ extern void maSetRangeDimensions(MaConn *conn, int length);
 extern void maSetRequestGroup(MaConn *conn, cchar *group);
 extern void maSetRequestUser(MaConn *conn, cchar *user);
 
+/**
+ *  Lock a connection
+ *  @description Requests are processed with the connection locked. Code that runs outside the connection's I/O 
+ *      events, such as timers, I/O events for back-end connections and other threads, must lock the connection 
+ *      before touching the request pipeline. Connections are locked before handler and stage locks.
+ *  @param conn Connection object
+ *  @ingroup MaConn
+ */
+extern void maLockConn(MaConn *conn);
+
+/**
+ *  Unlock a connection
+ *  @param conn Connection object locked via #maLockConn
+ *  @ingroup MaConn
+ */
+extern void maUnlockConn(MaConn *conn);
+
+/**
+ *  Hold a connection
+ *  @description Prevent the connection object from being freed. A connection closed while it is held is marked with
+ *      MA_CONN_DESTROYED and is freed when the last hold is released. The caller must know the connection is valid,
+ *      either because it has the connection locked or because it holds a reference that the handler's close routine 
+ *      revokes under the handler's lock. Holds may be taken while handler locks are held.
+ *  @param conn Connection object
+ *  @ingroup MaConn
+ */
+extern void maHoldConn(MaConn *conn);
+
+/**
+ *  Release a hold on a connection
+ *  @description The connection must not be locked by the caller. The connection is freed if it has been closed and 
+ *      this is the last hold.
+ *  @param conn Connection object held via #maHoldConn
+ *  @ingroup MaConn
+ */
+extern void maReleaseConn(MaConn *conn);
+
+/**
+ *  Connection event callback. Invoked with the connection locked.
+ *  @ingroup MaConn
+ */
+typedef void (*MaConnEventProc)(MaConn *conn, void *data);
+
+/**
+ *  Connection event
+ *  @description Run a callback for the current request from the event loop, serialized with the connection's I/O 
+ *      events. The connection is held while the event is pending.
+ *  @ingroup MaConn
+ */
+typedef struct MaConnEvent {
+    MaConn          *conn;                  /**< Connection to lock */
+    MaConnEventProc proc;                   /**< Callback. Null if the event has been cancelled */
+    void            *data;                  /**< Callback data. Typically owned by the request */
+} MaConnEvent;
+
+/**
+ *  Create a connection event
+ *  @param conn Connection object. Must be locked by the caller as the event is allocated from the connection.
+ *  @param proc Callback procedure
+ *  @param delay Msec to wait before running the callback
+ *  @param data Data argument for the callback
+ *  @return A connection event object. Use #maCancelConnEvent if the data is freed before the event runs.
+ *  @ingroup MaConn
+ */
+extern MaConnEvent *maCreateConnEvent(MaConn *conn, MaConnEventProc proc, int delay, void *data);
+
+/**
+ *  Cancel a connection event
+ *  @description The callback will not be run. The event object is freed when the event fires. Must be called with
+ *      the connection locked, typically from a stage close routine.
+ *  @param event Event object returned from #maCreateConnEvent
+ *  @ingroup MaConn
+ */
+extern void maCancelConnEvent(MaConnEvent *event);
+
+/********************************** MaBackend *********************************/
+/**
+ *  Backend connection pool
+ *  @description Handlers that forward requests over pooled connections to backend servers, such as FastCGI 
+ *      responders and proxy upstreams, embed this as the first member of their pool structure. Client connections 
+ *      are locked before the pool lock.
+ *  @ingroup MaBackend
+ */
+typedef struct MaBackendPool {
+    MprList         *waiting;               /**< Requests waiting for a connection */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;                 /**< Guards the pool, the hold counts and request bindings */
+#endif
+} MaBackendPool;
+
+/**
+ *  Backend connection
+ *  @description Embedded as the first member of the handler's connection structure. Backend I/O events run on their
+ *      own, so they lock the client connection of the bound request via #maLockBackendConn before touching its 
+ *      pipeline. The conn field is set and cleared under the pool lock.
+ *  @ingroup MaBackend
+ */
+typedef struct MaBackend {
+    MaBackendPool   *pool;                  /**< Owning pool */
+    MaConn          *conn;                  /**< Client connection of the bound request. Null when idle */
+    MprWaitHandler  *handler;               /**< I/O event handler. Null once the connection is closed */
+    int             busy;                   /**< Count of holds. Held connections are not freed or reused */
+} MaBackend;
+
+/**
+ *  Initialize a backend connection pool
+ *  @param pool Pool embedded as the first member of the handler's pool structure
+ *  @ingroup MaBackend
+ */
+extern void maInitBackendPool(MaBackendPool *pool);
+
+/**
+ *  Lock a backend connection pool
+ *  @param pool Backend connection pool
+ *  @ingroup MaBackend
+ */
+extern void maLockBackendPool(MaBackendPool *pool);
+
+/**
+ *  Unlock a backend connection pool
+ *  @param pool Backend connection pool
+ *  @ingroup MaBackend
+ */
+extern void maUnlockBackendPool(MaBackendPool *pool);
+
+/**
+ *  Hold a backend connection
+ *  @description Prevent the connection from being freed while in use. A connection closed while held is freed when 
+ *      the last hold is released.
+ *  @param backend Backend connection
+ *  @ingroup MaBackend
+ */
+extern void maHoldBackend(MaBackend *backend);
+
+/**
+ *  Release a hold on a backend connection
+ *  @description If the connection has been closed and this is the last hold, the enclosing connection structure is
+ *      freed.
+ *  @param backend Backend connection held via #maHoldBackend
+ *  @return False if the connection has been closed
+ *  @ingroup MaBackend
+ */
+extern bool maReleaseBackend(MaBackend *backend);
+
+/**
+ *  Hold a backend connection and lock its client connection
+ *  @description Used by backend I/O event callbacks. The pool lock is dropped while waiting for the client 
+ *      connection, so the binding is checked again once it is locked.
+ *  @param backend Backend connection
+ *  @return The locked and held client connection of the bound request. Null if the backend connection is idle.
+ *  @ingroup MaBackend
+ */
+extern MaConn *maLockBackendConn(MaBackend *backend);
+
+/**
+ *  Unlock a client connection locked via #maLockBackendConn
+ *  @description Unlock and release the client connection, enable further I/O events if the backend connection is 
+ *      still open and release the hold on the backend connection.
+ *  @param backend Backend connection
+ *  @param conn Client connection returned by #maLockBackendConn. May be null.
+ *  @return False if the backend connection has been closed
+ *  @ingroup MaBackend
+ */
+extern bool maUnlockBackendConn(MaBackend *backend, MaConn *conn);
+
+/**
+ *  Write response data from a backend to the client
+ *  @description Data is written outside the client connection's I/O events, so the queues are serviced and the 
+ *      connection is enabled for writable events if the connector could not write it all.
+ *  @param q Handler send queue
+ *  @param buf Data to write
+ *  @param len Length of data
+ *  @return Count of bytes written. This is less than len if the client queue is full.
+ *  @ingroup MaBackend
+ */
+extern int maWriteBackendData(MaQueue *q, cchar *buf, int len);
+
+/**
+ *  Enable writable events on a client connection if the connector has data it could not write
+ *  @param conn Client connection
+ *  @ingroup MaBackend
+ */
+extern void maEnableBackendWrites(MaConn *conn);
+
+/**
+ *  Pool event
+ *  @description Run a callback for a request waiting for a backend connection. The event is created by the thread
+ *      that releases a backend connection, which does not have the client connection locked, so the event is owned
+ *      by the pool.
+ *  @ingroup MaBackend
+ */
+typedef struct MaPoolEvent {
+    MaBackendPool   *pool;                  /**< Owning pool */
+    MaConn          *conn;                  /**< Client connection. Held while the event is pending */
+    MaConnEventProc proc;                   /**< Callback. Null if the event has been cancelled */
+    void            *data;                  /**< Callback data */
+} MaPoolEvent;
+
+/**
+ *  Create a pool event
+ *  @description The callback is invoked with the client connection locked.
+ *  @param pool Backend connection pool. Must be locked by the caller.
+ *  @param conn Client connection. The caller must know the connection is valid.
+ *  @param proc Callback procedure
+ *  @param data Data argument for the callback
+ *  @return A pool event object. Use #maCancelPoolEvent if the data is freed before the event runs.
+ *  @ingroup MaBackend
+ */
+extern MaPoolEvent *maCreatePoolEvent(MaBackendPool *pool, MaConn *conn, MaConnEventProc proc, void *data);
+
+/**
+ *  Cancel a pool event
+ *  @description Must be called with the client connection and the pool locked, typically from a stage close 
+ *      routine. The pool lock prevents a race with the creation of the event.
+ *  @param event Event object returned from #maCreatePoolEvent
+ *  @ingroup MaBackend
+ */
+extern void maCancelPoolEvent(MaPoolEvent *event);
+
+/****************************** MaHandshakeService ****************************/
+#if BLD_FEATURE_MULTITHREAD && BLD_FEATURE_SSL
+/**
+ *  SSL handshake statistics. Times are in msec.
+ */
+typedef struct MaHandshakeStats {
+    int             handshakes;             /**< Completed handshakes */
+    int             failed;                 /**< Failed or timed out handshakes */
+    int             rejected;               /**< Connections rejected because the queue was full */
+    int             queued;                 /**< Connections currently waiting for a handshake thread */
+    int             maxQueued;              /**< Peak queue depth */
+    MprTime         totalWait;              /**< Total time connections waited in the queue */
+    MprTime         maxWait;                /**< Longest single queue wait */
+    MprTime         totalDuration;          /**< Total handshake processing time for completed handshakes */
+    MprTime         maxDuration;            /**< Longest handshake processing time */
+} MaHandshakeStats;
+
+/**
+ *  SSL Handshake Service
+ *  @description New secure connections perform their SSL handshake on a small, bounded pool of dedicated threads.
+ *      This prevents a burst of new SSL clients from tying up the request pool threads with key exchange work.
+ *      Once the handshake completes, the connection is handed back to the normal request pool.
+ *  @stability Prototype
+ *  @defgroup MaHandshakeService MaHandshakeService
+ *  @see maCreateHandshakeService maStopHandshakeService maQueueHandshake maGetHandshakeStats
+ */
+typedef struct MaHandshakeService {
+    MprList         *queue;                 /**< Connections waiting for a handshake thread */
+    MprCond         *cond;                  /**< Signalled when connections are queued */
+    MprMutex        *mutex;                 /**< Multi-thread sync */
+    int             maxQueue;               /**< Max queue depth before rejecting new connections */
+    int             stopping;               /**< Threads should exit */
+    int             running;                /**< Count of running threads */
+    MaHandshakeStats stats;                 /**< Handshake statistics */
+} MaHandshakeService;
+
+/**
+ *  Create and start the SSL handshake service
+ *  @param http MaHttp object created via #maCreateHttp
+ *  @param threads Number of handshake threads to create
+ *  @param maxQueue Maximum number of connections that may wait for a handshake thread
+ *  @return A handshake service object. Use #maStopHandshakeService to stop.
+ *  @ingroup MaHandshakeService
+ */
+extern MaHandshakeService *maCreateHandshakeService(MaHttp *http, int threads, int maxQueue);
+
+/**
+ *  Stop the SSL handshake service
+ *  @description Stop the handshake threads and close any connections still waiting for a handshake.
+ *  @param hs Handshake service created via #maCreateHandshakeService
+ *  @ingroup MaHandshakeService
+ */
+extern void maStopHandshakeService(MaHandshakeService *hs);
+
+/**
+ *  Queue a connection for its SSL handshake
+ *  @description Queue a new secure connection to perform (or continue) its handshake on the handshake pool. If the 
+ *      queue is full, the connection is closed. The connection must be locked and is unlocked on return.
+ *  @param conn Connection object
+ *  @ingroup MaHandshakeService
+ */
+extern void maQueueHandshake(MaConn *conn);
+
+/**
+ *  Get SSL handshake statistics
+ *  @param http MaHttp object created via #maCreateHttp
+ *  @param stats Statistics structure to fill
+ *  @ingroup MaHandshakeService
+ */
+extern void maGetHandshakeStats(MaHttp *http, MaHandshakeStats *stats);
+#endif
+
 /********************************** MaRequest *********************************/
 /*
  *  Request methods
@@ -1599,6 +1958,8 @@ extern void maSetRequestUser(MaConn *conn, cchar *user);
 #define MA_REQ_CREATE_ENV   0x1             /**< Must create env for this request */
 #define MA_REQ_IF_MODIFIED  0x2             /**< If-[un]modified-since supplied */
 #define MA_REQ_CHUNKED      0x4             /**< Content is chunk encoded */
+#define MA_REQ_STREAM_INPUT 0x8             /**< Content is streamed to the handler as it arrives */
+#define MA_REQ_SPLICE_INPUT 0x10            /**< Content is spliced by the handler directly from the socket */
 
 /**
  *  Http Requests
@@ -1796,6 +2157,7 @@ extern MaRequest    *maCreateRequest(struct MaConn *conn);
 extern void         maFailConnection(struct MaConn *conn, int code, cchar *fmt, ...);
 extern MaAuth       *maGetAuth(MaConn *conn);
 extern void         maProcessReadEvent(MaConn *conn, MaPacket *packet);
+extern int          maSpliceContent(MaConn *conn);
 extern void         maProcessWriteEvent(MaConn *conn);
 extern void         maSetRequestFlags(MaConn *conn, int orFlags, int andFlags);
 extern int          maSetRequestUri(MaConn *conn, cchar *newUri);
@@ -1985,6 +2347,7 @@ extern void         maWriteAccessLogEntry(MaHost *host, cchar *buf, int len);
 /************************************ CGI *************************************/
 
 #define MA_CGI_SEEN_HEADER          0x1
+#define MA_CGI_NO_SPLICE            0x2
 
 /************************************ EGI *************************************/
 
@@ -1992,13 +2355,87 @@ extern void         maWriteAccessLogEntry(MaHost *host, cchar *buf, int len);
 
 typedef struct MaEgi {
     MprHashTable        *forms;
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex            *mutex;             /**< Multi-thread sync for suspended requests */
+#endif
 } MaEgi;
 
 
+/**
+ *  Suspended EGI request
+ *  @description Handle to an EGI request that has been suspended by its form via maSuspendEgi. The handle may be
+ *      used from any thread to write response data and to complete the request. It remains valid until
+ *      maCompleteEgi is called, even if the request times out or the client disconnects first.
+ *  @stability Evolving
+ *  @defgroup MaEgi MaEgi
+ *  @see maSuspendEgi maWriteEgi maWriteEgiBlock maCompleteEgi
+ */
+typedef struct MaEgiRequest {
+    MaEgi               *egi;               /**< Owning EGI handler */
+    MaConn              *conn;              /**< Client connection. Held while a resume event is pending */
+    MaQueue             *q;                 /**< Handler queue. Null once the request has been closed */
+    MprBuf              *pending;           /**< Data written by the form but not yet given to the pipeline */
+    MprEvent            *resume;            /**< Event to transfer pending data and completion to the pipeline */
+    int                 status;             /**< Completion status. Zero for success, otherwise an HTTP code */
+    int                 flags;              /**< Request flags */
+} MaEgiRequest;
+
+#define MA_EGI_RUNNING      0x1             /**< Form is still running in runEgi */
+#define MA_EGI_COMPLETE     0x2             /**< Form has called maCompleteEgi */
+
 typedef void (MaEgiForm)(MaQueue *q);
 
 extern int maDefineEgiForm(MaHttp *http, cchar *name, MaEgiForm *form);
 
+/**
+ *  Suspend an EGI request
+ *  @description Called by an EGI form to complete the request asynchronously. The form returns without writing
+ *      the end of the response and the thread is released. The response is finished later, possibly from another
+ *      thread, by calling maCompleteEgi. Response headers must be defined before the request is suspended.
+ *  @param q Queue reference passed to the form
+ *  @param timeout Time in milliseconds to wait for completion. If the request has not completed by then, it is failed 
+ *      and the connection is closed. Set to zero to use the host Timeout.
+ *  @return A suspended request handle. Returns null if the request cannot be suspended.
+ *  @ingroup MaEgi
+ */
+extern MaEgiRequest *maSuspendEgi(MaQueue *q, int timeout);
+
+/**
+ *  Write data to a suspended EGI request
+ *  @description Thread-safe routine to add response data to a suspended request. The data is buffered and 
+ *      written to the client from the event loop.
+ *  @param er Suspended request handle returned from maSuspendEgi
+ *  @param buf Data to write
+ *  @param len Length of data in buf
+ *  @return The number of bytes written. Returns MPR_ERR_CANT_WRITE if the request has already completed or has
+ *      been closed.
+ *  @ingroup MaEgi
+ */
+extern int maWriteEgiBlock(MaEgiRequest *er, cchar *buf, int len);
+
+/**
+ *  Write formatted data to a suspended EGI request
+ *  @param er Suspended request handle returned from maSuspendEgi
+ *  @param fmt Printf style formatted string
+ *  @param ... Arguments for fmt
+ *  @return The number of bytes written. Returns MPR_ERR_CANT_WRITE if the request has already completed or has
+ *      been closed.
+ *  @ingroup MaEgi
+ */
+extern int maWriteEgi(MaEgiRequest *er, cchar *fmt, ...);
+
+/**
+ *  Complete a suspended EGI request
+ *  @description Thread-safe routine to finish the response of a suspended request. The handle must not be used 
+ *      after this call.
+ *  @param er Suspended request handle returned from maSuspendEgi
+ *  @param status Set to zero if the response is complete. Otherwise set to an HTTP status code to fail the request.
+ *  @return Zero if the request was completed. Returns MPR_ERR_ABORTED if the request had already been closed
+ *      because it timed out or the client disconnected.
+ *  @ingroup MaEgi
+ */
+extern int maCompleteEgi(MaEgiRequest *er, int status);
+
 #endif
 
 
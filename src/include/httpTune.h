@@ -117,15 +117,29 @@
 
 
 #define MA_DEFAULT_MAX_THREADS  10              /**< Default number of threads */
+#define MA_HANDSHAKE_THREADS    2               /**< Default number of SSL handshake threads */
+#define MA_MAX_HANDSHAKE_QUEUE  256             /**< Max connections waiting for an SSL handshake thread */
 #define MA_KEEP_TIMEOUT         60000           /**< Keep connection alive timeout */
 #define MA_CGI_TIMEOUT          4000            /**< Time to wait to reap exit status */
 #define MA_MAX_KEEP_ALIVE       100             /**< Default requests per TCP conn */
 #define MA_TIMER_PERIOD         1000            /**< Timer checks ever 1 second */
 #define MA_CGI_PERIOD           20              /**< CGI poll period (only for windows) */
+#define MA_CGI_SPLICE_SIZE      (64 * 1024)     /**< Max CGI output to move to the client per splice */
+#define MA_INPUT_SPLICE_SIZE    (64 * 1024)     /**< Max request body data to move per splice */
+#define MA_UPLOAD_WRITE_SIZE    (1024 * 1024)   /**< Upload file data is written to disk in blocks of this size */
+#define MA_DIR_CACHE_SIZE       32              /**< Max directory listings cached by the dir handler */
+#define MA_DIR_CACHE_TIMEOUT    60000           /**< Max age of a cached directory listing */
+#define MA_FASTCGI_WORKERS      2               /**< Default number of FastCGI workers and connections */
+#define MA_FASTCGI_CHECK_PERIOD 1000            /**< Period to check for and restart exited FastCGI workers */
+#define MA_FASTCGI_BACKLOG      64              /**< Listen backlog for spawned FastCGI workers */
+#define MA_PROXY_CONNECTIONS    16              /**< Default max keep-alive connections per proxy upstream */
+#define MA_PROXY_MAX_FAILURES   3               /**< Consecutive failures before a proxy upstream is marked down */
+#define MA_PROXY_RETRY_PERIOD   30000           /**< Time a failed proxy upstream is left out of rotation */
 #define MA_MAX_ACCESS_LOG       (20971520)      /**< Access file size (20 MB) */
 #define MA_SERVER_TIMEOUT       (300 * 1000)
 #define MA_MAX_CONFIG_DEPTH     (16)            /* Max nest of directives in config file */
 #define MA_RANGE_BUFSIZE        (128)           /* Size of a range boundary */
+#define MA_CHUNK_FLUSH_PERIOD   (20)            /* Max msec to hold partial chunks while coalescing */
 #define MA_MAX_REWRITE          (10)            /* Maximum recursive URI rewrites */
 
 /*
@@ -144,6 +158,7 @@
  *  These constants are to sanity check user input in the http.conf
  */
 #define MA_TOP_THREADS          100
+#define MA_TOP_HANDSHAKE_QUEUE  (64 * 1024)
 
 #define MA_BOT_BODY             512
 #define MA_TOP_BODY             (0x7fffffff)        /* 2 GB */
@@ -106,6 +106,8 @@
 
 #if LINUX && !__UCLIBC__
     #include    <sys/sendfile.h>
+    #include    <sys/syscall.h>
+    #include    <spawn.h>
 #endif
 
 #if CYGWIN || LINUX
@@ -2926,7 +2928,7 @@ typedef struct MprFileInfo {
  *      mprGetParentDir mprMakeDir mprMakeDirPath mprMakeTempFileName mprGetRelFilename mprCleanFilename
  *      mprGetAbsFilename mprGetFileNewline mprGetFileDelimiter mprGetUnixFilename mprGetWinFilename 
  *      mprMapDelimiters MprFileInfo mprAccess mprCompareFilename mprCopyFile mprDisableFileBuffering
- *      mprEnableFileBuffering mprGetDirList
+ *      mprEnableFileBuffering mprGetDirList mprPreallocFile mprSyncFile mprTruncateFile
  *
  *  @defgroup MprFile MprFile
  */
@@ -3258,6 +3260,20 @@ extern long mprSeek(MprFile *file, int seekType, long distance);
  */
 extern int mprWrite(MprFile *file, cvoid *buf, uint count);
 
+/**
+ *  Move data from a pipe to a file
+ *  @description Move data from a pipe directly to a file without copying it through user space. This is only
+ *      supported on Linux. The file must not be buffered. The pipe is read without blocking.
+ *  @param file Pointer to an MprFile object returned via MprOpen.
+ *  @param fd Pipe file descriptor to read from
+ *  @param bytes Maximum number of bytes to move
+ *  @return A count of bytes actually moved. Returns zero if the pipe writer has closed and no data remains. 
+ *      Returns -1 on errors with errno set. Errno is set to EAGAIN if the pipe is empty and to EINVAL if splicing
+ *      is not supported.
+ *  @ingroup MprFile
+ */
+extern int mprSpliceToFile(MprFile *file, int fd, int bytes);
+
 /**
  *  Flush any buffered write data
  *  @description Write buffered write data and then reset the internal buffers.
@@ -3267,6 +3283,43 @@ extern int mprWrite(MprFile *file, cvoid *buf, uint count);
  */
 extern int mprFlush(MprFile *file);
 
+/**
+ *  Preallocate file storage
+ *  @description Reserve disk blocks for a file that will be written up to the given size. This permits the file
+ *      system to allocate contiguous storage. The file size is not changed. Call #mprTruncateFile to release any
+ *      unused reservation once the file is complete.
+ *  @param file Pointer to an MprFile object returned via MprOpen.
+ *  @param size Number of bytes to reserve from the start of the file.
+ *  @return Zero if successful. Returns MPR_ERR_BAD_STATE if preallocation is not supported on this platform.
+ *  @ingroup MprFile
+ */
+extern int mprPreallocFile(MprFile *file, MprOffset size);
+
+/**
+ *  Synchronize file data with the storage device
+ *  @description Write file data to the storage device. If \a length is zero, all buffered and cached data for the 
+ *      file is written and the call blocks until complete. Otherwise, write back of the given byte range is started.
+ *      If \a wait is true, the call blocks until the range has been written.
+ *  @param file Pointer to an MprFile object returned via MprOpen.
+ *  @param offset Starting byte offset of the range to write.
+ *  @param length Length of the range. Set to zero to synchronize the entire file.
+ *  @param wait Set to true to wait for the range to be written.
+ *  @return Zero if successful, otherwise a negative MPR error code.
+ *  @ingroup MprFile
+ */
+extern int mprSyncFile(MprFile *file, MprOffset offset, MprOffset length, bool wait);
+
+/**
+ *  Truncate a file
+ *  @description Set the length of a file. Any buffered write data is flushed first. Storage reserved beyond the
+ *      new length via #mprPreallocFile is released.
+ *  @param file Pointer to an MprFile object returned via MprOpen.
+ *  @param size New file size.
+ *  @return Zero if successful, otherwise a negative MPR error code.
+ *  @ingroup MprFile
+ */
+extern int mprTruncateFile(MprFile *file, MprOffset size);
+
 /**
  *  Compare two filenames
  *  @description Compare two filenames to see if they are equal. This does not convert filenames to absolute form first,
@@ -4868,6 +4921,7 @@ typedef struct MprSocketProvider {
     int             (*connectSocket)(struct MprSocket *socket, cchar *host, int port, int flags);
     struct MprSocket *(*createSocket)(MprCtx ctx, struct MprSsl *ssl);
     int             (*flushSocket)(struct MprSocket *socket);
+    int             (*handshakeSocket)(struct MprSocket *socket);
     int             (*listenSocket)(struct MprSocket *socket, cchar *host, int port, MprSocketAcceptProc acceptFn, 
                         void *data, int flags);
     int             (*readSocket)(struct MprSocket *socket, void *buf, int len);
@@ -4881,6 +4935,7 @@ typedef struct MprSocketProvider {
 typedef struct MprSocketService {
     int             maxClients;
     int             numClients;
+    int             numOffloaded;       /* Total secure sockets offloaded to kernel TLS */
 
     MprSocketProvider *standardProvider;
     MprSocketProvider *secureProvider;
@@ -4897,6 +4952,7 @@ extern void mprStopSocketService(MprSocketService *ss);
 extern int  mprSetMaxSocketClients(MprCtx ctx, int max);
 extern void mprSetSecureProvider(MprCtx ctx, MprSocketProvider *provider);
 extern bool mprHasSecureSockets(MprCtx ctx);
+extern int  mprGetOffloadedSockets(MprCtx ctx);
 
 /*
  *  Socket close flags
@@ -4924,6 +4980,7 @@ extern bool mprHasSecureSockets(MprCtx ctx);
 #define MPR_SOCKET_NODELAY      0x100       /**< Disable Nagle algorithm */
 #define MPR_SOCKET_THREAD       0x400       /**< Process callbacks on a pool thread */
 #define MPR_SOCKET_CLIENT       0x800       /**< Socket is a client */
+#define MPR_SOCKET_OFFLOAD      0x1000      /**< Secure socket encryption is offloaded to the kernel (kTLS) */
 
 
 /**
@@ -4939,8 +4996,8 @@ extern bool mprHasSecureSockets(MprCtx ctx);
  *  @see MprSocket, mprCreateSocket, mprOpenClientSocket, mprOpenServerSocket, mprCloseSocket, mprFree, mprFlushSocket,
  *      mprWriteSocket, mprWriteSocketString, mprReadSocket, mprSetSocketCallback, mprSetSocketEventMask, 
  *      mprGetSocketBlockingMode, mprGetSocketEof, mprGetSocketFd, mprGetSocketPort, mprGetSocketBlockingMode, 
- *      mprSetSocketNoDelay, mprGetSocketError, mprParseIp, mprSendFileToSocket, mprSetSocketEof, mprSocketIsSecure
- *      mprWriteSocketVector
+ *      mprSetSocketNoDelay, mprGetSocketError, mprParseIp, mprSendFileToSocket, mprSetSocketEof, mprSocketIsSecure,
+ *      mprSocketIsOffloaded, mprSpliceFromSocket, mprSpliceToSocket, mprWriteSocketVector
  *  @defgroup MprSocket MprSocket
  */
 typedef struct MprSocket {
@@ -5061,6 +5118,18 @@ extern void mprCloseSocket(MprSocket *sp, bool graceful);
  */
 extern int mprFlushSocket(MprSocket *sp);
 
+/**
+ *  Perform a secure socket handshake
+ *  @description Advance the SSL handshake on a newly accepted secure socket without reading any application data.
+ *      This permits the handshake to be run on a different thread to the one that will service the connection.
+ *      Standard sockets and providers that do not support explicit handshakes return zero immediately.
+ *  @param sp Socket object returned from #mprCreateSocket
+ *  @return Zero if the handshake is complete. Otherwise the I/O event mask (MPR_READABLE or MPR_WRITEABLE) required
+ *      before the handshake can progress, or a negative MPR error code on errors.
+ *  @ingroup MprSocket
+ */
+extern int mprHandshakeSocket(MprSocket *sp);
+
 
 /**
  *  Write to a socket
@@ -5210,6 +5279,36 @@ extern int mprGetSocketError(MprSocket *sp);
 extern MprOffset mprSendFileToSocket(MprFile *file, MprSocket *sock, MprOffset offset, int bytes, MprIOVec *beforeVec, 
     int beforeCount, MprIOVec *afterVec, int afterCount);
 
+/**
+ *  Move data from a pipe to a socket
+ *  @description Move data from a pipe directly to a socket without copying it through user space. This is only
+ *      supported on Linux and for sockets that are not secure or have their encryption offloaded to the kernel. 
+ *      The transfer does not block and may move less than the requested bytes.
+ *  @param sock Socket object returned from #mprCreateSocket
+ *  @param fd Pipe file descriptor to read from
+ *  @param bytes Maximum number of bytes to move
+ *  @return A count of bytes actually moved. Returns zero if the pipe writer has closed and no data remains. 
+ *      Returns -1 on errors with errno set. Errno is set to EAGAIN if the pipe is empty or the socket is full, and
+ *      to EINVAL if splicing is not supported.
+ *  @ingroup MprSocket
+ */
+extern int mprSpliceToSocket(MprSocket *sock, int fd, int bytes);
+
+/**
+ *  Move data from a socket to a pipe
+ *  @description Move data from a socket directly to a pipe without copying it through user space. This is only
+ *      supported on Linux and for sockets that are not secure. The transfer does not block and may move less than
+ *      the requested bytes.
+ *  @param sock Socket object returned from #mprCreateSocket
+ *  @param fd Pipe file descriptor to write to
+ *  @param bytes Maximum number of bytes to move
+ *  @return A count of bytes actually moved. Returns zero if the peer has closed the connection. Returns -1 on errors
+ *      with errno set. Errno is set to EAGAIN if the socket has no data or the pipe is full, and to EINVAL if 
+ *      splicing is not supported.
+ *  @ingroup MprSocket
+ */
+extern int mprSpliceFromSocket(MprSocket *sock, int fd, int bytes);
+
 extern void mprSetSocketEof(MprSocket *sp, bool eof);
 
 /**
@@ -5221,6 +5320,16 @@ extern void mprSetSocketEof(MprSocket *sp, bool eof);
  */
 extern bool mprSocketIsSecure(MprSocket *sp);
 
+/**
+ *  Determine if the socket encryption is offloaded to the kernel
+ *  @description Determine if a secure socket has had its TLS record encryption offloaded to the kernel (kTLS).
+ *      Offloaded sockets can be written directly, including via sendfile, and the kernel will encrypt the data.
+ *  @param sp Socket object returned from #mprCreateSocket
+ *  @return True if the socket is secure and its encryption is offloaded to the kernel, otherwise zero.
+ *  @ingroup MprSocket
+ */
+extern bool mprSocketIsOffloaded(MprSocket *sp);
+
 /**
  *  Write a vector to a socket
  *  @description Do scatter/gather I/O by writing a vector of buffers to a socket.
@@ -6106,6 +6215,7 @@ typedef void    (*MprCmdProc)(struct MprCmd *cmd, int fd, int channel, void *dat
 #define MPR_CMD_NEW_SESSION     0x1     /* Create a new session on unix */
 #define MPR_CMD_SHOW            0x2     /* Show the window of the created process on windows */
 #define MPR_CMD_DETACHED        0x4     /* Detach the child process and don't wait */
+#define MPR_CMD_SPAWN           0x8     /* Start the process via posix_spawn where supported */
 #define MPR_CMD_IN              0x1000  /* Connect to stdin */
 #define MPR_CMD_OUT             0x2000  /* Capture stdout */
 #define MPR_CMD_ERR             0x4000  /* Capture stdout */
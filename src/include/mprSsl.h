@@ -45,6 +45,22 @@ extern "C" {
 #define MPR_DEFAULT_CLIENT_CERT_FILE    "client.crt"
 #define MPR_DEFAULT_CLIENT_CERT_PATH    "certs"
 
+/*
+ *  Session resumption defaults
+ */
+#define MPR_SSL_SESSION_CACHE_SIZE      512         /* Max sessions in the server-side session cache */
+#define MPR_SSL_SESSION_TIMEOUT         300         /* Session and ticket key lifespan in seconds */
+#define MPR_SSL_CACHE_SHARDS            16          /* Session cache shards, each with its own lock */
+
+/*
+ *  Dynamic record sizing defaults. New and idle connections start with records that fit in one TCP segment so the
+ *  client can decrypt the first bytes as soon as they arrive. After writing the ramp-up bytes, full records are used.
+ */
+#define MPR_SSL_SMALL_RECORD            1400        /* Initial record payload. Fits one segment on a 1500 byte MTU */
+#define MPR_SSL_RECORD_RAMP             (1024 * 1024) /* Bytes to write before using maximum size records */
+#define MPR_SSL_RECORD_IDLE             1000        /* Idle msec after which to restart with small records */
+#define MPR_SSL_MAX_RECORD              16384       /* Maximum TLS record payload */
+
 typedef struct MprSsl {
     /*
      *  Server key and certificate configuration
@@ -64,6 +80,34 @@ typedef struct MprSsl {
     int             protocols;
     bool            initialized;
     bool            connTraced;
+    bool            offload;            /* Offload record encryption to the kernel (kTLS) where supported */
+
+    /*
+     *  Session resumption configuration
+     */
+    int             sessionCacheSize;   /* Max sessions in the session cache. Zero disables the cache */
+    int             sessionTimeout;     /* Session and ticket key lifespan in seconds */
+    bool            sessionTickets;     /* Issue stateless session tickets */
+    struct MprSslCache *cache;          /* Sharded server-side session cache */
+    struct MprSslTicketKeys *ticketKeys; /* Session ticket keys. Rotated every sessionTimeout */
+
+    /*
+     *  Dynamic record sizing
+     */
+    int             smallRecordSize;    /* Initial record payload size. Zero disables dynamic record sizing */
+    int             recordRampUp;       /* Bytes written with small records before using maximum size records */
+
+    /*
+     *  Handshake statistics
+     */
+    int             sessionHits;        /* Session cache lookups that found a session */
+    int             sessionMisses;      /* Session cache lookups that failed */
+    int             fullHandshakes;     /* Handshakes requiring a full key exchange */
+    int             resumedHandshakes;  /* Abbreviated handshakes resuming a cached or ticketed session */
+
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
 
     /*
      *  Per-SSL provider context information
@@ -89,6 +133,10 @@ typedef struct MprSslSocket
 #if BLD_FEATURE_OPENSSL
     SSL             *osslStruct;
     BIO             *bio;
+    bool            established;        /* Handshake complete and offload state determined */
+    int             rampBytes;          /* Bytes written since the connection was new or idle */
+    MprTime         lastWrite;          /* Time of the last write */
+    int             pendingWrite;       /* Length of a record write that must be retried */
 #endif
 #if BLD_FEATURE_MATRIXSSL
     ssl_t           *mssl;
@@ -99,6 +147,16 @@ typedef struct MprSslSocket
 #endif
 } MprSslSocket;
 
+/*
+ *  SSL handshake statistics. See mprGetSslStats.
+ */
+typedef struct MprSslStats {
+    int             sessionHits;        /* Session cache lookups that found a session */
+    int             sessionMisses;      /* Session cache lookups that failed */
+    int             fullHandshakes;     /* Handshakes requiring a full key exchange */
+    int             resumedHandshakes;  /* Abbreviated handshakes resuming a cached or ticketed session */
+} MprSslStats;
+
 
 extern MprModule *mprSslInit(MprCtx ctx, cchar *path);
 extern MprSsl *mprCreateSsl(MprCtx ctx);
@@ -109,6 +167,12 @@ extern void mprSetSslCaFile(MprSsl *ssl, cchar *caFile);
 extern void mprSetSslCaPath(MprSsl *ssl, cchar *caPath);
 extern void mprSetSslProtocols(MprSsl *ssl, int protocols);
 extern void mprVerifySslClients(MprSsl *ssl, bool on);
+extern void mprSetSslOffload(MprSsl *ssl, bool on);
+extern void mprSetSslSessionCache(MprSsl *ssl, int size);
+extern void mprSetSslSessionTimeout(MprSsl *ssl, int timeout);
+extern void mprSetSslSessionTickets(MprSsl *ssl, bool on);
+extern void mprSetSslRecordSizing(MprSsl *ssl, int smallRecordSize, int rampUp);
+extern void mprGetSslStats(MprSsl *ssl, MprSslStats *stats);
 
 #if BLD_FEATURE_OPENSSL
 extern int mprCreateOpenSslModule(MprCtx ctx, bool lazy);
@@ -13,6 +13,15 @@
  *  as individual files if you need.
  */
 
+/*
+ *  Flags for the splice system call used by the file and socket modules. The splice() prototype and flags are only
+ *  visible with _GNU_SOURCE, so the system call is invoked directly.
+ */
+#if LINUX && defined(SYS_splice)
+    #define MPR_SPLICE_MOVE         0x1
+    #define MPR_SPLICE_NONBLOCK     0x2
+#endif
+
 
 /************************************************************************/
 /*
@@ -4555,6 +4564,66 @@ static int makePipe(MprCmd *cmd, int index)
 
 
 #elif BLD_UNIX_LIKE
+#if LINUX && !__UCLIBC__ && defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 34)
+#define MPR_HAS_SPAWN 1
+/*
+ *  These are only declared if _GNU_SOURCE is defined
+ */
+extern int posix_spawn_file_actions_addchdir_np(posix_spawn_file_actions_t *actions, const char *path);
+extern int posix_spawn_file_actions_addclosefrom_np(posix_spawn_file_actions_t *actions, int from);
+extern char **environ;
+
+/*
+ *  Start the process via posix_spawn. This avoids running any code in the child before the exec. Unlike the vfork 
+ *  path, the child inherits the umask and all descriptors above stderr are closed.
+ */
+static int spawnProcess(MprCmd *cmd)
+{
+    posix_spawn_file_actions_t  actions;
+    MprCmdFile                  *files;
+    pid_t                       pid;
+    int                         i, rc, flags[MPR_CMD_MAX_PIPE];
+
+    files = cmd->files;
+    flags[MPR_CMD_STDIN] = MPR_CMD_IN;
+    flags[MPR_CMD_STDOUT] = MPR_CMD_OUT;
+    flags[MPR_CMD_STDERR] = MPR_CMD_ERR;
+
+    posix_spawn_file_actions_init(&actions);
+    if (cmd->dir) {
+        posix_spawn_file_actions_addchdir_np(&actions, cmd->dir);
+    }
+    for (i = 0; i < MPR_CMD_MAX_PIPE; i++) {
+        if (cmd->flags & flags[i]) {
+            if (files[i].clientFd >= 0) {
+                posix_spawn_file_actions_adddup2(&actions, files[i].clientFd, i);
+            } else {
+                posix_spawn_file_actions_addclose(&actions, i);
+            }
+        }
+    }
+    posix_spawn_file_actions_addclosefrom_np(&actions, 3);
+
+    rc = posix_spawn(&pid, cmd->program, &actions, NULL, cmd->argv, cmd->env ? cmd->env : environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (rc != 0) {
+        mprLog(cmd, 0, "cmd: Can't spawn a new process to run %s, err %d", cmd->program, rc);
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+    cmd->process = pid;
+
+    for (i = 0; i < MPR_CMD_MAX_PIPE; i++) {
+        if (files[i].clientFd >= 0) {
+            close(files[i].clientFd);
+            files[i].clientFd = -1;
+        }
+    }
+    return 0;
+}
+#endif
+
+
 static int startProcess(MprCmd *cmd)
 {
     MprCmdFile      *files;
@@ -4563,6 +4632,12 @@ static int startProcess(MprCmd *cmd)
 
     files = cmd->files;
 
+#if MPR_HAS_SPAWN
+    if (cmd->flags & MPR_CMD_SPAWN && !(cmd->flags & MPR_CMD_NEW_SESSION)) {
+        return spawnProcess(cmd);
+    }
+#endif
+
     /*
      *  Create the child
      */
@@ -6186,18 +6261,23 @@ static void queueEvent(MprEventService *es, MprEvent *event)
          */
         q = &es->timerQ;
 
-        if (event->due > es->lastEventDue) {
-            np = q->prev;
+        /*
+         *  Keep the timer queue sorted by due time as mprGetNextEvent stops at the first event not yet due. 
+         *  Find the last event due no later than this event and insert after it. Note: appendEvent inserts before np.
+         */
+        if (event->due >= es->lastEventDue) {
+            np = q;
 
         } else {
             for (np = q->prev; np != q; np = np->prev) {
-                if (event->due <= np->due) {
-                    break;
-                }
-                if (event->priority >= np->priority) {
+                if (event->due >= np->due) {
                     break;
                 }
             }
+            np = np->next;
+        }
+        if (np == q) {
+            es->lastEventDue = event->due;
         }
     } else {
         q = &es->eventQ;
@@ -6663,6 +6743,32 @@ int mprWrite(MprFile *file, const void *buf, uint count)
 }
 
 
+/*
+ *  Move data from a pipe to a file in the kernel. The pipe is read without blocking. The file must not be buffered.
+ */
+int mprSpliceToFile(MprFile *file, int fd, int bytes)
+{
+#if LINUX && defined(SYS_splice) && !BLD_FEATURE_ROMFS
+    int     written;
+
+    mprAssert(file);
+    mprAssert(file->buf == 0);
+
+    written = (int) syscall(SYS_splice, fd, NULL, file->fd, NULL, (size_t) bytes, MPR_SPLICE_MOVE | MPR_SPLICE_NONBLOCK);
+    if (written > 0) {
+        file->pos += written;
+        if (file->pos > file->size) {
+            file->size = file->pos;
+        }
+    }
+    return written;
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+
 int mprFlush(MprFile *file)
 {
     MprFileService  *fs;
@@ -6697,6 +6803,98 @@ int mprFlush(MprFile *file)
 }
 
 
+/*
+ *  Reserve storage for a file without changing its size. Uses the raw system call so the Linux fallocate extensions
+ *  are available without _GNU_SOURCE. Only used on 64-bit systems where the offsets are passed in single registers.
+ */
+int mprPreallocFile(MprFile *file, MprOffset size)
+{
+#if LINUX && defined(SYS_fallocate) && __LP64__ && !BLD_FEATURE_ROMFS
+    #define MPR_FALLOC_KEEP_SIZE    0x1
+
+    if (file == 0 || file->fd < 0) {
+        return MPR_ERR_BAD_HANDLE;
+    }
+    if (syscall(SYS_fallocate, file->fd, MPR_FALLOC_KEEP_SIZE, (MprOffset) 0, size) < 0) {
+        return MPR_ERR_CANT_ALLOCATE;
+    }
+    return 0;
+#else
+    return MPR_ERR_BAD_STATE;
+#endif
+}
+
+
+/*
+ *  Write file data to the storage device. A zero length synchronizes the entire file. Otherwise start (and optionally
+ *  wait for) write back of a range. Platforms without range support fall back to synchronizing the file when waiting.
+ */
+int mprSyncFile(MprFile *file, MprOffset offset, MprOffset length, bool wait)
+{
+#if !BLD_FEATURE_ROMFS && (BLD_UNIX_LIKE || WIN)
+#if LINUX && defined(SYS_sync_file_range) && __LP64__
+    #define MPR_SYNC_WAIT_BEFORE    0x1
+    #define MPR_SYNC_WRITE          0x2
+    #define MPR_SYNC_WAIT_AFTER     0x4
+    int     flags;
+#endif
+
+    if (file == 0 || file->fd < 0) {
+        return MPR_ERR_BAD_HANDLE;
+    }
+    if (mprFlush(file) < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+    if (length > 0) {
+#if LINUX && defined(SYS_sync_file_range) && __LP64__
+        flags = MPR_SYNC_WRITE;
+        if (wait) {
+            flags |= MPR_SYNC_WAIT_BEFORE | MPR_SYNC_WAIT_AFTER;
+        }
+        return (syscall(SYS_sync_file_range, file->fd, offset, length, flags) < 0) ? MPR_ERR_CANT_WRITE : 0;
+#else
+        if (!wait) {
+            return 0;
+        }
+#endif
+    }
+#if WIN
+    return (_commit(file->fd) < 0) ? MPR_ERR_CANT_WRITE : 0;
+#elif LINUX
+    return (fdatasync(file->fd) < 0) ? MPR_ERR_CANT_WRITE : 0;
+#else
+    return (fsync(file->fd) < 0) ? MPR_ERR_CANT_WRITE : 0;
+#endif
+#else
+    return MPR_ERR_BAD_STATE;
+#endif
+}
+
+
+int mprTruncateFile(MprFile *file, MprOffset size)
+{
+#if !BLD_FEATURE_ROMFS && (BLD_UNIX_LIKE || WIN)
+    if (file == 0 || file->fd < 0) {
+        return MPR_ERR_BAD_HANDLE;
+    }
+    if (mprFlush(file) < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+#if WIN
+    if (_chsize(file->fd, (long) size) < 0) {
+#else
+    if (ftruncate(file->fd, size) < 0) {
+#endif
+        return MPR_ERR_CANT_WRITE;
+    }
+    file->size = size;
+    return 0;
+#else
+    return MPR_ERR_BAD_STATE;
+#endif
+}
+
+
 long mprSeek(MprFile *file, int seekType, long pos)
 {
     MprFileService  *fs;
@@ -15282,6 +15480,7 @@ MprSocketService *mprCreateSocketService(MprCtx ctx)
     }
     ss->maxClients = INT_MAX;
     ss->numClients = 0;
+    ss->numOffloaded = 0;
 
     ss->standardProvider = createStandardProvider(ss);
     if (ss->standardProvider == NULL) {
@@ -15350,7 +15549,7 @@ static MprSocketProvider *createStandardProvider(MprSocketService *ss)
 {
     MprSocketProvider   *provider;
 
-    provider = mprAllocObj(ss, MprSocketProvider);
+    provider = mprAllocObjZeroed(ss, MprSocketProvider);
     if (provider == 0) {
         return 0;
     }
@@ -15381,6 +15580,22 @@ bool mprHasSecureSockets(MprCtx ctx)
 }
 
 
+/*
+ *  Return the number of secure sockets that have had record encryption offloaded to the kernel
+ */
+int mprGetOffloadedSockets(MprCtx ctx)
+{
+    MprSocketService    *ss;
+    int                 count;
+
+    ss = mprGetMpr(ctx)->socketService;
+    mprLock(ss->mutex);
+    count = ss->numOffloaded;
+    mprUnlock(ss->mutex);
+    return count;
+}
+
+
 int mprSetMaxSocketClients(MprCtx ctx, int max)
 {
     MprSocketService    *ss;
@@ -16075,7 +16290,10 @@ int mprWriteSocketVector(MprSocket *sp, MprIOVec *iovec, int count)
     int     total, len, i, written;
 
 #if BLD_UNIX_LIKE
-    if (sp->ssl == 0) {
+    /*
+     *  Offloaded secure sockets are encrypted by the kernel, so they can be written directly
+     */
+    if (sp->ssl == 0 || (sp->flags & MPR_SOCKET_OFFLOAD)) {
         return writev(sp->fd, (const struct iovec*) iovec, count);
     } else
 #endif
@@ -16131,7 +16349,8 @@ static MprOffset localSendfile(MprSocket *sp, MprFile *file, MprOffset off, int
 
 /*
  *  Write data from a file to a socket. Includes the ability to write header before and after the file data.
- *  Works even with a null "file" to just output the headers.
+ *  Works even with a null "file" to just output the headers. Secure sockets may only be used if their encryption
+ *  has been offloaded to the kernel.
  */
 MprOffset mprSendFileToSocket(MprFile *file, MprSocket *sock, MprOffset offset, int bytes, MprIOVec *beforeVec, 
     int beforeCount, MprIOVec *afterVec, int afterCount)
@@ -16142,6 +16361,7 @@ MprOffset mprSendFileToSocket(MprFile *file, MprSocket *sock, MprOffset offset,
     off_t           written, off;
     int             rc, i, done, toWriteBefore, toWriteAfter, toWriteFile;
 
+    mprAssert(sock->sslSocket == 0 || (sock->flags & MPR_SOCKET_OFFLOAD));
     rc = 0;
 
 #if MACOSX
@@ -16217,6 +16437,49 @@ MprOffset mprSendFileToSocket(MprFile *file, MprSocket *sock, MprOffset offset,
 }
 
 
+/*
+ *  Move data from a pipe to a socket in the kernel. Non-blocking regardless of the blocking mode of the pipe.
+ */
+int mprSpliceToSocket(MprSocket *sock, int fd, int bytes)
+{
+#if LINUX && defined(SYS_splice)
+    if (sock->sslSocket && !(sock->flags & MPR_SOCKET_OFFLOAD)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return (int) syscall(SYS_splice, fd, NULL, sock->fd, NULL, (size_t) bytes, MPR_SPLICE_MOVE | MPR_SPLICE_NONBLOCK);
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+
+/*
+ *  Move data from a socket to a pipe in the kernel. Non-blocking regardless of the blocking mode of the socket.
+ *  Secure sockets are never spliced as the data must be decrypted in user space.
+ */
+int mprSpliceFromSocket(MprSocket *sock, int fd, int bytes)
+{
+#if LINUX && defined(SYS_splice)
+    int     nbytes;
+
+    if (sock->sslSocket) {
+        errno = EINVAL;
+        return -1;
+    }
+    nbytes = (int) syscall(SYS_splice, sock->fd, NULL, fd, NULL, (size_t) bytes, MPR_SPLICE_MOVE | MPR_SPLICE_NONBLOCK);
+    if (nbytes == 0) {
+        sock->flags |= MPR_SOCKET_EOF;
+    }
+    return nbytes;
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+
 static int flushSocket(MprSocket *sp)
 {
     return 0;
@@ -16229,6 +16492,15 @@ int mprFlushSocket(MprSocket *sp)
 }
 
 
+int mprHandshakeSocket(MprSocket *sp)
+{
+    if (sp->provider->handshakeSocket == 0) {
+        return 0;
+    }
+    return sp->provider->handshakeSocket(sp);
+}
+
+
 /*
  *  Return true if end of file
  */
@@ -16861,6 +17133,12 @@ bool mprSocketIsSecure(MprSocket *sp)
 }
 
 
+bool mprSocketIsOffloaded(MprSocket *sp)
+{
+    return sp->sslSocket != 0 && (sp->flags & MPR_SOCKET_OFFLOAD);
+}
+
+
 /*
  *  @copy   default
  *
@@ -4868,6 +4868,7 @@ typedef struct MprSocketProvider {
     int             (*connectSocket)(struct MprSocket *socket, cchar *host, int port, int flags);
     struct MprSocket *(*createSocket)(MprCtx ctx, struct MprSsl *ssl);
     int             (*flushSocket)(struct MprSocket *socket);
+    int             (*handshakeSocket)(struct MprSocket *socket);
     int             (*listenSocket)(struct MprSocket *socket, cchar *host, int port, MprSocketAcceptProc acceptFn, 
                         void *data, int flags);
     int             (*readSocket)(struct MprSocket *socket, void *buf, int len);
@@ -4881,6 +4882,7 @@ typedef struct MprSocketProvider {
 typedef struct MprSocketService {
     int             maxClients;
     int             numClients;
+    int             numOffloaded;       /* Total secure sockets offloaded to kernel TLS */
 
     MprSocketProvider *standardProvider;
     MprSocketProvider *secureProvider;
@@ -4897,6 +4899,7 @@ extern void mprStopSocketService(MprSocketService *ss);
 extern int  mprSetMaxSocketClients(MprCtx ctx, int max);
 extern void mprSetSecureProvider(MprCtx ctx, MprSocketProvider *provider);
 extern bool mprHasSecureSockets(MprCtx ctx);
+extern int  mprGetOffloadedSockets(MprCtx ctx);
 
 /*
  *  Socket close flags
@@ -4924,6 +4927,7 @@ extern bool mprHasSecureSockets(MprCtx ctx);
 #define MPR_SOCKET_NODELAY      0x100       /**< Disable Nagle algorithm */
 #define MPR_SOCKET_THREAD       0x400       /**< Process callbacks on a pool thread */
 #define MPR_SOCKET_CLIENT       0x800       /**< Socket is a client */
+#define MPR_SOCKET_OFFLOAD      0x1000      /**< Secure socket encryption is offloaded to the kernel (kTLS) */
 
 
 /**
@@ -4939,8 +4943,8 @@ extern bool mprHasSecureSockets(MprCtx ctx);
  *  @see MprSocket, mprCreateSocket, mprOpenClientSocket, mprOpenServerSocket, mprCloseSocket, mprFree, mprFlushSocket,
  *      mprWriteSocket, mprWriteSocketString, mprReadSocket, mprSetSocketCallback, mprSetSocketEventMask, 
  *      mprGetSocketBlockingMode, mprGetSocketEof, mprGetSocketFd, mprGetSocketPort, mprGetSocketBlockingMode, 
- *      mprSetSocketNoDelay, mprGetSocketError, mprParseIp, mprSendFileToSocket, mprSetSocketEof, mprSocketIsSecure
- *      mprWriteSocketVector
+ *      mprSetSocketNoDelay, mprGetSocketError, mprParseIp, mprSendFileToSocket, mprSetSocketEof, mprSocketIsSecure,
+ *      mprSocketIsOffloaded, mprWriteSocketVector
  *  @defgroup MprSocket MprSocket
  */
 typedef struct MprSocket {
@@ -5061,6 +5065,18 @@ extern void mprCloseSocket(MprSocket *sp, bool graceful);
  */
 extern int mprFlushSocket(MprSocket *sp);
 
+/**
+ *  Perform a secure socket handshake
+ *  @description Advance the SSL handshake on a newly accepted secure socket without reading any application data.
+ *      This permits the handshake to be run on a different thread to the one that will service the connection.
+ *      Standard sockets and providers that do not support explicit handshakes return zero immediately.
+ *  @param sp Socket object returned from #mprCreateSocket
+ *  @return Zero if the handshake is complete. Otherwise the I/O event mask (MPR_READABLE or MPR_WRITEABLE) required
+ *      before the handshake can progress, or a negative MPR error code on errors.
+ *  @ingroup MprSocket
+ */
+extern int mprHandshakeSocket(MprSocket *sp);
+
 
 /**
  *  Write to a socket
@@ -5221,6 +5237,16 @@ extern void mprSetSocketEof(MprSocket *sp, bool eof);
  */
 extern bool mprSocketIsSecure(MprSocket *sp);
 
+/**
+ *  Determine if the socket encryption is offloaded to the kernel
+ *  @description Determine if a secure socket has had its TLS record encryption offloaded to the kernel (kTLS).
+ *      Offloaded sockets can be written directly, including via sendfile, and the kernel will encrypt the data.
+ *  @param sp Socket object returned from #mprCreateSocket
+ *  @return True if the socket is secure and its encryption is offloaded to the kernel, otherwise zero.
+ *  @ingroup MprSocket
+ */
+extern bool mprSocketIsOffloaded(MprSocket *sp);
+
 /**
  *  Write a vector to a socket
  *  @description Do scatter/gather I/O by writing a vector of buffers to a socket.
@@ -7309,6 +7335,22 @@ extern "C" {
 #define MPR_DEFAULT_CLIENT_CERT_FILE    "client.crt"
 #define MPR_DEFAULT_CLIENT_CERT_PATH    "certs"
 
+/*
+ *  Session resumption defaults
+ */
+#define MPR_SSL_SESSION_CACHE_SIZE      512         /* Max sessions in the server-side session cache */
+#define MPR_SSL_SESSION_TIMEOUT         300         /* Session and ticket key lifespan in seconds */
+#define MPR_SSL_CACHE_SHARDS            16          /* Session cache shards, each with its own lock */
+
+/*
+ *  Dynamic record sizing defaults. New and idle connections start with records that fit in one TCP segment so the
+ *  client can decrypt the first bytes as soon as they arrive. After writing the ramp-up bytes, full records are used.
+ */
+#define MPR_SSL_SMALL_RECORD            1400        /* Initial record payload. Fits one segment on a 1500 byte MTU */
+#define MPR_SSL_RECORD_RAMP             (1024 * 1024) /* Bytes to write before using maximum size records */
+#define MPR_SSL_RECORD_IDLE             1000        /* Idle msec after which to restart with small records */
+#define MPR_SSL_MAX_RECORD              16384       /* Maximum TLS record payload */
+
 typedef struct MprSsl {
     /*
      *  Server key and certificate configuration
@@ -7328,6 +7370,34 @@ typedef struct MprSsl {
     int             protocols;
     bool            initialized;
     bool            connTraced;
+    bool            offload;            /* Offload record encryption to the kernel (kTLS) where supported */
+
+    /*
+     *  Session resumption configuration
+     */
+    int             sessionCacheSize;   /* Max sessions in the session cache. Zero disables the cache */
+    int             sessionTimeout;     /* Session and ticket key lifespan in seconds */
+    bool            sessionTickets;     /* Issue stateless session tickets */
+    struct MprSslCache *cache;          /* Sharded server-side session cache */
+    struct MprSslTicketKeys *ticketKeys; /* Session ticket keys. Rotated every sessionTimeout */
+
+    /*
+     *  Dynamic record sizing
+     */
+    int             smallRecordSize;    /* Initial record payload size. Zero disables dynamic record sizing */
+    int             recordRampUp;       /* Bytes written with small records before using maximum size records */
+
+    /*
+     *  Handshake statistics
+     */
+    int             sessionHits;        /* Session cache lookups that found a session */
+    int             sessionMisses;      /* Session cache lookups that failed */
+    int             fullHandshakes;     /* Handshakes requiring a full key exchange */
+    int             resumedHandshakes;  /* Abbreviated handshakes resuming a cached or ticketed session */
+
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
 
     /*
      *  Per-SSL provider context information
@@ -7353,6 +7423,10 @@ typedef struct MprSslSocket
 #if BLD_FEATURE_OPENSSL
     SSL             *osslStruct;
     BIO             *bio;
+    bool            established;        /* Handshake complete and offload state determined */
+    int             rampBytes;          /* Bytes written since the connection was new or idle */
+    MprTime         lastWrite;          /* Time of the last write */
+    int             pendingWrite;       /* Length of a record write that must be retried */
 #endif
 #if BLD_FEATURE_MATRIXSSL
     ssl_t           *mssl;
@@ -7363,6 +7437,16 @@ typedef struct MprSslSocket
 #endif
 } MprSslSocket;
 
+/*
+ *  SSL handshake statistics. See mprGetSslStats.
+ */
+typedef struct MprSslStats {
+    int             sessionHits;        /* Session cache lookups that found a session */
+    int             sessionMisses;      /* Session cache lookups that failed */
+    int             fullHandshakes;     /* Handshakes requiring a full key exchange */
+    int             resumedHandshakes;  /* Abbreviated handshakes resuming a cached or ticketed session */
+} MprSslStats;
+
 
 extern MprModule *mprSslInit(MprCtx ctx, cchar *path);
 extern MprSsl *mprCreateSsl(MprCtx ctx);
@@ -7373,6 +7457,12 @@ extern void mprSetSslCaFile(MprSsl *ssl, cchar *caFile);
 extern void mprSetSslCaPath(MprSsl *ssl, cchar *caPath);
 extern void mprSetSslProtocols(MprSsl *ssl, int protocols);
 extern void mprVerifySslClients(MprSsl *ssl, bool on);
+extern void mprSetSslOffload(MprSsl *ssl, bool on);
+extern void mprSetSslSessionCache(MprSsl *ssl, int size);
+extern void mprSetSslSessionTimeout(MprSsl *ssl, int timeout);
+extern void mprSetSslSessionTickets(MprSsl *ssl, bool on);
+extern void mprSetSslRecordSizing(MprSsl *ssl, int smallRecordSize, int rampUp);
+extern void mprGetSslStats(MprSsl *ssl, MprSslStats *stats);
 
 #if BLD_FEATURE_OPENSSL
 extern int mprCreateOpenSslModule(MprCtx ctx, bool lazy);
@@ -8351,6 +8441,7 @@ void mprMatrixSslModuleDummy() {}
 #if BLD_FEATURE_OPENSSL
 
 #include    <openssl/dh.h>
+#include    <openssl/hmac.h>
 
 /*
  *  OpenSSL requires this static code. Ugh!
@@ -8360,6 +8451,53 @@ typedef struct RandBuf {
     int         pid;
 } RandBuf;
 
+/*
+ *  Server-side session cache. Sessions are stored in DER form and sharded by session ID so concurrent handshakes
+ *  rarely contend for the same lock.
+ */
+typedef struct CacheEntry {
+    char            *key;               /* Session ID in hex */
+    uchar           *data;              /* DER encoded session */
+    int             len;                /* Length of data */
+    MprTime         expires;            /* When the session expires */
+} CacheEntry;
+
+typedef struct CacheShard {
+    MprHashTable    *sessions;          /* Sessions indexed by session ID */
+    MprList         *order;             /* Sessions in order of insertion, oldest first */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
+} CacheShard;
+
+typedef struct MprSslCache {
+    CacheShard      shards[MPR_SSL_CACHE_SHARDS];
+    int             maxPerShard;        /* Max sessions per shard */
+} MprSslCache;
+
+/*
+ *  Session ticket keys. Tickets are issued with the current key. Tickets using the previous key are still accepted
+ *  but are renewed with the current key.
+ */
+typedef struct TicketKey {
+    uchar           name[16];
+    uchar           aesKey[32];
+    uchar           hmacKey[32];
+    MprTime         created;
+} TicketKey;
+
+typedef struct MprSslTicketKeys {
+    TicketKey       current;
+    TicketKey       previous;
+    bool            hasPrevious;
+} MprSslTicketKeys;
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+typedef const uchar SessionId;
+#else
+typedef uchar SessionId;
+#endif
+
 #if BLD_FEATURE_MULTITHREAD
 static MprMutex **locks;
 static int      numLocks;
@@ -8374,13 +8512,16 @@ typedef struct CRYPTO_dynlock_value DynLock;
 static MprSocket *acceptOss(MprSocket *sp, bool invokeCallback);
 static void     closeOss(MprSocket *sp, bool gracefully);
 static MprSsl   *getDefaultOpenSsl(MprCtx ctx);
+static void     establishOss(MprSocket *sp, MprSslSocket *osp);
 static int      configureCertificates(MprSsl *ssl, SSL_CTX *ctx, char *key, char *cert);
+static int      configureSessions(MprSsl *ssl, SSL_CTX *context);
 static int      configureOss(MprSsl *ssl);
 static int      connectOss(MprSocket *sp, cchar *host, int port, int flags);
 static MprSocketProvider *createOpenSslProvider(MprCtx ctx);
 static MprSocket *createOss(MprCtx ctx, MprSsl *ssl);
 static DH       *dhCallback(SSL *ssl, int isExport, int keyLength);
 static int      flushOss(MprSocket *sp);
+static int      handshakeOss(MprSocket *sp);
 static int      listenOss(MprSocket *sp, cchar *host, int port, MprSocketAcceptProc acceptFn, void *data, int flags);
 static int      openSslDestructor(MprSsl *ssl);
 static int      openSslSocketDestructor(MprSslSocket *ssp);
@@ -8388,6 +8529,7 @@ static int      readOss(MprSocket *sp, void *buf, int len);
 static RSA      *rsaCallback(SSL *ssl, int isExport, int keyLength);
 static int      verifyX509Certificate(int ok, X509_STORE_CTX *ctx);
 static int      writeOss(MprSocket *sp, void *buf, int len);
+static int      getRecordSize(MprSocket *sp, MprSslSocket *osp, int len);
 
 #if BLD_FEATURE_MULTITHREAD
 static DynLock  *sslCreateDynLock(const char *file, int line);
@@ -8400,6 +8542,14 @@ static ulong    sslThreadId(void);
 static DH       *get_dh512();
 static DH       *get_dh1024();
 
+static SSL_SESSION *getSessionCallback(SSL *osslStruct, SessionId *id, int idLen, int *copy);
+static int      newSessionCallback(SSL *osslStruct, SSL_SESSION *session);
+static void     removeSessionCallback(SSL_CTX *context, SSL_SESSION *session);
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+static int      ticketKeyCallback(SSL *osslStruct, uchar *name, uchar *iv, EVP_CIPHER_CTX *cipherCtx, HMAC_CTX *hmacCtx, 
+                    int encrypt);
+#endif
+
 
 int mprCreateOpenSslModule(MprCtx ctx, bool lazy)
 {
@@ -8509,6 +8659,7 @@ static MprSocketProvider *createOpenSslProvider(MprCtx ctx)
     provider->connectSocket = connectOss;
     provider->createSocket = createOss;
     provider->flushSocket = flushOss;
+    provider->handshakeSocket = handshakeOss;
     provider->listenSocket = listenOss;
     provider->readSocket = readOss;
     provider->writeSocket = writeOss;
@@ -8538,7 +8689,11 @@ static int configureOss(MprSsl *ssl)
 
     SSL_CTX_set_app_data(context, (void*) ssl);
     SSL_CTX_set_quiet_shutdown(context, 1);
-    SSL_CTX_sess_set_cache_size(context, 512);
+
+    if (configureSessions(ssl, context) < 0) {
+        SSL_CTX_free(context);
+        return MPR_ERR_CANT_INITIALIZE;
+    }
 
     /*
      *  Configure the certificates
@@ -8610,7 +8765,18 @@ static int configureOss(MprSsl *ssl)
      *  Enable all buggy client work-arounds 
      */
     SSL_CTX_set_options(context, SSL_OP_ALL);
-    SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_AUTO_RETRY);
+    SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_AUTO_RETRY);
+
+#if LINUX && defined(SSL_OP_ENABLE_KTLS)
+    /*
+     *  Ask OpenSSL to hand record encryption to the kernel once the handshake completes. If the kernel or the 
+     *  negotiated cipher does not support kTLS, OpenSSL quietly continues to encrypt in user space.
+     */
+    if (ssl->offload) {
+        SSL_CTX_set_options(context, SSL_OP_ENABLE_KTLS);
+        mprLog(ssl, 4, "OpenSSL: Enabling kernel TLS offload");
+    }
+#endif
 
     /*
      *  Select the required protocols
@@ -8900,6 +9066,7 @@ static int connectOss(MprSocket *sp, cchar *host, int port, int flags)
 #endif
         return MPR_ERR_CANT_CONNECT;
     }
+    establishOss(sp, osp);
     
     mprSetSocketBlockingMode(sp, 0);
 
@@ -8907,6 +9074,74 @@ static int connectOss(MprSocket *sp, cchar *host, int port, int flags)
 }
 
 
+/*
+ *  Called once the handshake has completed. Determine if OpenSSL was able to offload record encryption to the kernel.
+ *  If so, mark the socket so callers may write directly to the socket handle, including via sendfile.
+ */
+static void establishOss(MprSocket *sp, MprSslSocket *osp)
+{
+    MprSsl      *ssl;
+
+    osp->established = 1;
+
+    ssl = osp->ssl;
+    mprLock(ssl->mutex);
+    if (SSL_session_reused(osp->osslStruct)) {
+        ssl->resumedHandshakes++;
+    } else {
+        ssl->fullHandshakes++;
+    }
+    mprUnlock(ssl->mutex);
+
+#if LINUX && defined(SSL_OP_ENABLE_KTLS)
+    if (BIO_get_ktls_send(SSL_get_wbio(osp->osslStruct))) {
+        sp->flags |= MPR_SOCKET_OFFLOAD;
+        mprLock(sp->service->mutex);
+        sp->service->numOffloaded++;
+        mprUnlock(sp->service->mutex);
+        mprLog(sp, 4, "OpenSSL: Kernel TLS offload enabled for %s:%d using %s", sp->clientIpAddr, sp->port,
+            SSL_get_cipher(osp->osslStruct));
+    } else {
+        mprLog(sp, 5, "OpenSSL: Kernel TLS offload not available for %s:%d using %s", sp->clientIpAddr, sp->port,
+            SSL_get_cipher(osp->osslStruct));
+    }
+#endif
+}
+
+
+/*
+ *  Advance the server-side handshake. Return zero when complete, otherwise the I/O event needed to continue.
+ */
+static int handshakeOss(MprSocket *sp)
+{
+    MprSslSocket    *osp;
+    int             rc, error;
+
+    osp = (MprSslSocket*) sp->sslSocket;
+    if (osp == 0 || osp->osslStruct == 0) {
+        return MPR_ERR_BAD_STATE;
+    }
+    if (osp->established) {
+        return 0;
+    }
+    ERR_clear_error();
+    rc = SSL_do_handshake(osp->osslStruct);
+    if (rc == 1) {
+        establishOss(sp, osp);
+        return 0;
+    }
+    error = SSL_get_error(osp->osslStruct, rc);
+    if (error == SSL_ERROR_WANT_READ) {
+        return MPR_READABLE;
+
+    } else if (error == SSL_ERROR_WANT_WRITE) {
+        return MPR_WRITEABLE;
+    }
+    mprLog(sp, 4, "OpenSSL: Handshake failed with %s:%d, error %d", sp->clientIpAddr, sp->port, error);
+    return MPR_ERR_CANT_INITIALIZE;
+}
+
+
 static int readOss(MprSocket *sp, void *buf, int len)
 {
     MprSslSocket    *osp;
@@ -8968,17 +9203,47 @@ static int readOss(MprSocket *sp, void *buf, int len)
         mprRecallWaitHandler(sp->handler);
     }
 
+    if (!osp->established && SSL_is_init_finished(osp->osslStruct)) {
+        establishOss(sp, osp);
+    }
     return rc;
 }
 
 
 /*
- *  Write data. Return the number of bytes written or -1 on errors.
+ *  Compute how much to write in the next record. SSL_write emits one record per call for writes up to the maximum 
+ *  record size. New connections, and connections that have been idle, use small records until recordRampUp bytes 
+ *  have been written. This lets the client decrypt and process the first bytes without waiting for a full 16K record.
+ */
+static int getRecordSize(MprSocket *sp, MprSslSocket *osp, int len)
+{
+    MprSsl      *ssl;
+    MprTime     now;
+
+    ssl = osp->ssl;
+    if (ssl == 0 || ssl->smallRecordSize <= 0) {
+        return len;
+    }
+    now = mprGetTime(sp);
+    if ((now - osp->lastWrite) >= MPR_SSL_RECORD_IDLE) {
+        osp->rampBytes = 0;
+    }
+    osp->lastWrite = now;
+
+    if (osp->rampBytes < ssl->recordRampUp) {
+        return min(len, ssl->smallRecordSize);
+    }
+    return min(len, MPR_SSL_MAX_RECORD);
+}
+
+
+/*
+ *  Write data. Return the number of bytes written or -1 on errors. This may be less than len if the socket is full.
  */
 static int writeOss(MprSocket *sp, void *buf, int len)
 {
     MprSslSocket    *osp;
-    int             rc, totalWritten;
+    int             rc, totalWritten, toWrite;
 
     osp = (MprSslSocket*) sp->sslSocket;
 
@@ -8991,16 +9256,26 @@ static int writeOss(MprSocket *sp, void *buf, int len)
     ERR_clear_error();
 
     do {
-        rc = SSL_write(osp->osslStruct, buf, len);
+        toWrite = getRecordSize(sp, osp, len);
+        if (osp->pendingWrite > toWrite) {
+            /*
+             *  OpenSSL requires a retried write to be at least as long as the record it could not send
+             */
+            toWrite = min(osp->pendingWrite, len);
+        }
+        rc = SSL_write(osp->osslStruct, buf, toWrite);
         
-        mprLog(osp, 7, "OpenSSL: written %d, requested len %d", rc, len);
+        mprLog(osp, 7, "OpenSSL: written %d, requested len %d", rc, toWrite);
 
         if (rc <= 0) {
             rc = SSL_get_error(osp->osslStruct, rc);
             if (rc == SSL_ERROR_WANT_WRITE) {
-                //  TODO - rethink
-                mprSleep(sp, 10);
-                continue;
+                /*
+                 *  The socket is full. Return what has been written so the caller can wait for a writable event and
+                 *  retry with the rest of the data.
+                 */
+                osp->pendingWrite = toWrite;
+                break;
                 
             } else if (rc == SSL_ERROR_WANT_READ) {
                 //  AUTO-RETRY should stop this
@@ -9010,11 +9285,16 @@ static int writeOss(MprSocket *sp, void *buf, int len)
                 return -1;
             }
         }
+        osp->pendingWrite = 0;
 
         totalWritten += rc;
         buf = (void*) ((char*) buf + rc);
         len -= rc;
+        osp->rampBytes += rc;
 
+        if (!osp->established && SSL_is_init_finished(osp->osslStruct)) {
+            establishOss(sp, osp);
+        }
         mprLog(osp, 7, "OpenSSL: write: len %d, written %d, total %d, error %d", len, rc, totalWritten, 
             SSL_get_error(osp->osslStruct, rc));
 
@@ -9111,6 +9391,306 @@ static int verifyX509Certificate(int ok, X509_STORE_CTX *xContext)
 }
 
 
+/*
+ *  Configure session resumption via the sharded session cache and session tickets
+ */
+static int configureSessions(MprSsl *ssl, SSL_CTX *context)
+{
+    MprSslCache     *cache;
+    CacheShard      *shard;
+    int             i;
+
+    SSL_CTX_set_timeout(context, ssl->sessionTimeout);
+    SSL_CTX_set_session_id_context(context, (uchar*) "mprSsl", 6);
+
+    if (ssl->sessionCacheSize > 0) {
+        if ((cache = mprAllocObjZeroed(ssl, MprSslCache)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        cache->maxPerShard = max(ssl->sessionCacheSize / MPR_SSL_CACHE_SHARDS, 1);
+        for (i = 0; i < MPR_SSL_CACHE_SHARDS; i++) {
+            shard = &cache->shards[i];
+            shard->sessions = mprCreateHash(cache, 0);
+            shard->order = mprCreateList(cache);
+#if BLD_FEATURE_MULTITHREAD
+            shard->mutex = mprCreateLock(cache);
+#endif
+        }
+        ssl->cache = cache;
+
+        /*
+         *  Use our own cache instead of the OpenSSL internal cache which is protected by a single global lock
+         */
+        SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+        SSL_CTX_sess_set_new_cb(context, newSessionCallback);
+        SSL_CTX_sess_set_get_cb(context, getSessionCallback);
+        SSL_CTX_sess_set_remove_cb(context, removeSessionCallback);
+        mprLog(ssl, 4, "OpenSSL: Session cache for %d sessions, timeout %d secs", ssl->sessionCacheSize, 
+            ssl->sessionTimeout);
+
+    } else {
+        SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF);
+    }
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+    if (ssl->sessionTickets) {
+        if ((ssl->ticketKeys = mprAllocObjZeroed(ssl, MprSslTicketKeys)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        SSL_CTX_set_tlsext_ticket_key_cb(context, ticketKeyCallback);
+        mprLog(ssl, 4, "OpenSSL: Session tickets enabled");
+    } else {
+        SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+    }
+#endif
+    return 0;
+}
+
+
+/*
+ *  Select the cache shard for a session ID and format the ID as a hash key
+ */
+static CacheShard *getShard(MprSslCache *cache, SessionId *id, int idLen, char *key, int keySize)
+{
+    static char hex[] = "0123456789abcdef";
+    char        *cp;
+    int         i;
+
+    for (cp = key, i = 0; i < idLen && (cp + 2) < &key[keySize]; i++) {
+        *cp++ = hex[id[i] >> 4];
+        *cp++ = hex[id[i] & 0xf];
+    }
+    *cp = '\0';
+    return &cache->shards[(idLen > 0) ? (id[idLen - 1] % MPR_SSL_CACHE_SHARDS) : 0];
+}
+
+
+static void removeEntry(CacheShard *shard, CacheEntry *entry)
+{
+    mprRemoveHash(shard->sessions, entry->key);
+    mprRemoveItem(shard->order, entry);
+    mprFree(entry);
+}
+
+
+/*
+ *  Called by OpenSSL when a new session is established. Store a DER copy of the session.
+ */
+static int newSessionCallback(SSL *osslStruct, SSL_SESSION *session)
+{
+    MprSsl          *ssl;
+    MprSslCache     *cache;
+    CacheShard      *shard;
+    CacheEntry      *entry;
+    SessionId       *id;
+    uchar           *dp;
+    char            key[(SSL_MAX_SSL_SESSION_ID_LENGTH * 2) + 1];
+    uint            idLen;
+    int             len;
+
+    ssl = (MprSsl*) SSL_CTX_get_app_data(SSL_get_SSL_CTX(osslStruct));
+    if ((cache = ssl->cache) == 0 || (len = i2d_SSL_SESSION(session, NULL)) <= 0) {
+        return 0;
+    }
+    id = SSL_SESSION_get_id(session, &idLen);
+    shard = getShard(cache, id, idLen, key, sizeof(key));
+
+    mprLock(shard->mutex);
+    if ((entry = (CacheEntry*) mprLookupHash(shard->sessions, key)) != 0) {
+        removeEntry(shard, entry);
+    }
+    while (mprGetListCount(shard->order) >= cache->maxPerShard) {
+        removeEntry(shard, (CacheEntry*) mprGetItem(shard->order, 0));
+    }
+    if ((entry = mprAllocObjZeroed(cache, CacheEntry)) != 0) {
+        entry->key = mprStrdup(entry, key);
+        entry->data = dp = (uchar*) mprAlloc(entry, len);
+        entry->len = i2d_SSL_SESSION(session, &dp);
+        entry->expires = mprGetTime(ssl) + (ssl->sessionTimeout * MPR_TICKS_PER_SEC);
+        mprAddHash(shard->sessions, key, entry);
+        mprAddItem(shard->order, entry);
+    }
+    mprUnlock(shard->mutex);
+
+    /*
+     *  Return zero as we do not keep a reference to the session
+     */
+    return 0;
+}
+
+
+/*
+ *  Called by OpenSSL to resume a session when a client presents a session ID
+ */
+static SSL_SESSION *getSessionCallback(SSL *osslStruct, SessionId *id, int idLen, int *copy)
+{
+    MprSsl          *ssl;
+    MprSslCache     *cache;
+    CacheShard      *shard;
+    CacheEntry      *entry;
+    SSL_SESSION     *session;
+    cuchar          *dp;
+    char            key[(SSL_MAX_SSL_SESSION_ID_LENGTH * 2) + 1];
+
+    *copy = 0;
+    session = 0;
+    ssl = (MprSsl*) SSL_CTX_get_app_data(SSL_get_SSL_CTX(osslStruct));
+    if ((cache = ssl->cache) == 0) {
+        return 0;
+    }
+    shard = getShard(cache, id, idLen, key, sizeof(key));
+
+    mprLock(shard->mutex);
+    if ((entry = (CacheEntry*) mprLookupHash(shard->sessions, key)) != 0) {
+        if (entry->expires <= mprGetTime(ssl)) {
+            removeEntry(shard, entry);
+        } else {
+            dp = entry->data;
+            session = d2i_SSL_SESSION(NULL, &dp, entry->len);
+        }
+    }
+    mprUnlock(shard->mutex);
+
+    mprLock(ssl->mutex);
+    if (session) {
+        ssl->sessionHits++;
+    } else {
+        ssl->sessionMisses++;
+    }
+    mprUnlock(ssl->mutex);
+    return session;
+}
+
+
+/*
+ *  Called by OpenSSL when a session is invalidated or expires
+ */
+static void removeSessionCallback(SSL_CTX *context, SSL_SESSION *session)
+{
+    MprSsl          *ssl;
+    MprSslCache     *cache;
+    CacheShard      *shard;
+    CacheEntry      *entry;
+    SessionId       *id;
+    char            key[(SSL_MAX_SSL_SESSION_ID_LENGTH * 2) + 1];
+    uint            idLen;
+
+    ssl = (MprSsl*) SSL_CTX_get_app_data(context);
+    if ((cache = ssl->cache) == 0) {
+        return;
+    }
+    id = SSL_SESSION_get_id(session, &idLen);
+    shard = getShard(cache, id, idLen, key, sizeof(key));
+
+    mprLock(shard->mutex);
+    if ((entry = (CacheEntry*) mprLookupHash(shard->sessions, key)) != 0) {
+        removeEntry(shard, entry);
+    }
+    mprUnlock(shard->mutex);
+}
+
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+static int createTicketKey(TicketKey *key, MprTime now)
+{
+    if (RAND_bytes(key->name, sizeof(key->name)) <= 0 || RAND_bytes(key->aesKey, sizeof(key->aesKey)) <= 0 ||
+            RAND_bytes(key->hmacKey, sizeof(key->hmacKey)) <= 0) {
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+    key->created = now;
+    return 0;
+}
+
+
+/*
+ *  Initialize the cipher and HMAC contexts with a ticket key
+ */
+static int initTicketContexts(TicketKey *key, uchar *iv, EVP_CIPHER_CTX *cipherCtx, HMAC_CTX *hmacCtx, int encrypt)
+{
+    if (encrypt) {
+        if (!EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), NULL, key->aesKey, iv)) {
+            return MPR_ERR_CANT_INITIALIZE;
+        }
+    } else if (!EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), NULL, key->aesKey, iv)) {
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L
+    if (!HMAC_Init_ex(hmacCtx, key->hmacKey, sizeof(key->hmacKey), EVP_sha256(), NULL)) {
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+#else
+    HMAC_Init_ex(hmacCtx, key->hmacKey, sizeof(key->hmacKey), EVP_sha256(), NULL);
+#endif
+    return 0;
+}
+
+
+/*
+ *  Called by OpenSSL to encrypt a new session ticket or to decrypt a ticket presented by a client. Keys are rotated
+ *  every sessionTimeout seconds. Return 1 to accept the ticket, 2 to accept and renew, 0 to reject and -1 on errors.
+ */
+static int ticketKeyCallback(SSL *osslStruct, uchar *name, uchar *iv, EVP_CIPHER_CTX *cipherCtx, HMAC_CTX *hmacCtx, 
+        int encrypt)
+{
+    MprSsl              *ssl;
+    MprSslTicketKeys    *keys;
+    TicketKey           *key, fresh;
+    MprTime             now;
+    int                 rc;
+
+    ssl = (MprSsl*) SSL_CTX_get_app_data(SSL_get_SSL_CTX(osslStruct));
+    keys = ssl->ticketKeys;
+    now = mprGetTime(ssl);
+
+    mprLock(ssl->mutex);
+    if (keys->current.created == 0 || (now - keys->current.created) >= (ssl->sessionTimeout * MPR_TICKS_PER_SEC)) {
+        /*
+         *  Create the new key before rotating so a failure leaves the current keys intact
+         */
+        if (createTicketKey(&fresh, now) < 0) {
+            mprUnlock(ssl->mutex);
+            return -1;
+        }
+        if (keys->current.created) {
+            keys->previous = keys->current;
+            keys->hasPrevious = 1;
+        }
+        keys->current = fresh;
+        mprLog(ssl, 4, "OpenSSL: Rotated session ticket key");
+    }
+    if (encrypt) {
+        key = &keys->current;
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) <= 0) {
+            mprUnlock(ssl->mutex);
+            return -1;
+        }
+        memcpy(name, key->name, sizeof(key->name));
+        rc = 1;
+
+    } else if (memcmp(name, keys->current.name, sizeof(keys->current.name)) == 0) {
+        key = &keys->current;
+        rc = 1;
+
+    } else if (keys->hasPrevious && memcmp(name, keys->previous.name, sizeof(keys->previous.name)) == 0) {
+        key = &keys->previous;
+        rc = 2;
+
+    } else {
+        /*
+         *  Unknown key. Reject the ticket and do a full handshake.
+         */
+        mprUnlock(ssl->mutex);
+        return 0;
+    }
+    if (initTicketContexts(key, iv, cipherCtx, hmacCtx, encrypt) < 0) {
+        rc = -1;
+    }
+    mprUnlock(ssl->mutex);
+    return rc;
+}
+#endif
+
+
 static int flushOss(MprSocket *sp)
 {
 #if UNUSED
@@ -9414,6 +9994,15 @@ MprSsl *mprCreateSsl(MprCtx ctx)
     ssl->ciphers = mprStrdup(ssl, MPR_DEFAULT_CIPHER_SUITE);
     ssl->protocols = MPR_HTTP_PROTO_SSLV3 | MPR_HTTP_PROTO_TLSV1;
     ssl->verifyDepth = 6;
+    ssl->offload = 1;
+    ssl->sessionCacheSize = MPR_SSL_SESSION_CACHE_SIZE;
+    ssl->sessionTimeout = MPR_SSL_SESSION_TIMEOUT;
+    ssl->sessionTickets = 1;
+    ssl->smallRecordSize = MPR_SSL_SMALL_RECORD;
+    ssl->recordRampUp = MPR_SSL_RECORD_RAMP;
+#if BLD_FEATURE_MULTITHREAD
+    ssl->mutex = mprCreateLock(ssl);
+#endif
     return ssl;
 }
 
@@ -9490,6 +10079,57 @@ void mprVerifySslClients(MprSsl *ssl, bool on)
 }
 
 
+void mprSetSslOffload(MprSsl *ssl, bool on)
+{
+    ssl->offload = on;
+}
+
+
+void mprSetSslSessionCache(MprSsl *ssl, int size)
+{
+    ssl->sessionCacheSize = max(size, 0);
+}
+
+
+void mprSetSslSessionTimeout(MprSsl *ssl, int timeout)
+{
+    if (timeout > 0) {
+        ssl->sessionTimeout = timeout;
+    }
+}
+
+
+void mprSetSslSessionTickets(MprSsl *ssl, bool on)
+{
+    ssl->sessionTickets = on;
+}
+
+
+/*
+ *  Define the initial record size for new and idle connections and how many bytes to write before ramping up to
+ *  maximum size records. Set smallRecordSize to zero to always write maximum size records.
+ */
+void mprSetSslRecordSizing(MprSsl *ssl, int smallRecordSize, int rampUp)
+{
+    ssl->smallRecordSize = min(max(smallRecordSize, 0), MPR_SSL_MAX_RECORD);
+    ssl->recordRampUp = max(rampUp, 0);
+}
+
+
+/*
+ *  Return a snapshot of the session resumption and handshake statistics
+ */
+void mprGetSslStats(MprSsl *ssl, MprSslStats *stats)
+{
+    mprLock(ssl->mutex);
+    stats->sessionHits = ssl->sessionHits;
+    stats->sessionMisses = ssl->sessionMisses;
+    stats->fullHandshakes = ssl->fullHandshakes;
+    stats->resumedHandshakes = ssl->resumedHandshakes;
+    mprUnlock(ssl->mutex);
+}
+
+
 #endif /* SSL */
 
 
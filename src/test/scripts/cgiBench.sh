@@ -0,0 +1,116 @@
+#!/bin/bash
+#
+#   cgiBench.sh -- Benchmark CGI request latency for the cold, spawn and warm pool modes
+#
+#	Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+
+. scripts/common.sh
+
+USAGE="cgiBench [--config file] [--iterations count] [--startServer] [--serverThreads N] [--verbose]"
+
+CONF=appweb.conf
+ITERATIONS=200
+
+while [ "$1" != "" ]
+do
+	if [ "${1#--}" != ${1} ] ; then
+		case "$1" in
+		--config)
+			CONF=$2
+			shift ; shift ;;
+		--iterations)
+			ITERATIONS="$2"
+			shift ; shift ;;
+		--serverThreads)
+			SERVER_THREADS="$2"
+			shift ; shift ;;
+		--startServer)
+			STARTUP=1
+			shift ;;
+		--timeout)
+			TIMEOUT="$2"
+			shift ; shift ;;
+		--verbose)
+			VERBOSE=1
+			shift ;;
+		*)
+			echo "$USAGE"
+			exit 255
+		esac
+	else
+		echo "$USAGE"
+		exit 255
+	fi
+done
+
+#
+#	Measure the request latency for cgiProgram via each CGI mode. The locations are defined in conf/test.conf.
+#	The first warm pool request is a cold start that fills the pool.
+#
+executeTests()
+{
+	local results mode url
+
+	if ! type curl >/dev/null 2>/dev/null ; then
+		echo "WARNING: curl is not installed, can't run CGI benchmark"
+		return
+	fi
+	results=/tmp/results.$$
+
+	echo -e "Mode      \tRequests\t   Avg-msec\t   Min-msec\t   Max-msec"
+	for mode in cgi-bin cgi-spawn cgi-warm
+	do
+		url=http://$TEST_HOST/$mode/cgiProgram
+		curl --silent --show-error -o /dev/null $url
+		i=0
+		while [ $i -lt $ITERATIONS ]
+		do
+			curl --silent --show-error -o /dev/null -w "%{http_code} %{time_total}\n" $url
+			i=$((i + 1))
+		done > $results
+		if grep -v "^200 " $results >/dev/null ; then
+			echo "Request to $url failed" >&2
+			[ "$VERBOSE" = 1 ] && grep -v "^200 " $results >&2
+			rm -f $results
+			exit 255
+		fi
+		awk -v mode=$mode '
+			{ t = $2 * 1000; sum += t; if (NR == 1 || t < min) min = t; if (t > max) max = t }
+			END { printf("%-10s\t%8d\t%11.3f\t%11.3f\t%11.3f\n", mode, NR, sum / NR, min, max) }' $results
+	done
+	echo -e "\n# Completed CGI benchmark at `date +%T`\n"
+	rm -f $results
+}
+
+getListenAddress
+startServer
+setTimeout
+executeTests
+stopServer
+cleanup
+
+echo "# CGI benchmark complete"
+
+exit 0
+
+################################################################################
+#
+#	Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+#	The latest version of this code is available at http://www.embedthis.com
+#
+#	This software is open source; you can redistribute it and/or modify it
+#	under the terms of the GNU General Public License as published by the
+#	Free Software Foundation; either version 2 of the License, or (at your
+#	option) any later version.
+#
+#	This program is distributed WITHOUT ANY WARRANTY; without even the
+#	implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+#	See the GNU General Public License for more details at:
+#	http://www.embedthis.com/downloads/gplLicense.html
+#
+#	This General Public License does NOT permit incorporating this software
+#	into proprietary programs. If you are unable to comply with the GPL, a
+#	commercial license for this software and support services are available
+#	from Embedthis Software at http://www.embedthis.com
+#
+################################################################################
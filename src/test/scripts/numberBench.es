@@ -0,0 +1,46 @@
+/*
+ *  numberBench.es -- Benchmark Number allocation in the Ejscript VM
+ *
+ *  Usage: ejs --stats numberBench.es
+ *
+ *  Integer results between EJS_MIN_SMALL_INT and EJS_MAX_SMALL_INT use shared Number values and do not allocate. 
+ *  Compare the times and the garbage collection counts printed by --stats across builds.
+ */
+
+var iterations: Number = 1000000
+
+/*
+ *  Loop counter and arithmetic results within the small integer range
+ */
+var mark: Date = new Date
+var sum: Number = 0
+for (var i: Number = 0; i < iterations; i++) {
+    sum += i % 100
+}
+print("Small integer loop:  " + mark.elapsed + " msec, sum " + sum)
+
+/*
+ *  Array indexing and element arithmetic
+ */
+var list: Array = []
+for (i = 0; i < 256; i++) {
+    list[i] = i
+}
+mark = new Date
+var total: Number = 0
+for (var pass: Number = 0; pass < iterations / 256; pass++) {
+    for (i = 0; i < list.length; i++) {
+        total += list[i] & 0x7
+    }
+}
+print("Array iteration:     " + mark.elapsed + " msec, total " + total)
+
+/*
+ *  Results outside the small integer range are allocated as before
+ */
+mark = new Date
+sum = 0
+for (i = 0; i < iterations; i++) {
+    sum += i * 1000
+}
+print("Large integer loop:  " + mark.elapsed + " msec, sum " + sum)
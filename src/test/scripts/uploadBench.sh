@@ -0,0 +1,119 @@
+#!/bin/bash
+#
+#   uploadBench.sh -- Benchmark multipart file upload throughput
+#
+#	Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+
+. scripts/common.sh
+
+USAGE="uploadBench [--config file] [--iterations count] [--size MB] [--startServer] [--serverThreads N] [--verbose]"
+
+CONF=appweb.conf
+ITERATIONS=3
+SIZE=1024
+
+while [ "$1" != "" ]
+do
+	if [ "${1#--}" != ${1} ] ; then
+		case "$1" in
+		--config)
+			CONF=$2
+			shift ; shift ;;
+		--iterations)
+			ITERATIONS="$2"
+			shift ; shift ;;
+		--serverThreads)
+			SERVER_THREADS="$2"
+			shift ; shift ;;
+		--size)
+			SIZE="$2"
+			shift ; shift ;;
+		--startServer)
+			STARTUP=1
+			shift ;;
+		--timeout)
+			TIMEOUT="$2"
+			shift ; shift ;;
+		--verbose)
+			VERBOSE=1
+			shift ;;
+		*)
+			echo "$USAGE"
+			exit 255
+		esac
+	else
+		echo "$USAGE"
+		exit 255
+	fi
+done
+
+#
+#	The server must permit the upload size. Set LimitUploadSize in the server configuration.
+#
+executeTests()
+{
+	local data results i bytes secs
+
+	if ! type curl >/dev/null 2>/dev/null ; then
+		echo "WARNING: curl is not installed, can't run upload benchmark"
+		return
+	fi
+	data=/tmp/upload.$$
+	results=/tmp/results.$$
+
+	echo "# Creating ${SIZE} MB upload file"
+	dd if=/dev/urandom of=$data bs=1048576 count=$SIZE 2>/dev/null
+
+	echo -e "Iteration\t       Bytes\t Elapsed-sec\t        MB/sec"
+	i=0
+	while [ $i -lt $ITERATIONS ]
+	do
+		curl --silent --show-error -o $results -w "%{size_upload} %{time_total} %{http_code}\n" \
+			-F "file=@${data}" http://$TEST_HOST/upload/upload.html > $results.stats
+		read bytes secs code < $results.stats
+		if [ "$code" != 200 ] ; then
+			echo "Upload failed with HTTP code $code" >&2
+			[ "$VERBOSE" = 1 ] && cat $results >&2
+			rm -f $data $results $results.stats
+			exit 255
+		fi
+		echo "$i $bytes $secs" | awk '{ printf("%9d\t%12d\t%12.3f\t%14.2f\n", $1, $2, $3, $2 / $3 / 1048576) }'
+		i=$((i + 1))
+	done
+	echo -e "\n# Completed upload benchmark at `date +%T`\n"
+	rm -f $data $results $results.stats
+}
+
+
+getListenAddress
+startServer
+setTimeout
+executeTests
+stopServer
+cleanup
+
+echo "# Upload benchmark complete"
+
+exit 0
+
+################################################################################
+#
+#	Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+#	The latest version of this code is available at http://www.embedthis.com
+#
+#	This software is open source; you can redistribute it and/or modify it
+#	under the terms of the GNU General Public License as published by the
+#	Free Software Foundation; either version 2 of the License, or (at your
+#	option) any later version.
+#
+#	This program is distributed WITHOUT ANY WARRANTY; without even the
+#	implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+#	See the GNU General Public License for more details at:
+#	http://www.embedthis.com/downloads/gplLicense.html
+#
+#	This General Public License does NOT permit incorporating this software
+#	into proprietary programs. If you are unable to comply with the GPL, a
+#	commercial license for this software and support services are available
+#	from Embedthis Software at http://www.embedthis.com
+#
+################################################################################
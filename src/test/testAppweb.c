@@ -13,12 +13,16 @@
 extern MprTestDef testAlias;
 extern MprTestDef testAuth;
 extern MprTestDef testCgi;
+extern MprTestDef testChunk;
 extern MprTestDef testEgi;
 extern MprTestDef testEjs;
+extern MprTestDef testFastCgi;
 extern MprTestDef testGet;
 extern MprTestDef testHttp;
 extern MprTestDef testPhp;
+extern MprTestDef testProxy;
 extern MprTestDef testPost;
+extern MprTestDef testSsl;
 extern MprTestDef testUpload;
 extern MprTestDef testVhost;
 
@@ -33,6 +37,7 @@ static MprTestDef *groups[] =
     &testAuth,
 #if BLD_FEATURE_EGI && BLD_DEBUG
     &testEgi,
+    &testChunk,
 #endif
 #if BLD_FEATURE_EJS
     &testEjs,
@@ -40,11 +45,20 @@ static MprTestDef *groups[] =
 #if BLD_FEATURE_CGI
     &testCgi,
 #endif
+#if BLD_FEATURE_FASTCGI
+    &testFastCgi,
+#endif
 #if BLD_FEATURE_PHP
     &testPhp,
 #endif
-#if FUTURE
+#if BLD_FEATURE_PROXY
+    &testProxy,
+#endif
+#if BLD_FEATURE_UPLOAD
     &testUpload,
+#endif
+#if BLD_FEATURE_SSL
+    &testSsl,
 #endif
     &testVhost,
     0
@@ -433,6 +447,96 @@ int getDefaultPort(MprTestGroup *gp)
     return defaultPort;
 }
 
+
+/*
+ *  Open a socket to the server and send a request without using the http client. Used by tests that must see the
+ *  response framing on the wire. The connection is not kept alive.
+ */
+MprSocket *openRawRequest(MprTestGroup *gp, cchar *method, cchar *uri)
+{
+    MprSocket   *sp;
+    char        *request;
+    int         len, rc;
+
+    if ((sp = mprCreateSocket(gp, NULL)) == 0) {
+        return 0;
+    }
+    if (mprOpenClientSocket(sp, defaultHost, defaultPort, MPR_SOCKET_BLOCK) < 0) {
+        mprFree(sp);
+        return 0;
+    }
+    len = mprAllocSprintf(gp, &request, -1, "%s %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n", 
+        method, uri, defaultHost);
+    rc = mprWriteSocket(sp, request, len);
+    mprFree(request);
+    if (rc != len) {
+        mprFree(sp);
+        return 0;
+    }
+    return sp;
+}
+
+
+/*
+ *  Open a socket with a small receive buffer and segment size and send a GET request. These are set before connecting
+ *  so the server sees a small window and sizes its send buffer to match. Used to test a slow client. Return the socket
+ *  descriptor or -1.
+ */
+int openSlowRequest(MprTestGroup *gp, cchar *uri, int bufsize)
+{
+    struct sockaddr_in  addr;
+    char                *request;
+    int                 fd, len, rc, segment;
+
+    if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+        return -1;
+    }
+    segment = 536;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char*) &bufsize, sizeof(bufsize));
+    setsockopt(fd, IPPROTO_TCP, TCP_MAXSEG, (char*) &segment, sizeof(segment));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(defaultPort);
+    addr.sin_addr.s_addr = inet_addr(defaultHost);
+    if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    len = mprAllocSprintf(gp, &request, -1, "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n", uri, defaultHost);
+    rc = write(fd, request, len);
+    mprFree(request);
+    if (rc != len) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+/*
+ *  Read from a raw socket into the buffer until the pattern has been received or the server closes the connection.
+ *  Return a pointer to the pattern in the buffer, or 0 if not received.
+ */
+char *readRawUntil(MprSocket *sp, MprBuf *buf, cchar *pattern)
+{
+    char    data[MPR_BUFSIZE], *cp;
+    int     nbytes;
+
+    while (1) {
+        mprAddNullToBuf(buf);
+        if ((cp = strstr(mprGetBufStart(buf), pattern)) != 0) {
+            return cp;
+        }
+        if ((nbytes = mprReadSocket(sp, data, sizeof(data))) <= 0) {
+            if (nbytes < 0 || mprGetSocketEof(sp)) {
+                return 0;
+            }
+            continue;
+        }
+        mprPutBlockToBuf(buf, data, nbytes);
+    }
+}
+
 /*
  *  @copy   default
  *
@@ -16,12 +16,16 @@
 /********************************** Constants *********************************/
 
 extern bool bulkPost(MprTestGroup *gp, char *url, int size, int expectCode);
+extern int  getDefaultPort(MprTestGroup *gp);
 extern MprHttp *getHttp(MprTestGroup *gp);
 extern char *getValue(MprTestGroup *gp, char *key);
 extern int  httpRequest(MprHttp *http, cchar *method, cchar *uri);
 extern char *lookupValue(MprTestGroup *gp, char *key);
 extern bool match(MprTestGroup *gp, char *key, char *value);
 extern bool matchAnyCase(MprTestGroup *gp, char *key, char *value);
+extern MprSocket *openRawRequest(MprTestGroup *gp, cchar *method, cchar *uri);
+extern char *readRawUntil(MprSocket *sp, MprBuf *buf, cchar *pattern);
+extern int  openSlowRequest(MprTestGroup *gp, cchar *uri, int bufsize);
 extern bool simpleForm(MprTestGroup *gp, char *uri, char *formBody, int expectCode);
 extern bool simpleGet(MprTestGroup *gp, cchar *uri, int expect);
 extern bool simplePost(MprTestGroup *gp, char *uri, char *postBody, int len, int expectCode);
@@ -237,6 +237,29 @@ static void nph(MprTestGroup *gp)
 }
 
 
+/*
+ *  A CGI response with a Content-Length is not chunked. Where supported, the body is spliced to the socket.
+ */
+static void contentLength(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    cchar       *data;
+
+    http = getHttp(gp);
+
+    setSwitches(gp, "-c%20500000");
+    assert(simpleGet(gp, "/cgi-bin/cgiProgram", 0));
+    assert(mprGetHttpContentLength(http) == 500000);
+    data = mprGetHttpContent(http);
+    assert(data != 0);
+    if (data) {
+        assert(data[0] == '1' && data[63] == '\n');
+        assert(data[499999] == '0' + (500000 % 10));
+    }
+    setSwitches(gp, 0);
+}
+
+
 
 static void toughArgQuoting(MprTestGroup *gp)
 {
@@ -282,6 +305,53 @@ static void toughArgQuoting(MprTestGroup *gp)
 }
 
 
+/*
+ *  Scripts run via posix_spawn with a cached script resolution
+ */
+static void spawn(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, "/cgi-spawn/cgiProgram?a=1&b=2", 0));
+    assert(matchAnyCase(gp, "SCRIPT_NAME", "/cgi-spawn/cgiProgram"));
+    assert(match(gp, "QVAR a", "1"));
+    assert(match(gp, "QVAR b", "2"));
+
+    assert(simpleGet(gp, "/cgi-spawn/testScript?a+b+c", 0));
+    assert(match(gp, "QUERY_STRING", "a+b+c"));
+    assert(match(gp, "ARG[2]", "a"));
+
+    assert(simpleForm(gp, "/cgi-spawn/cgiProgram", "name=Peter&address=777+Mulberry+Lane", 0));
+    assert(match(gp, "PVAR name", "Peter"));
+    assert(match(gp, "PVAR address", "777 Mulberry Lane"));
+}
+
+
+/*
+ *  Scripts run by idle warm processes that read the request environment from stdin. Repeat so that requests are 
+ *  served both by cold starts and by the pool.
+ */
+static void warmPool(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 4; i++) {
+        assert(simpleGet(gp, "/cgi-warm/cgiProgram?a=1&b=2", 0));
+        assert(matchAnyCase(gp, "SCRIPT_NAME", "/cgi-warm/cgiProgram"));
+        assert(match(gp, "QVAR a", "1"));
+        assert(match(gp, "QVAR b", "2"));
+
+        assert(simpleForm(gp, "/cgi-warm/cgiProgram", "name=Peter&address=777+Mulberry+Lane", 0));
+        assert(match(gp, "PVAR name", "Peter"));
+        assert(match(gp, "PVAR address", "777 Mulberry Lane"));
+    }
+
+    /*
+     *  ISINDEX arguments require a cold start
+     */
+    assert(simpleGet(gp, "/cgi-warm/cgiProgram?a+b+c", 0));
+    assert(match(gp, "QUERY_STRING", "a+b+c"));
+}
+
+
 static void setSwitches(MprTestGroup *gp, cchar *switches)
 {
     MprHttp     *http;
@@ -305,7 +375,10 @@ MprTestDef testCgi = {
         MPR_TEST(0, status),
         MPR_TEST(0, location),
         MPR_TEST(0, nph),
+        MPR_TEST(0, contentLength),
         MPR_TEST(0, toughArgQuoting),
+        MPR_TEST(0, spawn),
+        MPR_TEST(0, warmPool),
         MPR_TEST(0, 0),
     },
 };
@@ -0,0 +1,219 @@
+/*
+ *  testChunk.c - Unit tests for the chunk filter
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "testAppweb.h"
+
+/*
+ *  Only test in debug mode as it requires the EGI test forms in the server itself.
+ */
+#if BLD_FEATURE_EGI && BLD_DEBUG
+/*********************************** Code *************************************/
+/*
+ *  Return the sizes of the chunks in a chunked response body as a space separated list of hex sizes
+ */
+static char *getChunkSizes(char *body, char *sizes, int len)
+{
+    char    *cp, *end, *limit;
+    int     size, used;
+
+    *sizes = '\0';
+    used = 0;
+    limit = &body[strlen(body)];
+
+    for (cp = body; strncmp(cp, "\r\n", 2) == 0; cp = end + 2 + size) {
+        size = (int) strtol(&cp[2], &end, 16);
+        if (end == &cp[2] || strncmp(end, "\r\n", 2) != 0 || &end[2 + size] > limit) {
+            break;
+        }
+        used += mprSprintf(&sizes[used], len - used, "%s%x", used ? " " : "", size);
+        if (size == 0) {
+            break;
+        }
+    }
+    return sizes;
+}
+
+
+/*
+ *  Run the chunk test form and return the chunk sizes. Also return the msec taken to receive the first chunk.
+ */
+static char *chunkRequest(MprTestGroup *gp, cchar *uri, char *sizes, int len, int *firstChunk)
+{
+    MprSocket   *sp;
+    MprBuf      *buf;
+    MprTime     mark;
+    char        *body;
+    int         offset;
+
+    *sizes = '\0';
+    *firstChunk = -1;
+    mark = mprGetTime(gp);
+
+    if ((sp = openRawRequest(gp, "GET", uri)) == 0) {
+        return 0;
+    }
+    buf = mprCreateBuf(gp, MPR_BUFSIZE, -1);
+    if ((body = readRawUntil(sp, buf, "\r\n\r\n")) != 0) {
+        /*
+         *  The first chunk prefix begins with the CRLF that ends the headers
+         */
+        offset = (int) (body - mprGetBufStart(buf)) + 2;
+        if (strstr(mprGetBufStart(buf), "Transfer-Encoding: chunked") == 0) {
+            mprLog(gp, 0, "Response is not chunked");
+
+        } else if (readRawUntil(sp, buf, "0123456789") != 0) {
+            *firstChunk = (int) mprGetElapsedTime(gp, mark);
+            if (readRawUntil(sp, buf, "\r\n0\r\n\r\n") != 0) {
+                getChunkSizes(mprGetBufStart(buf) + offset, sizes, len);
+            }
+        }
+    }
+    mprFree(buf);
+    mprFree(sp);
+    return sizes;
+}
+
+
+/*
+ *  The form writes 50 small packets and completes the request a second later. The packets should be coalesced into one
+ *  chunk which the flush timer sends well before the request completes.
+ */
+static void coalesce(MprTestGroup *gp)
+{
+    char    sizes[MPR_MAX_STRING];
+    int     firstChunk;
+
+    assert(chunkRequest(gp, "/egi/chunk", sizes, sizeof(sizes), &firstChunk) != 0);
+    assert(strcmp(sizes, "1f4 14 0") == 0);
+    assert(0 <= firstChunk && firstChunk < 800);
+}
+
+
+/*
+ *  The form flushes the queue after the first packet. It must be sent as its own chunk.
+ */
+static void flush(MprTestGroup *gp)
+{
+    char    sizes[MPR_MAX_STRING];
+    int     firstChunk;
+
+    assert(chunkRequest(gp, "/egi/chunk?flush=1", sizes, sizeof(sizes), &firstChunk) != 0);
+    assert(strcmp(sizes, "a 1ea 14 0") == 0);
+    assert(0 <= firstChunk && firstChunk < 800);
+}
+
+
+/*
+ *  Verify a chunked response body. Each chunk size must match the data that follows it and the data must be the 
+ *  alphabet repeated. Return the total data length or -1 if the body is corrupt.
+ */
+static int verifyChunks(char *body, char *limit)
+{
+    char    *cp, *end, *data;
+    int     i, size, offset;
+
+    offset = 0;
+    for (cp = body; (limit - cp) >= 5 && strncmp(cp, "\r\n", 2) == 0; cp = &data[size]) {
+        size = (int) strtol(&cp[2], &end, 16);
+        if (end == &cp[2] || strncmp(end, "\r\n", 2) != 0) {
+            break;
+        }
+        data = &end[2];
+        if (size == 0) {
+            return offset;
+        }
+        if (&data[size] > limit) {
+            break;
+        }
+        for (i = 0; i < size; i++) {
+            if (data[i] != 'a' + (offset + i) % 26) {
+                return -1;
+            }
+        }
+        offset += size;
+    }
+    return -1;
+}
+
+
+/*
+ *  The form streams a body over a couple of seconds to a client with a small receive window that is slow to read. 
+ *  Partial chunks are flushed while the socket is full and more data arrives before they can be sent. The chunk 
+ *  framing must stay intact.
+ */
+static void slowReader(MprTestGroup *gp)
+{
+    MprBuf      *buf;
+    char        data[MPR_BUFSIZE], *body;
+    int         fd, nbytes;
+
+    fd = openSlowRequest(gp, "/egi/chunkStream", 4096);
+    assert(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    mprSleep(gp, 500);
+
+    buf = mprCreateBuf(gp, MPR_BUFSIZE, -1);
+    while ((nbytes = read(fd, data, sizeof(data))) > 0) {
+        mprPutBlockToBuf(buf, data, nbytes);
+        mprSleep(gp, 10);
+    }
+    close(fd);
+    mprAddNullToBuf(buf);
+
+    body = strstr(mprGetBufStart(buf), "\r\n\r\n");
+    assert(body != 0);
+    if (body) {
+        assert(strstr(mprGetBufStart(buf), "Transfer-Encoding: chunked") != 0);
+        assert(verifyChunks(&body[2], mprGetBufEnd(buf)) == 20 * ((32 * 1024) + 37 + 100));
+    }
+    mprFree(buf);
+}
+
+
+MprTestDef testChunk = {
+    "chunk", 0, 0, 0,
+    {
+        MPR_TEST(0, coalesce),
+        MPR_TEST(0, flush),
+        MPR_TEST(0, slowReader),
+        MPR_TEST(0, 0),
+    },
+};
+#endif /* BLD_FEATURE_EGI */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
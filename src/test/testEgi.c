@@ -112,6 +112,39 @@ static void location(MprTestGroup *gp)
 }
 
 
+/*
+ *  Form suspends the request and completes it from a timer event
+ */
+static void async(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, "/egi/async", 0));
+    assert(match(gp, "STATE", "started"));
+    assert(match(gp, "RESULT", "done"));
+
+    /*
+     *  Connection should still be usable after an async request
+     */
+    assert(simpleGet(gp, "/egi/test", 0));
+}
+
+
+/*
+ *  Form suspends the request and never completes it in time. The host timer fails the request.
+ */
+static void asyncTimeout(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    MprTime     mark;
+
+    http = getHttp(gp);
+    mark = mprGetTime(gp);
+    if (httpRequest(http, "GET", "/egi/asyncTimeout") == 0) {
+        assert(mprGetHttpCode(http) != 200);
+    }
+    assert(mprGetElapsedTime(gp, mark) < 10 * MPR_TICKS_PER_SEC);
+}
+
+
 MprTestDef testEgi = {
     "egi", 0, 0, 0,
     {
@@ -121,6 +154,8 @@ MprTestDef testEgi = {
         MPR_TEST(0, alias),
         MPR_TEST(0, status),
         MPR_TEST(0, location),
+        MPR_TEST(0, async),
+        MPR_TEST(0, asyncTimeout),
         MPR_TEST(0, 0),
     },
 };
@@ -30,6 +30,149 @@ static void basic(MprTestGroup *gp)
 }
 
 
+/*
+ *  Requests after the first are created from the module cache
+ */
+static void cached(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 3; i++) {
+        assert(simpleGet(gp, "/ejs/ejsProgram.ejs?var1=a", 0));
+        assert(match(gp, "var1", "a"));
+        assert(match(gp, "url", "/ejs/ejsProgram.ejs"));
+    }
+}
+
+
+/*
+ *  Write a page that reports its version
+ */
+static bool writePage(MprTestGroup *gp, cchar *path, cchar *version)
+{
+    MprFile     *file;
+    char        page[MPR_MAX_STRING];
+    int         len;
+
+    if ((file = mprOpen(gp, path, O_CREAT | O_TRUNC | O_WRONLY | O_BINARY, 0644)) == 0) {
+        return 0;
+    }
+    len = mprSprintf(page, sizeof(page), "<html>\n<body>\n<%% write(\"version=%s,\") %%>\n</body>\n</html>\n", version);
+    if (mprWrite(file, page, len) != len) {
+        mprFree(file);
+        return 0;
+    }
+    mprFree(file);
+    return 1;
+}
+
+
+/*
+ *  A cached page is rebuilt when its source changes. The test configuration checks cached modules on every request.
+ *  Multithreaded builds serve the old module while the page is recompiled, so retry until the new version is seen.
+ */
+static void staleReload(MprTestGroup *gp)
+{
+    int     i;
+
+    assert(writePage(gp, "web/stale.ejs", "first"));
+    assert(simpleGet(gp, "/stale.ejs", 0));
+    assert(match(gp, "version", "first"));
+
+    assert(writePage(gp, "web/stale.ejs", "second"));
+    for (i = 0; i < 50; i++) {
+        if (!simpleGet(gp, "/stale.ejs", 0) || match(gp, "version", "second")) {
+            break;
+        }
+        mprSleep(gp, 100);
+    }
+    assert(match(gp, "version", "second"));
+
+    mprDelete(gp, "web/stale.ejs");
+    mprDelete(gp, "web/stale.mod");
+}
+
+
+/*
+ *  Class static properties must not be shared across requests. The controller increments a static on each request.
+ */
+static void statics(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 3; i++) {
+        assert(simpleGet(gp, "/statics/test", 0));
+        assert(match(gp, "hits", "1"));
+    }
+}
+
+
+/*
+ *  Requests reuse pooled interpreters without the module cache. Globals, objects and modules loaded by one request must
+ *  not be visible to the next.
+ */
+static void reset(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 4; i++) {
+        assert(simpleGet(gp, "/ejsPool/reset.ejs", 0));
+        assert(match(gp, "global", "undefined"));
+        assert(match(gp, "object", "undefined"));
+    }
+}
+
+
+/*
+ *  Request interpreters collect garbage as they run. Cloned objects must keep their property names when the objects 
+ *  they were cloned from are collected.
+ */
+static void clones(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, "/ejs/gcClone.ejs", 0));
+    assert(match(gp, "clones", "200"));
+    assert(match(gp, "corrupt", "0"));
+}
+
+
+/*
+ *  Memory used by a request that creates lots of garbage must stay bounded
+ */
+static void memory(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 2; i++) {
+        assert(simpleGet(gp, "/ejs/gcMemory.ejs", 0));
+        assert(match(gp, "growth", "bounded"));
+    }
+}
+
+
+/*
+ *  Web page templates. The page expands @@var references, includes a file and is rendered inside a layout.
+ */
+static void templates(MprTestGroup *gp)
+{
+    cchar   *content, *top, *body, *bottom;
+
+    assert(simpleGet(gp, "/ejs/template.ejs", 0));
+    assert(match(gp, "greeting", "Hello"));
+    assert(match(gp, "name", "Peter"));
+    assert(match(gp, "included", "Hello World"));
+
+    content = mprGetHttpContent(getHttp(gp));
+    assert(content != 0);
+    if (content) {
+        top = strstr(content, "layout=top");
+        body = strstr(content, "greeting=");
+        bottom = strstr(content, "layout=bottom");
+        assert(top != 0 && body != 0 && bottom != 0);
+        assert(top < body && body < bottom);
+    }
+}
+
+
 static void queryString(MprTestGroup *gp)
 {
     char    *post;
@@ -78,13 +221,106 @@ static void alias(MprTestGroup *gp)
 }
 
 
+#if BLD_FEATURE_EJS_DB
+/*
+ *  Database queries bind parameters and cache prepared statements. The least recently used statement is evicted when
+ *  the cache is full.
+ */
+static void database(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, "/ejs/db.ejs", 0));
+    assert(match(gp, "rows", "1"));
+    assert(match(gp, "idType", "integer"));
+    assert(match(gp, "priceType", "real"));
+    assert(match(gp, "quoted", "true"));
+    assert(match(gp, "byName", "1"));
+    assert(match(gp, "nulls", "1"));
+    assert(match(gp, "noMatch", "0"));
+    assert(match(gp, "count", "true"));
+    assert(match(gp, "kept", "true"));
+    assert(match(gp, "evicted", "true"));
+}
+
+
+/*
+ *  Cursors return typed rows. Reading a finished or closed cursor, or a cursor of a closed database, returns null.
+ */
+static void cursor(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, "/ejs/dbCursor.ejs", 0));
+    assert(match(gp, "id", "number 2"));
+    assert(match(gp, "price", "number 2.5"));
+    assert(match(gp, "name", "string item2"));
+    assert(match(gp, "nullNote", "true"));
+    assert(match(gp, "last", "true"));
+    assert(match(gp, "finished", "true"));
+    assert(match(gp, "forEach", "1 2 3"));
+    assert(match(gp, "closed", "true"));
+    assert(match(gp, "multiple", "rejected"));
+    assert(match(gp, "dbClosed", "true"));
+    assert(match(gp, "done", "true"));
+}
+#endif
+
+
+/*
+ *  Session state must persist across requests that send back the session cookie
+ */
+static void session(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    cchar       *cookie;
+    char        *value, *cp, count[16];
+    int         i;
+
+    http = getHttp(gp);
+
+    assert(simpleGet(gp, "/ejs/session.ejs", 0));
+    assert(match(gp, "count", "1"));
+    cookie = mprGetHttpHeader(http, "SET-COOKIE");
+    assert(cookie != 0);
+    if (cookie == 0) {
+        return;
+    }
+    value = mprStrdup(gp, cookie);
+    if ((cp = strchr(value, ';')) != 0) {
+        *cp = '\0';
+    }
+
+    for (i = 2; i <= 4; i++) {
+        mprSetHttpHeader(http, "Cookie", value, 1);
+        assert(simpleGet(gp, "/ejs/session.ejs", 0));
+        assert(match(gp, "count", mprItoa(count, sizeof(count), i, 10)));
+    }
+
+    /*
+     *  Without the cookie, a new session is created
+     */
+    assert(simpleGet(gp, "/ejs/session.ejs", 0));
+    assert(match(gp, "count", "1"));
+    mprFree(value);
+}
+
+
 MprTestDef testEjs = {
     "ejs", 0, 0, 0,
     {
         MPR_TEST(0, basic),
+        MPR_TEST(0, cached),
+        MPR_TEST(0, staleReload),
+        MPR_TEST(0, statics),
+        MPR_TEST(0, reset),
+        MPR_TEST(0, clones),
+        MPR_TEST(0, memory),
+        MPR_TEST(0, templates),
         MPR_TEST(0, queryString),
         MPR_TEST(0, encoding),
         MPR_TEST(0, alias),
+        MPR_TEST(0, session),
+#if BLD_FEATURE_EJS_DB
+        MPR_TEST(0, database),
+        MPR_TEST(0, cursor),
+#endif
         MPR_TEST(0, 0),
     },
 };
@@ -0,0 +1,195 @@
+/*
+ *  testFastCgi.c - Unit tests for the FastCGI handler
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "testAppweb.h"
+
+#if BLD_FEATURE_FASTCGI
+/************************************ Code ************************************/
+/*
+ *  Return the URI of the FastCGI test program. The proxy test group sets the group data to a prefix to run the tests
+ *  through the proxy.
+ */
+static char *uri(MprTestGroup *gp, cchar *path)
+{
+    char    *result;
+
+    mprAllocSprintf(gp, &result, -1, "%s%s", gp->data ? (cchar*) gp->data : "", path);
+    return result;
+}
+
+
+static void basic(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, uri(gp, "/fcgi/test"), 0));
+    assert(match(gp, "REQUEST_METHOD", "GET"));
+    assert(match(gp, "SCRIPT_NAME", "/fcgi/test"));
+}
+
+
+static void queryString(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, uri(gp, "/fcgi/test?a=b"), 0));
+    assert(match(gp, "QUERY_STRING", "a=b"));
+}
+
+
+/*
+ *  Successive requests should reuse the persistent responder connections
+ */
+static void persistent(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 20; i++) {
+        assert(simpleGet(gp, uri(gp, "/fcgi/test"), 0));
+        assert(match(gp, "REQUEST_METHOD", "GET"));
+    }
+}
+
+
+static void post(MprTestGroup *gp)
+{
+    assert(simplePost(gp, uri(gp, "/fcgi/test"), "name=value", 10, 0));
+    assert(match(gp, "REQUEST_METHOD", "POST"));
+    assert(match(gp, "BODY_LENGTH", "10"));
+    assert(strstr(mprGetHttpContent(getHttp(gp)), "name=value") != 0);
+}
+
+
+static void bulkOutput(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, uri(gp, "/fcgi/test?bytes=500000"), 0));
+    assert(mprGetHttpContentLength(getHttp(gp)) > 500000);
+}
+
+
+static void bulkInput(MprTestGroup *gp)
+{
+    assert(bulkPost(gp, uri(gp, "/fcgi/test"), 200 * 1024, 0));
+    assert(match(gp, "REQUEST_METHOD", "POST"));
+}
+
+
+/*
+ *  Return the worker process ID that serviced the last request
+ */
+static int getWorkerPid(MprTestGroup *gp)
+{
+    char    *value;
+
+    return ((value = lookupValue(gp, "PID")) != 0) ? atoi(value) : 0;
+}
+
+
+/*
+ *  A responder that dies mid-request must fail the request and be restarted by the handler. The request is retried
+ *  once on another connection, so with every worker exiting the request fails with a gateway error. Later requests
+ *  must be serviced by new workers.
+ */
+static void restart(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    int         oldPids[8], count, pid, i, j, restarted;
+
+    for (count = 0; count < (int) (sizeof(oldPids) / sizeof(int)); count++) {
+        assert(simpleGet(gp, "/fcgi/test", 0));
+        oldPids[count] = getWorkerPid(gp);
+        assert(oldPids[count] > 0);
+    }
+
+    http = getHttp(gp);
+    assert(httpRequest(http, "GET", "/fcgi/test?exit") == 0);
+    assert(mprGetHttpCode(http) == 502);
+
+    restarted = 0;
+    for (i = 0; i < 20 && !restarted; i++) {
+        mprSleep(gp, 250);
+        assert(simpleGet(gp, "/fcgi/test", 0));
+        assert(match(gp, "REQUEST_METHOD", "GET"));
+        pid = getWorkerPid(gp);
+        assert(pid > 0);
+        for (restarted = 1, j = 0; j < count; j++) {
+            if (pid == oldPids[j]) {
+                restarted = 0;
+            }
+        }
+    }
+    assert(restarted);
+}
+
+
+MprTestDef testFastCgi = {
+    "fastcgi", 0, 0, 0,
+    {
+        MPR_TEST(0, basic),
+        MPR_TEST(0, queryString),
+        MPR_TEST(0, persistent),
+        MPR_TEST(0, post),
+        MPR_TEST(0, bulkOutput),
+        MPR_TEST(0, bulkInput),
+        MPR_TEST(0, restart),
+        MPR_TEST(0, 0),
+    },
+};
+
+
+#if BLD_FEATURE_PROXY
+/*
+ *  The test server proxies /proxy/ to itself, so the same tests are run through the proxy
+ */
+static int initProxy(MprTestGroup *gp)
+{
+    gp->data = "/proxy";
+    return 0;
+}
+
+
+MprTestDef testProxyFastCgi = {
+    "fastcgi", 0, initProxy, 0,
+    {
+        MPR_TEST(0, basic),
+        MPR_TEST(0, queryString),
+        MPR_TEST(0, persistent),
+        MPR_TEST(0, post),
+        MPR_TEST(0, bulkOutput),
+        MPR_TEST(0, bulkInput),
+        MPR_TEST(0, 0),
+    },
+};
+#endif /* BLD_FEATURE_PROXY */
+#endif /* BLD_FEATURE_FASTCGI */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -23,6 +23,43 @@ static void dir(MprTestGroup *gp)
 }
 
 
+static void listing(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    cchar       *content;
+
+    http = getHttp(gp);
+
+    assert(httpRequest(http, "GET", "/listing/?C=N;O=A") == 0);
+    assert(mprGetHttpCode(http) == 200);
+    content = mprGetHttpContent(http);
+    assert(content != 0);
+    if (content) {
+        assert(strstr(content, "alpha.txt") != 0);
+        assert(strstr(content, "alpha.txt") < strstr(content, "beta.txt"));
+        assert(strstr(content, "beta.txt") < strstr(content, "gamma.txt"));
+    }
+
+    /*
+     *  Descending order and a page with only the middle item
+     */
+    assert(httpRequest(http, "GET", "/listing/?C=N;O=D") == 0);
+    content = mprGetHttpContent(http);
+    assert(content != 0 && strstr(content, "gamma.txt") < strstr(content, "alpha.txt"));
+
+    assert(httpRequest(http, "GET", "/listing/?C=N;O=A;start=1;count=1") == 0);
+    assert(mprGetHttpCode(http) == 200);
+    content = mprGetHttpContent(http);
+    assert(content != 0);
+    if (content) {
+        assert(strstr(content, "alpha.txt") == 0);
+        assert(strstr(content, "beta.txt") != 0);
+        assert(strstr(content, "gamma.txt") == 0);
+        assert(strstr(content, "start=2;count=1") != 0);
+    }
+}
+
+
 static void alias(MprTestGroup *gp)
 {
     assert(simpleGet(gp, "/AliasForMyDocuments/index.html", 0));
@@ -60,6 +97,7 @@ MprTestDef testGet = {
     {
         MPR_TEST(0, basic),
         MPR_TEST(0, dir),
+        MPR_TEST(0, listing),
         MPR_TEST(0, alias),
         MPR_TEST(0, query),
         MPR_TEST(0, withCustomHeader),
@@ -55,6 +55,164 @@ static void large(MprTestGroup *gp)
 }
 
 
+/*
+ *  A streamed body larger than LimitRequestBody is written to the file as it arrives
+ */
+static void streamedPut(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    char        *body;
+    int         size, code;
+
+    http = getHttp(gp);
+    size = 16 * 1024 * 1024;
+    body = (char*) mprAlloc(gp, size);
+    assert(body != 0);
+    memset(body, 'a', size);
+
+    mprSetHttpBody(http, body, size);
+    assert(httpRequest(http, "PUT", "/stream/streamedPut.dat") == 0);
+    code = mprGetHttpCode(http);
+    assert(code == 201 || code == 204);
+    mprFree(body);
+
+    assert(httpRequest(http, "GET", "/stream/streamedPut.dat") == 0);
+    assert(mprGetHttpCode(http) == 200);
+    assert(mprGetHttpContentLength(http) == size);
+
+    /*
+     *  Replacing the document must leave only the new content
+     */
+    mprSetHttpBody(http, "Hello World", 11);
+    assert(httpRequest(http, "PUT", "/stream/streamedPut.dat") == 0);
+    assert(mprGetHttpCode(http) == 204);
+    assert(httpRequest(http, "GET", "/stream/streamedPut.dat") == 0);
+    assert(mprGetHttpCode(http) == 200);
+    assert(mprGetHttpContentLength(http) == 11);
+
+    assert(httpRequest(http, "DELETE", "/stream/streamedPut.dat") == 0);
+    assert(mprGetHttpCode(http) == 204);
+}
+
+
+/*
+ *  Open a raw PUT request and write the headers and the first part of the body
+ */
+static MprSocket *openPut(MprTestGroup *gp, cchar *uri, cchar *body, int length, int first)
+{
+    MprSocket   *sp;
+    char        *headers;
+    int         len, rc;
+
+    if ((sp = mprCreateSocket(gp, NULL)) == 0) {
+        return 0;
+    }
+    if (mprOpenClientSocket(sp, "127.0.0.1", getDefaultPort(gp), MPR_SOCKET_BLOCK) < 0) {
+        mprFree(sp);
+        return 0;
+    }
+    len = mprAllocSprintf(gp, &headers, -1, 
+        "PUT %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\nContent-Length: %d\r\n\r\n", uri, length);
+    rc = mprWriteSocket(sp, headers, len);
+    mprFree(headers);
+    if (rc != len || mprWriteSocket(sp, (char*) body, first) != first) {
+        mprFree(sp);
+        return 0;
+    }
+    return sp;
+}
+
+
+/*
+ *  Body data that arrives after the headers is spliced from the socket to the file. Send the body in pieces so the 
+ *  document is assembled from both the buffered data that came with the headers and the spliced data.
+ */
+static void splicedPut(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    MprSocket   *sp;
+    MprBuf      *buf;
+    cchar       *content;
+    char        *body;
+    int         i, size, offset, len;
+
+    size = 256 * 1024;
+    body = (char*) mprAlloc(gp, size + 1);
+    assert(body != 0);
+    for (i = 0; i < size; i++) {
+        body[i] = 'a' + (i % 251) % 26;
+    }
+    body[size] = '\0';
+
+    sp = openPut(gp, "/stream/splicedPut.dat", body, size, 1000);
+    assert(sp != 0);
+    if (sp == 0) {
+        mprFree(body);
+        return;
+    }
+    for (offset = 1000; offset < size; offset += len) {
+        mprSleep(gp, 5);
+        len = min(size - offset, 32 * 1024);
+        if (mprWriteSocket(sp, &body[offset], len) != len) {
+            break;
+        }
+    }
+    assert(offset == size);
+    buf = mprCreateBuf(gp, MPR_BUFSIZE, -1);
+    assert(readRawUntil(sp, buf, "\r\n\r\n") != 0);
+    assert(strstr(mprGetBufStart(buf), " 201 ") != 0 || strstr(mprGetBufStart(buf), " 204 ") != 0);
+    mprFree(buf);
+    mprFree(sp);
+
+    http = getHttp(gp);
+    assert(httpRequest(http, "GET", "/stream/splicedPut.dat") == 0);
+    assert(mprGetHttpCode(http) == 200);
+    assert(mprGetHttpContentLength(http) == size);
+    content = mprGetHttpContent(http);
+    assert(content != 0 && memcmp(content, body, size) == 0);
+    mprFree(body);
+
+    assert(httpRequest(http, "DELETE", "/stream/splicedPut.dat") == 0);
+    assert(mprGetHttpCode(http) == 204);
+}
+
+
+/*
+ *  A client that disconnects before sending the whole body must leave the existing document unchanged
+ */
+static void abortedPut(MprTestGroup *gp)
+{
+    MprHttp     *http;
+    MprSocket   *sp;
+    char        *body;
+    int         size;
+
+    http = getHttp(gp);
+    mprSetHttpBody(http, "Hello World", 11);
+    assert(httpRequest(http, "PUT", "/stream/abortedPut.txt") == 0);
+    assert(mprGetHttpCode(http) == 201 || mprGetHttpCode(http) == 204);
+
+    size = 1024 * 1024;
+    body = (char*) mprAlloc(gp, size / 4);
+    assert(body != 0);
+    memset(body, 'a', size / 4);
+    sp = openPut(gp, "/stream/abortedPut.txt", body, size, size / 4);
+    assert(sp != 0);
+    mprSleep(gp, 200);
+    mprFree(sp);
+    mprFree(body);
+    mprSleep(gp, 200);
+
+    assert(httpRequest(http, "GET", "/stream/abortedPut.txt") == 0);
+    assert(mprGetHttpCode(http) == 200);
+    assert(mprGetHttpContentLength(http) == 11);
+    assert(strcmp(mprGetHttpContent(http), "Hello World") == 0);
+
+    assert(httpRequest(http, "DELETE", "/stream/abortedPut.txt") == 0);
+    assert(mprGetHttpCode(http) == 204);
+}
+
+
 #if MANUAL
 static void bad(MprTestGroup *gp)
 {
@@ -81,6 +239,9 @@ MprTestDef testPost = {
         MPR_TEST(0, basic),
         MPR_TEST(0, medium),
         MPR_TEST(0, large),
+        MPR_TEST(0, streamedPut),
+        MPR_TEST(0, splicedPut),
+        MPR_TEST(0, abortedPut),
 #if MANUAL_ONLY
         MPR_TEST(0, bad),
 #endif
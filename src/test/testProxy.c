@@ -0,0 +1,331 @@
+/*
+ *  testProxy.c - Unit tests for the reverse proxy handler
+ *
+ *  The test server proxies /proxy/ to itself. The balancing tests play the part of the upstreams themselves
+ *  (see conf/modules/proxy.conf).
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "testAppweb.h"
+
+#if BLD_FEATURE_PROXY
+/********************************** Defines ***********************************/
+/*
+ *  Upstream ports configured in conf/modules/proxy.conf. The down port must not have a listener when the tests start.
+ */
+#define PROXY_DOWN_PORT     4099
+#define PROXY_LEAST_PORT1   4097
+#define PROXY_LEAST_PORT2   4098
+
+#define PROXY_TIMEOUT       5000        /* Msec to wait for the proxy to connect to a test upstream */
+
+/*********************************** Locals ***********************************/
+
+#if BLD_FEATURE_FASTCGI
+extern MprTestDef testProxyFastCgi;
+#endif
+
+static MprTestDef *groups[] = {
+#if BLD_FEATURE_FASTCGI
+    &testProxyFastCgi,
+#endif
+    0
+};
+
+/************************************ Code ************************************/
+
+static void basic(MprTestGroup *gp)
+{
+    int     length;
+
+    assert(simpleGet(gp, "/index.html", 0));
+    length = mprGetHttpContentLength(getHttp(gp));
+
+    assert(simpleGet(gp, "/proxy/index.html", 0));
+    assert(mprGetHttpContentLength(getHttp(gp)) == length);
+}
+
+
+static void notFound(MprTestGroup *gp)
+{
+    assert(simpleGet(gp, "/proxy/doesNotExist.html", 404));
+}
+
+
+/*
+ *  Successive requests should reuse the pooled upstream connections
+ */
+static void persistent(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 20; i++) {
+        assert(simpleGet(gp, "/proxy/index.html", 0));
+    }
+}
+
+
+/*
+ *  Listen on a local port to act as an upstream. Return the socket or -1 on errors.
+ */
+static int listenUpstream(int port)
+{
+    struct sockaddr_in  addr;
+    int                 fd, on;
+
+    if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+        return -1;
+    }
+    on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*) &on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+/*
+ *  Wait for the proxy to connect to one of the listening upstreams. Return the accepted socket and the index of the
+ *  upstream, or -1 if no connection arrives within the timeout.
+ */
+static int acceptUpstream(int *listeners, int count, int timeout, int *index)
+{
+    struct timeval  tv;
+    fd_set          readFds;
+    int             i, maxFd;
+
+    FD_ZERO(&readFds);
+    for (maxFd = i = 0; i < count; i++) {
+        FD_SET(listeners[i], &readFds);
+        maxFd = max(maxFd, listeners[i]);
+    }
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
+    if (select(maxFd + 1, &readFds, 0, 0, &tv) <= 0) {
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (FD_ISSET(listeners[i], &readFds)) {
+            *index = i;
+            return accept(listeners[i], 0, 0);
+        }
+    }
+    return -1;
+}
+
+
+/*
+ *  Read a request on an upstream connection and send a complete response
+ */
+static bool respondUpstream(int fd)
+{
+    char    buf[MPR_BUFSIZE], *response;
+    int     len, nbytes;
+
+    for (len = 0; len < (int) sizeof(buf) - 1; len += nbytes) {
+        if ((nbytes = read(fd, &buf[len], sizeof(buf) - len - 1)) <= 0) {
+            return 0;
+        }
+        buf[len + nbytes] = '\0';
+        if (strstr(buf, "\r\n\r\n")) {
+            break;
+        }
+    }
+    response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok";
+    len = (int) strlen(response);
+    return write(fd, response, len) == len;
+}
+
+
+/*
+ *  Read the response to a raw request and test it succeeded
+ */
+static bool readResponse(MprTestGroup *gp, MprSocket *sp, cchar *expect)
+{
+    MprBuf      *buf;
+    bool        success;
+
+    buf = mprCreateBuf(gp, MPR_BUFSIZE, -1);
+    success = readRawUntil(sp, buf, "\r\n\r\n") != 0 && strncmp(mprGetBufStart(buf), "HTTP/1.1 200", 12) == 0;
+    if (success && expect) {
+        success = readRawUntil(sp, buf, expect) != 0;
+    }
+    mprFree(buf);
+    return success;
+}
+
+
+/*
+ *  One of the balanced upstreams is down. Requests must be retried on the live upstream and the failed upstream taken
+ *  out of rotation. Once out of rotation, the proxy must not connect to it even if it is listening again.
+ */
+static void health(MprTestGroup *gp)
+{
+    MprSocket   *sp;
+    int         i, fd, listener, index;
+
+    for (i = 0; i < 10; i++) {
+        assert(simpleGet(gp, "/proxyBalance/index.html", 0));
+    }
+
+    listener = listenUpstream(PROXY_DOWN_PORT);
+    assert(listener >= 0);
+    if (listener < 0) {
+        return;
+    }
+    for (i = 0; i < 10; i++) {
+        sp = openRawRequest(gp, "GET", "/proxyBalance/index.html");
+        assert(sp != 0);
+        if (sp == 0) {
+            break;
+        }
+        fd = acceptUpstream(&listener, 1, 200, &index);
+        assert(fd < 0);
+        if (fd >= 0) {
+            /*
+             *  Closing the connection makes the proxy retry the request on the live upstream
+             */
+            close(fd);
+        }
+        assert(readResponse(gp, sp, 0));
+        mprFree(sp);
+    }
+    close(listener);
+}
+
+
+/*
+ *  With least-connections balancing, a request must go to the upstream with the fewest requests in progress. The 
+ *  upstream that completed its request is selected next even though round-robin would select the other.
+ */
+static void leastConnections(MprTestGroup *gp)
+{
+    MprSocket   *first, *second, *third;
+    int         listeners[2], fds[2], fd, index, busy, idle;
+
+    fds[0] = fds[1] = -1;
+    first = second = third = 0;
+
+    listeners[0] = listenUpstream(PROXY_LEAST_PORT1);
+    listeners[1] = listenUpstream(PROXY_LEAST_PORT2);
+    assert(listeners[0] >= 0 && listeners[1] >= 0);
+    if (listeners[0] < 0 || listeners[1] < 0) {
+        goto done;
+    }
+    /*
+     *  The first request is held by its upstream. The second must go to the other upstream.
+     */
+    first = openRawRequest(gp, "GET", "/proxyLeast/first");
+    fd = first ? acceptUpstream(listeners, 2, PROXY_TIMEOUT, &busy) : -1;
+    assert(fd >= 0);
+    if (fd < 0) {
+        goto done;
+    }
+    fds[busy] = fd;
+    idle = !busy;
+
+    second = openRawRequest(gp, "GET", "/proxyLeast/second");
+    fd = second ? acceptUpstream(listeners, 2, PROXY_TIMEOUT, &index) : -1;
+    assert(fd >= 0);
+    if (fd < 0) {
+        goto done;
+    }
+    fds[index] = fd;
+    assert(index == idle);
+    if (index != idle) {
+        goto done;
+    }
+    assert(respondUpstream(fds[idle]));
+    assert(readResponse(gp, second, "ok"));
+    close(fds[idle]);
+    fds[idle] = -1;
+
+    /*
+     *  The proxy closes its upstream connection after the response is sent to the client
+     */
+    mprSleep(gp, 200);
+
+    third = openRawRequest(gp, "GET", "/proxyLeast/third");
+    fd = third ? acceptUpstream(listeners, 2, PROXY_TIMEOUT, &index) : -1;
+    assert(fd >= 0);
+    if (fd < 0) {
+        goto done;
+    }
+    assert(index == idle);
+    if (index == idle) {
+        fds[idle] = fd;
+        assert(respondUpstream(fds[idle]));
+        assert(readResponse(gp, third, "ok"));
+    } else {
+        close(fd);
+    }
+    assert(respondUpstream(fds[busy]));
+    assert(readResponse(gp, first, "ok"));
+
+done:
+    mprFree(first);
+    mprFree(second);
+    mprFree(third);
+    for (index = 0; index < 2; index++) {
+        if (fds[index] >= 0) {
+            close(fds[index]);
+        }
+        if (listeners[index] >= 0) {
+            close(listeners[index]);
+        }
+    }
+}
+
+
+MprTestDef testProxy = {
+    "proxy", groups, 0, 0,
+    {
+        MPR_TEST(0, basic),
+        MPR_TEST(0, notFound),
+        MPR_TEST(0, persistent),
+        MPR_TEST(0, health),
+        MPR_TEST(0, leastConnections),
+        MPR_TEST(0, 0),
+    },
+};
+
+#endif /* BLD_FEATURE_PROXY */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -0,0 +1,313 @@
+/*
+ *  testSsl.c - Unit tests for SSL
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "testAppweb.h"
+
+#if BLD_FEATURE_SSL
+#if BLD_FEATURE_OPENSSL
+    #include    <openssl/ssl.h>
+#endif
+/********************************** Defines ***********************************/
+/*
+ *  We expect an SSL virtual host on the default port + 4 (see test.conf)
+ */
+#define SSL_PORT_OFFSET     4
+
+/*
+ *  Dynamic record sizing configured for the SSL virtual host by SSLDynamicRecords in test.conf
+ */
+#define SSL_SMALL_RECORD    1400
+#define SSL_RECORD_RAMP     16384
+#define SSL_MAX_RECORD      16384
+
+#define TLS_HEADER          5               /* Record header: type, version, length */
+#define TLS_APPLICATION     23              /* Application data record type */
+#define TLS_OVERHEAD        256             /* Max record expansion for the MAC, padding and explicit IV */
+#define TLS_MAX_CIPHERTEXT  (SSL_MAX_RECORD + 2048)
+
+/*********************************** Code *************************************/
+/*
+ *  Get a page over SSL using a new client so the handshake is not skipped by keep-alive
+ */
+static bool sslGet(MprTestGroup *gp, cchar *uri, cchar *expect)
+{
+    MprHttp     *http;
+    cchar       *content;
+    char        *url;
+    bool        success;
+
+    http = mprCreateHttp(gp);
+    mprAllocSprintf(gp, &url, -1, "https://127.0.0.1:%d%s", getDefaultPort(gp) + SSL_PORT_OFFSET, uri);
+
+    success = 0;
+    if (mprHttpRequest(http, "GET", url, 0) == 0 && mprGetHttpCode(http) == 200) {
+        content = mprGetHttpContent(http);
+        success = (content && strstr(content, expect) != 0);
+    }
+    mprFree(url);
+    mprFree(http);
+    return success;
+}
+
+
+static void get(MprTestGroup *gp)
+{
+    int     i;
+
+    for (i = 0; i < 5; i++) {
+        assert(sslGet(gp, "/index.html", "SSL Index Page"));
+    }
+}
+
+
+/*
+ *  Connections that have not sent their client hello are waiting for handshake I/O. They must not occupy the
+ *  handshake threads or the queue, so other clients can still complete their handshakes.
+ */
+static void pendingHandshakes(MprTestGroup *gp)
+{
+    MprSocket   *idle[8];
+    int         i, count;
+
+    for (count = 0; count < (int) (sizeof(idle) / sizeof(MprSocket*)); count++) {
+        if ((idle[count] = mprCreateSocket(gp, NULL)) == 0) {
+            break;
+        }
+        if (mprOpenClientSocket(idle[count], "127.0.0.1", getDefaultPort(gp) + SSL_PORT_OFFSET, 0) < 0) {
+            mprFree(idle[count]);
+            break;
+        }
+    }
+    assert(count > 0);
+
+    assert(sslGet(gp, "/index.html", "SSL Index Page"));
+
+    for (i = 0; i < count; i++) {
+        mprFree(idle[i]);
+    }
+
+    /*
+     *  Closing the idle connections fails their handshakes. The service must still be usable.
+     */
+    assert(sslGet(gp, "/index.html", "SSL Index Page"));
+}
+
+
+#if BLD_FEATURE_OPENSSL
+static bool readFully(MprSocket *sp, char *buf, int len)
+{
+    int     nbytes;
+
+    while (len > 0) {
+        if ((nbytes = mprReadSocket(sp, buf, len)) <= 0) {
+            return 0;
+        }
+        buf += nbytes;
+        len -= nbytes;
+    }
+    return 1;
+}
+
+
+/*
+ *  Read one TLS record. Return the record length including the header or 0 on errors and end of file.
+ */
+static int readRecord(MprSocket *sp, uchar *record)
+{
+    int     len;
+
+    if (!readFully(sp, (char*) record, TLS_HEADER)) {
+        return 0;
+    }
+    len = (record[3] << 8) | record[4];
+    if (len > TLS_MAX_CIPHERTEXT || !readFully(sp, (char*) &record[TLS_HEADER], len)) {
+        return 0;
+    }
+    return TLS_HEADER + len;
+}
+
+
+/*
+ *  Send any TLS output waiting in the write BIO
+ */
+static bool flushTls(MprSocket *sp, BIO *wbio)
+{
+    char    buf[MPR_BUFSIZE];
+    int     len;
+
+    while ((len = BIO_read(wbio, buf, sizeof(buf))) > 0) {
+        if (mprWriteSocket(sp, buf, len) != len) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ *  Get a page over a plain socket and run the TLS protocol through memory BIOs so the record boundaries the server 
+ *  chose can be seen. Return the count of application data records and store their ciphertext lengths.
+ */
+static int getRecordLengths(MprTestGroup *gp, cchar *uri, int *lengths, int max)
+{
+    SSL_CTX     *ctx;
+    SSL         *ssl;
+    BIO         *rbio, *wbio;
+    MprSocket   *sp;
+    uchar       *record;
+    char        buf[MPR_BUFSIZE], *request;
+    int         count, len, rc;
+
+    count = -1;
+    ctx = SSL_CTX_new(SSLv23_client_method());
+    ssl = SSL_new(ctx);
+    rbio = BIO_new(BIO_s_mem());
+    wbio = BIO_new(BIO_s_mem());
+    SSL_set_bio(ssl, rbio, wbio);
+    SSL_set_connect_state(ssl);
+    record = (uchar*) mprAlloc(gp, TLS_HEADER + TLS_MAX_CIPHERTEXT);
+
+    sp = mprCreateSocket(gp, NULL);
+    if (mprOpenClientSocket(sp, "127.0.0.1", getDefaultPort(gp) + SSL_PORT_OFFSET, MPR_SOCKET_BLOCK) < 0) {
+        goto done;
+    }
+    while ((rc = SSL_do_handshake(ssl)) != 1) {
+        if (!flushTls(sp, wbio) || SSL_get_error(ssl, rc) != SSL_ERROR_WANT_READ) {
+            goto done;
+        }
+        if ((len = readRecord(sp, record)) == 0) {
+            goto done;
+        }
+        BIO_write(rbio, record, len);
+    }
+    len = mprAllocSprintf(gp, &request, -1, "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n", uri);
+    rc = SSL_write(ssl, request, len);
+    mprFree(request);
+    if (rc != len || !flushTls(sp, wbio)) {
+        goto done;
+    }
+
+    /*
+     *  Read records until the server closes the connection
+     */
+    count = 0;
+    while (count < max && (len = readRecord(sp, record)) > 0) {
+        if (record[0] == TLS_APPLICATION) {
+            lengths[count++] = len - TLS_HEADER;
+        }
+        BIO_write(rbio, record, len);
+        while (SSL_read(ssl, buf, sizeof(buf)) > 0) ;
+    }
+
+done:
+    mprFree(sp);
+    mprFree(record);
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    return count;
+}
+
+
+/*
+ *  Write a text file of at least the given size
+ */
+static bool writeBigFile(MprTestGroup *gp, cchar *path, int size)
+{
+    MprFile     *file;
+    char        line[MPR_MAX_STRING];
+    int         i, len, written;
+
+    if ((file = mprOpen(gp, path, O_CREAT | O_TRUNC | O_WRONLY | O_BINARY, 0644)) == 0) {
+        return 0;
+    }
+    for (i = written = 0; written < size; i++) {
+        len = mprSprintf(line, sizeof(line), "line %05d 0123456789012345678901234567890123456789\n", i);
+        if (mprWrite(file, line, len) != len) {
+            mprFree(file);
+            return 0;
+        }
+        written += len;
+    }
+    mprFree(file);
+    return 1;
+}
+
+
+/*
+ *  A new connection must start with small records and ramp up to maximum size records. The page is generated in the
+ *  SSL host documents so it is several times the ramp up size.
+ */
+static void recordSizes(MprTestGroup *gp)
+{
+    int     lengths[256], count, i, rampBytes;
+
+    assert(writeBigFile(gp, "sslWeb/big.txt", SSL_RECORD_RAMP * 3));
+    count = getRecordLengths(gp, "/big.txt", lengths, sizeof(lengths) / sizeof(int));
+    mprDelete(gp, "sslWeb/big.txt");
+    assert(count > 0);
+    if (count <= 0) {
+        return;
+    }
+    assert(lengths[0] <= SSL_SMALL_RECORD + TLS_OVERHEAD);
+
+    rampBytes = 0;
+    for (i = 0; i < count && lengths[i] <= SSL_SMALL_RECORD + TLS_OVERHEAD; i++) {
+        rampBytes += lengths[i];
+    }
+    assert(rampBytes >= SSL_RECORD_RAMP);
+    assert(i < count);
+
+    for (; i < count; i++) {
+        assert(lengths[i] <= SSL_MAX_RECORD + TLS_OVERHEAD);
+    }
+}
+#endif /* BLD_FEATURE_OPENSSL */
+
+
+MprTestDef testSsl = {
+    "ssl", 0, 0, 0,
+    {
+        MPR_TEST(0, get),
+        MPR_TEST(0, pendingHandshakes),
+#if BLD_FEATURE_OPENSSL
+        MPR_TEST(0, recordSizes),
+#endif
+        MPR_TEST(0, 0),
+    },
+};
+#endif /* BLD_FEATURE_SSL */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -8,19 +8,18 @@
 
 #include    "testAppweb.h"
 
-#if BLD_FEATURE_UPLOAD && BLD_FEATURE_CGI && 0
-/*********************************** Code *************************************/
+#if BLD_FEATURE_UPLOAD
+/*********************************** Locals ***********************************/
 
-void quick(MprTestGroup *gp)
-{
-    /*
-     *  Test one medium sized upload
-     */
-    uploadFile(gp, 38000);
-}
+#define BOUNDARY    "----------upload-test-boundary"
 
+/*********************************** Forwards *********************************/
 
-void small(MprTestGroup *gp)
+static bool uploadFile(MprTestGroup *gp, cchar *uri, int size, int expectCode);
+
+/************************************ Code ************************************/
+
+static void small(MprTestGroup *gp)
 {
     int     size;
 
@@ -28,137 +27,155 @@ void small(MprTestGroup *gp)
      *  Test very small file uploads
      */
     for (size = 0; size < 8; size++) {
-        uploadFile(gp, size);
+        assert(uploadFile(gp, "/upload/upload.html", size, 200));
     }
 }
 
 
-void medium(MprTestGroup *gp)
+static void medium(MprTestGroup *gp)
 {
     int     size;
 
     /*
-     *  Test medium file uploads. Choose a value that is right at an important internal buffer boundary for the upload 
-     *  handler. This number is from internal (debugging) knowlege.
+     *  Test uploads that straddle the handler's 64K parse buffer so the boundary delimiter is split between buffers
      */
-    for (size = 3830; size < 3830 + 10; size++) {
-        uploadFile(gp, size);
+    for (size = (64 * 1024) - 160; size < (64 * 1024) + 16; size += 7) {
+        assert(uploadFile(gp, "/upload/upload.html", size, 200));
     }
 }
 
 
-void large(MprTestGroup *gp)
+static void large(MprTestGroup *gp)
 {
-    int     i, size;
+    int     i;
 
-    /*
-     *  Test medium file uploads. Choose a value that is right at an important internal buffer boundary for the upload 
-     *  handler. This number is from internal (debugging) knowlege.
-     */
-    for (i = 1; i < 8; i++) {
-        size = (512 << (i - 1));
-        uploadFile(gp, size);
+    for (i = 1; i < 6; i++) {
+        assert(uploadFile(gp, "/upload/upload.html", (64 * 1024) << i, 200));
     }
 }
 
 
-void huge(MprTestGroup *gp)
+static void badBoundary(MprTestGroup *gp)
 {
-    int     i, size;
+    MprHttp     *http;
+    char        *body;
+
+    http = getHttp(gp);
+    body = "--wrong\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\nb\r\n--wrong--\r\n";
+
+    mprSetHttpHeader(http, "Content-Type", "multipart/form-data; boundary=" BOUNDARY, 1);
+    mprSetHttpBody(http, body, (int) strlen(body));
+    assert(httpRequest(http, "POST", "/upload/upload.html") == 0);
+    assert(mprGetHttpCode(http) == 400);
 
     /*
-     *  Test medium file uploads. Choose a value that is right at an important internal buffer boundary for the 
-     *  upload handler. This number is from internal (debugging) knowlege.
+     *  Missing boundary
      */
-    for (i = 8; i < 14; i++) {
-        size = (512 << (i - 1));
-        uploadFile(gp, size);
-    }
+    mprSetHttpHeader(http, "Content-Type", "multipart/form-data", 1);
+    mprSetHttpBody(http, body, (int) strlen(body));
+    assert(httpRequest(http, "POST", "/upload/upload.html") == 0);
+    assert(mprGetHttpCode(http) == 400);
 }
 
 
-int uploadFile(MprTestGroup *gp, int size)
+/*
+ *  Synchronized uploads complete the response once the files are on disk
+ */
+static void syncModes(MprTestGroup *gp)
 {
-#if UNUSED
-    MprCmd  *run;
-    char    cmd[MPR_MAX_FNAME];
-    char    *path;
-    int     rc, status;
-
-    path = "/tmp/uploadData";
-    if (makeTestFile(gp, path, size) < 0) {
-        return MPR_ERR_CANT_CREATE;
-    }
+    int     i;
 
-#if WIN
-{
-    char cwd[MPR_MAX_FNAME], pathBuf[MPR_MAX_FNAME];
-    getcwd(pathBuf, sizeof(pathBuf));
-    mprGetFullPathName(cwd, sizeof(cwd), pathBuf);
-    mprSprintf(cmd, sizeof(cmd), "PATH=%s;../../winTools", cwd);
-    rc = putenv(cmd);
-
-    mprSprintf(cmd, sizeof(cmd), "../../winTools/bash %s/unitTestUpload.sh %s", 
-        cwd, path);
-}
-#else
-    mprSprintf(cmd, sizeof(cmd), "/bin/bash ./unitTestUpload.sh %s", path);
-#endif
-
-    run = new MprCmd();
-    /* run->setCwd("."); */
-    /* rc = run->start(cmd, MPR_CMD_WAIT | MPR_CMD_CHDIR); */
-
-    rc = run->start(cmd, MPR_CMD_WAIT);
-    assert(rc == 0);
-    if (rc == 0) {
-        rc = run->getExitCode(&status);
-        assert(rc == 0);
-        assert(status == 0);
+    for (i = 0; i < 4; i++) {
+        assert(uploadFile(gp, "/uploadComplete/upload.html", (64 * 1024) << i, 200));
+        assert(uploadFile(gp, "/uploadStream/upload.html", (64 * 1024) << i, 200));
     }
-    gp->adjustTestCount(1, 1);
+    assert(uploadFile(gp, "/uploadComplete/upload.html", 0, 200));
+}
 
-    unlink(path);
-#endif
-    return 0;
+
+/*
+ *  A location upload directory must be used instead of the default
+ */
+static void locationDir(MprTestGroup *gp)
+{
+    assert(uploadFile(gp, "/uploadMissingDir/upload.html", 16, 500));
+    assert(uploadFile(gp, "/upload/upload.html", 16, 200));
 }
 
 
-int makeTestFile(MprTestGroup *gp, char *path, int size)
+/*
+ *  Upload a file of the given size with a form field before and after the file. The file content includes partial 
+ *  boundary strings to exercise the delimiter search.
+ */
+static bool uploadFile(MprTestGroup *gp, cchar *uri, int size, int expectCode)
 {
-    MprFile     file;
-    char        buf[512];
-    int         sofar, thisWrite, written, lineNumber, len;
+    MprHttp     *http;
+    MprBuf      *buf;
+    cchar       *content;
+    char        expected[MPR_MAX_STRING];
+    int         i, code;
+
+    http = getHttp(gp);
+    buf = mprCreateBuf(gp, size + MPR_BUFSIZE, -1);
+
+    mprPutStringToBuf(buf, "--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"name\"\r\n\r\nPeter\r\n");
+    mprPutStringToBuf(buf, "--" BOUNDARY "\r\n");
+    mprPutStringToBuf(buf, "Content-Disposition: form-data; name=\"file\"; filename=\"test.dat\"\r\n");
+    mprPutStringToBuf(buf, "Content-Type: application/octet-stream\r\n\r\n");
+    for (i = 0; i < size; i++) {
+        if ((i % 512) < 8) {
+            mprPutCharToBuf(buf, "\r\n--" BOUNDARY[i % 8]);
+        } else {
+            mprPutCharToBuf(buf, '0' + (i % 10));
+        }
+    }
+    mprPutStringToBuf(buf, "\r\n--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"address\"\r\n\r\nMulberry Lane\r\n");
+    mprPutStringToBuf(buf, "--" BOUNDARY "--\r\n");
+
+    mprSetHttpHeader(http, "Content-Type", "multipart/form-data; boundary=" BOUNDARY, 1);
+    mprSetHttpBody(http, mprGetBufStart(buf), mprGetBufLength(buf));
+    if (httpRequest(http, "POST", uri) < 0) {
+        mprFree(buf);
+        return 0;
+    }
+    mprFree(buf);
 
-    if (file.open(path, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0600) < 0) {
-        assert(0);
-        return MPR_ERR_CANT_OPEN;
+    code = mprGetHttpCode(http);
+    if (code != expectCode) {
+        mprLog(gp, 0, "Upload of %d bytes failed, response code: %d, msg %s\n", size, code, mprGetHttpMessage(http));
+        return 0;
     }
-    
-    sofar = 0;
-    lineNumber = 0;
-    while (sofar < size) {
-        len = mprSprintf(buf, sizeof(buf), 
-            "%05d - aaaaaaaaaa bbbbbbbbbb cccccccccc dddddddddd eeeeeeeeee\r\n",
-                lineNumber);
-        thisWrite = min(size - sofar, len);
-        written = file.write(buf, thisWrite);
-        if (written != thisWrite) {
-            assert(written == thisWrite);
-            return MPR_ERR_CANT_OPEN;
-        }
-        sofar += written;
-        lineNumber++;
+    if (code != 200) {
+        return 1;
     }
-    file.close();
-    return 0;
+    content = mprGetHttpContent(http);
+    mprSprintf(expected, sizeof(expected), "FILE file=test.dat SIZE=%d", size);
+    if (content == 0 || strstr(content, expected) == 0) {
+        mprLog(gp, 0, "Upload of %d bytes, bad response %s", size, content);
+        return 0;
+    }
+    return 1;
 }
 
-#else /* BLD_FEATURE_UPLOAD && BLD_FEATURE_CGI */
+
+MprTestDef testUpload = {
+    "upload", 0, 0, 0,
+    {
+        MPR_TEST(0, small),
+        MPR_TEST(0, medium),
+        MPR_TEST(0, large),
+        MPR_TEST(0, badBoundary),
+        MPR_TEST(0, syncModes),
+        MPR_TEST(0, locationDir),
+        MPR_TEST(0, 0),
+    },
+};
+
+#else /* BLD_FEATURE_UPLOAD */
 
 void mprTestUploadDummy() {}
 
-#endif /* BLD_FEATURE_UPLOAD && BLD_FEATURE_CGI */
+#endif /* BLD_FEATURE_UPLOAD */
 
 /*
  *  @copy   default
@@ -9,6 +9,7 @@
  *      cgiProgram [switches]
  *          -a                  Output the args (used for ISINDEX queries)
  *          -b bytes            Output content "bytes" long                 
+ *          -c bytes            Output content exactly "bytes" long with a Content-Length header
  *          -e                  Output the environment 
  *          -h lines            Output header "lines" long
  *          -l location         Output "location" header
@@ -55,7 +56,7 @@
 static int      getArgv(int *argc, char ***argv, int originalArgc, char **originalArgv);
 static int      hasError;
 static int      outputArgs, outputEnv, outputPost, outputQuery;
-static int      outputBytes, outputHeaderLines, responseStatus;
+static int      outputBytes, outputLength, outputHeaderLines, responseStatus;
 static int      nonParsedHeader;
 static char     *outputLocation;
 static char     *responseMsg;
@@ -85,6 +86,10 @@ static char     hex2Char(char* s);
 static char     *safeGetenv(char* key);
 static void     error(char *fmt, ...);
 static char     *getBaseName(char *name);
+#if !_WIN32 && !VXWORKS
+static int      readWarmEnv();
+extern char     **environ;
+#endif
 
 #if VXWORKS && _WRS_VXWORKS_MAJOR < 6
 #undef sleep
@@ -110,7 +115,7 @@ int main(int argc, char* argv[], char* envp[])
 
     err = 0;
     outputArgs = outputQuery = outputEnv = outputPost = 0;
-    outputBytes = outputHeaderLines = responseStatus = 0;
+    outputBytes = outputLength = outputHeaderLines = responseStatus = 0;
     outputLocation = 0;
     nonParsedHeader = 0;
     responseMsg = 0;
@@ -121,6 +126,18 @@ int main(int argc, char* argv[], char* envp[])
     originalArgc = argc;
     originalArgv = argv;
 
+#if !_WIN32 && !VXWORKS
+    if (getenv("CGI_WARM")) {
+        /*
+         *  Started in advance by the CGI handler. Wait for the request environment on stdin.
+         */
+        if (readWarmEnv() < 0) {
+            exit(255);
+        }
+        envp = environ;
+    }
+#endif
+
 #if _WIN32
     _setmode(0, O_BINARY);
     _setmode(1, O_BINARY);
@@ -153,6 +170,14 @@ int main(int argc, char* argv[], char* envp[])
                 }
                 break;
 
+            case 'c':
+                if (++i >= argc) {
+                    err = __LINE__;
+                } else {
+                    outputLength = atoi(argv[i]);
+                }
+                break;
+
             case 'e':
                 outputEnv++;
                 break;
@@ -212,7 +237,7 @@ int main(int argc, char* argv[], char* envp[])
         }
     }
     if (err) {
-        printf("usage: cgiProgram -aenp [-b bytes] [-h lines]\n"
+        printf("usage: cgiProgram -aenp [-b bytes] [-c bytes] [-h lines]\n"
             "\t[-l location] [-s status] [-t timeout]\n"
             "\tor set the HTTP_SWITCHES environment variable\n");
         printf("Error at cgiProgram:%d\n", __LINE__);
@@ -267,16 +292,24 @@ int main(int argc, char* argv[], char* envp[])
     if (responseStatus) {
         printf("Status: %d\r\n", responseStatus);
     }
+    if (outputLength) {
+        printf("Content-Length: %d\r\n", outputLength);
+    }
     printf("\r\n");
 
-    if ((outputBytes + outputArgs + outputEnv + outputQuery + outputPost + outputLocation + responseStatus) == 0) {
+    if ((outputBytes + outputLength + outputArgs + outputEnv + outputQuery + outputPost + outputLocation + responseStatus) == 0) {
         outputArgs++;
         outputEnv++;
         outputQuery++;
         outputPost++;
     }
 
-    if (outputBytes) {
+    if (outputLength) {
+        for (i = 1; i <= outputLength; i++) {
+            putchar((i % 64) ? ('0' + (i % 10)) : '\n');
+        }
+
+    } else if (outputBytes) {
         j = 0;
         for (i = 0; i < outputBytes; i++) {
             putchar('0' + j);
@@ -334,8 +367,9 @@ int main(int argc, char* argv[], char* envp[])
  */
 static int getArgv(int *pargc, char ***pargv, int originalArgc, char **originalArgv)
 {
-    char    *switches, *next, sbuf[1024];
-    int     i;
+    static char sbuf[1024];
+    char        *switches, *next;
+    int         i;
 
     *pargc = 0;
     if (getQueryString(&queryBuf, &queryLen) < 0) {
@@ -375,6 +409,42 @@ static int getArgv(int *pargc, char ***pargv, int originalArgc, char **originalA
 }
 
 
+#if !_WIN32 && !VXWORKS
+/*
+ *  Read the request environment written by the CGI handler to a warm process. This is a block of null terminated
+ *  "NAME=VALUE" strings ending with an empty string. Read a byte at a time so the request body is left on stdin.
+ */
+static int readWarmEnv()
+{
+    char    buf[4096], *cp;
+    int     len;
+
+    unsetenv("CGI_WARM");
+    len = 0;
+    while (1) {
+        if (read(0, &buf[len], 1) != 1) {
+            return -1;
+        }
+        if (buf[len] != '\0') {
+            if (++len >= (int) sizeof(buf)) {
+                return -1;
+            }
+            continue;
+        }
+        if (len == 0) {
+            break;
+        }
+        if ((cp = strdup(buf)) == 0) {
+            return -1;
+        }
+        putenv(cp);
+        len = 0;
+    }
+    return 0;
+}
+#endif
+
+
 static void printEnv(char **envp)
 {
     printf("<H2>Environment Variables</H2>\r\n");
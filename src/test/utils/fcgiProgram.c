@@ -0,0 +1,311 @@
+/*
+ *  fcgiProgram.c - Test FastCGI responder
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/*
+ *  Usage:
+ *      fcgiProgram
+ *
+ *  The responder is spawned by the FastCGI handler with a listening socket on file descriptor zero. It accepts
+ *  connections and services requests until killed. The response echoes the request parameters and body. The query
+ *  string may contain these commands:
+ *
+ *      bytes=N             Output N bytes of content
+ *      exit                Exit without responding. Used to test worker restarts.
+ */
+
+/********************************** Includes **********************************/
+
+#include "buildConfig.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#if BLD_UNIX_LIKE
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/*********************************** Locals ***********************************/
+
+#define FCGI_VERSION            1
+#define FCGI_HEADER_LEN         8
+#define FCGI_BEGIN_REQUEST      1
+#define FCGI_ABORT_REQUEST      2
+#define FCGI_END_REQUEST        3
+#define FCGI_PARAMS             4
+#define FCGI_STDIN              5
+#define FCGI_STDOUT             6
+#define FCGI_KEEP_CONN          1
+
+#define MAX_RECORD              65535
+#define MAX_PARAMS              (64 * 1024)
+#define MAX_BODY                (1024 * 1024)
+
+static int      keepConn;
+static char     params[MAX_PARAMS];
+static int      paramsLen;
+static char     *body;
+static int      bodyLen;
+
+/***************************** Forward Declarations ***************************/
+
+static int      readFully(int fd, char *buf, int len);
+static int      writeFully(int fd, char *buf, int len);
+static int      writeRecord(int fd, int type, char *buf, int len);
+static int      printf_fd(int fd, char *fmt, ...);
+static char     *getParam(char *name);
+static int      respond(int fd);
+
+/************************************ Code ************************************/
+
+int main(int argc, char *argv[])
+{
+    char    header[FCGI_HEADER_LEN], content[MAX_RECORD + 256];
+    int     fd, type, len, padding, done;
+
+    body = malloc(MAX_BODY);
+
+    while ((fd = accept(0, 0, 0)) >= 0 || errno == EINTR) {
+        if (fd < 0) {
+            continue;
+        }
+        keepConn = 1;
+        while (keepConn) {
+            paramsLen = bodyLen = 0;
+            for (done = 0; !done; ) {
+                if (readFully(fd, header, FCGI_HEADER_LEN) < 0) {
+                    keepConn = 0;
+                    break;
+                }
+                type = header[1];
+                len = ((header[4] & 0xFF) << 8) | (header[5] & 0xFF);
+                padding = header[6] & 0xFF;
+                if (readFully(fd, content, len + padding) < 0) {
+                    keepConn = 0;
+                    break;
+                }
+                switch (type) {
+                case FCGI_BEGIN_REQUEST:
+                    keepConn = content[2] & FCGI_KEEP_CONN;
+                    break;
+
+                case FCGI_PARAMS:
+                    if (len > 0 && (paramsLen + len) < MAX_PARAMS) {
+                        memcpy(&params[paramsLen], content, len);
+                        paramsLen += len;
+                    }
+                    break;
+
+                case FCGI_STDIN:
+                    if (len == 0) {
+                        done = 1;
+                    } else if ((bodyLen + len) < MAX_BODY) {
+                        memcpy(&body[bodyLen], content, len);
+                        bodyLen += len;
+                    }
+                    break;
+
+                case FCGI_ABORT_REQUEST:
+                    done = 1;
+                    break;
+                }
+            }
+            if (!done || respond(fd) < 0) {
+                break;
+            }
+        }
+        close(fd);
+    }
+    return 0;
+}
+
+
+static int respond(int fd)
+{
+    char    end[8], query[MAX_PARAMS], *cp;
+    int     bytes, i;
+
+    /*
+     *  getParam returns a static buffer, so the query must be copied
+     */
+    cp = getParam("QUERY_STRING");
+    strncpy(query, cp ? cp : "", sizeof(query) - 1);
+    query[sizeof(query) - 1] = '\0';
+    if (strcmp(query, "exit") == 0) {
+        exit(2);
+    }
+    bytes = 0;
+    if ((cp = strstr(query, "bytes=")) != 0) {
+        bytes = atoi(&cp[6]);
+    }
+
+    printf_fd(fd, "Content-Type: text/html\r\n\r\n");
+    printf_fd(fd, "<HTML><BODY>\r\n");
+    printf_fd(fd, "<P>PID=%d</P>\r\n", getpid());
+    printf_fd(fd, "<P>REQUEST_METHOD=%s</P>\r\n", getParam("REQUEST_METHOD"));
+    printf_fd(fd, "<P>SCRIPT_NAME=%s</P>\r\n", getParam("SCRIPT_NAME"));
+    printf_fd(fd, "<P>QUERY_STRING=%s</P>\r\n", query);
+    printf_fd(fd, "<P>BODY_LENGTH=%d</P>\r\n", bodyLen);
+    for (i = 0; i < bodyLen; i += MAX_RECORD) {
+        if (writeRecord(fd, FCGI_STDOUT, &body[i], (bodyLen - i) < MAX_RECORD ? (bodyLen - i) : MAX_RECORD) < 0) {
+            return -1;
+        }
+    }
+    for (i = 0; i < bytes; i += 64) {
+        if (writeRecord(fd, FCGI_STDOUT, "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ\n",
+                (bytes - i) < 64 ? (bytes - i) : 64) < 0) {
+            return -1;
+        }
+    }
+    if (printf_fd(fd, "</BODY></HTML>\r\n") < 0 || writeRecord(fd, FCGI_STDOUT, 0, 0) < 0) {
+        return -1;
+    }
+    memset(end, 0, sizeof(end));
+    return writeRecord(fd, FCGI_END_REQUEST, end, sizeof(end));
+}
+
+
+/*
+ *  Find a name/value parameter. Lengths over 127 bytes use a four byte encoding.
+ */
+static char *getParam(char *name)
+{
+    static char value[MAX_PARAMS];
+    unsigned char *cp, *end;
+    int         nameLen, valueLen;
+
+    cp = (unsigned char*) params;
+    end = (unsigned char*) &params[paramsLen];
+    while (cp < end) {
+        if (*cp & 0x80) {
+            nameLen = ((cp[0] & 0x7F) << 24) | (cp[1] << 16) | (cp[2] << 8) | cp[3];
+            cp += 4;
+        } else {
+            nameLen = *cp++;
+        }
+        if (*cp & 0x80) {
+            valueLen = ((cp[0] & 0x7F) << 24) | (cp[1] << 16) | (cp[2] << 8) | cp[3];
+            cp += 4;
+        } else {
+            valueLen = *cp++;
+        }
+        if (nameLen == (int) strlen(name) && strncmp((char*) cp, name, nameLen) == 0) {
+            memcpy(value, &cp[nameLen], valueLen);
+            value[valueLen] = '\0';
+            return value;
+        }
+        cp += nameLen + valueLen;
+    }
+    return 0;
+}
+
+
+static int printf_fd(int fd, char *fmt, ...)
+{
+    va_list     args;
+    char        buf[4096];
+    int         len;
+
+    va_start(args, fmt);
+    len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return writeRecord(fd, FCGI_STDOUT, buf, len);
+}
+
+
+static int writeRecord(int fd, int type, char *buf, int len)
+{
+    char    header[FCGI_HEADER_LEN];
+
+    header[0] = FCGI_VERSION;
+    header[1] = type;
+    header[2] = 0;
+    header[3] = 1;
+    header[4] = (len >> 8) & 0xFF;
+    header[5] = len & 0xFF;
+    header[6] = 0;
+    header[7] = 0;
+    if (writeFully(fd, header, FCGI_HEADER_LEN) < 0) {
+        return -1;
+    }
+    return writeFully(fd, buf, len);
+}
+
+
+static int readFully(int fd, char *buf, int len)
+{
+    int     nbytes;
+
+    while (len > 0) {
+        if ((nbytes = read(fd, buf, len)) <= 0) {
+            if (nbytes < 0 && errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buf += nbytes;
+        len -= nbytes;
+    }
+    return 0;
+}
+
+
+static int writeFully(int fd, char *buf, int len)
+{
+    int     nbytes;
+
+    while (len > 0) {
+        if ((nbytes = write(fd, buf, len)) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buf += nbytes;
+        len -= nbytes;
+    }
+    return 0;
+}
+
+#else
+int main(int argc, char *argv[])
+{
+    fprintf(stderr, "fcgiProgram: not supported on this platform\n");
+    return 1;
+}
+#endif /* BLD_UNIX_LIKE */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -0,0 +1,15 @@
+/*
+ *  Test.es - Controller for the statics unit test in testEjs.c
+ */
+
+public class TestController extends Controller {
+
+    static var hits: Number = 0
+
+    use namespace action
+
+    action function index() {
+        hits++
+        render("hits=" + hits + ",")
+    }
+}